@@ -124,6 +124,30 @@ ce_event_cb(clicon_handle h,
     return 0;
 }
 
+/*! Stream callback for replayed events as strings
+ *
+ * @param[in]  h     Clicon handle
+ * @param[in]  event Event as XML string
+ * @param[in]  arg   Extra argument provided in stream_ss_add
+ * @see ce_event_cb  For events as XML
+ */
+static int
+ce_event_str_cb(clicon_handle h,
+                char         *event,
+                void         *arg)
+{
+    struct client_entry *ce = (struct client_entry *)arg;
+
+    if (send_msg_notify(ce->ce_s, event) < 0){
+        if (errno == ECONNRESET || errno == EPIPE)
+            clicon_log(LOG_WARNING, "client %d reset", ce->ce_nr);
+        return 0;
+    }
+    ce->ce_out_notifications++;
+    netconf_monitoring_counter_inc(h, "out-notifications");
+    return 0;
+}
+
 /*! Unlock all db:s of a client and call user unlock calback 
  * @see xmldb_unlock_all  unlocks, but does not call user callbacks which is a backend thing
  */
@@ -1069,6 +1093,7 @@ from_client_create_subscription(clicon_handle h,
     struct timeval       start;
     struct timeval       stop;
     cvec                *nsc = NULL;
+    struct stream_subscription *ss;
     
     /* XXX should use prefix cf edit_config */
     if ((nsc = xml_nsctx_init(NULL, EVENT_RFC5277_NAMESPACE)) == NULL)
@@ -1109,10 +1134,12 @@ from_client_create_subscription(clicon_handle h,
         goto ok;
     }
     /* Add subscriber to stream - to make notifications for this client */
-    if (stream_ss_add(h, stream, selector,
-                      starttime?&start:NULL, stoptime?&stop:NULL,
-                      ce_event_cb, (void*)ce) < 0)
+    if ((ss = stream_ss_add(h, stream, selector,
+                            starttime?&start:NULL, stoptime?&stop:NULL,
+                            ce_event_cb, (void*)ce)) == NULL)
         goto done;
+    /* Replayed events are sent as stored, without parsing */
+    ss->ss_strfn = ce_event_str_cb;
     /* Replay of this stream to specific subscription according to start and 
      * stop (if present). 
      * RFC 5277: If <startTime> is not present, this is not a replay
@@ -1330,6 +1357,8 @@ from_client_stats(clicon_handle h,
 {
     int        retval = -1;
     uint64_t   nr;
+    uint64_t   hits;
+    uint64_t   misses;
     yang_stmt *ym;
     
     cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
@@ -1341,6 +1370,10 @@ from_client_stats(clicon_handle h,
     nr=0;
     yang_stats_global(&nr);
     cprintf(cbret, "<yangnr>%" PRIu64 "</yangnr>", nr);
+    xpath_cache_stats(&nr, &hits, &misses);
+    cprintf(cbret, "<xpathnr>%" PRIu64 "</xpathnr>", nr);
+    cprintf(cbret, "<xpathhits>%" PRIu64 "</xpathhits>", hits);
+    cprintf(cbret, "<xpathmisses>%" PRIu64 "</xpathmisses>", misses);
     cprintf(cbret, "</global>");
     if (clixon_stats_datastore_get(h, "running", cbret) < 0)
         goto done;
@@ -1534,6 +1567,7 @@ from_client_msg(clicon_handle        h,
     
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
     yspec = clicon_dbspec_yang(h); 
+    ce->ce_reply_sent = 0;
     /* Return netconf message. Should be filled in by the dispatch(sub) functions 
      * as wither rpc-error or by positive response.
      */
@@ -1719,6 +1753,10 @@ from_client_msg(clicon_handle        h,
         }
     } /* while */
  reply:
+    if (ce->ce_reply_sent){ /* Written in chunks, eg by get_nacm_and_reply */
+        ce->ce_reply_sent = 0;
+        goto ok;
+    }
     if (cbuf_len(cbret) == 0)
         if (netconf_operation_failed(cbret, "application", clicon_errno?clicon_err_reason:"unknown")< 0)
             goto done;
@@ -1742,7 +1780,7 @@ from_client_msg(clicon_handle        h,
             goto done;
         }
     }
-    // ok:
+ ok:
     retval = 0;
   done:  
     clicon_debug(CLIXON_DBG_DETAIL, "%s retval:%d", __FUNCTION__, retval);
@@ -1779,6 +1817,7 @@ from_client(int   s,
     int                  retval = -1;
     struct clicon_msg   *msg = NULL;
     struct client_entry *ce = (struct client_entry *)arg;
+    struct client_entry *c;
     clicon_handle        h = ce->ce_handle;
     int                  eof = 0;
 
@@ -1787,20 +1826,30 @@ from_client(int   s,
         clicon_err(OE_NETCONF, EINVAL, "Internal error: s != ce->ce_s");
         goto done;
     }
-    if (clicon_msg_rcv(ce->ce_s, 0, &msg, &eof) < 0)
+    /* Non-blocking read into per-client buffer, may contain several messages */
+    if (clicon_msg_rcv_buf(ce->ce_s, ce->ce_rbuf, &eof) < 0)
         goto done;
+    while (!eof){
+        /* msg points into ce_rbuf, no free */
+        if (clicon_msg_rcv_next(ce->ce_rbuf, &msg, &eof) < 0)
+            goto done;
+        if (msg == NULL)
+            break;
+        if (from_client_msg(h, ce, msg) < 0)
+            goto done;
+        /* Client may have been removed by the rpc, eg kill-session */
+        for (c = backend_client_list(h); c && c != ce; c = c->ce_next);
+        if (c == NULL || ce->ce_s != s)
+            goto ok;
+    }
     if (eof){
         backend_client_rm(h, ce); 
         netconf_monitoring_counter_inc(h, "dropped-sessions");
     }
-    else
-        if (from_client_msg(h, ce, msg) < 0)
-            goto done;
+ ok:
     retval = 0;
   done:
     clicon_debug(CLIXON_DBG_DETAIL, "%s retval=%d", __FUNCTION__, retval);
-    if (msg)
-        free(msg);
     return retval; /* -1 here terminates backend */
 }
 
@@ -96,29 +96,30 @@ generic_validate(clicon_handle       h,
                  cxobj             **xret)
 {
     int        retval = -1;
-    cxobj     *x2;
+    cxobj    **vec = NULL;
+    int        veclen;
+    int        nproc;
     int        i;
     int        ret;
-    cbuf      *cb = NULL;
 
+    nproc = clicon_option_int(h, "CLICON_VALIDATE_PROCESSES");
     /* All entries */
-    if ((ret = xml_yang_validate_all_top(h, td->td_target, xret)) < 0) 
+    if ((ret = xml_yang_validate_all_parallel(h, td->td_target, nproc, xret)) < 0) 
         goto done;
     if (ret == 0)
         goto fail;
-    /* changed entries */
-    for (i=0; i<td->td_clen; i++){
-        x2 = td->td_tcvec[i]; /* target changed */
-        /* Should this be recursive? */
-        if ((ret = xml_yang_validate_add(h, x2, xret)) < 0)
+    /* Changed entries, then added entries */
+    veclen = td->td_clen + td->td_alen;
+    if (veclen){
+        if ((vec = calloc(veclen, sizeof(cxobj *))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
             goto done;
-        if (ret == 0)
-            goto fail;
-    }
-    /* added entries */
-    for (i=0; i<td->td_alen; i++){
-        x2 = td->td_avec[i];
-        if ((ret = xml_yang_validate_add(h, x2, xret)) < 0)
+        }
+        for (i=0; i<td->td_clen; i++)
+            vec[i] = td->td_tcvec[i]; /* target changed */
+        for (i=0; i<td->td_alen; i++)
+            vec[td->td_clen+i] = td->td_avec[i];
+        if ((ret = xml_yang_validate_add_parallel(h, vec, veclen, nproc, xret)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
@@ -126,8 +127,8 @@ generic_validate(clicon_handle       h,
     // ok:
     retval = 1;
  done:
-    if (cb)
-        cbuf_free(cb);
+    if (vec)
+        free(vec);
     return retval;
  fail:
     retval = 0;
@@ -181,6 +182,12 @@ startup_common(clicon_handle       h,
     /* Get the startup datastore WITHOUT binding to YANG, sorting and default setting. 
      * It is done below, later in this function
      */
+    /* The tree is upgraded in place below, do not modify a cache shared with running */
+    if (xmldb_cache_unshare(h, db) < 0)
+        goto done;
+    /* The upgrade is not marked in the tree, see xml_diff_dirty */
+    if (xmldb_dirty_reset(h) < 0)
+        goto done;
     if (clicon_option_bool(h, "CLICON_XMLDB_UPGRADE_CHECKOLD")){
         if ((ret = xmldb_get0(h, db, YB_MODULE, NULL, "/", 0, 0, &xt, msdiff, &xerr)) < 0)
             goto done;
@@ -509,16 +516,29 @@ validate_common(clicon_handle       h,
     /* Clear flags xpath for get */
     xml_apply0(td->td_src, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
                (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE));
-    /* 3. Compute differences */
-    if (xml_diff(td->td_src,
-                 td->td_target,
-                 &td->td_dvec,      /* removed: only in running */
-                 &td->td_dlen,
-                 &td->td_avec,      /* added: only in candidate */
-                 &td->td_alen,
-                 &td->td_scvec,     /* changed: original values */
-                 &td->td_tcvec,     /* changed: wanted values */
-                 &td->td_clen) < 0)
+    /* 3. Compute differences
+     * If edits of db since copied from running are marked, only compare those */
+    if (xmldb_dirty_get(h, db)){
+        if (xml_diff_dirty(td->td_src,
+                           td->td_target,
+                           &td->td_dvec,      /* removed: only in running */
+                           &td->td_dlen,
+                           &td->td_avec,      /* added: only in candidate */
+                           &td->td_alen,
+                           &td->td_scvec,     /* changed: original values */
+                           &td->td_tcvec,     /* changed: wanted values */
+                           &td->td_clen) < 0)
+            goto done;
+    }
+    else if (xml_diff(td->td_src,
+                      td->td_target,
+                      &td->td_dvec,      /* removed: only in running */
+                      &td->td_dlen,
+                      &td->td_avec,      /* added: only in candidate */
+                      &td->td_alen,
+                      &td->td_scvec,     /* changed: original values */
+                      &td->td_tcvec,     /* changed: wanted values */
+                      &td->td_clen) < 0)
         goto done;
     transaction_dbg(h, CLIXON_DBG_DETAIL, td, __FUNCTION__);
     /* Mark as changed in tree */
@@ -738,6 +758,10 @@ candidate_commit(clicon_handle h,
 
     /* 9. Call plugin transaction end callbacks */
     plugin_transaction_end_all(h, td);
+
+    /* State data may depend on running */
+    if (clixon_statedata_cache_flush(h) < 0)
+        goto done;
     
     retval = 1;
  done:
@@ -180,6 +180,7 @@ client_get_streams(clicon_handle   h,
  * @param[in]     xpath   XPath selection, may be used to filter early
  * @param[in]     nsc     XML Namespace context for xpath
  * @param[in]     wdef    With-defaults parameter, see RFC 6243
+ * @param[in]     content Get config/state/both
  * @param[in,out] xret    Existing XML tree, merge x into this, or rpc-error
  * @retval        1       OK
  * @retval        0       Statedata callback failed (error in xret)
@@ -202,6 +203,7 @@ get_statedata(clicon_handle     h,
               char             *xpath,
               cvec             *nsc,
               withdefaults_type wdef,
+              netconf_content   content,
               cxobj           **xret)
 {
     int        retval = -1;
@@ -310,7 +312,7 @@ get_statedata(clicon_handle     h,
         }
     }
     /* Use plugin state callbacks */
-    if ((ret = clixon_plugin_statedata_all(h, yspec, nsc, xpath, wdef, xret)) < 0)
+    if ((ret = clixon_plugin_statedata_all(h, yspec, nsc, xpath, wdef, content, xret)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -437,9 +439,167 @@ filter_xpath_again(clicon_handle h,
     return retval;
 }
 
+/*! Remove the levels of a tree below depth, as when printing with depth
+ * @param[in]  x      XML tree
+ * @param[in]  depth  Nr of levels to keep, 1 is node itself
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+get_depth_prune(cxobj  *x,
+                int32_t depth)
+{
+    cxobj *xc;
+    cxobj *xprev;
+
+    xc = NULL;
+    xprev = NULL;
+    while ((xc = xml_child_each(x, xc, -1)) != NULL){
+        if (xml_type(xc) == CX_ATTR)
+            ;
+        else if (depth <= 1){
+            if (xml_purge(xc) < 0)
+                return -1;
+            xc = xprev;
+            continue;
+        }
+        else if (xml_type(xc) == CX_ELMNT &&
+                 get_depth_prune(xc, depth-1) < 0)
+            return -1;
+        xprev = xc;
+    }
+    return 0;
+}
+
+/*! Reply with data only, printed in XML or JSON as a RESTCONF data resource
+ *
+ * The reply is not a netconf rpc-reply, it is the data selected by xpath printed once in
+ * the requested format, so that a client can use it without parsing. Eg RESTCONF uses it
+ * as HTTP body. An empty reply means no data was selected by a non-root xpath.
+ * Errors are replied as before as <rpc-reply><rpc-error>.
+ * @param[in]  h        Clicon handle 
+ * @param[in]  ce       Client entry
+ * @param[in]  xret     Result XML tree, after NACM, or NULL
+ * @param[in]  xpath    XPath point to object to get
+ * @param[in]  nsc      Namespace context of xpath
+ * @param[in]  depth    Nr of levels to print, -1 is all, 0 is none
+ * @param[in]  format   FORMAT_XML or FORMAT_JSON
+ * @param[in]  pretty   Pretty-print
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see clicon_rpc_get_format
+ */
+static int
+get_reply_format(clicon_handle        h,
+                 struct client_entry *ce,
+                 cxobj               *xret,
+                 char                *xpath,
+                 cvec                *nsc,
+                 int32_t              depth,
+                 int                  format,
+                 int                  pretty)
+{
+    int        retval = -1;
+    cxobj     *xt = NULL;
+    cbuf      *cb = NULL;
+    cxobj    **xvec = NULL;
+    size_t     xlen;
+    cvec      *nscd = NULL;
+    yang_stmt *yspec;
+    int        i;
+
+    yspec = clicon_dbspec_yang(h);
+    if (xret == NULL){
+        if ((xt = xml_new(NETCONF_OUTPUT_DATA, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        xret = xt;
+    }
+    else if (xml_name_set(xret, NETCONF_OUTPUT_DATA) < 0)
+        goto done;
+    /* Top level is data, so add 1 to depth if significant */
+    if (depth >= 0 &&
+        get_depth_prune(xret, depth>0?depth+1:1) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (xpath == NULL || strcmp(xpath, "/") == 0){ /* Data root */
+        if (xml_bind_special(xret, yspec, "/nc:get/output/data") < 0)
+            goto done;
+        if (xmlns_set(xret, NULL, NETCONF_BASE_NAMESPACE) < 0)
+            goto done;
+        xml_sort(xret); /* Ensure attr is first */
+        switch (format){
+        case FORMAT_XML:
+            if (clixon_xml2cbuf(cb, xret, 0, pretty, -1, 0) < 0)
+                goto done;
+            break;
+        case FORMAT_JSON:
+            if (clixon_json2cbuf(cb, xret, pretty, 0, 0) < 0)
+                goto done;
+            break;
+        default:
+            break;
+        }
+    }
+    else{
+        if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath) < 0)
+            goto done;
+        switch (format){
+        case FORMAT_XML:
+            for (i=0; i<xlen; i++){
+                if (xml_nsctx_node(xvec[i], &nscd) < 0)
+                    goto done;
+                if (xmlns_set_all(xvec[i], nscd) < 0)
+                    goto done;
+                if (nscd){
+                    cvec_free(nscd);
+                    nscd = NULL;
+                }
+                if (clixon_xml2cbuf(cb, xvec[i], 0, pretty, -1, 0) < 0)
+                    goto done;
+            }
+            break;
+        case FORMAT_JSON:
+            if (xlen && xml2json_cbuf_vec(cb, xvec, xlen, pretty, 0) < 0)
+                goto done;
+            break;
+        default:
+            break;
+        }
+    }
+    if (send_msg_reply(ce->ce_s, cbuf_get(cb), cbuf_len(cb)+1) < 0){
+        switch (errno){
+        case EPIPE:     /* Client closed socket, see from_client_msg */
+        case ECONNRESET:
+            clicon_log(LOG_WARNING, "client rpc reset");
+            break;
+        default:
+            goto done;
+        }
+    }
+    ce->ce_reply_sent = 1;
+    retval = 0;
+ done:
+    if (nscd)
+        cvec_free(nscd);
+    if (xvec)
+        free(xvec);
+    if (cb)
+        cbuf_free(cb);
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
 /*! Help function for NACM access and returnmessage
  *
+ * A non-empty reply is not printed to cbret, it is written directly in chunks to the client
+ * socket, and ce_reply_sent is set. This avoids having the tree, the printed reply and the
+ * message copy in memory at the same time.
  * @param[in]  h        Clicon handle 
+ * @param[in]  ce       Client entry
  * @param[in]  xret     Result XML tree
  * @param[in]  xvec    xpath lookup result on xret
  * @param[in]  xlen    length of xvec
@@ -447,20 +607,26 @@ filter_xpath_again(clicon_handle h,
  * @param[in]  nsc      Namespace context of xpath
  * @param[in]  username User name for NACM access
  * @param[in]  depth    Nr of levels to print, -1 is all, 0 is none
+ * @param[in]  format   Reply with data only in FORMAT_XML or FORMAT_JSON, -1 for netconf reply
+ * @param[in]  pretty   Pretty-print data only reply
  * @param[out] cbret    Return xml tree, eg <rpc-reply>..., <rpc-error.. 
  * @retval     0        OK
  * @retval    -1        Error
+ * @see send_msg_reply_xml
  */
 static int
-get_nacm_and_reply(clicon_handle h,
-                   cxobj        *xret,
-                   cxobj       **xvec,
-                   size_t        xlen,
-                   char         *xpath,
-                   cvec         *nsc,
-                   char         *username,
-                   int32_t       depth,
-                   cbuf         *cbret)
+get_nacm_and_reply(clicon_handle        h,
+                   struct client_entry *ce,
+                   cxobj               *xret,
+                   cxobj              **xvec,
+                   size_t               xlen,
+                   char                *xpath,
+                   cvec                *nsc,
+                   char                *username,
+                   int32_t              depth,
+                   int                  format,
+                   int                  pretty,
+                   cbuf                *cbret)
 {
     int     retval = -1;
     cxobj  *xnacm = NULL;
@@ -472,6 +638,28 @@ get_nacm_and_reply(clicon_handle h,
         if (nacm_datanode_read(h, xret, xvec, xlen, username, xnacm) < 0) 
             goto done;
     }
+    if (format != -1 && cbuf_len(cbret) == 0){
+        if (get_reply_format(h, ce, xret, xpath, nsc, depth, format, pretty) < 0)
+            goto done;
+        goto ok;
+    }
+    if (xret != NULL && cbuf_len(cbret) == 0){
+        if (xml_name_set(xret, NETCONF_OUTPUT_DATA) < 0)
+            goto done;
+        /* Top level is data, so add 1 to depth if significant */
+        if (send_msg_reply_xml(ce->ce_s, "<rpc-reply xmlns=\"" NETCONF_BASE_NAMESPACE "\">", xret, depth>0?depth+1:depth, "</rpc-reply>") < 0){
+            switch (errno){
+            case EPIPE:     /* Client closed socket, see from_client_msg */
+            case ECONNRESET:
+                clicon_log(LOG_WARNING, "client rpc reset");
+                break;
+            default:
+                goto done;
+            }
+        }
+        ce->ce_reply_sent = 1;
+        goto ok;
+    }
     cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);     /* OK */
     if (xret==NULL)
         cprintf(cbret, "<data/>");
@@ -483,6 +671,7 @@ get_nacm_and_reply(clicon_handle h,
             goto done;
     }
     cprintf(cbret, "</rpc-reply>");
+ ok:
     retval = 0;
  done:
     return retval;
@@ -800,7 +989,7 @@ get_list_pagination(clicon_handle        h,
             cbuf_free(cba);
     }
 #endif /* LIST_PAGINATION_REMAINING */
-    if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, cbret) < 0)
+    if (get_nacm_and_reply(h, ce, xret, xvec, xlen, xpath, nsc, username, depth, -1, 0, cbret) < 0)
         goto done;
  ok:
     retval = 0;
@@ -866,6 +1055,8 @@ get_common(clicon_handle        h,
     uint32_t        limit = 0;
     withdefaults_type wdef;
     char             *wdefstr;
+    int               format = -1; /* Reply format if not netconf, see get_reply_format */
+    int               pretty = 0;
 
 #ifdef NETCONF_DEFAULT_RETRIEVAL_REPORT_ALL
     /* Clixon 6.0 backward compatibly for NETCONF get/get-config behavior */
@@ -912,6 +1103,17 @@ get_common(clicon_handle        h,
             goto ok;
         }
     }
+    /* Clixon extensions: format and pretty of a reply with data only */
+    if ((attr = xml_find_value(xe, "format")) != NULL){
+        if ((format = format_str2int(attr)) != FORMAT_XML && format != FORMAT_JSON){
+            if (netconf_bad_attribute(cbret, "application",
+                                      "format", "Unrecognized value of format attribute") < 0)
+                goto done;
+            goto ok;
+        }
+        if ((attr = xml_find_value(xe, "pretty")) != NULL)
+            pretty = strcmp(attr, "true") == 0;
+    }
     if ((wdefstr = xml_find_body(xe, "with-defaults")) != NULL) 
         wdef = withdefaults_str2int(wdefstr);
     /* Check if list pagination */
@@ -999,7 +1201,7 @@ get_common(clicon_handle        h,
         break;
     case CONTENT_ALL:       /* both config and state */
     case CONTENT_NONCONFIG: /* state data only */
-        if ((ret = get_statedata(h, xpath?xpath:"/", nsc, wdef, &xret)) < 0)
+        if ((ret = get_statedata(h, xpath?xpath:"/", nsc, wdef, content, &xret)) < 0)
             goto done;
         if (ret == 0){ /* Error from callback (error in xret) */
             if (clixon_xml2cbuf(cbret, xret, 0, 0, -1, 0) < 0)
@@ -1046,7 +1248,7 @@ get_common(clicon_handle        h,
         goto done;
     if (filter_xpath_again(h, yspec, xret, xvec, xlen, xpath, nsc) < 0)
         goto done;
-    if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, cbret) < 0)
+    if (get_nacm_and_reply(h, ce, xret, xvec, xlen, xpath, nsc, username, depth, format, pretty, cbret) < 0)
         goto done;
  ok:
     retval = 0;
@@ -104,6 +104,8 @@ backend_terminate(clicon_handle h)
         close(ss);
     /* Disconnect datastore */
     xmldb_disconnect(h);
+    /* Free compiled NACM policies */
+    nacm_policy_invalidate();
     /* Clear module state caches */
     if ((x = clicon_modst_cache_get(h, 0)) != NULL)
         xml_free(x);
@@ -134,7 +136,9 @@ backend_terminate(clicon_handle h)
     clixon_process_delete_all(h); 
 
     xpath_optimize_exit();
+    xpath_cache_exit();
     clixon_pagination_free(h);
+    clixon_statedata_free(h);
     
     if (pidfile)
         unlink(pidfile);   
@@ -142,6 +146,7 @@ backend_terminate(clicon_handle h)
         unlink(sockpath);
     backend_handle_exit(h); /* Also deletes streams. Cannot use h after this. */
     clixon_event_exit();
+    clixon_intern_exit(); /* After all XML is freed */
     clicon_debug(1, "%s done", __FUNCTION__); 
     clixon_err_exit();
     clicon_log_exit();
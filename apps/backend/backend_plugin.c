@@ -52,6 +52,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/param.h>
+#include <sys/time.h>
 #include <netinet/in.h>
 
 /* cligen */
@@ -313,14 +314,294 @@ clixon_plugin_statedata_one(clixon_plugin_t *cp,
     goto done;
 }
 
+/* Namespace of top-level state data nodes served by a plugin state callback
+ * @see clixon_statedata_ns_register
+ */
+typedef struct {
+    qelem_t         sn_qelem;     /* List header */
+    plgstatedata_t *sn_fn;        /* Plugin state data callback */
+    char           *sn_ns;        /* Namespace of top-level state data nodes */
+} statedata_ns_t;
+
+/* State data cache entry, value of "statedata-cache" hash
+ * @see statedata_cache_get
+ */
+typedef struct {
+    cxobj          *sc_xt;        /* Bound and sorted state tree from plugin */
+    struct timeval  sc_tv;        /* Time of plugin state callback */
+} statedata_cache_t;
+
+/*! Register the namespace of top-level state data nodes served by a state callback
+ *
+ * A plugin state callback that has registered namespaces is only called for a get if the
+ * xpath of the get may select top-level nodes in one of the namespaces, or if the xpath
+ * cannot be determined, eg "/" or "//x". A callback without registered namespaces is
+ * always called.
+ * Typically called in the plugin init function, once for each module the callback serves.
+ * @param[in]  h      Clixon handle
+ * @param[in]  fn     Plugin state data callback, ca_statedata
+ * @param[in]  ns     Namespace of top-level state data nodes
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @code
+ *    clixon_statedata_ns_register(h, example_statedata, "urn:example:clixon");
+ * @endcode
+ * @see xpath_top_namespaces
+ */
+int
+clixon_statedata_ns_register(clicon_handle   h,
+                             plgstatedata_t *fn,
+                             const char     *ns)
+{
+    int             retval = -1;
+    statedata_ns_t *snlist = NULL;
+    statedata_ns_t *sn;
+
+    if (fn == NULL || ns == NULL){
+        clicon_err(OE_PLUGIN, EINVAL, "fn or ns is NULL");
+        goto done;
+    }
+    if ((sn = malloc(sizeof(*sn))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(sn, 0, sizeof(*sn));
+    sn->sn_fn = fn;
+    if ((sn->sn_ns = strdup(ns)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        free(sn);
+        goto done;
+    }
+    clicon_ptr_get(h, "statedata-ns", (void**)&snlist);
+    ADDQ(sn, snlist);
+    if (clicon_ptr_set(h, "statedata-ns", snlist) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Check if a plugin state callback may serve state data selected by an xpath
+ *
+ * @param[in]  snlist  Registered namespaces
+ * @param[in]  fn      Plugin state data callback
+ * @param[in]  nsv     Namespaces of top-level nodes of xpath, or NULL if not determined
+ * @retval     1       Yes, call the callback
+ * @retval     0       No, skip the callback
+ */
+static int
+statedata_ns_match(statedata_ns_t *snlist,
+                   plgstatedata_t *fn,
+                   cvec           *nsv)
+{
+    statedata_ns_t *sn;
+    cg_var         *cv;
+    int             registered = 0;
+
+    if (nsv == NULL || (sn = snlist) == NULL)
+        return 1;
+    do {
+        if (sn->sn_fn == fn){
+            registered++;
+            cv = NULL;
+            while ((cv = cvec_each(nsv, cv)) != NULL)
+                if (strcmp(cv_string_get(cv), sn->sn_ns) == 0)
+                    return 1;
+        }
+        sn = NEXTQ(statedata_ns_t *, sn);
+    } while (sn && sn != snlist);
+    return registered ? 0 : 1;
+}
+
+/*! Free registered state data namespaces and state data cache
+ *
+ * @param[in]  h      Clixon handle
+ */
+int
+clixon_statedata_free(clicon_handle h)
+{
+    statedata_ns_t *snlist = NULL;
+    statedata_ns_t *sn;
+
+    if (clicon_ptr_get(h, "statedata-ns", (void**)&snlist) == 0){
+        while ((sn = snlist) != NULL){
+            DELQ(sn, snlist, statedata_ns_t *);
+            if (sn->sn_ns)
+                free(sn->sn_ns);
+            free(sn);
+        }
+        clicon_ptr_del(h, "statedata-ns");
+    }
+    return clixon_statedata_cache_flush(h);
+}
+
+/*! Make state data cache key of plugin, get parameters, xpath and namespace context
+ *
+ * @param[in]  cp      Plugin handle
+ * @param[in]  nsc     Namespace context for xpath
+ * @param[in]  xpath   String with XPATH syntax. or NULL for all
+ * @param[in]  wdef    With-defaults parameter, see RFC 6243
+ * @param[in]  content Get config/state/both
+ * @param[in]  cb      Key is written to this buffer
+ */
+static int
+statedata_cache_key(clixon_plugin_t  *cp,
+                    cvec             *nsc,
+                    char             *xpath,
+                    withdefaults_type wdef,
+                    netconf_content   content,
+                    cbuf             *cb)
+{
+    cg_var *cv = NULL;
+
+    cprintf(cb, "%s %d %d %s", clixon_plugin_name_get(cp), wdef, content, xpath ? xpath : "/");
+    while ((cv = cvec_each(nsc, cv)) != NULL)
+        cprintf(cb, " %s=%s", cv_name_get(cv) ? cv_name_get(cv) : "", cv_string_get(cv));
+    return 0;
+}
+
+/*! Get a copy of cached state data if not older than max-age
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  key    Cache key, see statedata_cache_key
+ * @param[in]  maxage Max age in milliseconds
+ * @param[out] xp     Copy of cached state tree, free with xml_free
+ * @retval     1      Found
+ * @retval     0      Not found or too old
+ * @retval    -1      Error
+ */
+static int
+statedata_cache_get(clicon_handle h,
+                    char         *key,
+                    int           maxage,
+                    cxobj       **xp)
+{
+    clicon_hash_t     *cache = NULL;
+    statedata_cache_t *sc;
+    size_t             vlen;
+    struct timeval     now;
+    struct timeval     td;
+
+    if (clicon_ptr_get(h, "statedata-cache", (void**)&cache) < 0 || cache == NULL)
+        return 0;
+    if ((sc = clicon_hash_value(cache, key, &vlen)) == NULL)
+        return 0;
+    gettimeofday(&now, NULL);
+    timersub(&now, &sc->sc_tv, &td);
+    if (td.tv_sec*1000 + td.tv_usec/1000 >= maxage)
+        return 0;
+    if ((*xp = xml_dup(sc->sc_xt)) == NULL)
+        return -1;
+    return 1;
+}
+
+/*! Add copy of state data to cache, replace old entry and remove entries older than max-age
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  key    Cache key, see statedata_cache_key
+ * @param[in]  maxage Max age in milliseconds
+ * @param[in]  x      State tree, bound and sorted
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+statedata_cache_set(clicon_handle h,
+                    char         *key,
+                    int           maxage,
+                    cxobj        *x)
+{
+    int                retval = -1;
+    clicon_hash_t     *cache = NULL;
+    statedata_cache_t  sc0 = {0,};
+    statedata_cache_t *sc;
+    size_t             vlen;
+    char             **keys = NULL;
+    size_t             klen = 0;
+    size_t             i;
+    struct timeval     td;
+
+    clicon_ptr_get(h, "statedata-cache", (void**)&cache);
+    if (cache == NULL){
+        if ((cache = clicon_hash_init()) == NULL)
+            goto done;
+        if (clicon_ptr_set(h, "statedata-cache", cache) < 0)
+            goto done;
+    }
+    gettimeofday(&sc0.sc_tv, NULL);
+    /* Remove old entries, including any previous entry of this key */
+    if (clicon_hash_keys(cache, &keys, &klen) < 0)
+        goto done;
+    for (i=0; i<klen; i++){
+        if ((sc = clicon_hash_value(cache, keys[i], &vlen)) == NULL)
+            continue;
+        timersub(&sc0.sc_tv, &sc->sc_tv, &td);
+        if (strcmp(keys[i], key) == 0 ||
+            td.tv_sec*1000 + td.tv_usec/1000 >= maxage){
+            if (sc->sc_xt)
+                xml_free(sc->sc_xt);
+            clicon_hash_del(cache, keys[i]);
+        }
+    }
+    if ((sc0.sc_xt = xml_dup(x)) == NULL)
+        goto done;
+    if (clicon_hash_add(cache, key, &sc0, sizeof(sc0)) == NULL){
+        xml_free(sc0.sc_xt);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Remove all cached state data
+ *
+ * Called when state data may have changed, eg after commit
+ * @param[in]  h      Clixon handle
+ * @see CLICON_STATE_CACHE_MAXAGE
+ */
+int
+clixon_statedata_cache_flush(clicon_handle h)
+{
+    int                retval = -1;
+    clicon_hash_t     *cache = NULL;
+    statedata_cache_t *sc;
+    size_t             vlen;
+    char             **keys = NULL;
+    size_t             klen = 0;
+    size_t             i;
+
+    if (clicon_ptr_get(h, "statedata-cache", (void**)&cache) < 0 || cache == NULL)
+        goto ok;
+    if (clicon_hash_keys(cache, &keys, &klen) < 0)
+        goto done;
+    for (i=0; i<klen; i++){
+        if ((sc = clicon_hash_value(cache, keys[i], &vlen)) != NULL && sc->sc_xt)
+            xml_free(sc->sc_xt);
+    }
+    clicon_hash_free(cache);
+    clicon_ptr_del(h, "statedata-cache");
+ ok:
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
 /*! Go through all backend statedata callbacks and collect state data
  * This is internal system call, plugin is invoked (does not call) this function
  * Backend plugins can register 
+ * Only callbacks that may serve the xpath are called, see clixon_statedata_ns_register
+ * If CLICON_STATE_CACHE_MAXAGE is set, state of a callback and xpath is cached and reused
+ * for that many milliseconds.
  * @param[in]     h       clicon handle
  * @param[in]     yspec   Yang spec
  * @param[in]     nsc     Namespace context
  * @param[in]     xpath   String with XPATH syntax. or NULL for all
  * @param[in]     wdef    With-defaults parameter, see RFC 6243
+ * @param[in]     content Get config/state/both, part of state cache key
  * @param[in,out] xret    State XML tree is merged with existing tree.
  * @retval       -1       Error
  * @retval        0       Statedata callback failed (xret set with netconf-error)
@@ -333,17 +614,47 @@ clixon_plugin_statedata_all(clicon_handle   h,
                             cvec           *nsc,
                             char           *xpath,
                             withdefaults_type wdef,
+                            netconf_content content,
                             cxobj         **xret)
 {
     int              retval = -1;
     int              ret;
     cxobj           *x = NULL;
     clixon_plugin_t *cp = NULL;
+    plgstatedata_t  *fn;
     cbuf            *cberr = NULL; 
     cxobj           *xerr = NULL;
+    cvec            *nsv = NULL;
+    statedata_ns_t  *snlist = NULL;
+    int              maxage;
+    cbuf            *cbkey = NULL;
     
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    clicon_ptr_get(h, "statedata-ns", (void**)&snlist);
+    /* Top-level namespaces of xpath, only needed if callbacks have registered namespaces */
+    if (snlist && xpath_top_namespaces(xpath, nsc, &nsv) < 0)
+        goto done;
+    if ((maxage = clicon_option_int(h, "CLICON_STATE_CACHE_MAXAGE")) < 0)
+        maxage = 0;
+    if (maxage && (cbkey = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
     while ((cp = clixon_plugin_each(h, cp)) != NULL) {
+        if ((fn = clixon_plugin_api_get(cp)->ca_statedata) == NULL)
+            continue;
+        if (!statedata_ns_match(snlist, fn, nsv))
+            continue;
+        if (maxage){
+            cbuf_reset(cbkey);
+            statedata_cache_key(cp, nsc, xpath, wdef, content, cbkey);
+            if ((ret = statedata_cache_get(h, cbuf_get(cbkey), maxage, &x)) < 0)
+                goto done;
+            if (ret == 1){
+                clicon_debug(CLIXON_DBG_DETAIL, "%s %s cached", __FUNCTION__, clixon_plugin_name_get(cp));
+                goto merge;
+            }
+        }
         if ((ret = clixon_plugin_statedata_one(cp, h, nsc, xpath, &x)) < 0)
             goto done;
         if (ret == 0){
@@ -363,31 +674,38 @@ clixon_plugin_statedata_all(clicon_handle   h,
         }
         if (x == NULL)
             continue;
+        if (xml_child_nr(x) != 0){
+            clicon_debug_xml(CLIXON_DBG_DETAIL, x, "%s %s STATE:", __FUNCTION__, clixon_plugin_name_get(cp));
+            /* XXX: ret == 0 invalid yang binding should be handled as internal error */
+            if ((ret = xml_bind_yang(h, x, YB_MODULE, yspec, &xerr)) < 0)
+                goto done;
+            if (ret == 0){
+                if (clixon_netconf_internal_error(xerr,
+                                                  ". Internal error, state callback returned invalid XML from plugin: ",
+                                                  clixon_plugin_name_get(cp)) < 0)
+                    goto done;
+                xml_free(*xret);
+                *xret = xerr;
+                xerr = NULL;
+                goto fail;
+            }
+            if (xml_sort_recurse(x) < 0)
+                goto done;
+            /* Remove global defaults and empty non-presence containers */
+            /* XXX: only for state data and according to with-defaults setting */
+            if (xml_defaults_nopresence(x, 2) < 0)
+                goto done;
+        }
+        /* Empty state is also cached, the callback is what is expensive */
+        if (maxage &&
+            statedata_cache_set(h, cbuf_get(cbkey), maxage, x) < 0)
+            goto done;
+    merge:
         if (xml_child_nr(x) == 0){
             xml_free(x);
             x = NULL;
             continue;
         }
-        clicon_debug_xml(CLIXON_DBG_DETAIL, x, "%s %s STATE:", __FUNCTION__, clixon_plugin_name_get(cp));
-        /* XXX: ret == 0 invalid yang binding should be handled as internal error */
-        if ((ret = xml_bind_yang(h, x, YB_MODULE, yspec, &xerr)) < 0)
-            goto done;
-        if (ret == 0){
-            if (clixon_netconf_internal_error(xerr,
-                                              ". Internal error, state callback returned invalid XML from plugin: ",
-                                              clixon_plugin_name_get(cp)) < 0)
-                goto done;
-            xml_free(*xret);
-            *xret = xerr;
-            xerr = NULL;
-            goto fail;
-        }
-        if (xml_sort_recurse(x) < 0)
-            goto done;
-        /* Remove global defaults and empty non-presence containers */
-        /* XXX: only for state data and according to with-defaults setting */
-        if (xml_defaults_nopresence(x, 2) < 0)
-            goto done;
         if ((ret = netconf_trymerge(x, yspec, xret)) < 0)
             goto done;
         if (ret == 0)
@@ -399,6 +717,10 @@ clixon_plugin_statedata_all(clicon_handle   h,
     } /* while plugin */
     retval = 1;
  done:
+    if (cbkey)
+        cbuf_free(cbkey);
+    if (nsv)
+        cvec_free(nsv);
     if (xerr)
         xml_free(xerr);
     if (cberr)
@@ -58,6 +58,7 @@ struct client_entry{
     struct client_entry  *ce_next;    /* The clients linked list */
     struct sockaddr       ce_addr;    /* The clients (UNIX domain) address */
     int                   ce_s;       /* Stream socket to client */
+    clicon_msg_rbuf      *ce_rbuf;    /* Receive buffer of ce_s, reused for all messages */
     int                   ce_nr;      /* Client number (for dbg/tracing) */
     uint32_t              ce_id;      /* Session id, accessor functions: clicon_session_id_get/set */
     char                 *ce_username;/* Translated from peer user cred */
@@ -72,6 +73,7 @@ struct client_entry{
     uint32_t              ce_in_bad_rpcs;    /* Not correct <rpc> messages */
     uint32_t              ce_out_rpc_errors; /*  <rpc-error> messages*/
     uint32_t              ce_out_notifications; /* Outgoing notifications */
+    int                   ce_reply_sent; /* Reply of current rpc already written by handler */
 };
 typedef struct client_entry client_entry;
 
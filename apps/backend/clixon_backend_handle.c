@@ -142,6 +142,10 @@ backend_client_add(clicon_handle    h,
         return NULL;
     }
     memset(ce, 0, sizeof(*ce));
+    if ((ce->ce_rbuf = clicon_msg_rbuf_new()) == NULL){
+        free(ce);
+        return NULL;
+    }
     ce->ce_nr = bh->bh_ce_nr++; /* Session-id ? */
     memcpy(&ce->ce_addr, addr, sizeof(*addr));
     ce->ce_next = bh->bh_ce_list;
@@ -192,6 +196,8 @@ backend_client_delete(clicon_handle        h,
                 free(ce->ce_transport);
             if (ce->ce_source_host)
                 free(ce->ce_source_host);
+            if (ce->ce_rbuf)
+                clicon_msg_rbuf_free(ce->ce_rbuf);
             free(ce);
             break;
         }
@@ -98,8 +98,11 @@ int clixon_plugin_reset_all(clicon_handle h, char *db);
 int clixon_plugin_pre_daemon_all(clicon_handle h);
 int clixon_plugin_daemon_all(clicon_handle h);
 
+int clixon_statedata_ns_register(clicon_handle h, plgstatedata_t *fn, const char *ns);
+int clixon_statedata_cache_flush(clicon_handle h);
+int clixon_statedata_free(clicon_handle h);
 int clixon_plugin_statedata_all(clicon_handle h, yang_stmt *yspec, cvec *nsc, char *xpath,
-                                withdefaults_type wdef, cxobj **xtop);
+                                withdefaults_type wdef, netconf_content content, cxobj **xtop);
 int clixon_plugin_lockdb_all(clicon_handle h, char *db, int lock, int id);
 
 int clixon_pagination_cb_register(clicon_handle h, handler_function fn, char *path, void *arg);
@@ -182,6 +182,7 @@ cli_terminate(clicon_handle h)
     clicon_data_cvec_del(h, "cli-edit-cvv");;
     clicon_data_cvec_del(h, "cli-edit-filter");;
     xpath_optimize_exit();
+    xpath_cache_exit();
     /* Delete all plugins, and RPC callbacks */
     clixon_plugin_module_exit(h);
     /* Delete CLI syntax et al */
@@ -189,6 +190,7 @@ cli_terminate(clicon_handle h)
 
     cli_history_save(h);
     cli_handle_exit(h);
+    clixon_intern_exit(); /* After all XML is freed */
     clixon_err_exit();
     clicon_log_exit();
     return 0;
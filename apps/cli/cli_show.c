@@ -216,6 +216,7 @@ expand_dbvar(void   *h,
     yang_stmt       *ytype;
     char            *mtpoint = NULL;
     yang_stmt       *yspec0 = NULL;
+    clicon_hash_t   *values = NULL; /* ordered-by user duplicates */
     
     if (argv == NULL || (cvec_len(argv) != 2 && cvec_len(argv) != 3)){
         clicon_err(OE_PLUGIN, EINVAL, "requires arguments: <db> <apipathfmt> [<mountpt>]");
@@ -355,15 +356,15 @@ expand_dbvar(void   *h,
             (yp = yang_parent_get(y)) != NULL &&
             yang_keyword_get(yp) == Y_LIST &&
             yang_find(yp, Y_ORDERED_BY, "user") != NULL){
-            /* Detect duplicates linearly in existing values */
-            {
-                cg_var *cv = NULL;
-                while ((cv = cvec_each(commands, cv)) != NULL)
-                    if (strcmp(cv_string_get(cv), bodystr) == 0)
-                        break;
-                if (cv == NULL)
-                    cvec_add_string(commands, NULL, bodystr);
-            }
+            /* Detect duplicates in a set of existing values */
+            if (values == NULL &&
+                (values = clicon_hash_init()) == NULL)
+                goto done;
+            if (clicon_hash_lookup(values, bodystr) != NULL)
+                continue;
+            if (clicon_hash_add(values, bodystr, NULL, 0) == NULL)
+                goto done;
+            cvec_add_string(commands, NULL, bodystr);
         }
         else{
             if (bodystr0 && strcmp(bodystr, bodystr0) == 0)
@@ -386,6 +387,8 @@ expand_dbvar(void   *h,
         xml_nsctx_free(nsc);
     if (api_path)
         free(api_path);
+    if (values)
+        clicon_hash_free(values);
     if (xvec)
         free(xvec);
     if (xtop)
@@ -187,6 +187,108 @@ netconf_hello_msg(clicon_handle h,
     return retval;
 }
 
+/*! Output a reply after the replies of outstanding asynchronous backend rpcs
+ *
+ * Replies to netconf rpcs are sent in request order
+ * @param[in]  h    Clixon handle
+ * @param[in]  cb   Encapsulated reply
+ * @param[in]  msg  Debug string
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+netconf_output_ordered(clicon_handle h,
+                       cbuf         *cb,
+                       char         *msg)
+{
+    if (clicon_rpc_async_wait(h) < 0)
+        return -1;
+    return netconf_output(1, cb, msg);
+}
+
+/*! Send reply of a netconf rpc
+ * @param[in]   h     Clixon handle
+ * @param[in]   xrpc  Incoming message on the form <rpc>...
+ * @param[in]   xret  Reply on the form <top><rpc-reply>..., or NULL
+ * @retval      0     OK
+ * @retval     -1     Error
+ */
+static int
+netconf_rpc_reply(clicon_handle h,
+                  cxobj        *xrpc,
+                  cxobj        *xret)
+{
+    int                  retval = -1;
+    cxobj               *xerr = NULL;
+    cxobj               *xc;
+    cbuf                *cbret = NULL;
+    netconf_framing_type framing;
+
+    framing = clicon_data_int_get(h, "netconf-framing");
+    /* Is there a return message in xret? */
+    if (xret == NULL){
+        if (netconf_operation_failed_xml(&xerr, "rpc", "Internal error: no xml return")< 0)
+            goto done;
+        if (netconf_add_request_attr(xrpc, xerr) < 0)
+            goto done;
+        if ((cbret = cbuf_new()) == NULL){ 
+            clicon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        if (clixon_xml2cbuf(cbret, xerr, 0, 0, -1, 0) < 0)
+            goto done;
+        if (netconf_output_encap(framing, cbret) < 0)
+            goto done;
+        if (netconf_output(1, cbret, "rpc-error") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((xc = xml_child_i(xret, 0))!=NULL){
+        /* Copy attributes from incoming request to reply. Skip already present (dont overwrite) */
+        if (netconf_add_request_attr(xrpc, xc) < 0)
+            goto done;
+        /* Printed and written in chunks, a large reply is not copied to one buffer */
+        if (netconf_output_xml(1, framing, xc, "rpc-reply") < 0)
+            goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (cbret)
+        cbuf_free(cbret);
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
+/*! Reply callback of a netconf rpc pipelined to the backend
+ * @param[in]  h      Clixon handle
+ * @param[in]  reqid  Request id
+ * @param[in]  xret   Reply on the form <top><rpc-reply>..., or NULL if backend closed
+ * @param[in]  arg    Attributes of incoming message on the form <rpc>, freed here
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see netconf_rpc_dispatch_async
+ */
+static int
+netconf_rpc_async_reply(clicon_handle h,
+                        uint32_t      reqid,
+                        cxobj        *xret,
+                        void         *arg)
+{
+    int    retval = -1;
+    cxobj *xrpc = (cxobj *)arg;
+
+    /* Backend closed: error is logged and no reply sent, as for a synchronous rpc */
+    if (xret != NULL &&
+        netconf_rpc_reply(h, xrpc, xret) < 0)
+        goto done;
+    retval = 0;
+ done:
+    xml_free(xrpc);
+    return retval;
+}
+
 /*! Process incoming Netconf RPC netconf message 
  * @param[in]   h     Clixon handle
  * @param[in]   xreq  XML tree containing netconf RPC message
@@ -205,7 +307,9 @@ netconf_rpc_message(clicon_handle h,
     cxobj               *xret = NULL; /* Return (out) */
     int                  ret;
     cbuf                *cbret = NULL;
-    cxobj               *xc;
+    cxobj               *xrpc0 = NULL;
+    cxobj               *xa;
+    cxobj               *xa2;
     netconf_framing_type framing;
 
     framing = clicon_data_int_get(h, "netconf-framing");
@@ -224,7 +328,7 @@ netconf_rpc_message(clicon_handle h,
             goto done;
         if (netconf_output_encap(framing, cbret) < 0)
             goto done;
-        if (netconf_output(1, cbret, "rpc-error") < 0)
+        if (netconf_output_ordered(h, cbret, "rpc-error") < 0)
             goto done;
         *eof = 1;
         goto ok;
@@ -245,49 +349,39 @@ netconf_rpc_message(clicon_handle h,
             goto done;
         if (netconf_output_encap(framing, cbret) < 0)
             goto done;
-        if (netconf_output(1, cbret, "rpc-error") < 0)
+        if (netconf_output_ordered(h, cbret, "rpc-error") < 0)
             goto done;
         goto ok;
     }
-    if (netconf_rpc_dispatch(h, xrpc, &xret, eof) < 0)
+    /* Rpcs forwarded as-is are pipelined to the backend, several may be outstanding */
+    /* Keep request attributes for the reply, see netconf_add_request_attr */
+    if ((xrpc0 = xml_new(xml_name(xrpc), NULL, CX_ELMNT)) == NULL)
         goto done;
-
-    /* Is there a return message in xret? */
-    if (xret == NULL){
-        if (netconf_operation_failed_xml(&xret, "rpc", "Internal error: no xml return")< 0)
-            goto done;
-        if (netconf_add_request_attr(xrpc, xret) < 0)
-            goto done;
-        if ((cbret = cbuf_new()) == NULL){ 
-            clicon_err(OE_XML, errno, "cbuf_new");
-            goto done;
-        }
-        if (clixon_xml2cbuf(cbret, xret, 0, 0, -1, 0) < 0)
-            goto done;
-        if (netconf_output_encap(framing, cbret) < 0)
+    xa = NULL;
+    while ((xa = xml_child_each(xrpc, xa, CX_ATTR)) != NULL){
+        if ((xa2 = xml_dup(xa)) == NULL)
             goto done;
-        if (netconf_output(1, cbret, "rpc-error") < 0)
+        if (xml_addsub(xrpc0, xa2) < 0)
             goto done;
-        goto ok;
     }
-    if ((xc = xml_child_i(xret, 0))!=NULL){
-        /* Copy attributes from incoming request to reply. Skip already present (dont overwrite) */
-        if (netconf_add_request_attr(xrpc, xc) < 0)
-            goto done;
-        if ((cbret = cbuf_new()) == NULL){ 
-            clicon_err(OE_XML, errno, "cbuf_new");
-            goto done;
-        }
-        if (clixon_xml2cbuf(cbret, xml_child_i(xret,0), 0, 0, -1, 0) < 0)
-            goto done;
-        if (netconf_output_encap(framing, cbret) < 0)
-            goto done;
-        if (netconf_output(1, cbret, "rpc-reply") < 0)
-            goto done;
+    if ((ret = netconf_rpc_dispatch_async(h, xrpc, netconf_rpc_async_reply, xrpc0)) < 0)
+        goto done;
+    if (ret == 1){
+        xrpc0 = NULL; /* Freed by callback */
+        goto ok;
     }
+    /* Other replies are sent after those of outstanding rpcs */
+    if (clicon_rpc_async_wait(h) < 0)
+        goto done;
+    if (netconf_rpc_dispatch(h, xrpc, &xret, eof) < 0)
+        goto done;
+    if (netconf_rpc_reply(h, xrpc, xret) < 0)
+        goto done;
  ok:
     retval = 0;
  done:
+    if (xrpc0)
+        xml_free(xrpc0);
     if (cbret)
         cbuf_free(cbret);
     if (xret)
@@ -339,7 +433,7 @@ netconf_input_packet(clicon_handle h,
                 goto done;
             if (netconf_output_encap(framing, cbret) < 0)
                 goto done;
-            if (netconf_output(1, cbret, "rpc-error") < 0)
+            if (netconf_output_ordered(h, cbret, "rpc-error") < 0)
                 goto done;
             goto ok;
         }
@@ -422,7 +516,7 @@ netconf_input_frame(clicon_handle h,
             goto done;
         if (netconf_output_encap(framing, cbret) < 0)
             goto done;
-        if (netconf_output(1, cbret, "rpc-error") < 0)
+        if (netconf_output_ordered(h, cbret, "rpc-error") < 0)
             goto done;
         goto ok;
     }
@@ -436,7 +530,7 @@ netconf_input_frame(clicon_handle h,
             goto done;
         if (netconf_output_encap(framing, cbret) < 0)
             goto done;
-        if (netconf_output(1, cbret, "rpc-error") < 0)
+        if (netconf_output_ordered(h, cbret, "rpc-error") < 0)
             goto done;
         goto ok;
     }
@@ -455,7 +549,7 @@ netconf_input_frame(clicon_handle h,
             goto done;
         if (netconf_output_encap(framing, cbret) < 0)
             goto done;
-        if (netconf_output(1, cbret, "rpc-error") < 0)
+        if (netconf_output_ordered(h, cbret, "rpc-error") < 0)
             goto done;
         goto ok;
     }
@@ -467,7 +561,7 @@ netconf_input_frame(clicon_handle h,
         }
         if (netconf_output_encap(framing, cbret) < 0)
             goto done;
-        if (netconf_output(1, cbret, "rpc-error") < 0)
+        if (netconf_output_ordered(h, cbret, "rpc-error") < 0)
             goto done;
         goto ok;
     }
@@ -481,7 +575,7 @@ netconf_input_frame(clicon_handle h,
             goto done;
         if (netconf_output_encap(framing, cbret) < 0)
             goto done;
-        if (netconf_output(1, cbret, "rpc-error") < 0)
+        if (netconf_output_ordered(h, cbret, "rpc-error") < 0)
             goto done;
         goto ok;
     }
@@ -574,6 +668,9 @@ netconf_input_cb(int   s,
         } /* read */
         if (len == 0){  /* EOF */
             clicon_debug(1, "%s len==0, closing", __FUNCTION__);
+            /* Send replies of outstanding rpcs before closing */
+            if (clicon_rpc_async_wait(h) < 0)
+                goto done;
             clixon_event_unreg_fd(s, netconf_input_cb);
             close(s);
             clixon_exit_set(1);     
@@ -700,8 +797,10 @@ netconf_terminate(clicon_handle h)
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     xpath_optimize_exit();
+    xpath_cache_exit();
     clixon_event_exit();
     clicon_handle_exit(h);
+    clixon_intern_exit(); /* After all XML is freed */
     clixon_err_exit();
     clicon_log_exit();
     return 0;
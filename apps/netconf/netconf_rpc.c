@@ -678,6 +678,67 @@ netconf_application_rpc(clicon_handle h,
     return retval;
 }
 
+/*! Check if a netconf rpc is forwarded as-is to the backend
+ * @param[in]  name  Name of rpc
+ * @retval     1     Forwarded as-is, generic validation is made before
+ * @retval     0     Not forwarded, or needs extra handling
+ */
+static int
+netconf_rpc_forward(char *name)
+{
+    return (strcmp(name, "copy-config") == 0 ||
+            strcmp(name, "delete-config") == 0 ||
+            strcmp(name, "lock") == 0 ||
+            strcmp(name, "unlock") == 0 ||
+            strcmp(name, "kill-session") == 0 ||
+            strcmp(name, "validate") == 0 ||  /* :validate */
+            strcmp(name, "commit") == 0 || /* :candidate */
+            strcmp(name, "cancel-commit") == 0 || 
+            strcmp(name, "discard-changes") == 0 ||
+            strcmp(name, "action") == 0);
+}
+
+/*! Forward a netconf rpc to the backend without waiting for the reply
+ *
+ * Only rpcs that are forwarded as-is by netconf_rpc_dispatch are sent, so that several
+ * such rpcs can be outstanding at the backend.
+ * @param[in]  h       clicon handle
+ * @param[in]  xn      Sub-tree (under xorig) at <rpc>...</rpc> level.
+ * @param[in]  fn      Reply callback, called with reply on the form <rpc-reply>...
+ * @param[in]  arg     Callback argument
+ * @retval     1       Sent, reply is handled by fn
+ * @retval     0       Not sent, use netconf_rpc_dispatch
+ * @retval    -1       Error, fatal
+ * @see netconf_rpc_dispatch
+ */
+int
+netconf_rpc_dispatch_async(clicon_handle        h,
+                           cxobj               *xn,
+                           clicon_rpc_async_cb *fn,
+                           void                *arg)
+{
+    int    retval = -1;
+    cxobj *xe;
+    char  *username;
+    cxobj *xa;
+
+    if (xml_child_nr_type(xn, CX_ELMNT) != 1 ||
+        (xe = xml_child_i_type(xn, 0, CX_ELMNT)) == NULL ||
+        !netconf_rpc_forward(xml_name(xe)))
+        return 0;
+    if ((username = clicon_username_get(h)) != NULL){
+        if (xml_add_attr(xn, "username", username, CLIXON_LIB_PREFIX, CLIXON_LIB_NS) < 0)
+            goto done;
+    }
+    if (clicon_rpc_netconf_xml_async(h, xn, fn, arg, NULL) < 0)
+        goto done;
+    retval = 1;
+ done:
+    if ((xa = xml_find(xn, "username")) != NULL)
+        xml_purge(xa);
+    return retval;
+}
+
 /*! The central netconf rpc dispatcher. Look at first tag and dispach to sub-functions.
  * Call plugin handler if tag not found. If not handled by any handler, return
  * error.
@@ -714,17 +775,7 @@ netconf_rpc_dispatch(clicon_handle h,
      */
     xe = NULL;
     while ((xe = xml_child_each(xn, xe, CX_ELMNT)) != NULL) {
-        if (strcmp(xml_name(xe), "copy-config") == 0 ||
-            strcmp(xml_name(xe), "delete-config") == 0 ||
-            strcmp(xml_name(xe), "lock") == 0 ||
-            strcmp(xml_name(xe), "unlock") == 0 ||
-            strcmp(xml_name(xe), "kill-session") == 0 ||
-            strcmp(xml_name(xe), "validate") == 0 ||  /* :validate */
-            strcmp(xml_name(xe), "commit") == 0 || /* :candidate */
-            strcmp(xml_name(xe), "cancel-commit") == 0 || 
-            strcmp(xml_name(xe), "discard-changes") == 0 ||
-            strcmp(xml_name(xe), "action") == 0
-            ){
+        if (netconf_rpc_forward(xml_name(xe))){
             if (clicon_rpc_netconf_xml(h, xml_parent(xe), xret, NULL) < 0)
                 goto done;      
         }
@@ -47,5 +47,10 @@ netconf_rpc_dispatch(clicon_handle h,
                      cxobj        *xn, 
                      cxobj       **xret,
                      int          *eof);
+int
+netconf_rpc_dispatch_async(clicon_handle        h,
+                           cxobj               *xn,
+                           clicon_rpc_async_cb *fn,
+                           void                *arg);
 
 #endif  /* _NETCONF_RPC_H_ */
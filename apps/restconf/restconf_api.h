@@ -48,4 +48,9 @@ int restconf_reply_send(void *req, int code, cbuf *cb, int head);
 
 cbuf *restconf_get_indata(void *req);
 
+/* Reply after asynchronous backend rpc, note arg is freed on resume or close */
+int restconf_reply_deferrable(void *req);
+int restconf_reply_defer(void *req, uint32_t reqid, void *arg);
+int restconf_reply_resume(void *req);
+
 #endif /* _RESTCONF_API_H_ */
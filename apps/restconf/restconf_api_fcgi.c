@@ -240,3 +240,38 @@ restconf_get_indata(void *req0)
         cprintf(cb, "%c", c);
     return cb;
 }
+
+/*! Check if reply can be deferred until an asynchronous backend rpc is replied
+ * @param[in]  req   Fastcgi request handle
+ * @retval     0     No, fastcgi requests are replied before the next is accepted
+ */
+int
+restconf_reply_deferrable(void *req0)
+{
+    return 0;
+}
+
+/*! Defer reply, not supported in fastcgi
+ * @param[in]  req    Fastcgi request handle
+ * @param[in]  reqid  Request id of backend rpc
+ * @param[in]  arg    Rpc callback argument
+ * @see restconf_reply_deferrable
+ */
+int
+restconf_reply_defer(void    *req0,
+                     uint32_t reqid,
+                     void    *arg)
+{
+    clicon_err(OE_RESTCONF, ENOTSUP, "Deferred reply not supported by fcgi");
+    return -1;
+}
+
+/*! Send deferred reply, not supported in fastcgi
+ * @param[in]  req   Fastcgi request handle
+ */
+int
+restconf_reply_resume(void *req0)
+{
+    clicon_err(OE_RESTCONF, ENOTSUP, "Deferred reply not supported by fcgi");
+    return -1;
+}
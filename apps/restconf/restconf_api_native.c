@@ -185,3 +185,59 @@ restconf_get_indata(void *req0)
     return cb;
 }
 
+/*! Check if reply can be deferred until an asynchronous backend rpc is replied
+ * @param[in]  req   Request handle
+ * @retval     1     Yes, use restconf_reply_defer
+ * @retval     0     No, use synchronous rpc
+ */
+int
+restconf_reply_deferrable(void *req0)
+{
+    return 1;
+}
+
+/*! Defer reply until an asynchronous backend rpc is replied
+ *
+ * The rpc callback sets the reply and calls restconf_reply_resume.
+ * If the request is closed before, the rpc is cancelled
+ * @param[in]  req    Request handle
+ * @param[in]  reqid  Request id of backend rpc
+ * @param[in]  arg    Rpc callback argument, malloced, freed with free when resumed or cancelled
+ * @see clicon_rpc_async_cancel
+ */
+int
+restconf_reply_defer(void    *req0,
+                     uint32_t reqid,
+                     void    *arg)
+{
+    int                   retval = -1;
+    restconf_stream_data *sd = (restconf_stream_data *)req0;
+
+    clicon_debug(1, "%s reqid:%u", __FUNCTION__, reqid);
+    if (sd == NULL){
+        clicon_err(OE_CFG, EINVAL, "sd is NULL");
+        goto done;
+    }
+    sd->sd_reqid = reqid;
+    sd->sd_reqarg = arg;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Send deferred reply
+ * @param[in]  req   Request handle, may be freed
+ * Prerequisites: reply set with restconf_reply_send
+ * @note the rpc callback argument is freed, do not use it after this call
+ */
+int
+restconf_reply_resume(void *req0)
+{
+    restconf_stream_data *sd = (restconf_stream_data *)req0;
+
+    if (sd == NULL){
+        clicon_err(OE_CFG, EINVAL, "sd is NULL");
+        return -1;
+    }
+    return restconf_stream_resume(sd);
+}
@@ -294,7 +294,7 @@ http1_upgrade_http2(clicon_handle         h,
 
 /*! Construct an HTTP/1 reply (dont actually send it)
  */
-static int
+int
 restconf_http1_reply(restconf_conn        *rc,
                      restconf_stream_data *sd)
 {
@@ -427,6 +427,7 @@ restconf_http1_path_root(clicon_handle  h,
     if (ret == 0) /* upgrade */
         goto upgrade;
 #endif
+    restconf_native_stats_request(h);
     /* Matching algorithm:
      * 1. try well-known
      * 2. try /restconf
@@ -454,7 +455,8 @@ restconf_http1_path_root(clicon_handle  h,
 #ifdef HAVE_LIBNGHTTP2
  upgrade:
 #endif
-    if (sd->sd_code)
+    /* If deferred, reply is constructed in restconf_stream_resume */
+    if (sd->sd_code && sd->sd_reqid == 0)
         if (restconf_http1_reply(rc, sd) < 0)
             goto done;
     retval = 0;
@@ -374,7 +374,9 @@ restconf_terminate(clicon_handle h)
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     xpath_optimize_exit();
+    xpath_cache_exit();
     restconf_handle_exit(h);
+    clixon_intern_exit(); /* After all XML is freed */
     clixon_err_exit();
     clicon_debug(1, "%s pid:%u done", __FUNCTION__, getpid());
     clicon_log_exit(); /* Must be after last clicon_debug */
@@ -824,6 +826,7 @@ restconf_config_init(clicon_handle h,
  * @param[in]  port      TCP port
  * @param[in]  backlog  Listen backlog, queie of pending connections
  * @param[in]  flags    Socket flags OR:ed in with the socket(2) type parameter
+ * @param[in]  reuseport Set SO_REUSEPORT, several worker processes bind the same address
  * @param[out] ss        Server socket (bound for accept)
  */
 int
@@ -833,6 +836,7 @@ restconf_socket_init(const char   *netns0,
                      uint16_t      port,
                      int           backlog,
                      int           flags,
+                     int           reuseport,
                      int          *ss)
 {
     int                 retval = -1;
@@ -849,7 +853,7 @@ restconf_socket_init(const char   *netns0,
         netns = netns0;
     if (clixon_inet2sin(addrtype, addrstr, port, sa, &sa_len) < 0)
         goto done;
-    if (clixon_netns_socket(netns, sa, sa_len, backlog, flags, addrstr, ss) < 0)
+    if (clixon_netns_socket(netns, sa, sa_len, backlog, flags, reuseport, addrstr, ss) < 0)
         goto done;
     clicon_debug(1, "%s ss=%d", __FUNCTION__, *ss);
     retval = 0;
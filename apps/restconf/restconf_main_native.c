@@ -120,12 +120,15 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
+#include <inttypes.h>
 #include <syslog.h>
 #include <pwd.h>
 #include <ctype.h>
 #include <signal.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
 #include <arpa/inet.h>
 #include <sys/resource.h>
 
@@ -537,6 +540,7 @@ restconf_accept_client(int   fd,
 {
     int                     retval = -1;
     restconf_socket        *rsock;
+    restconf_native_handle *rn;
     clicon_handle           h;
     int                     s;
     struct sockaddr         from = {0,};
@@ -586,6 +590,9 @@ restconf_accept_client(int   fd,
                  rsock->rs_addrstr,
                  rsock->rs_port);
     clicon_data_set(h, "session-source-host", rsock->rs_from_addr);
+    if ((rn = restconf_native_handle_get(h)) != NULL &&
+        rn->rn_stats != NULL && rn->rn_worker >= 0)
+        rn->rn_stats[rn->rn_worker].rw_accepts++;
     /* Accept SSL */
     if (restconf_ssl_accept_client(h, s, rsock, NULL) < 0)
         goto done;
@@ -637,6 +644,8 @@ restconf_native_terminate(clicon_handle h)
         }
         if (rn->rn_ctx)
             SSL_CTX_free(rn->rn_ctx);
+        if (rn->rn_stats)
+            munmap(rn->rn_stats, rn->rn_workers*sizeof(*rn->rn_stats));
         free(rn);
     }
     EVP_cleanup();
@@ -753,6 +762,10 @@ openssl_init_socket(clicon_handle h,
     /* Extract socket parameters from single socket config: ns, addr, port, ssl */
     if (restconf_socket_extract(h, xs, nsc, rsock, &netns, &address, &addrtype, &port) < 0)
         goto done;
+    if ((rn = restconf_native_handle_get(h)) == NULL){
+        clicon_err(OE_XML, EFAULT, "No openssl handle");
+        goto done;
+    }
     if (rsock->rs_callhome){
         if (!rsock->rs_ssl){
             clicon_err(OE_SSL, EINVAL, "Restconf callhome requires SSL");
@@ -760,7 +773,8 @@ openssl_init_socket(clicon_handle h,
         }
     }
     else { /* listen/accept */
-        /* Open restconf socket and bind for later accept */
+        /* Open restconf socket and bind for later accept
+         * Several workers bind the same address, see restconf_workers_start */
         if (restconf_socket_init(netns, address, addrtype, port,
                              SOCKET_LISTEN_BACKLOG,
 #ifdef RESTCONF_OPENSSL_NONBLOCKING
@@ -768,14 +782,11 @@ openssl_init_socket(clicon_handle h,
 #else /* blocking */
                                  0,
 #endif
+                                 rn->rn_workers > 1,
                                  &ss
                                  ) < 0)
             goto done;
     }
-    if ((rn = restconf_native_handle_get(h)) == NULL){
-        clicon_err(OE_XML, EFAULT, "No openssl handle");
-        goto done;
-    }
     if ((rsock->rs_addrstr = strdup(address)) == NULL){
         clicon_err(OE_UNIX, errno, "strdup");
         goto done;
@@ -888,6 +899,10 @@ restconf_openssl_init(clicon_handle h,
     if (xpath_vec(xrestconf, nsc, "socket", &vec, &veclen) < 0)
         goto done;
     for (i=0; i<veclen; i++){
+        /* Only first worker calls home, otherwise there would be one connection per worker */
+        if (rn->rn_worker > 0 &&
+            xpath_first(vec[i], nsc, "call-home") != NULL)
+            continue;
         if (openssl_init_socket(h, vec[i], nsc) < 0){
             /* Bind errors are ignored, proceed with next after log */
             if (clicon_errno == OE_UNIX && clicon_suberrno == EADDRNOTAVAIL)
@@ -1100,6 +1115,233 @@ restconf_sig_term(int arg)
     clixon_exit_set(1); 
 }
 
+/*! Signal child: worker process exited
+ *
+ * Handler is needed for sigsuspend to return, workers are reaped in restconf_supervisor
+ */
+static void
+restconf_sig_child(int arg)
+{
+}
+
+/* Set by SIGUSR1 in supervisor: log worker statistics */
+static int _restconf_sig_stats = 0;
+
+/*! Signal user1: log aggregated worker statistics
+ */
+static void
+restconf_sig_stats(int arg)
+{
+    _restconf_sig_stats++;
+}
+
+/*! Log per-worker and aggregated statistics
+ *
+ * @param[in]  rn    Restconf native handle
+ */
+static void
+restconf_workers_stats_log(restconf_native_handle *rn)
+{
+    restconf_worker_stats *rw;
+    uint64_t               accepts = 0;
+    uint64_t               requests = 0;
+    int                    i;
+
+    for (i=0; i<rn->rn_workers; i++){
+        rw = &rn->rn_stats[i];
+        clicon_log(LOG_NOTICE, "%s: worker %d pid: %u restarts: %u accepts: %" PRIu64 " requests: %" PRIu64,
+                   __PROGRAM__, i, rw->rw_pid, rw->rw_restarts, rw->rw_accepts, rw->rw_requests);
+        accepts += rw->rw_accepts;
+        requests += rw->rw_requests;
+    }
+    clicon_log(LOG_NOTICE, "%s: workers: %d accepts: %" PRIu64 " requests: %" PRIu64,
+               __PROGRAM__, rn->rn_workers, accepts, requests);
+}
+
+/*! Fork a restconf worker process
+ *
+ * The child returns and continues as worker, with its own backend session: the
+ * backend socket and session-id of the supervisor are not shared but re-opened
+ * on first backend RPC.
+ * @param[in]  h     Clicon handle
+ * @param[in]  rn    Restconf native handle
+ * @param[in]  i     Worker number
+ * @retval     0     OK, parent
+ * @retval     1     OK, child (worker)
+ * @retval    -1     Error
+ */
+static int
+restconf_worker_fork(clicon_handle           h,
+                     restconf_native_handle *rn,
+                     int                     i)
+{
+    pid_t pid;
+    int   s;
+
+    if ((pid = fork()) < 0){
+        clicon_err(OE_UNIX, errno, "fork");
+        return -1;
+    }
+    if (pid != 0){ /* Supervisor */
+        rn->rn_stats[i].rw_pid = pid;
+        clicon_debug(1, "%s worker %d pid: %u", __FUNCTION__, i, pid);
+        return 0;
+    }
+    /* Worker */
+    rn->rn_worker = i;
+    if ((s = clicon_client_socket_get(h)) != -1){
+        close(s);
+        clicon_client_socket_set(h, -1);
+    }
+    clicon_session_id_del(h);
+    if (set_signal(SIGCHLD, SIG_DFL, NULL) < 0 ||
+        set_signal(SIGUSR1, SIG_IGN, NULL) < 0){
+        clicon_err(OE_DAEMON, errno, "Setting signal");
+        return -1;
+    }
+    clicon_signal_unblock(0);
+    return 1;
+}
+
+/*! Start restconf worker processes
+ *
+ * If more than one worker, fork workers that each open all listen sockets with SO_REUSEPORT
+ * and run their own event loop, while this process continues as supervisor.
+ * Worker statistics are kept in memory shared between supervisor and workers.
+ * @param[in]  h       Clicon handle
+ * @param[in]  rn      Restconf native handle
+ * @param[in]  workers Number of workers
+ * @retval     0       OK, rn_worker is set to worker number, or -1 in supervisor
+ * @retval    -1       Error
+ * @see restconf_supervisor
+ */
+static int
+restconf_workers_start(clicon_handle           h,
+                       restconf_native_handle *rn,
+                       int                     workers)
+{
+    int retval = -1;
+    int i;
+    int ret;
+
+    if ((rn->rn_stats = mmap(NULL, workers*sizeof(*rn->rn_stats),
+                             PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0)) == MAP_FAILED){
+        rn->rn_stats = NULL;
+        clicon_err(OE_UNIX, errno, "mmap");
+        goto done;
+    }
+    memset(rn->rn_stats, 0, workers*sizeof(*rn->rn_stats));
+    rn->rn_workers = workers;
+    if (workers == 1){ /* Single process */
+        rn->rn_worker = 0;
+        rn->rn_stats[0].rw_pid = getpid();
+        goto ok;
+    }
+    rn->rn_worker = -1;
+    if (set_signal(SIGCHLD, restconf_sig_child, NULL) < 0 ||
+        set_signal(SIGUSR1, restconf_sig_stats, NULL) < 0){
+        clicon_err(OE_DAEMON, errno, "Setting signal");
+        goto done;
+    }
+    /* Block signals handled by supervisor, see sigsuspend in restconf_supervisor */
+    clicon_signal_block(SIGCHLD);
+    clicon_signal_block(SIGTERM);
+    clicon_signal_block(SIGINT);
+    clicon_signal_block(SIGUSR1);
+    for (i=0; i<workers; i++){
+        if ((ret = restconf_worker_fork(h, rn, i)) < 0)
+            goto done;
+        if (ret == 1) /* worker */
+            break;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Supervise restconf worker processes until terminated
+ *
+ * A worker killed by a signal, eg a crash, is restarted. A worker that exits is not
+ * restarted, instead all workers are terminated and the supervisor exits, with error
+ * if the worker exit status is non-zero.
+ * SIGTERM/SIGINT terminates all workers, SIGUSR1 logs worker statistics.
+ * @param[in]  h     Clicon handle
+ * @param[in]  rn    Restconf native handle
+ * @retval     0     OK, terminated by signal, this process is supervisor
+ * @retval     1     OK, this process is a restarted worker
+ * @retval    -1     Error, or worker exited
+ */
+static int
+restconf_supervisor(clicon_handle           h,
+                    restconf_native_handle *rn)
+{
+    int      retval = -1;
+    sigset_t oset;
+    pid_t    pid;
+    int      status;
+    int      i;
+    int      ret;
+    int      exited = 0;
+
+    clicon_debug(1, "%s workers: %d", __FUNCTION__, rn->rn_workers);
+    sigemptyset(&oset);
+    while (clixon_exit_get() != 1){
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0){
+            for (i=0; i<rn->rn_workers; i++)
+                if (rn->rn_stats[i].rw_pid == pid)
+                    break;
+            if (i == rn->rn_workers)
+                continue;
+            rn->rn_stats[i].rw_pid = 0;
+            if (clixon_exit_get() == 1) /* Already terminating */
+                continue;
+            if (WIFSIGNALED(status)){
+                clicon_log(LOG_WARNING, "%s: worker %d pid: %u killed by signal %d, restarting",
+                           __PROGRAM__, i, pid, WTERMSIG(status));
+                rn->rn_stats[i].rw_restarts++;
+                if ((ret = restconf_worker_fork(h, rn, i)) < 0)
+                    goto done;
+                if (ret == 1){ /* restarted worker */
+                    retval = 1;
+                    goto done;
+                }
+            }
+            else {
+                clicon_log(LOG_NOTICE, "%s: worker %d pid: %u exited with status %d, terminating",
+                           __PROGRAM__, i, pid, WEXITSTATUS(status));
+                if (WEXITSTATUS(status) != 0)
+                    exited++;
+                clixon_exit_set(1);
+            }
+        }
+        if (clixon_exit_get() == 1)
+            break;
+        if (_restconf_sig_stats){
+            _restconf_sig_stats = 0;
+            restconf_workers_stats_log(rn);
+        }
+        sigsuspend(&oset); /* Wait for signal with all signals unblocked */
+    }
+    /* Terminate and wait for remaining workers */
+    for (i=0; i<rn->rn_workers; i++)
+        if (rn->rn_stats[i].rw_pid != 0)
+            kill(rn->rn_stats[i].rw_pid, SIGTERM);
+    for (i=0; i<rn->rn_workers; i++)
+        if (rn->rn_stats[i].rw_pid != 0){
+            waitpid(rn->rn_stats[i].rw_pid, &status, 0);
+            rn->rn_stats[i].rw_pid = 0;
+        }
+    restconf_workers_stats_log(rn);
+    if (exited){
+        clicon_err(OE_DAEMON, 0, "Restconf worker exited");
+        goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Usage help routine
  *
  * @param[in]  argv0  command line
@@ -1144,6 +1386,9 @@ main(int    argc,
     int             ret;
     cxobj          *xrestconf = NULL;
     char           *inline_config = NULL;
+    cxobj          *x;
+    char           *bstr;
+    int             workers = 1;
 
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init(__PROGRAM__, LOG_INFO, logdst);
@@ -1309,6 +1554,22 @@ main(int    argc,
     memset(rn, 0, sizeof *rn);
     if (restconf_native_handle_set(h, rn) < 0)
         goto done;
+    /* Fork worker processes if configured, this process continues as worker or supervisor */
+    if ((x = xpath_first(xrestconf, NULL, "workers")) != NULL &&
+        (bstr = xml_body(x)) != NULL &&
+        (workers = atoi(bstr)) < 1)
+        workers = 1;
+    if (restconf_workers_start(h, rn, workers) < 0)
+        goto done;
+    if (rn->rn_worker == -1){ /* Supervisor */
+        if ((ret = restconf_supervisor(h, rn)) < 0)
+            goto done;
+        if (ret == 0){
+            retval = 0;
+            goto done;
+        }
+        /* Restarted worker */
+    }
     /* Openssl inits */ 
     if (restconf_openssl_init(h, dbg, xrestconf) < 0)
         goto done;
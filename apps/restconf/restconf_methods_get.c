@@ -66,6 +66,143 @@
 /* Forward */
 static int api_data_pagination(clicon_handle h, void *req, char *api_path, int pi, cvec *qvec, int pretty, restconf_media media_out);
 
+/* Deferred GET reply, argument of api_data_get_cb */
+struct api_data_get_arg{
+    void          *ag_req;      /* Generic www handle */
+    int            ag_pretty;   /* Pretty-printed xml/json output */
+    restconf_media ag_media;    /* Output media */
+    int            ag_head;     /* If 1 is HEAD, otherwise GET */
+    int            ag_notfound; /* No data is "404 Not Found", ie xpath is not root */
+};
+
+/*! Send reply to GET (or HEAD) of data printed by the backend
+ * @param[in]  h        Clixon handle
+ * @param[in]  req      Generic Www handle
+ * @param[in]  ret      Return value of clicon_rpc_get_format, if -1 clicon_err is set
+ * @param[in]  cbx      Data, consumed
+ * @param[in]  xret     Error reply if ret is 0
+ * @param[in]  notfound If set, no data is "404 Not Found"
+ * @param[in]  pretty   Set to 1 for pretty-printed xml/json output
+ * @param[in]  media_out Output media
+ * @param[in]  head     If 1 is HEAD, otherwise GET
+ */
+static int
+api_data_get_reply(clicon_handle  h,
+                   void          *req,
+                   int            ret,
+                   cbuf          *cbx,
+                   cxobj         *xret,
+                   int            notfound,
+                   int            pretty,
+                   restconf_media media_out,
+                   int            head)
+{
+    int        retval = -1;
+    cxobj     *xerr = NULL; /* malloced */
+    cxobj     *xe = NULL;   /* not malloced */
+
+    if (ret < 0){
+        if (netconf_operation_failed_xml(&xerr, "protocol", clicon_err_reason) < 0)
+            goto done;
+        if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+            goto done;
+        goto ok;
+    }
+    /* Check if error return  */
+    if (ret == 0){
+        if ((xe = xpath_first(xret, NULL, "//rpc-error")) == NULL){
+            if (netconf_operation_failed_xml(&xerr, "application", "Internal error, no rpc-error in error reply") < 0)
+                goto done;
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto ok;
+        }
+        if (api_return_err(h, req, xe, pretty, media_out, 0) < 0)
+            goto done;
+        goto ok;
+    }
+    /* Check if not exists */
+    if (cbuf_len(cbx) == 0 && notfound){
+        /* 4.3: If a retrieval request for a data resource represents an 
+           instance that does not exist, then an error response containing 
+           a "404 Not Found" status-line MUST be returned by the server.  
+           The error-tag value "invalid-value" is used in this case. */
+        if (netconf_invalid_value_xml(&xerr, "application", "Instance does not exist") < 0)
+            goto done;
+        /* override invalid-value default 400 with 404 */
+        if (api_return_err0(h, req, xerr, pretty, media_out, 404) < 0)
+            goto done;
+        goto ok;
+    }
+    clicon_debug(1, "%s cbuf:%s", __FUNCTION__, cbuf_get(cbx));
+    if (restconf_reply_header(req, "Content-Type", "%s", restconf_media_int2str(media_out)) < 0)
+        goto done;
+    if (restconf_reply_header(req, "Cache-Control", "no-cache") < 0)
+        goto done;
+    if (restconf_reply_send(req, 200, cbx, head) < 0)
+        goto done;
+    cbx = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (cbx)
+        cbuf_free(cbx);
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
+/*! Backend reply callback of deferred GET, send the reply
+ * @param[in]  h      Clixon handle
+ * @param[in]  reqid  Request id
+ * @param[in]  data   Reply, or NULL if backend closed socket
+ * @param[in]  arg    struct api_data_get_arg, freed on resume
+ * @see api_data_get2  where the request is sent
+ */
+static int
+api_data_get_cb(clicon_handle h,
+                uint32_t      reqid,
+                char         *data,
+                void         *arg)
+{
+    int                      retval = -1;
+    struct api_data_get_arg *ag = (struct api_data_get_arg *)arg;
+    void                    *req = ag->ag_req;
+    cbuf                    *cbx = NULL;
+    cxobj                   *xret = NULL;
+    int                      ret = -1;
+
+    clicon_debug(1, "%s reqid:%u", __FUNCTION__, reqid);
+    if ((cbx = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto fail;
+    }
+    /* If backend closed socket, ret is -1 and clicon_err is set */
+    if (data != NULL)
+        ret = clicon_rpc_get_format_reply(data, cbx, &xret);
+    ret = api_data_get_reply(h, req, ret, cbx, xret, ag->ag_notfound,
+                             ag->ag_pretty, ag->ag_media, ag->ag_head);
+    cbx = NULL;
+    if (ret < 0)
+        goto fail;
+ resume:
+    /* Always resume, otherwise the request is never replied */
+    if (restconf_reply_resume(req) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cbx)
+        cbuf_free(cbx);
+    if (xret)
+        xml_free(xret);
+    return retval;
+ fail:
+    clicon_log(LOG_WARNING, "%s: %s", __FUNCTION__, clicon_err_reason);
+    if (restconf_reply_send(req, 500, NULL, 0) < 0) /* Internal server error */
+        goto done;
+    goto resume;
+}
+
 /*! Generic GET (both HEAD and GET)
  * According to restconf 
  * @param[in]  h        Clixon handle
@@ -93,6 +230,7 @@ static int api_data_pagination(clicon_handle h, void *req, char *api_path, int p
  * "400 Bad Request" status-line MUST be returned by the server.
  * Netconf: <get-config>, <get>                        
  * @note there is an ad-hoc method to determine json pagination request instead of regular GET
+ * @note if the reply can be deferred, it is sent by api_data_get_cb when the backend replies
  */
 static int
 api_data_get2(clicon_handle  h,
@@ -110,11 +248,7 @@ api_data_get2(clicon_handle  h,
     yang_stmt *yspec;
     cxobj     *xret = NULL;
     cxobj     *xerr = NULL; /* malloced */
-    cxobj     *xe = NULL;   /* not malloced */
-    cxobj    **xvec = NULL;
-    size_t     xlen;
     int        i;
-    cxobj     *x;
     int        ret;
     cvec      *nsc = NULL;
     char      *attr; /* attribute value string */
@@ -124,7 +258,10 @@ api_data_get2(clicon_handle  h,
     cxobj     *xbot = NULL;
     yang_stmt *y = NULL;
     char      *defaults = NULL;
-    cvec      *nscd = NULL;
+    int        notfound;
+    enum format_enum format;
+    struct api_data_get_arg *ag = NULL;
+    uint32_t   reqid = 0;
     
     clicon_debug(1, "%s", __FUNCTION__);
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
@@ -201,111 +338,52 @@ api_data_get2(clicon_handle  h,
     }
 
     clicon_debug(1, "%s path:%s", __FUNCTION__, xpath);
-    ret = clicon_rpc_get(h, xpath, nsc, content, depth, defaults, &xret);
-
-    if (ret < 0){
-        if (netconf_operation_failed_xml(&xerr, "protocol", clicon_err_reason) < 0)
-            goto done;
-        if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+    notfound = xpath != NULL && strcmp(xpath, "/") != 0;
+    /* The backend prints the selected data in the reply media, it is used as body as-is */
+    format = media_out==YANG_DATA_JSON?FORMAT_JSON:FORMAT_XML;
+    if (restconf_reply_deferrable(req)){
+        /* Do not wait for the backend, other requests are served meanwhile */
+        if ((ag = malloc(sizeof(*ag))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
             goto done;
-        goto ok;
-    }
-    /* We get return via netconf which is complete tree from root 
-     * We need to cut that tree to only the object.
-     */
-#if 0 /* DEBUG */
-    if (clicon_debug_get())
-        clicon_debug_xml(1, xret, "%s xret:", __FUNCTION__);
-#endif
-    /* Check if error return  */
-    if ((xe = xpath_first(xret, NULL, "//rpc-error")) != NULL){
-        if (api_return_err(h, req, xe, pretty, media_out, 0) < 0)
+        }
+        memset(ag, 0, sizeof(*ag));
+        ag->ag_req = req;
+        ag->ag_pretty = pretty;
+        ag->ag_media = media_out;
+        ag->ag_head = head;
+        ag->ag_notfound = notfound;
+        if (clicon_rpc_get_format_async(h, xpath, nsc, content, depth, defaults,
+                                        format, pretty,
+                                        api_data_get_cb, ag, &reqid) < 0){
+            if (api_data_get_reply(h, req, -1, NULL, NULL, notfound, pretty, media_out, head) < 0)
+                goto done;
+            goto ok;
+        }
+        if (restconf_reply_defer(req, reqid, ag) < 0)
             goto done;
+        ag = NULL;
         goto ok;
     }
-    /* Normal return, no error */
     if ((cbx = cbuf_new()) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    if (xpath==NULL || strcmp(xpath,"/")==0){ /* Special case: data root */
-        switch (media_out){
-        case YANG_DATA_XML:
-            if (clixon_xml2cbuf(cbx, xret, 0, pretty, -1, 0) < 0) /* Dont print top object?  */
-                goto done;
-            break;
-        case YANG_DATA_JSON:
-            if (clixon_json2cbuf(cbx, xret, pretty, 0, 0) < 0)
-                goto done;
-            break;
-        default:
-            break;
-        }
-    }
-    else{
-        if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath) < 0){
-            if (netconf_operation_failed_xml(&xerr, "application", clicon_err_reason) < 0)
-                goto done;
-            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
-                goto done;
-            goto ok;
-        }
-        /* Check if not exists */
-        if (xlen == 0){
-            /* 4.3: If a retrieval request for a data resource represents an 
-               instance that does not exist, then an error response containing 
-               a "404 Not Found" status-line MUST be returned by the server.  
-               The error-tag value "invalid-value" is used in this case. */
-            if (netconf_invalid_value_xml(&xerr, "application", "Instance does not exist") < 0)
-                goto done;
-            /* override invalid-value default 400 with 404 */
-            if (api_return_err0(h, req, xerr, pretty, media_out, 404) < 0)
-                goto done;
-            goto ok;
-        }
-        switch (media_out){
-        case YANG_DATA_XML:
-            for (i=0; i<xlen; i++){
-                x = xvec[i];
-                if (xml_nsctx_node(x, &nscd) < 0)
-                    goto done;
-                if (xmlns_set_all(x, nscd) < 0)
-                    goto done;
-                if (nscd){
-                    cvec_free(nscd);
-                    nscd = NULL;
-                }
-                if (clixon_xml2cbuf(cbx, x, 0, pretty, -1, 0) < 0) /* Dont print top object?  */
-                    goto done;
-            }
-            break;
-        case YANG_DATA_JSON:
-            /* In: <x xmlns="urn:example:clixon">0</x>
-             * Out: {"example:x": {"0"}}
-             */
-            if (xml2json_cbuf_vec(cbx, xvec, xlen, pretty, 0) < 0)
-                goto done;
-            break;
-        default:
-            break;
-        }
-    }
-    clicon_debug(1, "%s cbuf:%s", __FUNCTION__, cbuf_get(cbx));
-    if (restconf_reply_header(req, "Content-Type", "%s", restconf_media_int2str(media_out)) < 0)
-        goto done;
-    if (restconf_reply_header(req, "Cache-Control", "no-cache") < 0)
-        goto done;
-    if (restconf_reply_send(req, 200, cbx, head) < 0)
+    ret = clicon_rpc_get_format(h, xpath, nsc, content, depth, defaults,
+                                format, pretty, cbx, &xret);
+    if (api_data_get_reply(h, req, ret, cbx, xret, notfound, pretty, media_out, head) < 0){
+        cbx = NULL;
         goto done;
+    }
     cbx = NULL;
  ok:
     retval = 0;
  done:
     clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    if (ag)
+        free(ag);
     if (xpath)
         free(xpath);
-    if (nscd)
-        cvec_free(nscd);
     if (nsc)
         xml_nsctx_free(nsc);
     if (xtop)
@@ -316,8 +394,6 @@ api_data_get2(clicon_handle  h,
         xml_free(xret);
     if (xerr)
         xml_free(xerr);
-    if (xvec)
-        free(xvec);
     return retval;
 }
 
@@ -143,6 +143,12 @@ restconf_stream_find(restconf_conn *rc,
 int
 restconf_stream_free(restconf_stream_data *sd)
 {
+    if (sd->sd_reqid != 0){
+        /* Backend still processes the request, but the reply is dropped */
+        clicon_rpc_async_cancel(sd->sd_conn->rc_h, sd->sd_reqid);
+        if (sd->sd_reqarg)
+            free(sd->sd_reqarg);
+    }
     if (sd->sd_fd != -1) {
         close(sd->sd_fd);
     }
@@ -635,6 +641,39 @@ read_regular(restconf_conn *rc,
 
 #ifdef HAVE_HTTP1
 
+/*! Write HTTP/1 reply of stream and reset output
+ *
+ * @param[in]  rc     Restconf connection handle, freed if closed
+ * @param[in]  sd     Restconf stream
+ * @retval     -1     Error
+ * @retval     0      Socket closed
+ * @retval     1      OK
+ */
+static int
+restconf_http1_write(restconf_conn        *rc,
+                     restconf_stream_data *sd)
+{
+    int retval = -1;
+    int ret;
+
+    if ((ret = native_buf_write(rc->rc_h, cbuf_get(sd->sd_outp_buf), cbuf_len(sd->sd_outp_buf),
+                                rc, __FUNCTION__)) < 0)
+        goto done;
+    cvec_reset(sd->sd_outp_hdrs); /* Can be done in native_send_reply */
+    cbuf_reset(sd->sd_outp_buf);
+    if (sd->sd_body)
+        cbuf_reset(sd->sd_body);
+    if (ret == 0 || rc->rc_exit){  /* Server-initiated exit */
+        if (restconf_close_ssl_socket(rc, __FUNCTION__, 0) < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
+    retval = 1;
+ done:
+    return retval;
+}
+
 /*! Restconf HTTP/1 processing after chunk of bytes read
  *
  * @param[in]  rc           Restconf connection handle 
@@ -761,24 +800,23 @@ restconf_http1_process(restconf_conn *rc,
     /* main restconf processing */
     if (restconf_http1_path_root(h, rc) < 0)
         goto done;
-    if ((ret = native_buf_write(h, cbuf_get(sd->sd_outp_buf), cbuf_len(sd->sd_outp_buf),
-                                rc, __FUNCTION__)) < 0)
-        goto done;
-    cvec_reset(sd->sd_outp_hdrs); /* Can be done in native_send_reply */
-    cbuf_reset(sd->sd_outp_buf);
     cbuf_reset(sd->sd_inbuf);
     cbuf_reset(sd->sd_indata);
-    if (sd->sd_body)
-        cbuf_reset(sd->sd_body);
     if (sd->sd_qvec){
         cvec_free(sd->sd_qvec);
         sd->sd_qvec = NULL;
     }
-    if (ret == 0 || rc->rc_exit){  /* Server-initiated exit */
-        if (restconf_close_ssl_socket(rc, __FUNCTION__, 0) < 0)
-            goto done;
-        goto closed;
+    /* Reply is sent when the backend has replied, do not read next request until then
+     * @see restconf_stream_resume
+     */
+    if (sd->sd_reqid != 0){
+        clixon_event_unreg_fd(rc->rc_s, restconf_connection);
+        goto ok;
     }
+    if ((ret = restconf_http1_write(rc, sd)) < 0)
+        goto done;
+    if (ret == 0)
+        goto closed;
  ok:
     retval = 1;
  done:
@@ -905,6 +943,58 @@ restconf_http2_process(restconf_conn *rc,
 }
 #endif /* HAVE_LIBNGHTTP2 */
 
+/*! Send deferred reply of stream after its backend rpc is replied
+ *
+ * The reply is set by the rpc callback with restconf_reply_header and restconf_reply_send.
+ * A http/1 connection is read again after the reply is written.
+ * @param[in]  sd   Restconf stream, its connection may be closed and freed
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see restconf_reply_defer
+ */
+int
+restconf_stream_resume(restconf_stream_data *sd)
+{
+    int            retval = -1;
+    restconf_conn *rc = sd->sd_conn;
+#ifdef HAVE_HTTP1
+    int            ret;
+#endif
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    sd->sd_reqid = 0;
+    if (sd->sd_reqarg){
+        free(sd->sd_reqarg);
+        sd->sd_reqarg = NULL;
+    }
+    switch (rc->rc_proto){
+#ifdef HAVE_HTTP1
+    case HTTP_10:
+    case HTTP_11:
+        if (sd->sd_code && restconf_http1_reply(rc, sd) < 0)
+            goto done;
+        if ((ret = restconf_http1_write(rc, sd)) < 0)
+            goto done;
+        if (ret == 1 &&
+            clixon_event_reg_fd(rc->rc_s, restconf_connection, (void*)rc, "restconf client socket") < 0)
+            goto done;
+        break;
+#endif /* HAVE_HTTP1 */
+#ifdef HAVE_LIBNGHTTP2
+    case HTTP_2:
+        if (http2_resume(rc, sd) < 0)
+            goto done;
+        break;
+#endif /* HAVE_LIBNGHTTP2 */
+    default:
+        break;
+    }
+    retval = 0;
+ done:
+    clicon_debug(1, "%s %d", __FUNCTION__, retval);
+    return retval;
+}
+
 /*! Get restconf native handle
  * @param[in]  h     Clicon handle
  * @retval     rn    Restconf native handle
@@ -921,6 +1011,23 @@ restconf_native_handle_get(clicon_handle h)
     return NULL;
 }
 
+/*! Count a received HTTP request in the statistics of this worker
+ *
+ * @param[in]  h     Clicon handle
+ * @retval     0     OK
+ * @see restconf_worker_stats
+ */
+int
+restconf_native_stats_request(clicon_handle h)
+{
+    restconf_native_handle *rn;
+
+    if ((rn = restconf_native_handle_get(h)) != NULL &&
+        rn->rn_stats != NULL && rn->rn_worker >= 0)
+        rn->rn_stats[rn->rn_worker].rw_requests++;
+    return 0;
+}
+
 /*---------------------------- Connect ---------------------------------*/
 
 /*! New data connection after accept, receive and reply on data socket
@@ -92,6 +92,8 @@ typedef struct  {
     void                 *sd_req;       /* Lib-specific request */
     int                   sd_upgrade2;  /* Upgrade to http/2 */
     uint8_t              *sd_settings2; /* Settings for upgrade to http/2 request */
+    uint32_t              sd_reqid;     /* Outstanding backend rpc, reply deferred until done */
+    void                 *sd_reqarg;    /* Reply callback argument of sd_reqid, malloced */
 } restconf_stream_data;
 
 typedef struct restconf_socket restconf_socket;
@@ -113,6 +115,7 @@ typedef struct restconf_conn {
     SSL                  *rc_ssl;       /* Structure for SSL connection */
     restconf_stream_data *rc_streams; /* List of http/2 session streams */
     int                   rc_exit;    /* Set to close socket server-side */
+    int                   rc_recv;    /* Set while processing http/2 input */
     /* Decision to keep lib-specific data here, otherwise new struct necessary
      * drawback is specific includes need to go everywhere */
 #ifdef HAVE_LIBNGHTTP2
@@ -159,6 +162,17 @@ typedef struct restconf_socket{
 
 } restconf_socket;
 
+/* Per-worker statistics
+ * One entry per worker in memory shared with the supervisor, see restconf_workers_start
+ * Each entry is only written by its worker
+ */
+typedef struct {
+    pid_t           rw_pid;        /* Worker process id, 0 if not running */
+    uint32_t        rw_restarts;   /* Times worker has been restarted by supervisor */
+    uint64_t        rw_accepts;    /* Accepted connections */
+    uint64_t        rw_requests;   /* Received HTTP requests (http/1 or http/2 streams) */
+} restconf_worker_stats;
+
 /* Restconf handle 
  * Global data about ssl (not per packet/request)
  */
@@ -166,6 +180,9 @@ typedef struct {
     SSL_CTX         *rn_ctx;       /* SSL context */
     restconf_socket *rn_sockets;   /* List of restconf server (ready for accept) sockets */
     void            *rn_arg;       /* Packet specific handle */
+    int              rn_workers;   /* Number of worker processes */
+    int              rn_worker;    /* This worker: 0..rn_workers-1, or -1 if supervisor */
+    restconf_worker_stats *rn_stats; /* Shared vector of rn_workers stats entries */
 } restconf_native_handle;
 
 /*
@@ -174,12 +191,14 @@ typedef struct {
 restconf_stream_data *restconf_stream_data_new(restconf_conn *rc, int32_t stream_id);
 restconf_stream_data *restconf_stream_find(restconf_conn *rc, int32_t id);
 int               restconf_stream_free(restconf_stream_data *sd);
+int               restconf_stream_resume(restconf_stream_data *sd);
 restconf_conn    *restconf_conn_new(clicon_handle h, int s, restconf_socket *socket);
 int               ssl_x509_name_oneline(SSL *ssl, char **oneline);
 
 int               restconf_close_ssl_socket(restconf_conn *rc, const char *callfn, int sslerr0);
 int               restconf_connection_sanity(clicon_handle h, restconf_conn *rc, restconf_stream_data *sd);
 restconf_native_handle *restconf_native_handle_get(clicon_handle h);
+int               restconf_native_stats_request(clicon_handle h);
 int               restconf_connection(int s, void *arg);
 int               restconf_ssl_accept_client(clicon_handle h, int s, restconf_socket *rsock, restconf_conn  **rcp);
 int               restconf_idle_timer_unreg(restconf_conn *rc);
@@ -310,6 +310,7 @@ restconf_nghttp2_path(restconf_stream_data *sd)
     /* Check sanity of session, eg ssl client cert validation, may set rc_exit */
     if (restconf_connection_sanity(h, rc, sd) < 0)
         goto done;
+    restconf_native_stats_request(h);
     if (!rc->rc_exit){
         /* Matching algorithm:
          * 1. try well-known
@@ -456,6 +457,38 @@ restconf_submit_response(nghttp2_session      *session,
     return retval;
 }
 
+/*! Submit reply of a stream
+ */
+static int
+http2_reply(restconf_conn        *rc,
+            restconf_stream_data *sd,
+            nghttp2_session      *session,
+            int32_t               stream_id)
+{
+    int retval = -1;
+
+    /* If body, add a content-length header 
+     *    A server MUST NOT send a Content-Length header field in any response
+     * with a status code of 1xx (Informational) or 204 (No Content).  A
+     * server MUST NOT send a Content-Length header field in any 2xx
+     * (Successful) response to a CONNECT request (Section 4.3.6 of
+     * [RFC7231]).
+     */
+    if (sd->sd_code != 204 && sd->sd_code > 199 && sd->sd_body_len)
+        if (restconf_reply_header(sd, "Content-Length", "%zu", sd->sd_body_len) < 0)
+            goto done;  
+    if (sd->sd_code){
+        if (restconf_submit_response(session, rc, stream_id, sd) < 0)
+            goto done;
+    }
+    else {
+        /* 500 Internal server error ? */
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Simulate a received request in an upgrade scenario by talking the http/1 parameters
  */
 int
@@ -485,24 +518,44 @@ http2_exec(restconf_conn        *rc,
     }
     if (restconf_param_del_all(rc->rc_h) < 0) // XXX
         goto done;
+    /* If deferred, reply is submitted in http2_resume */
+    if (sd->sd_reqid == 0 &&
+        http2_reply(rc, sd, session, stream_id) < 0)
+        goto done;
+    retval = 0;
+ done:
+    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    return retval;
+}
 
-    /* If body, add a content-length header 
-     *    A server MUST NOT send a Content-Length header field in any response
-     * with a status code of 1xx (Informational) or 204 (No Content).  A
-     * server MUST NOT send a Content-Length header field in any 2xx
-     * (Successful) response to a CONNECT request (Section 4.3.6 of
-     * [RFC7231]).
-     */
-    if (sd->sd_code != 204 && sd->sd_code > 199 && sd->sd_body_len)
-        if (restconf_reply_header(sd, "Content-Length", "%zu", sd->sd_body_len) < 0)
-            goto done;  
-    if (sd->sd_code){
-        if (restconf_submit_response(session, rc, stream_id, sd) < 0)
-            goto done;
-    }
-    else {
-        /* 500 Internal server error ? */
+/*! Submit and send deferred reply of a stream after the backend has replied
+ *
+ * @param[in]  rc   Restconf connection
+ * @param[in]  sd   Restconf stream
+ * @retval     0    OK, also if stream is closed by peer
+ * @retval    -1    Error
+ * @see restconf_stream_resume
+ */
+int
+http2_resume(restconf_conn        *rc,
+             restconf_stream_data *sd)
+{
+    int           retval = -1;
+    nghttp2_error ngerr;
+
+    clicon_debug(1, "%s %d", __FUNCTION__, sd->sd_stream_id);
+    if (nghttp2_session_find_stream(rc->rc_ngsession, sd->sd_stream_id) == NULL)
+        goto ok; /* Closed by peer */
+    if (http2_reply(rc, sd, rc->rc_ngsession, sd->sd_stream_id) < 0)
+        goto done;
+    /* If called from within http2_recv, the reply is sent when input is processed */
+    if (!rc->rc_recv){
+        clicon_err_reset();
+        if ((ngerr = nghttp2_session_send(rc->rc_ngsession)) != 0 &&
+            clicon_errno)
+            goto done; /* Otherwise not fatal, connection is closed on next read */
     }
+ ok:
     retval = 0;
  done:
     clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
@@ -898,7 +951,10 @@ http2_recv(restconf_conn       *rc,
         goto done;
     }
     /* may make additional pending frames */
-    if ((ngerr = nghttp2_session_mem_recv(rc->rc_ngsession, buf, n)) < 0){
+    rc->rc_recv = 1;
+    ngerr = nghttp2_session_mem_recv(rc->rc_ngsession, buf, n);
+    rc->rc_recv = 0;
+    if (ngerr < 0){
         if (ngerr == NGHTTP2_ERR_BAD_CLIENT_MAGIC){
             /* :enum:`NGHTTP2_ERR_BAD_CLIENT_MAGIC`
              *     Invalid client magic was detected.  This error only returns
@@ -1152,6 +1152,8 @@ snmp_table_set(clicon_handle               h,
 }
 
 /*! Find "next" object from oids minus key and return that.
+ * The next object is found by a binary search in the polled and sorted table index,
+ * the backend is only queried if the table is not polled or the poll is too old.
  * @param[in]  h        Clixon handle
  * @param[in]  ylist    Yang of table (of list type)
  * @param[in]  oids     OID of ultimate scalar value
@@ -1161,6 +1163,7 @@ snmp_table_set(clicon_handle               h,
  * @retval     1        OK
  * @retval     0        Failed
  * @retval    -1        Error
+ * @see mibyang_table_poll
  * XXX: merge with cache
  */
 static int
@@ -1171,103 +1174,46 @@ snmp_table_getnext(clicon_handle               h,
                    netsnmp_agent_request_info *reqinfo,
                    netsnmp_request_info       *request)
 {
-    int        retval = -1;
-    cvec      *nsc = NULL;
-    char      *xpath = NULL;
-    cxobj     *xt = NULL;
-    cxobj     *xerr;
-    cxobj     *xtable;
-    cxobj     *xrow;
-    cxobj     *xcol;
-    yang_stmt *ycol;
-    yang_stmt *ys;
-    int        ret;
-    cvec      *cvk_name;
-    oid        oidc[MAX_OID_LEN] = {0,}; /* Table / list oid */
-    size_t     oidclen = MAX_OID_LEN;
-    oid        oidk[MAX_OID_LEN] = {0,}; /* Key oid */
-    size_t     oidklen = MAX_OID_LEN;
-    oid        oidnext[MAX_OID_LEN] = {0x7fffffff,}; /* Next oid: start with high value */
-    size_t     oidnextlen = MAX_OID_LEN;
-    int        found = 0; 
-    cxobj     *xnext = NULL;
-    yang_stmt *ynext = NULL;
-    cbuf      *cb = NULL;
+    int                      retval = -1;
+    struct snmp_table_index *ti = NULL;
+    struct snmp_table_cell  *tc;
+    size_t                   lo;
+    size_t                   hi;
+    size_t                   mid;
+    int                      found = 0; 
+    cbuf                    *cb = NULL;
 
     clicon_debug(1, "%s", __FUNCTION__);
-    if ((ys = yang_parent_get(ylist)) == NULL ||
-        yang_keyword_get(ys) != Y_CONTAINER){
-        clicon_err(OE_YANG, EINVAL, "ylist parent is not list");
-        goto done;
-    }
-    if (xml_nsctx_yang(ys, &nsc) < 0)
-        goto done;
-    if (snmp_yang2xpath(ys, NULL, &xpath) < 0)
+    if (snmp_table_index_get(h, ylist, &ti) < 0)
         goto done;
-    if (clicon_rpc_get(h, xpath, nsc, CONTENT_ALL, -1, NULL, &xt) < 0)
-        goto done;
-    if ((xerr = xpath_first(xt, NULL, "/rpc-error")) != NULL){
-        clixon_netconf_error(xerr, "clicon_rpc_get", NULL);
-        goto done;
-    }
-    if ((xtable = xpath_first(xt, nsc, "%s", xpath)) != NULL) {
-        /* Make a clone of key-list, but replace names with values */
-        if ((cvk_name = yang_cvec_get(ylist)) == NULL){
-            clicon_err(OE_YANG, 0, "No keys");
-            goto done;
-        }
-        xrow = NULL;
-        while ((xrow = xml_child_each(xtable, xrow, CX_ELMNT)) != NULL) {
-            /* Get key part of OID from XML list entry */
-            if ((ret = snmp_xmlkey2val_oid(xrow, cvk_name, NULL, /*&cvk_oid,*/ oidk, &oidklen)) < 0)
-                goto done;
-            if (ret == 0)
-                continue; /* skip row, not all indexes */
-            xcol = NULL;
-            while ((xcol = xml_child_each(xrow, xcol, CX_ELMNT)) != NULL) {
-                if ((ycol = xml_spec(xcol)) == NULL)
-                    continue;
-                if (yang_keyword_get(ycol) != Y_LEAF)
-                    continue;
-                if ((ret = yangext_oid_get(ycol, oidc, &oidclen, NULL)) < 0)
-                    goto done;
-                if (ret == 0)
-                    continue;
-                /* Append key oid */
-                if (oid_append(oidc, &oidclen, oidk, oidklen) < 0)
-                    goto done;
-                /* Get smallest larger */
-                if (oid_eq(oidc, oidclen, oids, oidslen) > 0 &&
-                    oid_eq(oidc, oidclen, oidnext, oidnextlen) < 0){
-                    memcpy(oidnext, oidc, oidclen*sizeof(*oidnext));
-                    oidnextlen = oidclen;
-                    xnext = xcol;
-                    ynext = ycol;
-                    found++;
-                }
-            } /* while xcol */
-        } /* while xrow */
+    /* Binary search for the first cell with larger OID than requested */
+    lo = 0;
+    hi = ti->ti_len;
+    while (lo < hi){
+        mid = lo + (hi - lo)/2;
+        tc = &ti->ti_cells[mid];
+        if (oid_eq(tc->tc_oid, tc->tc_oidlen, oids, oidslen) > 0)
+            hi = mid;
+        else
+            lo = mid + 1;
     }
-    if (found){
-        if (snmp_scalar_return(xnext, ynext, oidnext, oidnextlen, reqinfo, request) < 0)
+    if (lo < ti->ti_len){
+        tc = &ti->ti_cells[lo];
+        if (snmp_scalar_return(tc->tc_xcol, xml_spec(tc->tc_xcol),
+                               tc->tc_oid, tc->tc_oidlen, reqinfo, request) < 0)
             goto done;
+        found++;
         if ((cb = cbuf_new()) == NULL){
             clicon_err(OE_UNIX, errno, "cbuf_new");
             goto done;
         }
-        oid_cbuf(cb, oidnext, oidnextlen);
+        oid_cbuf(cb, tc->tc_oid, tc->tc_oidlen);
         clicon_debug(1, "%s next: %s", __FUNCTION__, cbuf_get(cb));
     }
     retval = found;
  done:
     if (cb)
         cbuf_free(cb);
-    if (xpath)
-        free(xpath);
-    if (xt)
-        xml_free(xt);
-    if (nsc)
-        xml_nsctx_free(nsc);    
     return retval;
 }
 
@@ -1375,6 +1321,8 @@ clixon_snmp_table_handler1(netsnmp_mib_handler          *handler,
             netsnmp_request_set_error(request, SNMP_ERR_COMMITFAILED);
             goto done;
         }
+        /* Tables may have changed, poll again on next getnext */
+        snmp_table_index_reset(sh->sh_h);
         break;
     case MODE_SET_FREE:     // 4
         break;
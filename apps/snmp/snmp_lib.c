@@ -183,7 +183,10 @@ snmp_msg_int2str(int msg)
  * @param[in] objid1     Second OID vector 
  * @param[in] objid1len  Length of second OID vector 
  * @retval   0  Equal
- * @retval !=0  Not equal, see man memcmp
+ * @retval  <0  First OID is lexicographically smaller than second
+ * @retval  >0  First OID is lexicographically larger than second
+ * Sub-identifiers are compared as numbers, not bytes, so that the order is the SNMP
+ * walk order also for sub-identifiers larger than 255
  * Should really be netsnmp lib function, but cant find any?
  */
 int
@@ -193,16 +196,19 @@ oid_eq(const oid *objid0,
        size_t     objid1len)
 {
     size_t min;
-    int    ret;
+    size_t i;
 
     if (objid0len < objid1len)
         min = objid0len;
     else
         min = objid1len;
     /* First compare common prefix */
-    ret = memcmp(objid0, objid1, min*sizeof(*objid0));
-    if (ret != 0)
-        return ret;
+    for (i=0; i<min; i++){
+        if (objid0[i] < objid1[i])
+            return -1;
+        if (objid0[i] > objid1[i])
+            return 1;
+    }
     /* If equal, check lengths */
     if (objid0len < objid1len)
         return -1;
@@ -78,6 +78,26 @@ struct clixon_snmp_handle {
 };
 typedef struct clixon_snmp_handle clixon_snmp_handle;
 
+/* A cell, ie a column leaf of a row, in a polled table
+ */
+struct snmp_table_cell {
+    oid          *tc_oid;              /* Column OID + row index OID */
+    size_t        tc_oidlen;
+    cxobj        *tc_xcol;             /* Column leaf in ti_xt */
+};
+
+/* Polled table with its cells sorted by OID, used for getnext
+ * @see mibyang_table_poll
+ */
+struct snmp_table_index {
+    qelem_t       ti_q;                /* Queue of polled tables */
+    yang_stmt    *ti_ylist;            /* Yang list of table */
+    cxobj        *ti_xt;               /* Polled table tree, owns the cells' xml */
+    struct snmp_table_cell *ti_cells;  /* Cells sorted by OID */
+    size_t        ti_len;              /* Number of cells */
+    struct timeval ti_tv;              /* Time of poll */
+};
+
 /*
  * Prototypes
  */
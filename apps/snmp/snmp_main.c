@@ -117,6 +117,7 @@ snmp_terminate(clicon_handle h)
         xml_free(x);
         x = NULL;
     }
+    snmp_table_index_reset(h);
     clicon_rpc_close_session(h);
     if ((yspec = clicon_dbspec_yang(h)) != NULL)
         ys_free(yspec);
@@ -127,8 +128,10 @@ snmp_terminate(clicon_handle h)
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     xpath_optimize_exit();
+    xpath_cache_exit();
     clixon_event_exit();
     clicon_handle_exit(h);
+    clixon_intern_exit(); /* After all XML is freed */
     clixon_err_exit();
     clicon_log_exit();
     if (pidfile)
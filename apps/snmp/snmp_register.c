@@ -57,11 +57,14 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <pwd.h>
 #include <syslog.h>
 #include <errno.h>
 #include <sys/types.h>
+#include <sys/time.h>
 #include <signal.h>
 
 /* net-snmp */
@@ -445,38 +448,98 @@ mibyang_augment_register(clicon_handle h,
     return retval;
 }
 
-/*! Register table sub-oid:s of existing entries in clixon
+/*! Compare two table cells by OID, qsort callback
+ */
+static int
+snmp_table_cell_cmp(const void *arg0,
+                    const void *arg1)
+{
+    const struct snmp_table_cell *tc0 = (const struct snmp_table_cell *)arg0;
+    const struct snmp_table_cell *tc1 = (const struct snmp_table_cell *)arg1;
+
+    return oid_eq(tc0->tc_oid, tc0->tc_oidlen, tc1->tc_oid, tc1->tc_oidlen);
+}
+
+/*! Free a polled table index
+ * @param[in]  ti    Table index
+ */
+static int
+snmp_table_index_free(struct snmp_table_index *ti)
+{
+    size_t i;
+
+    if (ti->ti_cells){
+        for (i=0; i<ti->ti_len; i++)
+            if (ti->ti_cells[i].tc_oid)
+                free(ti->ti_cells[i].tc_oid);
+        free(ti->ti_cells);
+    }
+    if (ti->ti_xt)
+        xml_free(ti->ti_xt);
+    free(ti);
+    return 0;
+}
+
+/*! Find polled table index of a yang list
+ * @param[in]  tilist  Queue of polled tables
+ * @param[in]  ylist   Mib-Yang node (list)
+ * @retval     ti      Table index
+ * @retval     NULL    Not found
+ */
+static struct snmp_table_index *
+snmp_table_index_find(struct snmp_table_index *tilist,
+                      yang_stmt               *ylist)
+{
+    struct snmp_table_index *ti;
+
+    if ((ti = tilist) != NULL){
+        do {
+            if (ti->ti_ylist == ylist)
+                return ti;
+            ti = NEXTQ(struct snmp_table_index *, ti);
+        } while (ti && ti != tilist);
+    }
+    return NULL;
+}
+
+/*! Poll a table and index its cells sorted by OID
  * This assumes a table contains a set of keys and a list of leafs only
- * The function makes a query to the datastore and registers all table entries that
- * currently exists. This means it registers for a static table. If new rows or columns
- * are created or deleted this will not change the OID registration.
- * That is, the table registration is STATIC
+ * The function makes a query to the backend and builds an index of the OIDs of all table
+ * cells (column leafs of rows) that currently exist, sorted in SNMP walk order.
+ * The index replaces any earlier index of the same table and is kept in the handle so
+ * that getnext can be made with a binary search instead of a backend query.
  * @param[in]  h     Clixon handle
- * @param[in]  ys    Mib-Yang node (container)
  * @param[in]  ylist Mib-Yang node (list)
  * @retval     0     OK
  * @retval    -1     Error
+ * @see snmp_table_index_get  Get index, poll if not present or too old
  */
 int
 mibyang_table_poll(clicon_handle h,
                    yang_stmt    *ylist)
 {
-    int        retval = -1;
-    cvec      *nsc = NULL;
-    char      *xpath = NULL;
-    cxobj     *xt = NULL;
-    cxobj     *xerr;
-    cxobj     *xtable;
-    cxobj     *xrow;
-    cxobj     *xcol;
-    yang_stmt *y;
-    cvec      *cvk_name;
-    cvec      *cvk_val = NULL; /* vector of index keys: original index */
-    yang_stmt *ys;
-    int        ret;
-    oid        oidk[MAX_OID_LEN] = {0,};
-    size_t     oidklen = MAX_OID_LEN;
-    
+    int                      retval = -1;
+    cvec                    *nsc = NULL;
+    char                    *xpath = NULL;
+    cxobj                   *xt = NULL;
+    cxobj                   *xerr;
+    cxobj                   *xtable;
+    cxobj                   *xrow;
+    cxobj                   *xcol;
+    yang_stmt               *ycol;
+    cvec                    *cvk_name;
+    yang_stmt               *ys;
+    int                      ret;
+    oid                      oidc[MAX_OID_LEN] = {0,}; /* Column oid */
+    size_t                   oidclen;
+    oid                      oidk[MAX_OID_LEN] = {0,}; /* Key oid */
+    size_t                   oidklen;
+    struct snmp_table_index *tilist = NULL;
+    struct snmp_table_index *ti = NULL;
+    struct snmp_table_index *ti0;
+    struct snmp_table_cell  *tc;
+    size_t                   vlen = 0;
+
     clicon_debug(1, "%s", __FUNCTION__);
     if ((ys = yang_parent_get(ylist)) == NULL ||
         yang_keyword_get(ys) != Y_CONTAINER){
@@ -493,33 +556,81 @@ mibyang_table_poll(clicon_handle h,
         clixon_netconf_error(xerr, "clicon_rpc_get", NULL);
         goto done;
     }
+    if ((ti = malloc(sizeof(*ti))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(ti, 0, sizeof(*ti));
+    ti->ti_ylist = ylist;
+    gettimeofday(&ti->ti_tv, NULL);
     if ((xtable = xpath_first(xt, nsc, "%s", xpath)) != NULL) {
-        /* Make a clone of key-list, but replace names with values */
         if ((cvk_name = yang_cvec_get(ylist)) == NULL){
             clicon_err(OE_YANG, 0, "No keys");
             goto done;
         }
         xrow = NULL;
         while ((xrow = xml_child_each(xtable, xrow, CX_ELMNT)) != NULL) {
-            if ((ret = snmp_xmlkey2val_oid(xrow, cvk_name, &cvk_val, oidk, &oidklen)) < 0)
+            /* Get key part of OID from XML list entry */
+            oidklen = MAX_OID_LEN;
+            if ((ret = snmp_xmlkey2val_oid(xrow, cvk_name, NULL, oidk, &oidklen)) < 0)
                 goto done;
             if (ret == 0)
                 continue; /* skip row, not all indexes */
             xcol = NULL;
             while ((xcol = xml_child_each(xrow, xcol, CX_ELMNT)) != NULL) {
-                if ((y = xml_spec(xcol)) == NULL)
+                if ((ycol = xml_spec(xcol)) == NULL)
+                    continue;
+                if (yang_keyword_get(ycol) != Y_LEAF)
                     continue;
-                if (mibyang_leaf_register(h, y, cvk_val, oidk, oidklen) < 0) 
+                oidclen = MAX_OID_LEN;
+                if ((ret = yangext_oid_get(ycol, oidc, &oidclen, NULL)) < 0)
                     goto done;
-            }
-        }
+                if (ret == 0)
+                    continue;
+                /* Append key oid */
+                if (oid_append(oidc, &oidclen, oidk, oidklen) < 0)
+                    goto done;
+                if (ti->ti_len >= vlen){
+                    vlen = vlen ? 2*vlen : 64;
+                    if ((tc = realloc(ti->ti_cells, vlen*sizeof(*tc))) == NULL){
+                        clicon_err(OE_UNIX, errno, "realloc");
+                        goto done;
+                    }
+                    ti->ti_cells = tc;
+                }
+                tc = &ti->ti_cells[ti->ti_len];
+                if ((tc->tc_oid = malloc(oidclen*sizeof(*oidc))) == NULL){
+                    clicon_err(OE_UNIX, errno, "malloc");
+                    goto done;
+                }
+                memcpy(tc->tc_oid, oidc, oidclen*sizeof(*oidc));
+                tc->tc_oidlen = oidclen;
+                tc->tc_xcol = xcol;
+                ti->ti_len++;
+            } /* while xcol */
+        } /* while xrow */
+    }
+    if (ti->ti_len > 1)
+        qsort(ti->ti_cells, ti->ti_len, sizeof(*ti->ti_cells), snmp_table_cell_cmp);
+    /* The cells point into the polled tree */
+    ti->ti_xt = xt;
+    xt = NULL;
+    /* Replace earlier index of same table */
+    clicon_ptr_get(h, "snmp-table-index", (void**)&tilist);
+    if ((ti0 = snmp_table_index_find(tilist, ylist)) != NULL){
+        DELQ(ti0, tilist, struct snmp_table_index *);
+        snmp_table_index_free(ti0);
     }
+    ADDQ(ti, tilist);
+    clicon_ptr_set(h, "snmp-table-index", tilist);
+    clicon_debug(1, "%s %s: %zu cells", __FUNCTION__, yang_argument_get(ylist), ti->ti_len);
+    ti = NULL;
     retval = 0;
  done:
+    if (ti)
+        snmp_table_index_free(ti);
     if (xpath)
         free(xpath);
-    if (cvk_val)
-        cvec_free(cvk_val);
     if (xt)
         xml_free(xt);
     if (nsc)
@@ -527,6 +638,68 @@ mibyang_table_poll(clicon_handle h,
     return retval;
 }
 
+/*! Get polled table index, poll table if not polled or if poll is too old
+ * @param[in]  h     Clixon handle
+ * @param[in]  ylist Mib-Yang node (list)
+ * @param[out] tip   Table index, valid until next poll or reset
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see SNMP_TABLE_POLL_TTL
+ */
+int
+snmp_table_index_get(clicon_handle             h,
+                     yang_stmt                *ylist,
+                     struct snmp_table_index **tip)
+{
+    int                      retval = -1;
+    struct snmp_table_index *tilist = NULL;
+    struct snmp_table_index *ti;
+    struct timeval           now;
+    struct timeval           td;
+
+    clicon_ptr_get(h, "snmp-table-index", (void**)&tilist);
+    if ((ti = snmp_table_index_find(tilist, ylist)) != NULL){
+        gettimeofday(&now, NULL);
+        timersub(&now, &ti->ti_tv, &td);
+        if (td.tv_sec < SNMP_TABLE_POLL_TTL)
+            goto ok;
+    }
+    if (mibyang_table_poll(h, ylist) < 0)
+        goto done;
+    tilist = NULL;
+    clicon_ptr_get(h, "snmp-table-index", (void**)&tilist);
+    if ((ti = snmp_table_index_find(tilist, ylist)) == NULL){
+        clicon_err(OE_SNMP, 0, "Table %s not polled", yang_argument_get(ylist));
+        goto done;
+    }
+ ok:
+    *tip = ti;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Remove all polled table indexes, eg after a commit has changed the tables
+ * @param[in]  h     Clixon handle
+ * @retval     0     OK
+ */
+int
+snmp_table_index_reset(clicon_handle h)
+{
+    struct snmp_table_index *tilist = NULL;
+    struct snmp_table_index *ti;
+
+    if (clicon_ptr_get(h, "snmp-table-index", (void**)&tilist) < 0 ||
+        tilist == NULL)
+        return 0;
+    while ((ti = tilist) != NULL){
+        DELQ(ti, tilist, struct snmp_table_index *);
+        snmp_table_index_free(ti);
+    }
+    clicon_ptr_del(h, "snmp-table-index");
+    return 0;
+}
+
 /*! Traverse mib-yang tree, identify scalars and tables, register OID and callbacks
  *
  * The tree is traversed depth-first, which at least guarantees that a parent is
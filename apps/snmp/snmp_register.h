@@ -45,6 +45,8 @@ extern "C" {
  * Prototypes
  */
 int mibyang_table_poll(clicon_handle h, yang_stmt *ylist);
+int snmp_table_index_get(clicon_handle h, yang_stmt *ylist, struct snmp_table_index **tip);
+int snmp_table_index_reset(clicon_handle h);
 int clixon_snmp_traverse_mibyangs(clicon_handle h);
 
 #endif /* _SNMP_REGISTER_H_ */
@@ -41,6 +41,7 @@
   *  -s  enable the state function
   *  -S <file>  read state data from file, otherwise construct it programmatically (requires -s)
   *  -i  read state file on init not by request for optimization (requires -sS <file>)
+  *  -N <ns> register namespace of state file data and log state callback calls (requires -sS <file>)
   *  -u  enable upgrade function - auto-upgrade testing
   *  -U  general-purpose upgrade
   *  -t  enable transaction logging (call syslog for every transaction)
@@ -68,7 +69,7 @@
 #include <clixon/clixon_backend.h> 
 
 /* Command line options to be passed to getopt(3) */
-#define BACKEND_EXAMPLE_OPTS "a:nrsS:x:iuUtV:"
+#define BACKEND_EXAMPLE_OPTS "a:nrsS:x:iN:uUtV:"
 
 /* Enabling this improves performance in tests, but there may trigger the "double XPath"
  * problem.
@@ -121,6 +122,14 @@ static char *_state_xpath = NULL;
  */
 static int _state_file_cached = 0;
 
+/*! Namespace of state file data, registered for the state file callback
+ * Calls of the state file callback are logged, for testing that it is only called for a
+ * matching xpath
+ * Start backend with -- -sS <file> -N <namespace>
+ * @see clixon_statedata_ns_register
+ */
+static char *_state_ns = NULL;
+
 /*! Cache control of read state file pagination example,
  * keep xml tree cache as long as db is locked
  */
@@ -542,6 +551,8 @@ example_statefile(clicon_handle     h,
     /* If -S is set, then read state data from file */
     if (!_state || !_state_file)
         goto ok;
+    if (_state_ns)
+        clicon_log(LOG_NOTICE, "%s", __FUNCTION__);
     yspec = clicon_dbspec_yang(h);
     /* Read state file if either not cached, or the cache is NULL */
     if (_state_file_cached == 0 ||
@@ -1424,6 +1435,9 @@ clixon_plugin_init(clicon_handle h)
         case 'i': /* read state file on init not by request (requires -sS <file> */
             _state_file_cached = 1;
             break;
+        case 'N': /* state file namespace (requires -sS <file>) */
+            _state_ns = optarg;
+            break;
        case 'u': /* module-specific upgrade */
            _module_upgrade = 1;
            break;
@@ -1448,6 +1462,19 @@ clixon_plugin_init(clicon_handle h)
                                               NULL) < 0)
                 goto done;
         }
+        if (_state_ns &&
+            clixon_statedata_ns_register(h, example_statefile, _state_ns) < 0)
+            goto done;
+    }
+    else if (_state){
+        /* Namespaces of top-level nodes returned by example_statedata */
+        if (clixon_statedata_ns_register(h, example_statedata,
+                                         "urn:ietf:params:xml:ns:yang:ietf-interfaces") < 0)
+            goto done;
+        if (clixon_statedata_ns_register(h, example_statedata, "urn:example:clixon") < 0)
+            goto done;
+        if (clixon_statedata_ns_register(h, example_statedata, "urn:example:events") < 0)
+            goto done;
     }
         
     if (_notification_stream){
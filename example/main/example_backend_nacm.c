@@ -39,6 +39,7 @@
  * - transaction test
  *  -t  enable transaction logging (call syslog for every transaction)
  *  -v <xpath> Failing validate and commit if <xpath> is present (synthetic error)
+ *  -m  register the namespace of nacm state data and log state callback calls
  */
 #include <stdio.h>
 #include <stdlib.h>
@@ -59,7 +60,7 @@
 #include <clixon/clixon_backend.h> 
 
 /* Command line options to be passed to getopt(3) */
-#define BACKEND_NACM_OPTS "tv:"
+#define BACKEND_NACM_OPTS "tv:m"
 
 /*! Variable to control transaction logging (for debug)
  * If set, call syslog for every transaction callback
@@ -80,6 +81,13 @@ static char *_validate_fail_xpath = NULL;
  */
 static int   _validate_fail_toggle = 0; /* fail at validate and commit */
 
+/*! Register the namespace of nacm state data, and log calls of the state callback
+ * For testing that the state callback is only called for a matching xpath
+ * Start backend with -- -m
+ * @see clixon_statedata_ns_register
+ */
+static int _state_ns = 0;
+
 int
 nacm_begin(clicon_handle    h, 
            transaction_data td)
@@ -191,6 +199,8 @@ nacm_statedata(clicon_handle h,
     int     retval = -1;
     cxobj **xvec = NULL;
 
+    if (_state_ns)
+        clicon_log(LOG_NOTICE, "%s", __FUNCTION__);
     /* Example of (static) statedata, real code would poll state */
     if (clixon_xml_parse_string("<nacm xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-acm\">"
                                 "<denied-data-writes>0</denied-data-writes>"
@@ -250,13 +260,20 @@ clixon_plugin_init(clicon_handle h)
         case 'v': /* validate fail */
             _validate_fail_xpath = optarg;
             break;
+        case 'm': /* state namespace */
+            _state_ns = 1;
+            break;
         }
+    if (_state_ns &&
+        clixon_statedata_ns_register(h, nacm_statedata,
+                                     "urn:ietf:params:xml:ns:yang:ietf-netconf-acm") < 0)
+        goto done;
 
     nacm_mode = clicon_option_str(h, "CLICON_NACM_MODE");
     if (nacm_mode==NULL || strcmp(nacm_mode, "disabled") == 0){
         clicon_log(LOG_DEBUG, "%s CLICON_NACM_MODE not enabled: example nacm module disabled", __FUNCTION__);
-        /* Skip nacm module if not enabled _unless_ we use transaction tests */
-        if (_transaction_log == 0) 
+        /* Skip nacm module if not enabled _unless_ we use transaction or state tests */
+        if (_transaction_log == 0 && _state_ns == 0)
             return NULL;
     }
     /* Return plugin API */
@@ -67,11 +67,27 @@
  */
 #define XPATH_LIST_OPTIMIZE
 
+/*! Size of XPath parse-tree LRU cache, number of cached xpath strings
+ * Parsed xpaths are cached and reused by xpath_vec_ctx and its callers (xpath_first,
+ * xpath_vec, etc). Set to 0 to disable the cache.
+ * @see xpath_parse_cached
+ */
+#define XPATH_CACHE_SIZE 1024
+
+/*! Minimum number of children of a yang statement for it to get a name index
+ * The index maps child arguments to statements, including data nodes under choice/case
+ * and input/output, and is used by yang_find and yang_find_datanode instead of a linear
+ * scan. It is built when a yang spec is loaded. Set to 0 to disable.
+ * @see yang_index_build
+ */
+#define YANG_INDEX_MIN 16
+
 /*! Add explicit search indexes, so that binary search can be made for non-key list indexes
  * This also applies if there are multiple keys and you want to search on only the second for 
  * example.
- * There may be some cases where the index vector is not updated, need to verify before 
- * enabling this completely.
+ * Declare an index leaf with the clixon-config search_index extension. The index vectors are
+ * updated when list elements or index leafs are added, removed, copied or modified, and used
+ * by instance-id and xpath predicates on the index leaf, eg x[i='42']
  */
 #define XML_EXPLICIT_INDEX
 
@@ -202,6 +218,35 @@
  */
 #define AUTOCLI_DEPRECATED_HIDE
 
+/*! Number of seconds a polled SNMP table is used by getnext before it is polled again
+ * clixon_snmp keeps each table sorted by OID so that a walk is served by binary search
+ * instead of fetching the table from the backend for every getnext.
+ * A successful SNMP set commit also drops all polled tables.
+ * Set to 0 to poll the table on every getnext.
+ * @see mibyang_table_poll
+ */
+#define SNMP_TABLE_POLL_TTL 5
+
+/*! Size in bytes of arena chunks of XML nodes, must be a power of 2
+ * Transient trees, such as parsed internal messages, allocate their nodes, child vectors and
+ * values in chunks of this size. The chunks are freed when the tree is freed.
+ * @see xml_arena_push
+ */
+#define XML_ARENA_CHUNK_SIZE 16384
+
+/*! Size in bytes of each chunk when the backend writes a get reply to a client
+ * The reply data is printed and written to the client socket in chunks of this size instead
+ * of being printed to one buffer, so memory for a large reply is bounded by the chunk size.
+ * @see send_msg_reply_xml
+ */
+#define BACKEND_REPLY_CHUNK_SIZE 65536
+
+/*! Size in bytes of each chunk when the netconf client writes an rpc-reply to its peer
+ * With chunked framing (RFC 6242) each such chunk is one netconf chunk.
+ * @see netconf_output_xml
+ */
+#define NETCONF_REPLY_CHUNK_SIZE 65536
+
 /*! Temporar fix for xpath_traverse_canonical for yang schema mount
  * Must rewrite function to handle mountpoints, now just ignore errors
  * See also 
@@ -57,6 +57,7 @@ typedef struct {
     cxobj    *de_xml;      /* cache */
     int       de_modified; /* Dirty since loaded/copied/committed/etc XXX:nocache? */
     int       de_empty;    /* Empty on read from file, xmldb_readfile and xmldb_put sets it */
+    int       de_dirty;    /* Cache is running with edits marked XML_FLAG_DIRTY, see xml_diff_dirty */
 } db_elmnt;
 
 /*
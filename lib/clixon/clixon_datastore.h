@@ -71,6 +71,9 @@ int xmldb_create(clicon_handle h, const char *db);
 int xmldb_db_reset(clicon_handle h, const char *db);
 
 cxobj *xmldb_cache_get(clicon_handle h, const char *db);
+int xmldb_cache_unshare(clicon_handle h, const char *db);
+int xmldb_dirty_get(clicon_handle h, const char *db);
+int xmldb_dirty_reset(clicon_handle h);
 
 int xmldb_modified_get(clicon_handle h, const char *db);
 int xmldb_modified_set(clicon_handle h, const char *db, int value);
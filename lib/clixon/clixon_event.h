@@ -40,6 +40,12 @@
 #ifndef _CLIXON_EVENT_H_
 #define _CLIXON_EVENT_H_
 
+/*
+ * Constants
+ */
+/* Flags to clixon_event_reg_fd_flags */
+#define CLIXON_EVENT_EDGE 0x01 /* Edge-triggered: callback must read until EAGAIN */
+
 /*
  * Prototypes
  */
@@ -57,6 +63,8 @@ int clicon_sig_ignore_get(void);
 
 int clixon_event_reg_fd(int fd, int (*fn)(int, void*), void *arg, char *str);
 
+int clixon_event_reg_fd_flags(int fd, int (*fn)(int, void*), void *arg, char *str, int flags);
+
 int clixon_event_unreg_fd(int s, int (*fn)(int, void*));
 
 int clixon_event_reg_timeout(struct timeval t,  int (*fn)(int, void*), 
@@ -39,7 +39,7 @@
 #define _CLIXON_HASH_H_
 
 struct clicon_hash {
-    qelem_t     h_qelem;
+    qelem_t     h_qelem;   /* List of all entries in insertion order */
     char       *h_key;
     size_t      h_vlen;
     void       *h_val;
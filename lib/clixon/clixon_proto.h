@@ -51,6 +51,9 @@ struct clicon_msg {
     char        op_body[0]; /* rest of message, actual data */
 };
 
+/* Per-connection receive buffer, opaque, see clicon_msg_rcv_buf */
+typedef struct clicon_msg_rbuf clicon_msg_rbuf;
+
 /*
  * Prototypes
  */ 
@@ -84,10 +87,22 @@ int clicon_msg_rcv(int s, int intr, struct clicon_msg **msg, int *eof);
 
 int clicon_msg_rcv1(int s, cbuf *cb, int *eof);
 
+clicon_msg_rbuf *clicon_msg_rbuf_new(void);
+
+int clicon_msg_rbuf_free(clicon_msg_rbuf *rb);
+
+int clicon_msg_rcv_buf(int s, clicon_msg_rbuf *rb, int *eof);
+
+int clicon_msg_rcv_next(clicon_msg_rbuf *rb, struct clicon_msg **msg, int *eof);
+
+int send_msg_notify(int s, char *event);
+
 int send_msg_notify_xml(clicon_handle h, int s, cxobj *xev);
 
 int send_msg_reply(int s, char *data, uint32_t datalen);
 
+int send_msg_reply_xml(int s, char *pre, cxobj *xn, int32_t depth, char *post);
+
 int detect_endtag(char *tag, char  ch, int  *state);
 
 int clixon_inet2sin(const char *addrtype, const char *addrstr, uint16_t port, struct sockaddr *sa, size_t *sa_len);
@@ -42,11 +42,42 @@
 #ifndef _CLIXON_PROTO_CLIENT_H_
 #define _CLIXON_PROTO_CLIENT_H_
 
+/*
+ * Types
+ */
+/*! Callback for reply to asynchronous rpc
+ * @param[in]  h      Clixon handle
+ * @param[in]  reqid  Request id
+ * @param[in]  xret   Reply as XML tree, or NULL if backend closed socket (clicon_err set)
+ * @param[in]  arg    Argument given when sending request
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+typedef int (clicon_rpc_async_cb)(clicon_handle h, uint32_t reqid, cxobj *xret, void *arg);
+
+/*! Callback for unparsed reply to asynchronous rpc
+ * @param[in]  h      Clixon handle
+ * @param[in]  reqid  Request id
+ * @param[in]  data   Reply as string, or NULL if backend closed socket (clicon_err set)
+ * @param[in]  arg    Argument given when sending request
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+typedef int (clicon_rpc_async_data_cb)(clicon_handle h, uint32_t reqid, char *data, void *arg);
+
+/*
+ * Prototypes
+ */
 int clicon_rpc_connect(clicon_handle h, int *sock0);
 int clicon_rpc_msg(clicon_handle h, struct clicon_msg *msg, cxobj **xret0);
 int clicon_rpc_msg_persistent(clicon_handle h, struct clicon_msg *msg, cxobj **xret0, int *sock0);
 int clicon_rpc_netconf(clicon_handle h, char *xmlst, cxobj **xret, int *sp);
 int clicon_rpc_netconf_xml(clicon_handle h, cxobj *xml, cxobj **xret, int *sp);
+int clicon_rpc_msg_async(clicon_handle h, struct clicon_msg *msg, clicon_rpc_async_cb *fn, void *arg, uint32_t *reqid);
+int clicon_rpc_netconf_xml_async(clicon_handle h, cxobj *xml, clicon_rpc_async_cb *fn, void *arg, uint32_t *reqid);
+int clicon_rpc_async_cancel(clicon_handle h, uint32_t reqid);
+int clicon_rpc_async_pending(clicon_handle h);
+int clicon_rpc_async_wait(clicon_handle h);
 int clicon_rpc_get_config(clicon_handle h, char *username, char *db, char *xpath, cvec *nsc, char *defaults, cxobj **xret);
 int clicon_rpc_edit_config(clicon_handle h, char *db, enum operation_type op, 
                            char *xml);
@@ -55,6 +86,9 @@ int clicon_rpc_delete_config(clicon_handle h, char *db);
 int clicon_rpc_lock(clicon_handle h, char *db);
 int clicon_rpc_unlock(clicon_handle h, char *db);
 int clicon_rpc_get(clicon_handle h, char *xpath, cvec *nsc, netconf_content content, int32_t depth, char *defaults, cxobj **xret);
+int clicon_rpc_get_format(clicon_handle h, char *xpath, cvec *nsc, netconf_content content, int32_t depth, char *defaults, enum format_enum format, int pretty, cbuf *cbdata, cxobj **xerr);
+int clicon_rpc_get_format_async(clicon_handle h, char *xpath, cvec *nsc, netconf_content content, int32_t depth, char *defaults, enum format_enum format, int pretty, clicon_rpc_async_data_cb *fn, void *arg, uint32_t *reqid);
+int clicon_rpc_get_format_reply(char *data, cbuf *cbdata, cxobj **xerr);
 int clicon_rpc_get_pageable_list(clicon_handle h, char *datastore, char *xpath, 
                                  cvec *nsc, netconf_content content, int32_t depth, char *defaults,
                                  uint32_t offset, uint32_t limit,
@@ -54,6 +54,14 @@
  */
 typedef int (*stream_fn_t)(clicon_handle h, int op, cxobj *event, void *arg);
 
+/* Subscription callback with serialized event, used by replay
+ * @param[in]  h     Clicon handle
+ * @param[in]  event Event as XML string
+ * @param[in]  arg   Extra argument provided in stream_ss_add
+ * @see stream_fn_t
+ */
+typedef int (*stream_str_fn_t)(clicon_handle h, char *event, void *arg);
+
 struct stream_subscription{
     qelem_t                     ss_q;   /* queue header */
     char                       *ss_stream; /* Name of associated stream */
@@ -62,13 +70,26 @@ struct stream_subscription{
     struct timeval              ss_stoptime; /* Replay stoptime */
     stream_fn_t                 ss_fn;     /* Callback when event occurs */
     void                       *ss_arg;    /* Callback argument */
+    stream_str_fn_t             ss_strfn;  /* Optional callback for replayed events */
+};
+
+/* Sparse time index entry of a replay segment */
+struct stream_replay_index{
+    struct timeval ri_tv;  /* Timestamp of event */
+    off_t          ri_off; /* File offset of event record */
 };
 
-/* Replay time-series */
+/* Replay time-series: a segment file of serialized events */
 struct stream_replay{
-    qelem_t        r_q;   /* queue header */
-    struct timeval r_tv;  /* time index */
-    cxobj         *r_xml; /* event in xml form */
+    qelem_t        r_q;     /* queue header */
+    uint32_t       r_nr;    /* Segment sequence number, part of file name */
+    int            r_fd;    /* Open segment file */
+    off_t          r_size;  /* Size of segment file */
+    uint32_t       r_count; /* Number of events in segment */
+    struct timeval r_first; /* Timestamp of first event */
+    struct timeval r_last;  /* Timestamp of last event */
+    struct stream_replay_index *r_index; /* Sparse time index */
+    size_t         r_ilen;  /* Length of time index */
 };
 
 /* See RFC8040 9.3, stream list, no replay support for now
@@ -80,7 +101,10 @@ struct event_stream{
     struct stream_subscription *es_subscription;
     int                  es_replay_enabled; /* set if replay is enables */
     struct timeval       es_retention; /* replay retention - how much to save */
-    struct stream_replay *es_replay;
+    struct stream_replay *es_replay; /* Replay segments, oldest first */
+    char                *es_replay_dir; /* Directory of replay segments, or NULL */
+    size_t               es_replay_maxsize; /* Max size of replay segments, 0: no limit */
+    size_t               es_replay_size; /* Size of replay segments */
 
 };
 typedef struct event_stream event_stream_t;
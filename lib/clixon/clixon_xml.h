@@ -175,6 +175,18 @@ typedef struct xml cxobj; /* struct defined in clicon_xml.c */
  */
 typedef int (xml_applyfn_t)(cxobj *x, void *arg);
 
+/*! Callback function type for streaming xml parsing, see clixon_xml_parse_fd
+ *
+ * Called when an element start-tag (including attributes) has been parsed, and
+ * when the whole element including its children has been parsed
+ * @param[in]  x    XML node  
+ * @param[in]  end  0: start-tag parsed, 1: element complete
+ * @param[in]  arg  General-purpose argument
+ * @retval    -1    Error, parsing is aborted
+ * @retval     0    OK, continue
+ */
+typedef int (xml_parsefn_t)(cxobj *x, int end, void *arg);
+
 typedef struct clixon_xml_vec clixon_xvec; /* struct defined in clicon_xml_vec.c */
 
 /* Alternative formats */
@@ -199,6 +211,10 @@ enum format_enum{
 #define XML_FLAG_DEFAULT   0x40 /* Added when a value is set as default @see xml_default */
 #define XML_FLAG_TOP       0x80 /* Top datastore symbol */
 #define XML_FLAG_BODYKEY  0x100 /* Text parsing key to be translated from body to key */
+#define XML_FLAG_DIRTY   0x200 /* Datastore node or descendant edited since copied from running
+                                 * @see xml_diff_dirty */
+#define XML_FLAG_DIRTYRM 0x400 /* Datastore node children removed or re-ordered since copied
+                                 * from running */
 
 /*
  * Prototypes
@@ -244,6 +260,8 @@ int       xml_child_insert_pos(cxobj *x, cxobj *xc, int i);
 int       xml_childvec_set(cxobj *x, int len);
 cxobj   **xml_childvec_get(cxobj *x);
 int       clixon_child_xvec_append(cxobj *x, clixon_xvec *xv);
+int       xml_arena_push(void);
+int       xml_arena_pop(void);
 cxobj    *xml_new(char *name, cxobj *xn_parent, enum cxobj_type type);
 cxobj    *xml_new_body(char *name, cxobj *parent, char *val);
 yang_stmt *xml_spec(cxobj *x);
@@ -301,6 +319,7 @@ int       xml_search_index_p(cxobj *x);
 int       xml_search_vector_get(cxobj *x, char *name, clixon_xvec **xvec);
 int       xml_search_child_insert(cxobj *xp, cxobj *x);
 int       xml_search_child_rm(cxobj *xp, cxobj *x);
+int       xml_search_list_update(cxobj *xc, int insert);
 cxobj    *xml_child_index_each(cxobj *xparent, char *name, cxobj *xprev, enum cxobj_type type);
 
 #endif
@@ -40,6 +40,18 @@
 #ifndef _CLIXON_XML_IO_H_
 #define _CLIXON_XML_IO_H_
 
+/*
+ * Types
+ */
+/*! Callback for chunked XML output, see clixon_xml2chunks
+ * @param[in]  buf   Chunk of XML text, not NULL-terminated
+ * @param[in]  len   Length of chunk
+ * @param[in]  arg   User argument
+ * @retval     0     OK
+ * @retval    -1     Error, stop printing
+ */
+typedef int (clixon_xml_chunk_cb)(char *buf, size_t len, void *arg);
+
 /*
  * Prototypes
  */
@@ -47,8 +59,10 @@ int   clixon_xml2file(FILE *f, cxobj *xn, int level, int pretty, clicon_output_c
 int   xml_print(FILE *f, cxobj *xn);
 int   xml_dump(FILE  *f, cxobj *x);
 int   clixon_xml2cbuf(cbuf *cb, cxobj *x, int level, int prettyprint, int32_t depth, int skiptop);
+int   clixon_xml2chunks(cxobj *xn, int level, int pretty, int32_t depth, int skiptop, size_t chunklen, clixon_xml_chunk_cb *fn, void *arg);
 int   xmltree2cbuf(cbuf *cb, cxobj *x, int level);
 int   clixon_xml_parse_file(FILE *f, yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xerr);
+int   clixon_xml_parse_fd(int fd, xml_parsefn_t *fn, void *arg, cxobj **xt);
 int   clixon_xml_parse_string(const char *str, yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xerr);
 int   clixon_xml_parse_va(yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xerr, 
                         const char *format, ...)  __attribute__ ((format (printf, 5, 6)));
@@ -134,6 +134,10 @@ xpath_tree *xpath_tree_traverse(xpath_tree *xt, ...);
 int   xpath_tree_free(xpath_tree *xs);
 int   xpath_parse(const char *xpath, xpath_tree **xptree);
 int   xpath_vec_ctx(cxobj *xcur, cvec *nsc, const char *xpath, int localonly, xp_ctx  **xrp);
+int   xpath_tree_vec_ctx(cxobj *xcur, cvec *nsc, xpath_tree *xptree, int localonly, xp_ctx  **xrp);
+int   xpath_tree_vec_bool(cxobj *xcur, cvec *nsc, xpath_tree *xptree);
+int   xpath_cache_stats(uint64_t *nr, uint64_t *hits, uint64_t *misses);
+void  xpath_cache_exit(void);
 
 int    xpath_vec_bool(cxobj *xcur, cvec *nsc, const char *xpformat, ...) __attribute__ ((format (printf, 3, 4)));
 int    xpath_vec_flag(cxobj *xcur, cvec *nsc, const char *xpformat, uint16_t flags, 
@@ -150,6 +154,7 @@ int    xpath_vec(cxobj *xcur, cvec *nsc, const char *xpformat, cxobj ***vec, siz
 
 int xpath2canonical(const char *xpath0, cvec *nsc0, yang_stmt *yspec, char **xpath1, cvec **nsc1, cbuf **cbreason);
 int xpath_count(cxobj *xcur, cvec *nsc, const char *xpath, uint32_t *count);
+int xpath_top_namespaces(const char *xpath, cvec *nsc, cvec **nsvp);
 int xml2xpath(cxobj *x, cvec *nsc, int spec, int apostrophe, char **xpath);
 int xpath2xml(char *xpath, cvec *nsc, cxobj *xtop, yang_stmt *ytop,
               cxobj **xbotp, yang_stmt **ybotp, cxobj **xerr);
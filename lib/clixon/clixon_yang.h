@@ -60,6 +60,7 @@
 #ifdef XML_EXPLICIT_INDEX
 #define YANG_FLAG_INDEX 0x08  /* This yang node under list is (extra) index. --> you can access
                                * list elements using this index with binary search */
+#define YANG_FLAG_INDEX_LIST 0x80 /* This yang list has (extra) index leafs with YANG_FLAG_INDEX */
 #endif
 #ifdef USE_CONFIG_FLAG_CACHE
 #define YANG_FLAG_CONFIG_CACHE 0x10  /* Ancestor config cache is active */
@@ -167,6 +168,7 @@ enum yang_class{
 typedef enum yang_class yang_class;
 
 struct xml;
+struct xpath_tree;
 
 /* This is the external handle type exposed in the API.
  * The internal struct is defined in clixon_yang_internal.h */
@@ -228,6 +230,9 @@ char      *yang_when_xpath_get(yang_stmt *ys);
 int        yang_when_xpath_set(yang_stmt *ys, char *xpath);
 cvec      *yang_when_nsc_get(yang_stmt *ys);
 int        yang_when_nsc_set(yang_stmt *ys, cvec *nsc);
+struct xpath_tree *yang_xpath_tree_get(yang_stmt *ys);
+struct xpath_tree *yang_when_xpath_tree_get(yang_stmt *ys);
+cvec      *yang_xpath_nsc_get(yang_stmt *ys);
 const char *yang_filename_get(yang_stmt *ys);
 int        yang_filename_set(yang_stmt *ys, const char *filename);
 int        yang_linenum_get(yang_stmt *ys);
@@ -255,6 +260,8 @@ int        ys_module_by_xml(yang_stmt *ysp, struct xml *xt, yang_stmt **ymodp);
 yang_stmt *ys_module(yang_stmt *ys);
 int        ys_real_module(yang_stmt *ys, yang_stmt **ymod);
 yang_stmt *ys_spec(yang_stmt *ys);
+int        yang_index_build(yang_stmt *ys);
+int        yang_index_clear(yang_stmt *ys);
 yang_stmt *yang_find(yang_stmt *yn, int keyword, const char *argument);
 int        yang_match(yang_stmt *yn, int keyword, char *argument);
 yang_stmt *yang_find_datanode(yang_stmt *yn, char *argument);
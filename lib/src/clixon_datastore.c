@@ -76,9 +76,12 @@
 #include "clixon_options.h"
 #include "clixon_data.h"
 #include "clixon_netconf_lib.h"
+#include "clixon_xml_map.h"
+#include "clixon_nacm.h"
 #include "clixon_datastore.h"
 #include "clixon_datastore_write.h"
 #include "clixon_datastore_read.h"
+#include "clixon_datastore_journal.h"
 
 
 /*! Translate from symbolic database name to actual filename in file-system
@@ -149,6 +152,65 @@ xmldb_connect(clicon_handle h)
     return 0;
 }
 
+/*! Count how many datastore caches refer to an XML tree
+ *
+ * Datastore caches are shared copy-on-write after xmldb_copy
+ * @param[in]  h    Clicon handle
+ * @param[in]  xt   XML cache tree
+ * @retval     n    Number of datastores whose cache is xt
+ * @retval    -1    Error
+ */
+static int
+xmldb_cache_refs(clicon_handle h,
+                 cxobj        *xt)
+{
+    int       retval = -1;
+    char    **keys = NULL;
+    size_t    klen;
+    int       i;
+    db_elmnt *de;
+    int       n = 0;
+
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
+        goto done;
+    for (i = 0; i < klen; i++)
+        if ((de = clicon_hash_value(clicon_db_elmnt(h), keys[i], NULL)) != NULL &&
+            de->de_xml == xt)
+            n++;
+    retval = n;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Remove the XML cache of a datastore, free it unless shared with another datastore
+ *
+ * @param[in]  h    Clicon handle
+ * @param[in]  de   Datastore element
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xmldb_cache_release(clicon_handle h,
+                    db_elmnt     *de)
+{
+    int    retval = -1;
+    cxobj *xt;
+    int    ret;
+
+    if ((xt = de->de_xml) != NULL){
+        de->de_xml = NULL;
+        if ((ret = xmldb_cache_refs(h, xt)) < 0)
+            goto done;
+        if (ret == 0)
+            xml_free(xt);
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Disconnect from a datastore plugin and deallocate resources
  * @param[in]  handle  Disconect and deallocate from this handle
  * @retval     0       OK
@@ -167,10 +229,8 @@ xmldb_disconnect(clicon_handle h)
         goto done;
     for(i = 0; i < klen; i++) 
         if ((de = clicon_hash_value(clicon_db_elmnt(h), keys[i], NULL)) != NULL){
-            if (de->de_xml){
-                xml_free(de->de_xml);
-                de->de_xml = NULL;
-            }
+            if (xmldb_cache_release(h, de) < 0)
+                goto done;
         }
     retval = 0;
  done:
@@ -198,55 +258,60 @@ xmldb_copy(clicon_handle h,
     db_elmnt           *de2 = NULL; /* to */
     db_elmnt            de0 = {0,};
     cxobj              *x1 = NULL;  /* from */
-    cxobj              *x2 = NULL;  /* to */
 
     clicon_debug(1, "%s %s %s", __FUNCTION__, from, to);
     /* XXX lock */
     if (clicon_datastore_cache(h) != DATASTORE_NOCACHE){
-        /* Copy in-memory cache */
-        /* 1. "to" xml tree in x1 */
+        /* Share in-memory cache, copy-on-write, see xmldb_cache_unshare */
         if ((de1 = clicon_db_elmnt_get(h, from)) != NULL)
             x1 = de1->de_xml;
-        if ((de2 = clicon_db_elmnt_get(h, to)) != NULL)
-            x2 = de2->de_xml;
-        if (x1 == NULL && x2 == NULL){
-            /* do nothing */
-        }
-        else if (x1 == NULL){  /* free x2 and set to NULL */
-            xml_free(x2);
-            x2 = NULL;
-        }
-        else  if (x2 == NULL){ /* create x2 and copy from x1 */
-            if ((x2 = xml_new(xml_name(x1), NULL, CX_ELMNT)) == NULL)
+        if (strcmp(to, "running") == 0){
+            /* Compiled NACM policies are kept unless the NACM config changes */
+            de2 = clicon_db_elmnt_get(h, to);
+            if (nacm_policy_changed(de2 ? de2->de_xml : NULL, x1, de1 && de1->de_dirty) < 0)
                 goto done;
-            xml_flag_set(x2, XML_FLAG_TOP);
-            if (xml_copy(x1, x2) < 0) 
+            /* Edits marked in other datastores are relative to the old running */
+            if (xmldb_dirty_reset(h) < 0)
                 goto done;
         }
-        else{ /* copy x1 to x2 */
-            xml_free(x2);
-            if ((x2 = xml_new(xml_name(x1), NULL, CX_ELMNT)) == NULL)
-                goto done;
-            xml_flag_set(x2, XML_FLAG_TOP);
-            if (xml_copy(x1, x2) < 0) 
+        if ((de2 = clicon_db_elmnt_get(h, to)) != NULL &&
+            de2->de_xml != x1){
+            /* Release old "to" tree, unless shared with other datastore */
+            if (xmldb_cache_release(h, de2) < 0)
                 goto done;
         }
-        /* always set cache although not strictly necessary in case 1
-         * above, but logic gets complicated due to differences with
+        /* always set cache although not strictly necessary if both are NULL,
+         * but logic gets complicated due to differences with
          * de and de->de_xml */
         if (de2)
             de0 = *de2;
-        de0.de_xml = x2; /* The new tree */
+        de0.de_xml = x1; /* The shared tree */
+        /* Track edits from here on, see xmldb_dirty_get */
+        if (strcmp(from, "running") == 0 || strcmp(to, "running") == 0){
+            if (x1)
+                xml_dirty_clear(x1);
+            if (de1 && strcmp(to, "running") == 0)
+                de1->de_dirty = 1;
+            de0.de_dirty = 1;
+        }
+        else
+            de0.de_dirty = de1 ? de1->de_dirty : 0;
     }
+    else if (strcmp(to, "running") == 0)
+        nacm_policy_invalidate();
     clicon_db_elmnt_set(h, to, &de0);
 
     /* Copy the files themselves (above only in-memory cache) */
+    if (xmldb_journal_flush(h, from) < 0)
+        goto done;
     if (xmldb_db2file(h, from, &fromfile) < 0)
         goto done;
     if (xmldb_db2file(h, to, &tofile) < 0)
         goto done;
     if (clicon_file_copy(fromfile, tofile) < 0)
         goto done;
+    if (xmldb_journal_reset(tofile) < 0)
+        goto done;
     retval = 0;
  done:
     if (fromfile)
@@ -389,6 +454,7 @@ xmldb_exists(clicon_handle h,
     int                 retval = -1;
     char               *filename = NULL;
     struct stat         sb;
+    size_t              jlen;
 
     clicon_debug(CLIXON_DBG_DETAIL, "%s %s", __FUNCTION__, db);
     if (xmldb_db2file(h, db, &filename) < 0)
@@ -397,8 +463,12 @@ xmldb_exists(clicon_handle h,
         retval = 0;
 
     else{
-        if (sb.st_size == 0)
-            retval = 0;
+        if (sb.st_size == 0){
+            /* Empty snapshot but content may be in journal */
+            if (xmldb_journal_size(filename, &jlen) < 0)
+                goto done;
+            retval = jlen?1:0;
+        }
         else
             retval = 1;
     }
@@ -418,14 +488,17 @@ int
 xmldb_clear(clicon_handle h, 
             const char   *db)
 {
-    cxobj    *xt = NULL;
     db_elmnt *de = NULL;
     
+    if (strcmp(db, "running") == 0){
+        if (xmldb_dirty_reset(h) < 0)
+            return -1;
+        nacm_policy_invalidate();
+    }
     if ((de = clicon_db_elmnt_get(h, db)) != NULL){
-        if ((xt = de->de_xml) != NULL){
-            xml_free(xt);
-            de->de_xml = NULL;
-        }
+        if (xmldb_cache_release(h, de) < 0)
+            return -1;
+        de->de_dirty = 0;
     }
     return 0;
 }
@@ -455,6 +528,8 @@ xmldb_delete(clicon_handle h,
             clicon_err(OE_DB, errno, "truncate %s", filename);
             goto done;
         }
+    if (xmldb_journal_reset(filename) < 0)
+        goto done;
     retval = 0;
  done:
     if (filename)
@@ -476,14 +551,17 @@ xmldb_create(clicon_handle h,
     char               *filename = NULL;
     int                 fd = -1;
     db_elmnt           *de = NULL;
-    cxobj              *xt = NULL;
 
     clicon_debug(CLIXON_DBG_DETAIL, "%s %s", __FUNCTION__, db);
+    if (strcmp(db, "running") == 0){
+        if (xmldb_dirty_reset(h) < 0)
+            goto done;
+        nacm_policy_invalidate();
+    }
     if ((de = clicon_db_elmnt_get(h, db)) != NULL){
-        if ((xt = de->de_xml) != NULL){
-            xml_free(xt);
-            de->de_xml = NULL;
-        }
+        if (xmldb_cache_release(h, de) < 0)
+            goto done;
+        de->de_dirty = 0;
     }
     if (xmldb_db2file(h, db, &filename) < 0)
         goto done;
@@ -536,6 +614,99 @@ xmldb_cache_get(clicon_handle h,
     return de->de_xml;
 }
 
+/*! Make the XML cache of a datastore private before modifying it
+ *
+ * Datastore caches are shared after xmldb_copy, so that copying eg running to candidate
+ * does not copy the tree. A writer modifying a cache tree must first call this function.
+ * If the cache is shared with another datastore, it is replaced by a private copy.
+ * @param[in]  h    Clicon handle
+ * @param[in]  db   Database name
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xmldb_copy
+ */
+int
+xmldb_cache_unshare(clicon_handle h,
+                    const char   *db)
+{
+    int       retval = -1;
+    db_elmnt *de;
+    cxobj    *x0;
+    cxobj    *x1;
+    int       ret;
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL ||
+        (x0 = de->de_xml) == NULL)
+        goto ok;
+    if ((ret = xmldb_cache_refs(h, x0)) < 0)
+        goto done;
+    if (ret > 1){
+        if ((x1 = xml_new(xml_name(x0), NULL, CX_ELMNT)) == NULL)
+            goto done;
+        xml_flag_set(x1, XML_FLAG_TOP);
+        if (xml_copy(x0, x1) < 0){
+            xml_free(x1);
+            goto done;
+        }
+        de->de_xml = x1;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get dirty-path tracking flag from datastore
+ *
+ * If set, the datastore cache is a copy of running where every edit since the copy is
+ * marked with XML_FLAG_DIRTY, and can be compared with running using xml_diff_dirty.
+ * Set when copied from or to running with cache enabled, reset when running changes
+ * or the cache is cleared.
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Database name
+ * @retval     0     Not tracked, use xml_diff
+ * @retval     1     Edits are tracked, xml_diff_dirty can be used
+ * @see xmldb_copy
+ */
+int
+xmldb_dirty_get(clicon_handle h,
+                const char   *db)
+{
+    db_elmnt *de;
+    
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL)
+        return 0;
+    return de->de_dirty;
+}
+
+/*! Reset dirty-path tracking flag of all datastores, eg when running is changed
+ *
+ * @param[in]  h     Clicon handle
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xmldb_dirty_get
+ */
+int
+xmldb_dirty_reset(clicon_handle h)
+{
+    int       retval = -1;
+    char    **keys = NULL;
+    size_t    klen;
+    int       i;
+    db_elmnt *de;
+
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
+        goto done;
+    for (i = 0; i < klen; i++)
+        if ((de = clicon_hash_value(clicon_db_elmnt(h), keys[i], NULL)) != NULL)
+            de->de_dirty = 0;
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
 /*! Get modified flag from datastore
  * @param[in]  h     Clicon handle
  * @param[in]  db    Database name
@@ -667,6 +838,8 @@ xmldb_rename(clicon_handle h,
         clicon_err(OE_UNIX, errno, "rename: %s", strerror(errno));
         goto done;
     };
+    if (xmldb_journal_rename(old, fname) < 0)
+        goto done;
     retval = 0;
  done:
     if (cb)
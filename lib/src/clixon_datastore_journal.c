@@ -0,0 +1,661 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2020-2023 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * Datastore journal
+ * If CLICON_XMLDB_JOURNAL is set, xmldb_put appends each edit as a record to a journal 
+ * file <db>_db.journal instead of re-writing the whole datastore file <db>_db (the snapshot).
+ * When the journal grows larger than the snapshot (and CLICON_XMLDB_JOURNAL_MAX) it is
+ * compacted: the snapshot is re-written atomically and the journal is removed.
+ * On read, the journal is replayed on top of the snapshot.
+ *
+ * Journal file format:
+ *   clixon-journal-1 <dev> <inode> <size>\n        # Header: identifies the snapshot
+ *   <operation> <len> <checksum>\n<payload>\n      # Record, zero or more
+ * where payload is <len> bytes of XML: <config xmlns:..>...</config>
+ * and checksum is a 32-bit FNV-1a hash of the payload in hex.
+ *
+ * Crash consistency:
+ * - A record is written with a single write followed by fsync. A partially written
+ *   (torn) or corrupt last record is discarded and truncated on replay.
+ * - A snapshot is written to a temporary file which is renamed to the snapshot. The
+ *   journal header identifies the snapshot by device, inode and size, so that a journal
+ *   left by a crash after the rename (ie already included in the snapshot) is stale
+ *   and is not replayed again.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <syslog.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_string.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_xml_sort.h"
+#include "clixon_xml_bind.h"
+#include "clixon_options.h"
+#include "clixon_data.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_xml_nsctx.h"
+#include "clixon_xml_io.h"
+#include "clixon_yang_module.h"
+#include "clixon_datastore.h"
+#include "clixon_datastore_write.h"
+#include "clixon_datastore_read.h"
+#include "clixon_datastore_journal.h"
+
+/* Journal file header magic, first token of first line */
+#define JOURNAL_MAGIC "clixon-journal-1"
+
+/* Journal file suffix, appended to datastore file name */
+#define JOURNAL_SUFFIX ".journal"
+
+/* Max length of a journal header or record header line */
+#define JOURNAL_LINELEN 128
+
+/*! Get journal file name of a datastore file
+ * @param[in]  dbfile  Datastore (snapshot) file
+ * @param[out] jfile   Journal file name, malloced, free with free()
+ */
+static int
+journal_file(const char *dbfile,
+             char      **jfile)
+{
+    size_t len;
+
+    len = strlen(dbfile) + strlen(JOURNAL_SUFFIX) + 1;
+    if ((*jfile = malloc(len)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    snprintf(*jfile, len, "%s%s", dbfile, JOURNAL_SUFFIX);
+    return 0;
+}
+
+/*! Get journal header identifying the current snapshot file
+ * @param[in]  dbfile  Datastore (snapshot) file
+ * @param[out] hdr     Header line including newline
+ * @param[in]  len     Length of hdr
+ * @retval     1       OK
+ * @retval     0       Snapshot does not exist
+ * @retval    -1       Error
+ */
+static int
+journal_header(const char *dbfile,
+               char       *hdr,
+               size_t      len)
+{
+    struct stat st;
+
+    if (stat(dbfile, &st) < 0){
+        if (errno == ENOENT)
+            return 0;
+        clicon_err(OE_UNIX, errno, "stat(%s)", dbfile);
+        return -1;
+    }
+    snprintf(hdr, len, "%s %" PRIuMAX " %" PRIuMAX " %" PRIdMAX "\n", JOURNAL_MAGIC,
+             (uintmax_t)st.st_dev, (uintmax_t)st.st_ino, (intmax_t)st.st_size);
+    return 1;
+}
+
+/*! 32-bit FNV-1a checksum of journal record payload
+ */
+static uint32_t
+journal_checksum(const char *buf,
+                 size_t      len)
+{
+    uint32_t h = 2166136261U;
+    size_t   i;
+
+    for (i=0; i<len; i++){
+        h ^= (uint8_t)buf[i];
+        h *= 16777619U;
+    }
+    return h;
+}
+
+/*! Write all of buf to fd
+ */
+static int
+journal_write(int         fd,
+              const char *buf,
+              size_t      len)
+{
+    ssize_t n;
+
+    while (len > 0){
+        if ((n = write(fd, buf, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_UNIX, errno, "write");
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*! Serialize an edit as a journal record payload
+ *
+ * Namespace declarations in scope of x1, including those of its ancestors (eg rpc), 
+ * are declared on the top-level config element so that the record is self-contained.
+ * @param[out] cb   Payload: <config xmlns:..>...</config>
+ * @param[in]  x1   Modification tree as given to xmldb_put, or NULL
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+xmldb_journal_record(cbuf  *cb,
+                     cxobj *x1)
+{
+    int     retval = -1;
+    cvec   *nsc = NULL;
+    cg_var *cv;
+    cxobj  *xc;
+    char   *prefix;
+
+    cprintf(cb, "<%s", NETCONF_INPUT_CONFIG);
+    if (x1 != NULL){
+        if (xml_nsctx_node(x1, &nsc) < 0)
+            goto done;
+        cv = NULL;
+        while ((cv = cvec_each(nsc, cv)) != NULL){
+            if ((prefix = cv_name_get(cv)) == NULL)
+                cprintf(cb, " xmlns=\"");
+            else
+                cprintf(cb, " xmlns:%s=\"", prefix);
+            if (xml_chardata_cbuf_append(cb, cv_string_get(cv)) < 0)
+                goto done;
+            cprintf(cb, "\"");
+        }
+    }
+    cprintf(cb, ">");
+    xc = NULL;
+    while (x1 && (xc = xml_child_each(x1, xc, CX_ELMNT)) != NULL)
+        if (clixon_xml2cbuf(cb, xc, 0, 0, -1, 0) < 0)
+            goto done;
+    cprintf(cb, "</%s>", NETCONF_INPUT_CONFIG);
+    retval = 0;
+ done:
+    if (nsc)
+        xml_nsctx_free(nsc);
+    return retval;
+}
+
+/*! Append an edit record to the journal of a datastore
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  dbfile  Datastore (snapshot) file
+ * @param[in]  op      Edit operation
+ * @param[in]  cbrec   Record payload, see xmldb_journal_record
+ * @retval     1       OK, record appended
+ * @retval     0       Record not appended or journal full: caller should compact
+ * @retval    -1       Error
+ * The record is synced to disk before return.
+ */
+int
+xmldb_journal_append(clicon_handle       h,
+                     const char         *dbfile,
+                     enum operation_type op,
+                     cbuf               *cbrec)
+{
+    int         retval = -1;
+    char       *jfile = NULL;
+    int         fd = -1;
+    char        hdr[JOURNAL_LINELEN];
+    char        buf[JOURNAL_LINELEN];
+    struct stat st;
+    struct stat snap;
+    ssize_t     n;
+    cbuf       *cb = NULL;
+    int         ret;
+    int         jmax;
+
+    if ((ret = journal_header(dbfile, hdr, sizeof(hdr))) < 0)
+        goto done;
+    if (ret == 0)
+        goto compact;
+    if (journal_file(dbfile, &jfile) < 0)
+        goto done;
+    if ((fd = open(jfile, O_RDWR|O_CREAT|O_APPEND, S_IRUSR|S_IWUSR)) < 0){
+        clicon_debug(1, "%s open(%s): %s", __FUNCTION__, jfile, strerror(errno));
+        goto compact;
+    }
+    if (fstat(fd, &st) < 0){
+        clicon_err(OE_UNIX, errno, "fstat(%s)", jfile);
+        goto done;
+    }
+    /* Check journal is for current snapshot, otherwise it is stale: start anew */
+    if (st.st_size > 0){
+        if ((n = pread(fd, buf, sizeof(buf)-1, 0)) < 0){
+            clicon_err(OE_UNIX, errno, "pread(%s)", jfile);
+            goto done;
+        }
+        buf[n] = '\0';
+        if (strncmp(buf, hdr, strlen(hdr)) != 0){
+            if (ftruncate(fd, 0) < 0){
+                clicon_err(OE_UNIX, errno, "ftruncate(%s)", jfile);
+                goto done;
+            }
+            st.st_size = 0;
+        }
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (st.st_size == 0)
+        cprintf(cb, "%s", hdr);
+    cprintf(cb, "%s %zu %08" PRIx32 "\n", xml_operation2str(op),
+            cbuf_len(cbrec), journal_checksum(cbuf_get(cbrec), cbuf_len(cbrec)));
+    cbuf_append_buf(cb, cbuf_get(cbrec), cbuf_len(cbrec));
+    cbuf_append(cb, '\n');
+    if (journal_write(fd, cbuf_get(cb), cbuf_len(cb)) < 0)
+        goto done;
+    if (fsync(fd) < 0){
+        clicon_err(OE_UNIX, errno, "fsync(%s)", jfile);
+        goto done;
+    }
+    /* Compact when journal is larger than both snapshot and configured max */
+    if ((jmax = clicon_option_int(h, "CLICON_XMLDB_JOURNAL_MAX")) < 0)
+        jmax = 0;
+    if (stat(dbfile, &snap) == 0 &&
+        st.st_size + cbuf_len(cb) > snap.st_size &&
+        st.st_size + cbuf_len(cb) > jmax)
+        goto compact;
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (fd != -1)
+        close(fd);
+    if (jfile)
+        free(jfile);
+    return retval;
+ compact:
+    retval = 0;
+    goto done;
+}
+
+/*! Apply one journal record payload to a datastore tree
+ * @param[in]  h      Clixon handle
+ * @param[in]  x0     Datastore tree, bound to yang
+ * @param[in]  op     Edit operation
+ * @param[in]  str    Record payload
+ * @param[in]  yspec  Yang spec
+ * @retval     0      OK
+ * @retval    -1      Error, also if record could not be applied
+ */
+static int
+journal_apply(clicon_handle       h,
+              cxobj              *x0,
+              enum operation_type op,
+              char               *str,
+              yang_stmt          *yspec)
+{
+    int    retval = -1;
+    cxobj *xt = NULL;
+    cxobj *xc;
+    cxobj *xerr = NULL;
+    cbuf  *cbret = NULL;
+    int    ret;
+
+    if ((cbret = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml_parse_string(str, YB_NONE, NULL, &xt, NULL) < 0)
+        goto done;
+    if ((xc = xml_find_type(xt, NULL, NETCONF_INPUT_CONFIG, CX_ELMNT)) == NULL){
+        clicon_err(OE_DB, 0, "Journal record without %s", NETCONF_INPUT_CONFIG);
+        goto done;
+    }
+    if ((ret = xml_bind_yang(h, xc, YB_MODULE, yspec, &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        if (clixon_xml2cbuf(cbret, xerr, 0, 0, -1, 0) < 0)
+            goto done;
+        goto fail;
+    }
+    if (xml_sort_recurse(xc) < 0)
+        goto done;
+    if ((ret = xmldb_put_tree(h, x0, op, xc, yspec, NULL, NULL, 1, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    retval = 0;
+ done:
+    if (cbret)
+        cbuf_free(cbret);
+    if (xerr)
+        xml_free(xerr);
+    if (xt)
+        xml_free(xt);
+    return retval;
+ fail:
+    clicon_err(OE_DB, 0, "Journal record could not be applied: %s", cbuf_get(cbret));
+    goto done;
+}
+
+/*! Replay journal of a datastore on top of its snapshot tree
+ *
+ * Records are applied in order. A stale journal is removed. An incomplete or corrupt
+ * tail, eg from a crash during append, is discarded and the journal is truncated after
+ * the last valid record.
+ * @param[in]  h       Clixon handle
+ * @param[in]  dbfile  Datastore (snapshot) file
+ * @param[in]  yb      How snapshot tree is bound. If YB_NONE it is bound if needed
+ * @param[in]  yspec   Yang spec
+ * @param[in]  x0      Snapshot tree, top-level config
+ * @retval     n       Number of records applied
+ * @retval    -1       Error
+ */
+int
+xmldb_journal_replay(clicon_handle h,
+                     const char   *dbfile,
+                     yang_bind     yb,
+                     yang_stmt    *yspec,
+                     cxobj        *x0)
+{
+    int                 retval = -1;
+    char               *jfile = NULL;
+    int                 fd = -1;
+    struct stat         st;
+    char                hdr[JOURNAL_LINELEN];
+    char               *buf = NULL;
+    char               *eol;
+    char               *payload;
+    size_t              off;
+    size_t              len;
+    uint32_t            csum;
+    char                opstr[JOURNAL_LINELEN];
+    enum operation_type op;
+    int                 nr = 0;
+    ssize_t             n;
+    int                 ret;
+
+    if (journal_file(dbfile, &jfile) < 0)
+        goto done;
+    if ((fd = open(jfile, O_RDWR)) < 0){
+        if (errno == ENOENT)
+            goto ok;
+        clicon_err(OE_UNIX, errno, "open(%s)", jfile);
+        goto done;
+    }
+    if (fstat(fd, &st) < 0){
+        clicon_err(OE_UNIX, errno, "fstat(%s)", jfile);
+        goto done;
+    }
+    if ((buf = malloc(st.st_size + 1)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    for (off = 0; off < st.st_size; off += n)
+        if ((n = pread(fd, buf + off, st.st_size - off, off)) <= 0){
+            if (n < 0 && errno == EINTR){
+                n = 0;
+                continue;
+            }
+            clicon_err(OE_UNIX, errno, "pread(%s)", jfile);
+            goto done;
+        }
+    buf[st.st_size] = '\0';
+    if ((ret = journal_header(dbfile, hdr, sizeof(hdr))) < 0)
+        goto done;
+    len = strlen(hdr);
+    if (ret == 0 || st.st_size < len || strncmp(buf, hdr, len) != 0){
+        clicon_debug(1, "%s: stale journal %s removed", __FUNCTION__, jfile);
+        if (unlink(jfile) < 0){
+            clicon_err(OE_UNIX, errno, "unlink(%s)", jfile);
+            goto done;
+        }
+        goto ok;
+    }
+    off = len;
+    while (off < st.st_size){
+        if ((eol = memchr(buf + off, '\n', st.st_size - off)) == NULL ||
+            eol - (buf + off) >= JOURNAL_LINELEN)
+            break;
+        *eol = '\0';
+        if (sscanf(buf + off, "%127s %zu %" SCNx32, opstr, &len, &csum) != 3)
+            break;
+        payload = eol + 1;
+        if (len >= st.st_size - (payload - buf) || payload[len] != '\n')
+            break;
+        if (journal_checksum(payload, len) != csum)
+            break;
+        if (xml_operation(opstr, &op) < 0)
+            break;
+        payload[len] = '\0';
+        if (nr == 0 && yb == YB_NONE){
+            if ((ret = xml_bind_yang(h, x0, YB_MODULE, yspec, NULL)) < 0)
+                goto done;
+            if (xml_sort_recurse(x0) < 0)
+                goto done;
+        }
+        if (journal_apply(h, x0, op, payload, yspec) < 0)
+            goto done;
+        nr++;
+        off = payload + len + 1 - buf;
+    }
+    if (off < st.st_size){
+        clicon_log(LOG_WARNING, "%s: discarding %zu bytes of incomplete journal record",
+                   jfile, (size_t)(st.st_size - off));
+        if (ftruncate(fd, off) < 0){
+            clicon_err(OE_UNIX, errno, "ftruncate(%s)", jfile);
+            goto done;
+        }
+    }
+    clicon_debug(1, "%s: %d records replayed from %s", __FUNCTION__, nr, jfile);
+ ok:
+    retval = nr;
+ done:
+    if (buf)
+        free(buf);
+    if (fd != -1)
+        close(fd);
+    if (jfile)
+        free(jfile);
+    return retval;
+}
+
+/*! Remove journal of a datastore, eg when the snapshot is re-written
+ * @param[in]  dbfile  Datastore (snapshot) file
+ */
+int
+xmldb_journal_reset(const char *dbfile)
+{
+    int   retval = -1;
+    char *jfile = NULL;
+
+    if (journal_file(dbfile, &jfile) < 0)
+        goto done;
+    if (unlink(jfile) < 0 && errno != ENOENT){
+        clicon_err(OE_UNIX, errno, "unlink(%s)", jfile);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (jfile)
+        free(jfile);
+    return retval;
+}
+
+/*! Get size of valid journal records, excluding header
+ * @param[in]  dbfile  Datastore (snapshot) file
+ * @param[out] len     Length of journal records, 0 if no or stale journal
+ */
+int
+xmldb_journal_size(const char *dbfile,
+                   size_t     *len)
+{
+    int         retval = -1;
+    char       *jfile = NULL;
+    int         fd = -1;
+    char        hdr[JOURNAL_LINELEN];
+    char        buf[JOURNAL_LINELEN];
+    struct stat st;
+    ssize_t     n;
+    int         ret;
+
+    *len = 0;
+    if (journal_file(dbfile, &jfile) < 0)
+        goto done;
+    if ((fd = open(jfile, O_RDONLY)) < 0)
+        goto ok;
+    if (fstat(fd, &st) < 0){
+        clicon_err(OE_UNIX, errno, "fstat(%s)", jfile);
+        goto done;
+    }
+    if ((n = pread(fd, buf, sizeof(buf)-1, 0)) < 0){
+        clicon_err(OE_UNIX, errno, "pread(%s)", jfile);
+        goto done;
+    }
+    buf[n] = '\0';
+    if ((ret = journal_header(dbfile, hdr, sizeof(hdr))) < 0)
+        goto done;
+    if (ret == 1 && strncmp(buf, hdr, strlen(hdr)) == 0)
+        *len = st.st_size - strlen(hdr);
+ ok:
+    retval = 0;
+ done:
+    if (fd != -1)
+        close(fd);
+    if (jfile)
+        free(jfile);
+    return retval;
+}
+
+/*! Compact journal of a datastore into its snapshot, if there are journal records
+ *
+ * Used before the snapshot file is used by itself, eg copied.
+ * @param[in]  h   Clixon handle
+ * @param[in]  db  Symbolic database name, eg "candidate", "running"
+ */
+int
+xmldb_journal_flush(clicon_handle h,
+                    const char   *db)
+{
+    int        retval = -1;
+    char      *dbfile = NULL;
+    size_t     len;
+    db_elmnt  *de;
+    cxobj     *x0 = NULL;
+    cxobj     *xt = NULL;
+    yang_stmt *yspec;
+    int        ret;
+
+    if (xmldb_db2file(h, db, &dbfile) < 0)
+        goto done;
+    if (xmldb_journal_size(dbfile, &len) < 0)
+        goto done;
+    if (len == 0)
+        goto ok;
+    if ((de = clicon_db_elmnt_get(h, db)) != NULL &&
+        clicon_datastore_cache(h) != DATASTORE_NOCACHE)
+        x0 = de->de_xml;
+    if (x0 == NULL){
+        if ((yspec = clicon_dbspec_yang(h)) == NULL){
+            clicon_err(OE_YANG, ENOENT, "No yang spec");
+            goto done;
+        }
+        if ((ret = xmldb_readfile(h, db, YB_MODULE, yspec, &xt, NULL, NULL, NULL)) < 0)
+            goto done;
+        if (ret == 0){
+            clicon_err(OE_DB, 0, "Invalid datastore %s", db);
+            goto done;
+        }
+        x0 = xt;
+    }
+    if (xmldb_write_snapshot(h, x0, dbfile) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (xt)
+        xml_free(xt);
+    if (dbfile)
+        free(dbfile);
+    return retval;
+}
+
+/*! Rename journal along with its datastore file
+ * @param[in]  dbfile   Old datastore file
+ * @param[in]  newfile  New datastore file
+ */
+int
+xmldb_journal_rename(const char *dbfile,
+                     const char *newfile)
+{
+    int   retval = -1;
+    char *jfile = NULL;
+    char *jnew = NULL;
+
+    if (journal_file(dbfile, &jfile) < 0)
+        goto done;
+    if (journal_file(newfile, &jnew) < 0)
+        goto done;
+    if (rename(jfile, jnew) < 0 && errno != ENOENT){
+        clicon_err(OE_UNIX, errno, "rename(%s)", jfile);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (jfile)
+        free(jfile);
+    if (jnew)
+        free(jnew);
+    return retval;
+}
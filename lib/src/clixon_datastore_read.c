@@ -83,6 +83,7 @@
 #include "clixon_xml_nsctx.h"
 #include "clixon_datastore.h"
 #include "clixon_datastore_read.h"
+#include "clixon_datastore_journal.h"
 
 #define handle(xh) (assert(text_handle_check(xh)==0),(struct text_handle *)(xh))
 
@@ -438,65 +439,157 @@ disable_nacm_on_empty(cxobj     *xt,
     return retval;
 }
 
-/*! Common read function that reads an XML tree from file
- * @param[in]  th     Datastore text handle
- * @param[in]  db     Symbolic database name, eg "candidate", "running"
- * @param[in]  yb     How to bind yang to XML top-level when parsing
+/*! Analyze and strip module-state of a datastore tree, and clone yang spec if needed
+ *
+ * Datastore files may contain module-state defining which modules are used in the file.
+ * Strip module-state, analyze it with CHANGE/ADD/RM and return msdiff
+ * If obsolete/deleted yang modules are found, a clone yspec is created with exactly the
+ * yang modules found.
+ * @param[in]  h      Clixon handle
  * @param[in]  yspec  Top-level yang spec
- * @param[out] xp     XML tree read from file
- * @param[out] de     If set, return db-element status (eg empty flag)
- * @param[out] msdiff If set, return modules-state differences
+ * @param[in]  x0     XML tree with top-level "config"
+ * @param[in]  msdiff Modules-state differences, or NULL
+ * @param[in]  yb     How to bind yang to XML top-level when parsing
+ * @param[out] yspec1 Clone yang spec if needed, free with ys_free1(yspec1, 1)
  * @param[out] xerr   XML error if retval is 0
- * @retval     -1     General error, check specific clicon_errno, clicon_suberrno
- * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
  * @retval     1      OK
- * @note Use of 1 for OK
- * @note retval 0 is NYI because calling functions cannot handle it yet
- * XXX if this code pass tests this code can be rewritten, esp the modstate stuff
+ * @retval     0      Failed and xerr set
+ * @retval    -1      Error
  */
-int
-xmldb_readfile(clicon_handle    h,
-               const char      *db,
-               yang_bind        yb,
-               yang_stmt       *yspec,
-               cxobj          **xp,
-               db_elmnt        *de,
-               modstate_diff_t *msdiff0,
-               cxobj          **xerr)
+static int
+xmldb_readfile_modstate(clicon_handle    h,
+                        yang_stmt       *yspec,
+                        cxobj           *x0,
+                        modstate_diff_t *msdiff,
+                        yang_bind        yb,
+                        yang_stmt      **yspec1,
+                        cxobj          **xerr)
 {
-    int              retval = -1;
-    cxobj           *x0 = NULL;
-    char            *dbfile = NULL;
-    FILE            *fp = NULL;
-    char            *format;
-    int              ret;
-    modstate_diff_t *msdiff = NULL;
-    cxobj           *xmsd;           /* XML module state diff */
-    yang_stmt       *ymod;
-    char            *name;
-    char            *ns;             /* namespace */
-    char            *rev;            /* revision */
-    int              needclone;
-    cxobj           *xmodfile = NULL;
-    cxobj           *x;
-    yang_stmt       *yspec1 = NULL;
+    int        retval = -1;
+    cxobj     *xmsd;           /* XML module state diff */
+    yang_stmt *ymod;
+    char      *name;
+    char      *ns;             /* namespace */
+    char      *rev;            /* revision */
+    int        needclone;
+    cxobj     *xmodfile = NULL;
+    cxobj     *x;
 
-    if (yb != YB_MODULE && yb != YB_NONE){
-        clicon_err(OE_XML, EINVAL, "yb is %d but should be module or none", yb);
-        goto done;
-    }
-    if (xmldb_db2file(h, db, &dbfile) < 0)
-        goto done;
-    if (dbfile==NULL){
-        clicon_err(OE_XML, 0, "dbfile NULL");
-        goto done;
+    /* First try RFC8525, but also backward compatible RFC7895 */
+    if ((x = xpath_first(x0, NULL, "yang-library/module-set")) != NULL ||
+        (x = xml_find_type(x0, NULL, "modules-state", CX_ELMNT)) != NULL){
+        if ((xmodfile = xml_dup(x)) == NULL)
+            goto done;
     }
-    if ((format = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) == NULL){
-        clicon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
+    if (text_read_modstate(h, yspec, x0, msdiff) < 0)
         goto done;
-    }
-    clicon_debug(CLIXON_DBG_DEFAULT, "Reading datastore %s using %s", dbfile, format);
-    /* Parse file into internal XML tree from different formats */
+    if (yb == YB_MODULE && msdiff){
+        /* Check if old/deleted yangs not present in the loaded/running yangspec.
+         * If so, append them to the global yspec
+         */
+        needclone = 0;
+        xmsd = NULL;
+        while ((xmsd = xml_child_each(msdiff->md_diff, xmsd, CX_ELMNT)) != NULL) {
+            if (xml_flag(xmsd, XML_FLAG_CHANGE|XML_FLAG_DEL) == 0)
+                continue;
+            needclone++;
+            /* Extract name, namespace, and revision */
+            if ((name = xml_find_body(xmsd, "name")) == NULL)
+                continue;
+            if ((ns = xml_find_body(xmsd, "namespace")) == NULL)
+                continue;
+            /* Extract revision */
+            if ((rev = xml_find_body(xmsd, "revision")) == NULL)
+                continue;
+            /* Add old/deleted yangs not present in the loaded/running yangspec. */
+            if ((ymod = yang_find_module_by_namespace_revision(yspec, ns, rev)) == NULL){
+                /* YANG Module not found, look for it and append if found */
+                if (yang_spec_parse_module(h, name, rev, yspec) < 0){
+                    /* Special case: file-not-found errors */
+                    if (clicon_suberrno == ENOENT){
+                        cbuf *cberr = NULL;
+                        if ((cberr = cbuf_new()) == NULL){
+                            clicon_err(OE_XML, errno, "cbuf_new");
+                            goto done;
+                        }
+                        cprintf(cberr, "Internal error: %s", clicon_err_reason);
+                        clicon_err_reset();
+                        if (xerr && netconf_operation_failed_xml(xerr, "application", cbuf_get(cberr))< 0)
+                            goto done;
+                        cbuf_free(cberr);
+                        goto fail;
+                    }
+                    goto done;
+                }
+            }
+        }
+        /* If we found an obsolete yang module, we need to make a clone yspec with the
+         * exactly the yang modules found 
+         * Same ymodules are inserted into yspec1, ie pointers only
+         */
+        if (needclone && xmodfile){
+            if ((*yspec1 = yspec_new()) == NULL)
+                goto done;
+            xmsd = NULL;
+            while ((xmsd = xml_child_each(xmodfile, xmsd, CX_ELMNT)) != NULL) {
+                if (strcmp(xml_name(xmsd), "module"))
+                    continue;
+                if ((ns = xml_find_body(xmsd, "namespace")) == NULL)
+                    continue;
+                if ((rev = xml_find_body(xmsd, "revision")) == NULL)
+                    continue;
+                if ((ymod = yang_find_module_by_namespace_revision(yspec, ns, rev)) == NULL)
+                    continue; // XXX error?
+                if (yn_insert1(*yspec1, ymod) < 0)
+                    goto done;
+            }
+        }
+    } /* if msdiff */
+    retval = 1;
+ done:
+    if (xmodfile)
+        xml_free(xmodfile);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Multi-pass read of a datastore file: parse, strip modstate, bind yang and sort
+ *
+ * Used for JSON, schema mount and as fallback of xmldb_readfile_stream
+ * @param[in]  h      Clixon handle
+ * @param[in]  dbfile Datastore filename
+ * @param[in]  format Datastore format, "xml" or "json"
+ * @param[in]  yb     How to bind yang to XML top-level when parsing
+ * @param[in]  yspec  Top-level yang spec
+ * @param[in]  msdiff Modules-state differences, or NULL
+ * @param[out] xp     XML tree read from file
+ * @param[out] yspec1 Clone yang spec if needed
+ * @param[out] empty  Set if datastore is empty
+ * @param[out] xerr   XML error if retval is 0
+ * @retval     1      OK
+ * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
+ * @retval    -1      Error
+ */
+static int
+xmldb_readfile_multipass(clicon_handle    h,
+                         const char      *dbfile,
+                         const char      *format,
+                         yang_bind        yb,
+                         yang_stmt       *yspec,
+                         modstate_diff_t *msdiff,
+                         cxobj          **xp,
+                         yang_stmt      **yspec1,
+                         int             *empty,
+                         cxobj          **xerr)
+{
+    int    retval = -1;
+    cxobj *x0 = NULL;
+    FILE  *fp = NULL;
+    cxobj *x;
+    int    ret;
+
     if ((fp = fopen(dbfile, "r")) == NULL) {
         clicon_err(OE_UNIX, errno, "open(%s)", dbfile);
         goto done;
@@ -536,97 +629,312 @@ xmldb_readfile(clicon_handle    h,
         xml_purge(x);
 
     xml_flag_set(x0, XML_FLAG_TOP);
-    if (xml_child_nr(x0) == 0 && de)
-        de->de_empty = 1;
+    *empty = (xml_child_nr(x0) == 0);
+    if ((ret = xmldb_readfile_modstate(h, yspec, x0, msdiff, yb, yspec1, xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (yb == YB_MODULE){
+        /* xml looks like: <top><config><x>... actually YB_MODULE_NEXT 
+         */
+        if ((ret = xml_bind_yang(h, x0, YB_MODULE, *yspec1?*yspec1:yspec, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if (xml_sort_recurse(x0) < 0)
+            goto done;
+    }
+    *xp = x0;
+    x0 = NULL;
+    retval = 1;
+ done:
+    if (fp)
+        fclose(fp);
+    if (x0)
+        xml_free(x0);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! State of single-pass datastore read, see xmldb_readfile_stream */
+struct readfile_stream {
+    clicon_handle    rs_h;
+    yang_stmt       *rs_yspec0;   /* Top-level yang spec */
+    yang_stmt       *rs_yspec;    /* Yang spec used for binding, clone or top-level */
+    yang_stmt       *rs_yspec1;   /* Clone yang spec created from modstate, or NULL */
+    modstate_diff_t *rs_msdiff;   /* Modules-state differences, or NULL */
+    cxobj          **rs_xerr;     /* XML error if binding fails */
+    int              rs_ntop;     /* Number of parsed children of config */
+    int              rs_bound;    /* Number of children of config bound to yang */
+    int              rs_modstate; /* Modstate analyzed and stripped */
+    int              rs_failed;   /* Yang binding failed, xerr set */
+};
+
+/*! Parse callback of single-pass datastore read: bind yang, strip and sort each element
+ *
+ * Elements are bound on their start-tag: children of config from the top-level yang 
+ * modules and others from their parent. When an element is complete, its bodies are 
+ * stripped and its children sorted. Module-state is stripped and analyzed when complete.
+ * @param[in]  x    XML node
+ * @param[in]  end  0: start-tag parsed, 1: element complete
+ * @param[in]  arg  struct readfile_stream
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xmldb_readfile_stream_cb(cxobj *x,
+                         int    end,
+                         void  *arg)
+{
+    struct readfile_stream *rs = (struct readfile_stream *)arg;
+    cxobj                  *xp;
+    cxobj                  *xs = NULL;
+    yang_bind               yb;
+    char                   *name;
+    int                     i;
+    int                     ret;
+
+    if (rs->rs_failed)
+        return 0;
+    /* Skip <config> itself and children of an unknown top-level (error later) */
+    if ((xp = xml_parent(x)) == NULL || xml_parent(xp) == NULL)
+        return 0;
+    if (xml_parent(xml_parent(xp)) == NULL){ /* Child of config */
+        if (strcmp(xml_name(xp), DATASTORE_TOP_SYMBOL) != 0)
+            return 0;
+        name = xml_name(x);
+        if (strcmp(name, "yang-library") == 0 || strcmp(name, "modules-state") == 0){
+            if (!end)
+                return 0;
+            rs->rs_ntop++;
+            /* Module-state before any data: a clone yspec can be used for binding */
+            if (rs->rs_bound == 0 && rs->rs_modstate == 0){
+                rs->rs_modstate++;
+                if ((ret = xmldb_readfile_modstate(rs->rs_h, rs->rs_yspec0, xp, rs->rs_msdiff,
+                                                   YB_MODULE, &rs->rs_yspec1, rs->rs_xerr)) < 0)
+                    return -1;
+                if (ret == 0)
+                    rs->rs_failed++;
+                if (rs->rs_yspec1)
+                    rs->rs_yspec = rs->rs_yspec1;
+            }
+            return 0;
+        }
+        yb = YB_MODULE;
+    }
+    else if (xml_spec(xp) != NULL)
+        yb = YB_PARENT;
+    else
+        yb = YB_NONE;
+    if (end){
+        if (yb == YB_MODULE)
+            rs->rs_ntop++;
+        if (xml_spec(x) && xml_bind_yang_node_end(x) < 0)
+            return -1;
+        if (xml_sort_node(x) < 0)
+            return -1;
+    }
+    else if (yb != YB_NONE){
+        /* Use previous element sibling with same name as role model */
+        if (yb == YB_PARENT){
+            for (i = xml_child_nr(xp) - 2; i >= 0; i--){
+                xs = xml_child_i(xp, i);
+                if (xml_type(xs) == CX_ELMNT)
+                    break;
+            }
+            if (i < 0 ||
+                xml_spec(xs) == NULL ||
+                clicon_strcmp(xml_name(xs), xml_name(x)) != 0 ||
+                clicon_strcmp(xml_prefix(xs), xml_prefix(x)) != 0)
+                xs = NULL;
+        }
+        if ((ret = xml_bind_yang_node(x, yb, rs->rs_yspec, xs, rs->rs_xerr)) < 0)
+            return -1;
+        if (ret == 0)
+            rs->rs_failed++;
+        if (yb == YB_MODULE)
+            rs->rs_bound++;
+    }
+    return 0;
+}
+
+/*! Single-pass read of an XML datastore file: bind yang, strip and sort while parsing
+ *
+ * The file is read in one chunk and parsed in place. Each element is bound to yang when
+ * its start-tag is parsed and sorted when complete, so the tree is only traversed once.
+ * Module-state first in the file is analyzed before any data is bound, so that a clone
+ * yspec can be used for obsolete modules.
+ * @param[in]  h      Clixon handle
+ * @param[in]  dbfile Datastore filename
+ * @param[in]  yspec  Top-level yang spec
+ * @param[in]  msdiff Modules-state differences, or NULL
+ * @param[out] xp     XML tree read from file
+ * @param[out] yspec1 Clone yang spec if needed
+ * @param[out] empty  Set if datastore is empty
+ * @param[out] xerr   XML error if retval is 0
+ * @retval     2      Module-state after data requires clone yspec, use multi-pass read
+ * @retval     1      OK
+ * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
+ * @retval    -1      Error
+ * @see xmldb_readfile_multipass
+ */
+static int
+xmldb_readfile_stream(clicon_handle    h,
+                      const char      *dbfile,
+                      yang_stmt       *yspec,
+                      modstate_diff_t *msdiff,
+                      cxobj          **xp,
+                      yang_stmt      **yspec1,
+                      int             *empty,
+                      cxobj          **xerr)
+{
+    int                    retval = -1;
+    struct readfile_stream rs = {0,};
+    cxobj                 *x0 = NULL;
+    int                    fd = -1;
+    cxobj                 *x;
+    int                    ret;
+
+    rs.rs_h = h;
+    rs.rs_yspec0 = yspec;
+    rs.rs_yspec = yspec;
+    rs.rs_msdiff = msdiff;
+    rs.rs_xerr = xerr;
+    if ((fd = open(dbfile, O_RDONLY)) < 0) {
+        clicon_err(OE_UNIX, errno, "open(%s)", dbfile);
+        goto done;
+    }    
+    if (clixon_xml_parse_fd(fd, xmldb_readfile_stream_cb, &rs, &x0) < 0)
+        goto done;
+    if (rs.rs_failed)
+        goto fail;
+    /* Always assert a top-level called "config", see xmldb_readfile_multipass */
+    if (xml_child_nr(x0) == 0){ 
+        if (xml_name_set(x0, DATASTORE_TOP_SYMBOL) < 0)
+            goto done;     
+    }
+    else if (singleconfigroot(x0, &x0) < 0)
+        goto done;
+    /* Purge all top-level body objects */
+    x = NULL;
+    while ((x = xml_find_type(x0, NULL, "body", CX_BODY)) != NULL)
+        xml_purge(x);
+    xml_flag_set(x0, XML_FLAG_TOP);
+    *empty = (rs.rs_ntop == 0);
+    if (rs.rs_modstate == 0){
+        if ((ret = xmldb_readfile_modstate(h, yspec, x0, msdiff, YB_MODULE, &rs.rs_yspec1, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if (rs.rs_yspec1 && rs.rs_bound){
+            retval = 2; /* Data bound to wrong yspec */
+            goto done;
+        }
+    }
+    if (xml_sort_node(x0) < 0)
+        goto done;
+    *xp = x0;
+    x0 = NULL;
+    *yspec1 = rs.rs_yspec1;
+    rs.rs_yspec1 = NULL;
+    retval = 1;
+ done:
+    if (rs.rs_yspec1)
+        ys_free1(rs.rs_yspec1, 1);
+    if (fd != -1)
+        close(fd);
+    if (x0)
+        xml_free(x0);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Common read function that reads an XML tree from file
+ * @param[in]  th     Datastore text handle
+ * @param[in]  db     Symbolic database name, eg "candidate", "running"
+ * @param[in]  yb     How to bind yang to XML top-level when parsing
+ * @param[in]  yspec  Top-level yang spec
+ * @param[out] xp     XML tree read from file
+ * @param[out] de     If set, return db-element status (eg empty flag)
+ * @param[out] msdiff If set, return modules-state differences
+ * @param[out] xerr   XML error if retval is 0
+ * @retval     -1     General error, check specific clicon_errno, clicon_suberrno
+ * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
+ * @retval     1      OK
+ * @note Use of 1 for OK
+ * @note retval 0 is NYI because calling functions cannot handle it yet
+ * XML datastores bound to yang are read in a single pass, see xmldb_readfile_stream
+ */
+int
+xmldb_readfile(clicon_handle    h,
+               const char      *db,
+               yang_bind        yb,
+               yang_stmt       *yspec,
+               cxobj          **xp,
+               db_elmnt        *de,
+               modstate_diff_t *msdiff0,
+               cxobj          **xerr)
+{
+    int              retval = -1;
+    cxobj           *x0 = NULL;
+    char            *dbfile = NULL;
+    char            *format;
+    int              ret;
+    modstate_diff_t *msdiff = NULL;
+    yang_stmt       *yspec1 = NULL;
+    int              empty = 0;
 
+    if (yb != YB_MODULE && yb != YB_NONE){
+        clicon_err(OE_XML, EINVAL, "yb is %d but should be module or none", yb);
+        goto done;
+    }
+    if (xmldb_db2file(h, db, &dbfile) < 0)
+        goto done;
+    if (dbfile==NULL){
+        clicon_err(OE_XML, 0, "dbfile NULL");
+        goto done;
+    }
+    if ((format = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) == NULL){
+        clicon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
+        goto done;
+    }
+    clicon_debug(CLIXON_DBG_DEFAULT, "Reading datastore %s using %s", dbfile, format);
     /* Check if we support modstate */
     if (clicon_option_bool(h, "CLICON_XMLDB_MODSTATE"))
         if ((msdiff = modstate_diff_new()) == NULL)
             goto done;
-    /* First try RFC8525, but also backward compatible RFC7895 */
-    if ((x = xpath_first(x0, NULL, "yang-library/module-set")) != NULL ||
-        (x = xml_find_type(x0, NULL, "modules-state", CX_ELMNT)) != NULL){
-        if ((xmodfile = xml_dup(x)) == NULL)
+    /* Parse file into internal XML tree from different formats */
+    if (yb == YB_MODULE &&
+        strcmp(format, "json") != 0 &&
+        !clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT")){
+        if ((ret = xmldb_readfile_stream(h, dbfile, yspec, msdiff, &x0, &yspec1, &empty, xerr)) < 0)
             goto done;
+        if (ret == 0)
+            goto fail;
+        if (ret == 2 && msdiff){ /* Fallback to multi-pass, restart modstate analysis */
+            modstate_diff_free(msdiff);
+            if ((msdiff = modstate_diff_new()) == NULL)
+                goto done;
+        }
     }
-    /* Datastore files may contain module-state defining
-     * which modules are used in the file. 
-     * Strip module-state, analyze it with CHANGE/ADD/RM and return msdiff
-     */
-    if (text_read_modstate(h, yspec, x0, msdiff) < 0)
-        goto done;
-    if (yb == YB_MODULE){
-        if (msdiff){
-            /* Check if old/deleted yangs not present in the loaded/running yangspec.
-             * If so, append them to the global yspec
-             */
-            needclone = 0;
-            xmsd = NULL;
-            while ((xmsd = xml_child_each(msdiff->md_diff, xmsd, CX_ELMNT)) != NULL) {
-                if (xml_flag(xmsd, XML_FLAG_CHANGE|XML_FLAG_DEL) == 0)
-                    continue;
-                needclone++;
-                /* Extract name, namespace, and revision */
-                if ((name = xml_find_body(xmsd, "name")) == NULL)
-                    continue;
-                if ((ns = xml_find_body(xmsd, "namespace")) == NULL)
-                    continue;
-                /* Extract revision */
-                if ((rev = xml_find_body(xmsd, "revision")) == NULL)
-                    continue;
-                /* Add old/deleted yangs not present in the loaded/running yangspec. */
-                if ((ymod = yang_find_module_by_namespace_revision(yspec, ns, rev)) == NULL){
-                    /* YANG Module not found, look for it and append if found */
-                    if (yang_spec_parse_module(h, name, rev, yspec) < 0){
-                        /* Special case: file-not-found errors */
-                        if (clicon_suberrno == ENOENT){
-                            cbuf *cberr = NULL;
-                            if ((cberr = cbuf_new()) == NULL){
-                                clicon_err(OE_XML, errno, "cbuf_new");
-                                goto done;
-                            }
-                            cprintf(cberr, "Internal error: %s", clicon_err_reason);
-                            clicon_err_reset();
-                            if (xerr && netconf_operation_failed_xml(xerr, "application", cbuf_get(cberr))< 0)
-                                goto done;
-                            cbuf_free(cberr);
-                            goto fail;
-                        }
-                        goto done;
-                    }
-                }
-            }
-            /* If we found an obsolete yang module, we need to make a clone yspec with the
-             * exactly the yang modules found 
-             * Same ymodules are inserted into yspec1, ie pointers only
-             */
-            if (needclone && xmodfile){
-                if ((yspec1 = yspec_new()) == NULL)
-                    goto done;
-                xmsd = NULL;
-                while ((xmsd = xml_child_each(xmodfile, xmsd, CX_ELMNT)) != NULL) {
-                    if (strcmp(xml_name(xmsd), "module"))
-                        continue;
-                    if ((ns = xml_find_body(xmsd, "namespace")) == NULL)
-                        continue;
-                    if ((rev = xml_find_body(xmsd, "revision")) == NULL)
-                        continue;
-                    if ((ymod = yang_find_module_by_namespace_revision(yspec, ns, rev)) == NULL)
-                        continue; // XXX error?
-                    if (yn_insert1(yspec1, ymod) < 0)
-                        goto done;
-                }
-            }
-        } /* if msdiff */
-        /* xml looks like: <top><config><x>... actually YB_MODULE_NEXT 
-         */
-        if ((ret = xml_bind_yang(h, x0, YB_MODULE, yspec1?yspec1:yspec, xerr)) < 0)
+    if (x0 == NULL){
+        if ((ret = xmldb_readfile_multipass(h, dbfile, format, yb, yspec, msdiff,
+                                            &x0, &yspec1, &empty, xerr)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
-        if (xml_sort_recurse(x0) < 0)
-            goto done;
     }
+    if (de)
+        de->de_empty = empty;
+    /* Replay datastore journal, if any, on top of snapshot */
+    if ((ret = xmldb_journal_replay(h, dbfile, yb, yspec1?yspec1:yspec, x0)) < 0)
+        goto done;
+    if (ret > 0 && de)
+        de->de_empty = (xml_child_nr(x0) == 0);
     if (xp){
         *xp = x0;
         x0 = NULL;
@@ -640,12 +948,8 @@ xmldb_readfile(clicon_handle    h,
  done:
     if (yspec1)
         ys_free1(yspec1, 1);
-    if (xmodfile)
-        xml_free(xmodfile);
     if (msdiff)
         modstate_diff_free(msdiff);
-    if (fp)
-        fclose(fp);
     if (dbfile)
         free(dbfile);
     if (x0)
@@ -874,8 +1178,10 @@ xmldb_get_cache(clicon_handle     h,
          * No, argument against: we may want to have a semantically wrong file and wish to edit?
          */
         de0.de_xml = x0t;
-        if (de)
+        if (de){
             de0.de_id = de->de_id;
+            de0.de_dirty = de->de_dirty;
+        }
         clicon_db_elmnt_set(h, db, &de0); /* Content is copied */
     } /* x0t == NULL */
     else
@@ -911,6 +1217,8 @@ xmldb_get_cache(clicon_handle     h,
     if ((x1t = xml_new(xml_name(x0t), NULL, CX_ELMNT)) == NULL)
         goto done;
     xml_flag_set(x1t, XML_FLAG_TOP);    
+    /* Keep marked edits for commit diff, see xml_diff_dirty */
+    xml_flag_set(x1t, xml_flag(x0t, XML_FLAG_DIRTY|XML_FLAG_DIRTYRM));
     xml_spec_set(x1t, xml_spec(x0t));
     
     if (xlen < 1000){
@@ -1062,8 +1370,10 @@ xmldb_get_zerocopy(clicon_handle    h,
          * No, argument against: we may want to have a semantically wrong file and wish to edit?
          */
         de0.de_xml = x0t;
-        if (de)
+        if (de){
             de0.de_id = de->de_id;
+            de0.de_dirty = de->de_dirty;
+        }
         clicon_db_elmnt_set(h, db, &de0);
     } /* x0t == NULL */
     else
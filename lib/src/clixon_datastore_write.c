@@ -83,6 +83,7 @@
 #include "clixon_datastore.h"
 #include "clixon_datastore_write.h"
 #include "clixon_datastore_read.h"
+#include "clixon_datastore_journal.h"
 
 /*! Given an attribute name and its expected namespace, find its value
  * 
@@ -288,6 +289,7 @@ check_when_condition(cxobj              *x0p,
     int       retval = -1;
     char      *xpath = NULL;
     cvec      *nsc = NULL;
+    xpath_tree *xpt;
     int        nr;
     yang_stmt *y = NULL;
     cbuf      *cberr = NULL;
@@ -296,13 +298,15 @@ check_when_condition(cxobj              *x0p,
     if ((y = y0) != NULL ||
         (y = (yang_stmt*)xml_spec(x1)) != NULL){
         if ((xpath = yang_when_xpath_get(y)) != NULL){ 
+            if ((xpt = yang_when_xpath_tree_get(y)) == NULL)
+                goto done;
             nsc = yang_when_nsc_get(y);
             x1p = xml_parent(x1);
-            if ((nr = xpath_vec_bool(x1p, nsc, "%s", xpath)) < 0) /* Try request */
+            if ((nr = xpath_tree_vec_bool(x1p, nsc, xpt)) < 0) /* Try request */
                 goto done;
             if (nr == 0){
                 /* Try existing tree */
-                if ((nr = xpath_vec_bool(x0p, nsc, "%s", xpath)) < 0)
+                if ((nr = xpath_tree_vec_bool(x0p, nsc, xpt)) < 0)
                     goto done;
                 if (nr == 0){
                     if ((cberr = cbuf_new()) == NULL){
@@ -415,6 +419,7 @@ choice_delete_other(cxobj     *x0,
         }
         /* Check if x0/y0 is part of other choice/case than y1 recursively , if so purge */
         if (choice_is_other(y0c, y0case, y0choice, y1c, y1case, y1choice) == 1){
+            xml_dirty_mark(x0, 1);
             if (xml_purge(x0c) < 0)
                 goto done;
             x0c = x0prev;
@@ -592,6 +597,7 @@ text_modify(clicon_handle       h,
                  * original object is not reverted.
                  */
                 if (x0){
+                    xml_dirty_mark(x0p, 1);
                     xml_purge(x0);
                     x0 = NULL;
                 }
@@ -681,14 +687,30 @@ text_modify(clicon_handle       h,
                         if (ret == 0)
                             goto fail;
                     }
+#ifdef XML_EXPLICIT_INDEX
+                    /* Search index vectors are sorted on value: remove before changing the
+                     * value and insert after */
+                    if (xml_search_index_p(x0) && xml_search_child_rm(x0p, x0) < 0)
+                        goto done;
+#endif
                     if (xml_value_set(x0b, x1bstr) < 0)
                         goto done;
+#ifdef XML_EXPLICIT_INDEX
+                    if (xml_search_index_p(x0)){
+                        if (xml_cv_set(x0, NULL) < 0)
+                            goto done;
+                        if (xml_search_child_insert(x0p, x0) < 0)
+                            goto done;
+                    }
+#endif
                     /* If a default value ies replaced, then reset default flag */
                     if (xml_flag(x0, XML_FLAG_DEFAULT))
                         xml_flag_reset(x0, XML_FLAG_DEFAULT);
                 }
             } /* x1bstr */
             if (changed){ 
+                if (insert != INS_LAST) /* ordered-by user: siblings re-ordered */
+                    xml_dirty_mark(x0p, 1);
                 if (xml_insert(x0p, x0, insert, valstr, NULL) < 0) 
                     goto done;
             }
@@ -711,8 +733,10 @@ text_modify(clicon_handle       h,
                 /* Purge if x1 value is NULL(match-all) or both values are equal */
                 if ((x1bstr == NULL) ||
                     ((x0bstr=xml_body(x0)) != NULL && strcmp(x0bstr, x1bstr)==0)){
+                    xml_dirty_mark(x0p, 1);
                     if (xml_purge(x0) < 0)
                         goto done;
+                    x0 = NULL;
                 }
                 else {
                     if (op == OP_DELETE){
@@ -788,6 +812,7 @@ text_modify(clicon_handle       h,
                  * original object is not reverted.
                  */
                 if (x0){
+                    xml_dirty_mark(x0p, 1);
                     xml_purge(x0);
                     x0 = NULL;
                 }
@@ -811,12 +836,16 @@ text_modify(clicon_handle       h,
                     permit = 1;
                 }
                 if (x0){
+                    xml_dirty_mark(x0p, 1);
                     xml_purge(x0);
                 }
                 if ((x0 = xml_new(x1name, x0p, CX_ELMNT)) == NULL)
                     goto done;
                 if (xml_copy(x1, x0) < 0)
                     goto done;
+                /* Opaque data is compared in its entirety, see xml_diff_dirty */
+                xml_apply0(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_set,
+                           (void*)(XML_FLAG_DIRTY|XML_FLAG_DIRTYRM));
                 break;
             } /* anyxml, anydata */
             if (x0==NULL){
@@ -936,6 +965,8 @@ text_modify(clicon_handle       h,
 #ifdef XML_PARENT_CANDIDATE
                 xml_parent_candidate_set(x0, NULL);
 #endif
+                if (insert != INS_LAST) /* ordered-by user: siblings re-ordered */
+                    xml_dirty_mark(x0p, 1);
                 if (xml_insert(x0p, x0, insert, keystr, nscx1) < 0)
                     goto done;
             }
@@ -954,8 +985,10 @@ text_modify(clicon_handle       h,
                     if (ret == 0)
                         goto fail;
                 }
+                xml_dirty_mark(x0p, 1);
                 if (xml_purge(x0) < 0)
                     goto done;
+                x0 = NULL;
             }
             break;
         default:
@@ -976,6 +1009,9 @@ text_modify(clicon_handle       h,
         free(createstr);
     if (nscx1)
         xml_nsctx_free(nscx1);
+    /* Mark edited node and its ancestors for commit, see xml_diff_dirty */
+    if (x0 && xml_parent(x0))
+        xml_dirty_mark(x0, 0);
     /* Remove dangling added objects */
     if (changed && x0 && xml_parent(x0)==NULL)
         xml_purge(x0);
@@ -1051,6 +1087,7 @@ text_modify_top(clicon_handle       h,
                         goto fail;
                     permit = 1;
                 }
+                xml_dirty_mark(x0t, 1);
                 while ((x0c = xml_child_i(x0t, 0)) != 0)
                     if (xml_purge(x0c) < 0)
                         goto done;
@@ -1091,6 +1128,7 @@ text_modify_top(clicon_handle       h,
                 goto fail;
             permit = 1;
         }
+        xml_dirty_mark(x0t, 1);
         while ((x0c = xml_child_i(x0t, 0)) != 0)
             if (xml_purge(x0c) < 0)
                 goto done;
@@ -1127,6 +1165,7 @@ text_modify_top(clicon_handle       h,
             goto done;
         if (x0c && (yc != xml_spec(x0c))){
             /* There is a match but is should be replaced (choice)*/
+            xml_dirty_mark(x0t, 1);
             if (xml_purge(x0c) < 0)
                 goto done;
             x0c = NULL;
@@ -1152,6 +1191,176 @@ text_modify_top(clicon_handle       h,
     goto done;
 } /* text_modify_top */
 
+/*! Modify an in-memory datastore tree given an xml tree and an operation
+ *
+ * Apply modification, then remove NONE nodes and global defaults. Common for xmldb_put
+ * and datastore journal replay.
+ * @param[in]  h        Clixon handle
+ * @param[in]  x0       Datastore tree, top-level config
+ * @param[in]  op       Top-level operation, can be superceded by other op in tree
+ * @param[in]  x1       Modification tree, top-level config
+ * @param[in]  yspec    Top-level yang spec
+ * @param[in]  username User name for nacm
+ * @param[in]  xnacm    NACM XML tree, root should be "nacm"
+ * @param[in]  permit   If set, no NACM tests using xnacm required
+ * @param[out] cbret    Initialized cligen buffer. On exit contains XML if retval == 0
+ * @retval     1        OK
+ * @retval     0        Failed, cbret contains error xml message
+ * @retval    -1        Error
+ * @see xmldb_put
+ */
+int
+xmldb_put_tree(clicon_handle       h,
+               cxobj              *x0,
+               enum operation_type op,
+               cxobj              *x1,
+               yang_stmt          *yspec,
+               char               *username,
+               cxobj              *xnacm,
+               int                 permit,
+               cbuf               *cbret)
+{
+    int retval = -1;
+    int ret;
+
+    /* Here assume if xnacm is set and !permit do NACM */
+    clicon_data_del(h, "objectexisted");
+    /* 
+     * Modify base tree x with modification x1. This is where the
+     * new tree is made.
+     */
+    if ((ret = text_modify_top(h, x0, x1, yspec, op, username, xnacm, permit, cbret)) < 0)
+        goto done;
+    /* If xml return - ie netconf error xml tree, then stop and return OK */
+    if (ret == 0)
+        goto fail;
+    /* Remove NONE nodes if all subs recursively are also NONE */
+    if (xml_tree_prune_flagged_sub(x0, XML_FLAG_NONE, 0, NULL) <0)
+        goto done;
+    if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, 
+                  (void*)(XML_FLAG_NONE|XML_FLAG_MARK)) < 0)
+        goto done;
+    /* Remove global defaults and empty non-presence containers */
+    if (xml_defaults_nopresence(x0, 2) < 0)
+        goto done;
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Write datastore tree to file including module state
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  x0      Datastore tree, top-level config
+ * @param[in]  f       Open file
+ */
+static int
+xmldb_write_file(clicon_handle h,
+                 cxobj        *x0,
+                 FILE         *f)
+{
+    int    retval = -1;
+    cxobj *x;
+    cxobj *xmodst = NULL;
+    char  *format;
+    int    pretty;
+
+    /* Add module revision info before writing to file)
+     * Only if CLICON_XMLDB_MODSTATE is set
+     */
+    if ((x = clicon_modst_cache_get(h, 1)) != NULL){
+        if ((xmodst = xml_dup(x)) == NULL)
+            goto done;
+        if (xml_addsub(x0, xmodst) < 0)
+            goto done;
+    }
+    if ((format = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) == NULL){
+        clicon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
+        goto done;
+    }
+    pretty = clicon_option_bool(h, "CLICON_XMLDB_PRETTY");
+    if (strcmp(format,"json")==0){
+        if (clixon_json2file(f, x0, pretty, fprintf, 0, 0) < 0)
+            goto done;
+    }
+    else if (clixon_xml2file(f, x0, 0, pretty, fprintf, 0, 0) < 0)
+        goto done;
+    retval = 0;
+ done:
+    /* Remove modules state after writing to file
+     */
+    if (xmodst && xml_purge(xmodst) < 0)
+        retval = -1;
+    return retval;
+}
+
+/*! Write datastore snapshot file atomically and remove its journal
+ *
+ * Write to a temporary file, sync it and rename it to the datastore file. If a temporary
+ * file cannot be created, eg due to directory permissions, re-write the file in place.
+ * @param[in]  h       Clixon handle
+ * @param[in]  x0      Datastore tree, top-level config
+ * @param[in]  dbfile  Datastore file
+ * @see xmldb_journal_append
+ */
+int
+xmldb_write_snapshot(clicon_handle h,
+                     cxobj        *x0,
+                     const char   *dbfile)
+{
+    int    retval = -1;
+    cbuf  *cb = NULL;
+    char  *tmpfile;
+    FILE  *f = NULL;
+    int    inplace = 0;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s.tmp", dbfile);
+    tmpfile = cbuf_get(cb);
+    if ((f = fopen(tmpfile, "w")) == NULL){
+        if (errno != EACCES){
+            clicon_err(OE_CFG, errno, "Creating file %s", tmpfile);
+            goto done;
+        }
+        inplace++;
+        if ((f = fopen(dbfile, "w")) == NULL){
+            clicon_err(OE_CFG, errno, "Creating file %s", dbfile);
+            goto done;
+        }
+    }
+    if (xmldb_write_file(h, x0, f) < 0)
+        goto done;
+    if (fflush(f) != 0 || fsync(fileno(f)) < 0){
+        clicon_err(OE_UNIX, errno, "fsync");
+        goto done;
+    }
+    if (fclose(f) != 0){
+        f = NULL;
+        clicon_err(OE_UNIX, errno, "fclose");
+        goto done;
+    }
+    f = NULL;
+    if (!inplace && rename(tmpfile, dbfile) < 0){
+        clicon_err(OE_UNIX, errno, "rename(%s)", tmpfile);
+        goto done;
+    }
+    if (xmldb_journal_reset(dbfile) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (f != NULL)
+        fclose(f);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! Modify database given an xml tree and an operation
  *
  * @param[in]  h      CLICON handle
@@ -1193,14 +1402,12 @@ xmldb_put(clicon_handle       h,
     db_elmnt   *de = NULL;
     int         ret;
     cxobj      *xnacm = NULL;
-    cxobj      *xmodst = NULL;
-    cxobj      *x;
     int         permit = 0; /* nacm permit all */
-    char       *format;
     cvec       *nsc = NULL; /* nacm namespace context */
     int         firsttime = 0;
-    int         pretty;
     cxobj      *xerr = NULL;
+    int         journal;
+    cbuf       *cbrec = NULL;
 
     if (cbret == NULL){
         clicon_err(OE_XML, EINVAL, "cbret is NULL");
@@ -1215,6 +1422,13 @@ xmldb_put(clicon_handle       h,
                    xml_name(x1), NETCONF_INPUT_CONFIG);
         goto done;
     }
+    /* Copy cache if shared with other datastore before modifying it */
+    if (xmldb_cache_unshare(h, db) < 0)
+        goto done;
+    /* Edits marked in other datastores are relative to the old running */
+    if (strcmp(db, "running") == 0 &&
+        xmldb_dirty_reset(h) < 0)
+        goto done;
     if ((de = clicon_db_elmnt_get(h, db)) != NULL){
         if (clicon_datastore_cache(h) != DATASTORE_NOCACHE)
             x0 = de->de_xml; /* XXX flag is not XML_FLAG_TOP */
@@ -1244,13 +1458,17 @@ xmldb_put(clicon_handle       h,
     xnacm = clicon_nacm_cache(h);
     permit = (xnacm==NULL);
 
-    /* Here assume if xnacm is set and !permit do NACM */
-    clicon_data_del(h, "objectexisted");
-    /* 
-     * Modify base tree x with modification x1. This is where the
-     * new tree is made.
-     */
-    if ((ret = text_modify_top(h, x0, x1, yspec, op, username, xnacm, permit, cbret)) < 0)
+    /* Serialize edit for journal before it is applied */
+    journal = clicon_option_bool(h, "CLICON_XMLDB_JOURNAL") && op != OP_REPLACE;
+    if (journal){
+        if ((cbrec = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        if (xmldb_journal_record(cbrec, x1) < 0)
+            goto done;
+    }
+    if ((ret = xmldb_put_tree(h, x0, op, x1, yspec, username, xnacm, permit, cbret)) < 0)
         goto done;
     /* If xml return - ie netconf error xml tree, then stop and return OK */
     if (ret == 0){
@@ -1261,16 +1479,6 @@ xmldb_put(clicon_handle       h,
         }
         goto fail;
     }
-
-    /* Remove NONE nodes if all subs recursively are also NONE */
-    if (xml_tree_prune_flagged_sub(x0, XML_FLAG_NONE, 0, NULL) <0)
-        goto done;
-    if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, 
-                  (void*)(XML_FLAG_NONE|XML_FLAG_MARK)) < 0)
-        goto done;
-    /* Remove global defaults and empty non-presence containers */
-    if (xml_defaults_nopresence(x0, 2) < 0)
-        goto done;
 #if 0 /* debug */
     if (xml_apply0(x0, -1, xml_sort_verify, NULL) < 0)
         clicon_log(LOG_NOTICE, "%s: verify failed #3", __FUNCTION__);
@@ -1292,36 +1500,34 @@ xmldb_put(clicon_handle       h,
         clicon_err(OE_XML, 0, "dbfile NULL");
         goto done;
     }
-    /* Add module revision info before writing to file)
-     * Only if CLICON_XMLDB_MODSTATE is set
-     */
-    if ((x = clicon_modst_cache_get(h, 1)) != NULL){
-        if ((xmodst = xml_dup(x)) == NULL)
+    if (journal){
+        /* Append edit to journal, or compact journal into a new snapshot */
+        if ((ret = xmldb_journal_append(h, dbfile, op, cbrec)) < 0)
             goto done;
-        if (xml_addsub(x0, xmodst) < 0)
+        if (ret == 0 && xmldb_write_snapshot(h, x0, dbfile) < 0)
             goto done;
     }
-    if ((format = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) == NULL){
-        clicon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
-        goto done;
+    else if (clicon_option_bool(h, "CLICON_XMLDB_JOURNAL")){
+        /* Replace: journal is no better than a new snapshot */
+        if (xmldb_write_snapshot(h, x0, dbfile) < 0)
+            goto done;
     }
-    if ((f = fopen(dbfile, "w")) == NULL){
-        clicon_err(OE_CFG, errno, "Creating file %s", dbfile);
-        goto done;
-    } 
-    pretty = clicon_option_bool(h, "CLICON_XMLDB_PRETTY");
-    if (strcmp(format,"json")==0){
-        if (clixon_json2file(f, x0, pretty, fprintf, 0, 0) < 0)
+    else {
+        if ((f = fopen(dbfile, "w")) == NULL){
+            clicon_err(OE_CFG, errno, "Creating file %s", dbfile);
+            goto done;
+        } 
+        if (xmldb_write_file(h, x0, f) < 0)
+            goto done;
+        /* A journal left from journal mode is included in the new file */
+        if (xmldb_journal_reset(dbfile) < 0)
             goto done;
     }
-    else if (clixon_xml2file(f, x0, 0, pretty, fprintf, 0, 0) < 0)
-        goto done;
-    /* Remove modules state after writing to file
-     */
-    if (xmodst && xml_purge(xmodst) < 0)
-        goto done;
     retval = 1;
  done:
+    /* Policies compiled during the edit are from the NACM tree before it */
+    if (strcmp(db, "running") == 0)
+        nacm_policy_invalidate();
     if (f != NULL)
         fclose(f);
     if (xerr)
@@ -1332,6 +1538,8 @@ xmldb_put(clicon_handle       h,
         free(dbfile);
     if (cb)
         cbuf_free(cb);
+    if (cbrec)
+        cbuf_free(cbrec);
     if (x0 && clicon_datastore_cache(h) == DATASTORE_NOCACHE)
         xml_free(x0);
     return retval;
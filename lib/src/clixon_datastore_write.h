@@ -45,6 +45,9 @@
 /*
  * Prototypes
  */
+int xmldb_put_tree(clicon_handle h, cxobj *x0, enum operation_type op, cxobj *x1, yang_stmt *yspec,
+                   char *username, cxobj *xnacm, int permit, cbuf *cbret);
+int xmldb_write_snapshot(clicon_handle h, cxobj *x0, const char *dbfile);
 int xmldb_put(clicon_handle h, const char *db, enum operation_type op, cxobj *xt, char *username, cbuf *cbret);
 
 #endif /* _CLIXON_DATASTORE_WRITE_H */
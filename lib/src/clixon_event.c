@@ -50,8 +50,12 @@
 #include <string.h>
 #include <signal.h>
 #include <syslog.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#ifdef HAVE_EPOLL_CREATE1
+#include <sys/epoll.h>
+#endif
 
 #include <cligen/cligen.h>
 
@@ -69,15 +73,30 @@
  */
 #define EVENT_STRLEN 32
 
+/* Initial size of fd table, grows by doubling */
+#define EVENT_FDTAB_INIT 64
+
+/* Initial size of timer heap, grows by doubling */
+#define EVENT_HEAP_INIT 16
+
+/* Max number of events returned from one epoll_wait */
+#define EVENT_EPOLL_MAX 64
+
+/* Internal fd flag: fd cannot be polled (eg regular file) and is always ready */
+#define CLIXON_EVENT_NOPOLL 0x100
+
 /*
  * Types
  */
 struct event_data{
-    struct event_data *e_next;     /* next in list */
+    struct event_data *e_next;     /* next in per-fd list */
     int (*e_fn)(int, void*);            /* function */
     enum {EVENT_FD, EVENT_TIME} e_type;        /* type of event */
     int e_fd;                      /* File descriptor */
+    int e_flags;                   /* CLIXON_EVENT_* flags, fd events only */
+    uint64_t e_gen;                /* Registration generation, fd events only */
     struct timeval e_time;         /* Timeout */
+    int e_index;                   /* Position in timer heap, timer events only */
     void *e_arg;                   /* function argument */
     char e_string[EVENT_STRLEN];             /* string for debugging */
 };
@@ -86,12 +105,29 @@ struct event_data{
  * Internal variables
  * XXX consider use handle variables instead of global
  */
-static struct event_data *ee = NULL;
-static struct event_data *ee_timers = NULL;
+/* File descriptor events indexed by fd. Each slot is a list of callbacks on that fd */
+static struct event_data **ee_fds = NULL;
+static int ee_fdlen = 0;     /* Allocated length of ee_fds */
+static int ee_fdmax = -1;    /* Highest registered fd */
 
-/* Set if element in ee is deleted (clixon_event_unreg_fd). Check in ee loops */
+/* Timer events as a binary min-heap ordered by e_time, root is next to expire */
+static struct event_data **ee_timers = NULL;
+static int ee_timerlen = 0;  /* Number of timers in heap */
+static int ee_timermax = 0;  /* Allocated length of heap */
+
+/* Incremented on each fd registration. Events in a dispatch round registered after the
+ * round started are skipped (the fd may have been closed and reused by a callback) */
+static uint64_t _ee_gen = 0;
+
+/* Incremented when an fd event is deleted (clixon_event_unreg_fd). Check in dispatch */
 static int _ee_unreg = 0;
 
+#ifdef HAVE_EPOLL_CREATE1
+static int   _ee_epfd = -1;  /* epoll instance */
+static pid_t _ee_eppid = 0;  /* Process that created epoll instance, re-create after fork */
+static int   _ee_nopoll = 0; /* Number of fds that cannot be polled, see CLIXON_EVENT_NOPOLL */
+#endif
+
 /* If set (eg by signal handler) exit select loop on next run and return 0 */
 static int _clicon_exit = 0;
 
@@ -161,6 +197,87 @@ clicon_sig_ignore_get(void)
     return _clicon_sig_ignore;
 }
 
+/*! Make room for fd in the fd table
+ * @param[in]  fd  File descriptor
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+event_fdtab_grow(int fd)
+{
+    struct event_data **tab;
+    int                 len;
+
+    if (fd < ee_fdlen)
+        return 0;
+    len = ee_fdlen?ee_fdlen:EVENT_FDTAB_INIT;
+    while (len <= fd)
+        len *= 2;
+    if ((tab = realloc(ee_fds, len*sizeof(struct event_data *))) == NULL){
+        clicon_err(OE_EVENTS, errno, "realloc");
+        return -1;
+    }
+    memset(&tab[ee_fdlen], 0, (len-ee_fdlen)*sizeof(struct event_data *));
+    ee_fds = tab;
+    ee_fdlen = len;
+    return 0;
+}
+
+#ifdef HAVE_EPOLL_CREATE1
+/*! Add, modify or delete fd in epoll instance
+ * @param[in]  op    EPOLL_CTL_ADD, EPOLL_CTL_MOD or EPOLL_CTL_DEL
+ * @param[in]  fd    File descriptor
+ * @param[in]  flags CLIXON_EVENT_* flags
+ */
+static int
+event_epoll_ctl(int op,
+                int fd,
+                int flags)
+{
+    struct epoll_event ev = {0,};
+
+    ev.events = EPOLLIN;
+    if (flags & CLIXON_EVENT_EDGE)
+        ev.events |= EPOLLET;
+    ev.data.fd = fd;
+    return epoll_ctl(_ee_epfd, op, fd, &ev);
+}
+
+/*! Create epoll instance if not done, or re-create it in a forked child
+ * The epoll interest list is shared between parent and child after fork, so a child
+ * that continues to run the event loop needs its own instance with the inherited fds.
+ */
+static int
+event_epoll_init(void)
+{
+    int    retval = -1;
+    pid_t  pid;
+    int    fd;
+
+    pid = getpid();
+    if (_ee_epfd != -1 && _ee_eppid == pid)
+        return 0;
+    if (_ee_epfd != -1)
+        close(_ee_epfd);
+    if ((_ee_epfd = epoll_create1(EPOLL_CLOEXEC)) < 0){
+        clicon_err(OE_EVENTS, errno, "epoll_create1");
+        goto done;
+    }
+    _ee_eppid = pid;
+    for (fd = 0; fd <= ee_fdmax; fd++){
+        if (ee_fds[fd] == NULL || (ee_fds[fd]->e_flags & CLIXON_EVENT_NOPOLL))
+            continue;
+        if (event_epoll_ctl(EPOLL_CTL_ADD, fd, ee_fds[fd]->e_flags) < 0){
+            clicon_err(OE_EVENTS, errno, "epoll_ctl %s", ee_fds[fd]->e_string);
+            goto done;
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+#endif /* HAVE_EPOLL_CREATE1 */
+
 /*! Register a callback function to be called on input on a file descriptor.
  *
  * @param[in]  fd  File descriptor
@@ -172,6 +289,7 @@ clicon_sig_ignore_get(void)
  * }
  * clixon_event_reg_fd(fd, fn, (void*)42, "call fn on input on fd");
  * @endcode 
+ * @see clixon_event_reg_fd_flags  For edge-triggered mode
  * @see clixon_event_unreg_fd
  */
 int
@@ -180,11 +298,48 @@ clixon_event_reg_fd(int   fd,
                     void *arg, 
                     char *str)
 {
-    struct event_data *e;
+    return clixon_event_reg_fd_flags(fd, fn, arg, str, 0);
+}
 
+/*! Register a callback function on a file descriptor with mode flags
+ *
+ * @param[in]  fd    File descriptor
+ * @param[in]  fn    Function to call when input available on fd
+ * @param[in]  arg   Argument to function fn
+ * @param[in]  str   Describing string for logging
+ * @param[in]  flags CLIXON_EVENT_EDGE: edge-triggered, else level-triggered
+ * In edge-triggered mode fn is only called when new input arrives, and must therefore read
+ * until EAGAIN on a non-blocking fd. Edge mode requires epoll, otherwise it is ignored.
+ * The mode of an fd is set by its first registration, later registrations on the same fd
+ * inherit it.
+ * @see clixon_event_reg_fd
+ */
+int
+clixon_event_reg_fd_flags(int   fd, 
+                          int (*fn)(int, void*), 
+                          void *arg, 
+                          char *str,
+                          int   flags)
+{
+    int                retval = -1;
+    struct event_data *e = NULL;
+
+    if (str == NULL || fn == NULL || fd < 0){
+        clicon_err(OE_CFG, EINVAL, "str or fn is NULL or fd is negative");
+        goto done;
+    }
+#ifndef HAVE_EPOLL_CREATE1
+    if (fd >= FD_SETSIZE){
+        clicon_err(OE_EVENTS, EINVAL, "fd %d >= FD_SETSIZE", fd);
+        goto done;
+    }
+    flags &= ~CLIXON_EVENT_EDGE;
+#endif
+    if (event_fdtab_grow(fd) < 0)
+        goto done;
     if ((e = (struct event_data *)malloc(sizeof(struct event_data))) == NULL){
         clicon_err(OE_EVENTS, errno, "malloc");
-        return -1;
+        goto done;
     }
     memset(e, 0, sizeof(struct event_data));
     strncpy(e->e_string, str, EVENT_STRLEN-1);
@@ -192,16 +347,44 @@ clixon_event_reg_fd(int   fd,
     e->e_fn = fn;
     e->e_arg = arg;
     e->e_type = EVENT_FD;
-    e->e_next = ee;
-    ee = e;
-    clicon_debug(CLIXON_DBG_DETAIL, "%s, registering %s", __FUNCTION__, e->e_string);
-    return 0;
+    e->e_gen = ++_ee_gen;
+    if (ee_fds[fd] != NULL)
+        e->e_flags = ee_fds[fd]->e_flags;
+    else{
+        e->e_flags = flags & CLIXON_EVENT_EDGE;
+#ifdef HAVE_EPOLL_CREATE1
+        if (event_epoll_init() < 0)
+            goto done;
+        if (event_epoll_ctl(EPOLL_CTL_ADD, fd, e->e_flags) < 0){
+            /* Regular files cannot be polled but are always readable (as in select) */
+            if (errno != EPERM){
+                clicon_err(OE_EVENTS, errno, "epoll_ctl %s", str);
+                goto done;
+            }
+            e->e_flags |= CLIXON_EVENT_NOPOLL;
+            _ee_nopoll++;
+        }
+#endif
+    }
+    e->e_next = ee_fds[fd];
+    ee_fds[fd] = e;
+    if (fd > ee_fdmax)
+        ee_fdmax = fd;
+    e = NULL;
+    clicon_debug(CLIXON_DBG_DETAIL, "%s, registering %s", __FUNCTION__, str);
+    retval = 0;
+ done:
+    if (e)
+        free(e);
+    return retval;
 }
 
 /*! Deregister a file descriptor callback
  * @param[in]  s   File descriptor
  * @param[in]  fn  Function to call when input available on fd
  * Note: deregister when exactly function and socket match, not argument
+ * Note: deregister before closing s, since the fd may otherwise remain in the epoll set if 
+ * it is shared with another process
  * @see clixon_event_reg_fd
  * @see clixon_event_unreg_timeout
  */
@@ -212,20 +395,108 @@ clixon_event_unreg_fd(int   s,
     struct event_data *e, **e_prev;
     int found = 0;
 
-    e_prev = &ee;
-    for (e = ee; e; e = e->e_next){
-        if (fn == e->e_fn && s == e->e_fd) {
+    if (s < 0 || s > ee_fdmax)
+        return -1;
+    e_prev = &ee_fds[s];
+    for (e = ee_fds[s]; e; e = e->e_next){
+        if (fn == e->e_fn) {
             found++;
             *e_prev = e->e_next;
             _ee_unreg++;
+#ifdef HAVE_EPOLL_CREATE1
+            /* Last callback on fd, remove from epoll. Ignore errors, fd may be closed */
+            if (ee_fds[s] == NULL){
+                if (e->e_flags & CLIXON_EVENT_NOPOLL)
+                    _ee_nopoll--;
+                else if (_ee_epfd != -1 && _ee_eppid == getpid())
+                    (void)event_epoll_ctl(EPOLL_CTL_DEL, s, e->e_flags);
+            }
+#endif
             free(e);
             break;
         }
         e_prev = &e->e_next;
     }
+    while (ee_fdmax >= 0 && ee_fds[ee_fdmax] == NULL)
+        ee_fdmax--;
     return found?0:-1;
 }
 
+/*! Compare two timers, ties are broken by registration order
+ */
+static int
+event_timer_lt(struct event_data *e0,
+               struct event_data *e1)
+{
+    if (timercmp(&e0->e_time, &e1->e_time, !=))
+        return timercmp(&e0->e_time, &e1->e_time, <);
+    return e0->e_gen < e1->e_gen;
+}
+
+/*! Set timer at heap position i
+ */
+static void
+event_heap_set(int                i,
+               struct event_data *e)
+{
+    ee_timers[i] = e;
+    e->e_index = i;
+}
+
+/*! Move timer at position i up in heap until heap property holds
+ */
+static void
+event_heap_up(int i)
+{
+    struct event_data *e = ee_timers[i];
+    int                parent;
+
+    while (i > 0){
+        parent = (i-1)/2;
+        if (!event_timer_lt(e, ee_timers[parent]))
+            break;
+        event_heap_set(i, ee_timers[parent]);
+        i = parent;
+    }
+    event_heap_set(i, e);
+}
+
+/*! Move timer at position i down in heap until heap property holds
+ */
+static void
+event_heap_down(int i)
+{
+    struct event_data *e = ee_timers[i];
+    int                child;
+
+    while ((child = 2*i+1) < ee_timerlen){
+        if (child+1 < ee_timerlen && event_timer_lt(ee_timers[child+1], ee_timers[child]))
+            child++;
+        if (!event_timer_lt(ee_timers[child], e))
+            break;
+        event_heap_set(i, ee_timers[child]);
+        i = child;
+    }
+    event_heap_set(i, e);
+}
+
+/*! Remove timer at position i from heap, the timer is not freed
+ */
+static struct event_data *
+event_heap_remove(int i)
+{
+    struct event_data *e = ee_timers[i];
+
+    ee_timerlen--;
+    if (i < ee_timerlen){
+        event_heap_set(i, ee_timers[ee_timerlen]);
+        event_heap_up(i);
+        event_heap_down(ee_timers[i]->e_index);
+    }
+    ee_timers[ee_timerlen] = NULL;
+    return e;
+}
+
 /*! Call a callback function at an absolute time
  *
  * @param[in]  t   Absolute (not relative!) timestamp when callback is called
@@ -256,13 +527,22 @@ clixon_event_reg_timeout(struct timeval t,
 {
     int                 retval = -1;
     struct event_data  *e;
-    struct event_data  *e1;
-    struct event_data **e_prev;
+    struct event_data **heap;
+    int                 len;
 
     if (str == NULL || fn == NULL){
         clicon_err(OE_CFG, EINVAL, "str or fn is NULL");
         goto done;
     }
+    if (ee_timerlen == ee_timermax){
+        len = ee_timermax?2*ee_timermax:EVENT_HEAP_INIT;
+        if ((heap = realloc(ee_timers, len*sizeof(struct event_data *))) == NULL){
+            clicon_err(OE_EVENTS, errno, "realloc");
+            goto done;
+        }
+        ee_timers = heap;
+        ee_timermax = len;
+    }
     if ((e = (struct event_data *)malloc(sizeof(struct event_data))) == NULL){
         clicon_err(OE_EVENTS, errno, "malloc");
         return -1;
@@ -273,15 +553,10 @@ clixon_event_reg_timeout(struct timeval t,
     e->e_arg = arg;
     e->e_type = EVENT_TIME;
     e->e_time = t;
-    /* Sort into right place */
-    e_prev = &ee_timers;
-    for (e1=ee_timers; e1; e1=e1->e_next){
-        if (timercmp(&e->e_time, &e1->e_time, <))
-            break;
-        e_prev = &e1->e_next;
-    }
-    e->e_next = e1;
-    *e_prev = e;
+    e->e_gen = ++_ee_gen;
+    /* Insert last in heap and sift up into right place */
+    event_heap_set(ee_timerlen++, e);
+    event_heap_up(e->e_index);
     clicon_debug(CLIXON_DBG_DETAIL, "%s: %s", __FUNCTION__, str); 
     retval = 0;
  done:
@@ -292,6 +567,7 @@ clixon_event_reg_timeout(struct timeval t,
  * Note: deregister when exactly function and function arguments match, not time. So you
  * cannot have same function and argument callback on different timeouts. This is a little
  * different from clixon_event_unreg_fd.
+ * If there are several matches, the one that expires first is removed.
  * @param[in]  fn   Function to call at time t
  * @param[in]  arg  Argument to function fn
  * @retval     0    OK, timeout unregistered
@@ -303,20 +579,20 @@ int
 clixon_event_unreg_timeout(int (*fn)(int, void*), 
                            void *arg)
 {
-    struct event_data *e, **e_prev;
-    int found = 0;
-
-    e_prev = &ee_timers;
-    for (e = ee_timers; e; e = e->e_next){
-        if (fn == e->e_fn && arg == e->e_arg) {
-            found++;
-            *e_prev = e->e_next;
-            free(e);
-            break;
-        }
-        e_prev = &e->e_next;
+    struct event_data *e;
+    struct event_data *ef = NULL;
+    int                i;
+
+    for (i = 0; i < ee_timerlen; i++){
+        e = ee_timers[i];
+        if (fn == e->e_fn && arg == e->e_arg &&
+            (ef == NULL || event_timer_lt(e, ef)))
+            ef = e;
     }
-    return found?0:-1;
+    if (ef == NULL)
+        return -1;
+    free(event_heap_remove(ef->e_index));
+    return 0;
 }
 
 /*! Poll to see if there is any data available on this file descriptor.
@@ -329,18 +605,107 @@ int
 clixon_event_poll(int fd)
 {
     int            retval = -1;
-    fd_set         fdset;
-    struct timeval tnull = {0,};
+    struct pollfd  pfd = {0,};
 
-    FD_ZERO(&fdset);
-    FD_SET(fd, &fdset);
-    if ((retval = select(FD_SETSIZE, &fdset, NULL, NULL, &tnull)) < 0)
-        clicon_err(OE_EVENTS, errno, "select");
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    if ((retval = poll(&pfd, 1, 0)) < 0)
+        clicon_err(OE_EVENTS, errno, "poll");
     return retval;
 }
 
+/*! Call all callbacks registered on a file descriptor
+ * @param[in]  fd   File descriptor that has input
+ * @param[in]  gen  Only call callbacks registered before this generation
+ * @retval     0    OK
+ * @retval    -1    Error in callback
+ * If a callback unregisters any event, remaining callbacks on this fd are called next round
+ */
+static int
+event_fd_dispatch(int      fd,
+                  uint64_t gen)
+{
+    struct event_data *e;
+    struct event_data *e_next;
+    int                unreg;
+
+    if (fd > ee_fdmax)
+        return 0;
+    for (e = ee_fds[fd]; e; e = e_next){
+        e_next = e->e_next;
+        if (e->e_gen > gen) /* Registered in this round, may be a reused fd */
+            continue;
+        clicon_debug(CLIXON_DBG_DETAIL, "%s: FD_ISSET: %s", __FUNCTION__, e->e_string);
+        unreg = _ee_unreg;
+        if ((*e->e_fn)(e->e_fd, e->e_arg) < 0){
+            clicon_debug(1, "%s Error in: %s", __FUNCTION__, e->e_string);
+            return -1;
+        }
+        if (_ee_unreg != unreg)
+            break;
+    }
+    return 0;
+}
+
+/*! Wait for file descriptor input or timeout
+ * @param[out] fds   Vector of fds with input, length EVENT_EPOLL_MAX (epoll) or ee_fdmax+1
+ * @param[in]  tp    Timeout or NULL for no timeout
+ * @retval     n     Number of fds in fds
+ * @retval    -1     Error, errno set
+ */
+static int
+event_wait(int            *fds,
+           struct timeval *tp)
+{
+    int                n;
+    int                fd;
+#ifdef HAVE_EPOLL_CREATE1
+    struct epoll_event events[EVENT_EPOLL_MAX];
+    int                nready = 0;
+    int                timeout = -1;
+    int                i;
+
+    if (event_epoll_init() < 0){
+        errno = EINVAL;
+        return -1;
+    }
+    /* Fds that cannot be polled are always ready */
+    for (fd = 0; _ee_nopoll && fd <= ee_fdmax; fd++)
+        if (ee_fds[fd] && (ee_fds[fd]->e_flags & CLIXON_EVENT_NOPOLL) && nready < EVENT_EPOLL_MAX/2)
+            fds[nready++] = fd;
+    if (nready)
+        timeout = 0;
+    else if (tp){ /* Round up to ms to not wake up before timer expires */
+        if (tp->tv_sec >= INT32_MAX/1000)
+            timeout = INT32_MAX;
+        else
+            timeout = tp->tv_sec*1000 + (tp->tv_usec+999)/1000;
+    }
+    if ((n = epoll_wait(_ee_epfd, events, EVENT_EPOLL_MAX - nready, timeout)) < 0)
+        return -1;
+    for (i=0; i<n; i++)
+        fds[nready++] = events[i].data.fd;
+    return nready;
+#else
+    fd_set fdset;
+    
+    FD_ZERO(&fdset);
+    for (fd = 0; fd <= ee_fdmax; fd++)
+        if (ee_fds[fd])
+            FD_SET(fd, &fdset);
+    if ((n = select(FD_SETSIZE, &fdset, NULL, NULL, tp)) <= 0)
+        return n;
+    n = 0;
+    for (fd = 0; fd <= ee_fdmax; fd++)
+        if (ee_fds[fd] && FD_ISSET(fd, &fdset))
+            fds[n++] = fd;
+    return n;
+#endif
+}
+
 /*! Dispatch file descriptor events (and timeouts) by invoking callbacks.
  *
+ * Uses epoll if available, otherwise select.
  * @param[in] h  Clixon handle
  * @retval    0  OK
  * @retval   -1  Error: eg select, callback, timer, 
@@ -352,35 +717,46 @@ int
 clixon_event_loop(clicon_handle h)
 {
     struct event_data *e;
-    struct event_data *e_next;
     int                n;
+    int                i;
     struct timeval     t;
     struct timeval     t0;
     struct timeval     tnull = {0,};
-    fd_set             fdset;
     int                retval = -1;
+    int               *fds = NULL;
+    int                fdslen = 0;
+    uint64_t           gen;
 
     while (clixon_exit_get() != 1){
-        FD_ZERO(&fdset);
         if (clicon_sig_child_get()){
             /* Go through processes and wait for child processes */
             if (clixon_process_waitpid(h) < 0)
                 goto err;
             clicon_sig_child_set(0);
         }
-        for (e=ee; e; e=e->e_next)
-            if (e->e_type == EVENT_FD)
-                FD_SET(e->e_fd, &fdset);
-        if (ee_timers != NULL){
+#ifdef HAVE_EPOLL_CREATE1
+        n = EVENT_EPOLL_MAX;
+#else
+        n = ee_fdmax+1;
+#endif
+        if (fdslen < n){
+            if ((fds = realloc(fds, n*sizeof(int))) == NULL){
+                clicon_err(OE_EVENTS, errno, "realloc");
+                goto err;
+            }
+            fdslen = n;
+        }
+        gen = _ee_gen;
+        if (ee_timerlen > 0){
             gettimeofday(&t0, NULL);
-            timersub(&ee_timers->e_time, &t0, &t); 
+            timersub(&ee_timers[0]->e_time, &t0, &t); 
             if (t.tv_sec < 0)
-                n = select(FD_SETSIZE, &fdset, NULL, NULL, &tnull); 
+                n = event_wait(fds, &tnull); 
             else
-                n = select(FD_SETSIZE, &fdset, NULL, NULL, &t); 
+                n = event_wait(fds, &t); 
         }
         else
-            n = select(FD_SETSIZE, &fdset, NULL, NULL, NULL);
+            n = event_wait(fds, NULL);
         if (clixon_exit_get() == 1){
             break;
         }
@@ -419,9 +795,8 @@ clixon_event_loop(clicon_handle h)
                 clicon_err(OE_EVENTS, errno, "select");
             goto err;
         }
-        if (n==0){ /* Timeout */
-            e = ee_timers;
-            ee_timers = ee_timers->e_next;
+        if (n==0 && ee_timerlen > 0){ /* Timeout */
+            e = event_heap_remove(0);
             clicon_debug(CLIXON_DBG_DETAIL, "%s timeout: %s", __FUNCTION__, e->e_string);
             if ((*e->e_fn)(0, e->e_arg) < 0){
                 free(e);
@@ -429,23 +804,12 @@ clixon_event_loop(clicon_handle h)
             }
             free(e);
         }
-        _ee_unreg = 0;
-        for (e=ee; e; e=e_next){
+        for (i=0; i<n; i++){
             if (clixon_exit_get() == 1){
                 break;
             }
-            e_next = e->e_next;
-            if(e->e_type == EVENT_FD && FD_ISSET(e->e_fd, &fdset)){
-                clicon_debug(CLIXON_DBG_DETAIL, "%s: FD_ISSET: %s", __FUNCTION__, e->e_string);
-                if ((*e->e_fn)(e->e_fd, e->e_arg) < 0){
-                    clicon_debug(1, "%s Error in: %s", __FUNCTION__, e->e_string);
-                    goto err;
-                }
-                if (_ee_unreg){
-                    _ee_unreg = 0;
-                    break;
-                }
-            }
+            if (event_fd_dispatch(fds[i], gen) < 0)
+                goto err;
         }
         clixon_exit_decr(); /* If exit is set and > 1, decrement it (and exit when 1) */
         continue;
@@ -455,6 +819,8 @@ clixon_event_loop(clicon_handle h)
     }
     if (clixon_exit_get() == 1)
         retval = 0;
+    if (fds)
+        free(fds);
     clicon_debug(1, "%s done:%d", __FUNCTION__, retval);
     return retval;
 }
@@ -463,18 +829,33 @@ int
 clixon_event_exit(void)
 {
     struct event_data *e, *e_next;
+    int                fd;
+    int                i;
     
-    e_next = ee;
-    while ((e = e_next) != NULL){
-        e_next = e->e_next;
-        free(e);
-    }
-    ee = NULL;
-    e_next = ee_timers;
-    while ((e = e_next) != NULL){
-        e_next = e->e_next;
-        free(e);
+    for (fd = 0; fd <= ee_fdmax; fd++){
+        e_next = ee_fds[fd];
+        while ((e = e_next) != NULL){
+            e_next = e->e_next;
+            free(e);
+        }
     }
+    if (ee_fds)
+        free(ee_fds);
+    ee_fds = NULL;
+    ee_fdlen = 0;
+    ee_fdmax = -1;
+    for (i = 0; i < ee_timerlen; i++)
+        free(ee_timers[i]);
+    if (ee_timers)
+        free(ee_timers);
     ee_timers = NULL;
+    ee_timerlen = 0;
+    ee_timermax = 0;
+#ifdef HAVE_EPOLL_CREATE1
+    if (_ee_epfd != -1 && _ee_eppid == getpid())
+        close(_ee_epfd);
+    _ee_epfd = -1;
+    _ee_nopoll = 0;
+#endif
     return 0;
 }
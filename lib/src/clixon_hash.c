@@ -98,19 +98,152 @@
 #include "clixon_err.h"
 #include "clixon_hash.h"
 
-#define HASH_SIZE       1031    /* Number of hash buckets. Should be a prime */ 
+/*
+ * The hash table uses open addressing with linear probing. Slots contain a pointer to
+ * the (separately allocated) entry and the full hash value, so that entries and values
+ * keep their addresses when the table is resized.
+ * The table is doubled when the load exceeds HASH_LOAD_MAX/HASH_LOAD_DIV and halved
+ * when it falls below a quarter of that. Deletion shifts entries back instead of
+ * leaving tombstones.
+ * All entries are also kept in a list (h_qelem) in insertion order for iteration.
+ */
+#define HASH_SIZE_MIN   16      /* Initial and minimal number of slots, power of 2 */
+#define HASH_LOAD_MAX   3       /* Max load factor: HASH_LOAD_MAX/HASH_LOAD_DIV */
+#define HASH_LOAD_DIV   4
 #define align4(s) (((s)/4)*4 + 4)
 
-/*! A very simplistic algorithm to calculate a hash bucket index
+/*! Hash table slot
+ */
+struct hash_slot{
+    uint64_t      hs_hash;     /* Full hash value of key */
+    clicon_hash_t hs_entry;    /* Entry, or NULL if slot is empty */
+};
+
+/*! Hash table, the clicon_hash_t * handle of the API points to this struct
  */
-static uint32_t
-hash_bucket(const char *str)
+struct hash_table{
+    struct hash_slot *ht_slots;  /* Vector of slots */
+    size_t            ht_size;   /* Number of slots, power of 2 */
+    size_t            ht_nr;     /* Number of entries */
+    clicon_hash_t     ht_list;   /* All entries in insertion order */
+};
+
+#define hash_table_get(hash) ((struct hash_table *)(hash))
+
+/* 64-bit multiplicative constants (from xxHash64) */
+#define HASH_P1 0x9E3779B185EBCA87ULL
+#define HASH_P2 0xC2B2AE3D27D4EB4FULL
+#define HASH_P3 0x165667B19E3779F9ULL
+
+static inline uint64_t
+hash_rotl(uint64_t x,
+          int      r)
 {
-    uint32_t n = 0;
+    return (x << r) | (x >> (64 - r));
+}
 
-    while(*str)
-        n += (uint32_t)*str++;
-    return n % HASH_SIZE;
+/*! Mix 64 bits of key into hash state
+ */
+static inline uint64_t
+hash_round(uint64_t h,
+           uint64_t k)
+{
+    k *= HASH_P2;
+    k = hash_rotl(k, 31);
+    k *= HASH_P1;
+    h ^= k;
+    return hash_rotl(h, 27) * HASH_P1 + HASH_P3;
+}
+
+/*! Compute 64-bit hash value of a string key
+ *
+ * Reads the key 8 bytes at a time, inspired by xxHash64 including its final avalanche,
+ * so that all bits of the result depend on all bytes of the key.
+ * @param[in]  key  Zero-terminated string
+ * @retval     h    Hash value
+ */
+static uint64_t
+hash_string(const char *key)
+{
+    size_t   len = strlen(key);
+    uint64_t h = HASH_P3 + len;
+    uint64_t k;
+    size_t   i;
+
+    for (i = 0; i + 8 <= len; i += 8){
+        memcpy(&k, key + i, 8);
+        h = hash_round(h, k);
+    }
+    if (i < len){
+        k = 0;
+        memcpy(&k, key + i, len - i);
+        h = hash_round(h, k);
+    }
+    h ^= h >> 33;
+    h *= HASH_P2;
+    h ^= h >> 29;
+    h *= HASH_P3;
+    h ^= h >> 32;
+    return h;
+}
+
+/*! Find slot of key, or the empty slot where it should be inserted
+ * @param[in]  ht    Hash table
+ * @param[in]  key   Key
+ * @param[in]  hv    Hash value of key
+ * @retval     i     Slot index
+ */
+static size_t
+hash_slot_find(struct hash_table *ht,
+               const char        *key,
+               uint64_t           hv)
+{
+    size_t            mask = ht->ht_size - 1;
+    size_t            i;
+    struct hash_slot *hs;
+
+    for (i = hv & mask; ; i = (i + 1) & mask){
+        hs = &ht->ht_slots[i];
+        if (hs->hs_entry == NULL)
+            break;
+        if (hs->hs_hash == hv && strcmp(hs->hs_entry->h_key, key) == 0)
+            break;
+    }
+    return i;
+}
+
+/*! Re-allocate slot vector with a new size and re-insert all entries
+ * @param[in]  ht    Hash table
+ * @param[in]  size  New number of slots, power of 2 and larger than number of entries
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+hash_resize(struct hash_table *ht,
+            size_t             size)
+{
+    struct hash_slot *old = ht->ht_slots;
+    size_t            oldsize = ht->ht_size;
+    size_t            i;
+    size_t            j;
+
+    if ((ht->ht_slots = calloc(size, sizeof(struct hash_slot))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        ht->ht_slots = old;
+        return -1;
+    }
+    ht->ht_size = size;
+    for (i = 0; i < oldsize; i++){
+        if (old[i].hs_entry == NULL)
+            continue;
+        for (j = old[i].hs_hash & (size - 1);
+             ht->ht_slots[j].hs_entry != NULL;
+             j = (j + 1) & (size - 1))
+            ;
+        ht->ht_slots[j] = old[i];
+    }
+    free(old);
+    return 0;
 }
 
 /*! Initialize hash table.
@@ -122,14 +255,20 @@ hash_bucket(const char *str)
 clicon_hash_t *
 clicon_hash_init(void)
 {
-  clicon_hash_t *hash;
-
-  if ((hash = (clicon_hash_t *)malloc(sizeof(clicon_hash_t) * HASH_SIZE)) == NULL){
-      clicon_err(OE_UNIX, errno, "malloc");
-      return NULL;
-  }
-  memset(hash, 0, sizeof(clicon_hash_t)*HASH_SIZE);
-  return hash;
+    struct hash_table *ht;
+
+    if ((ht = malloc(sizeof(*ht))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(ht, 0, sizeof(*ht));
+    if ((ht->ht_slots = calloc(HASH_SIZE_MIN, sizeof(struct hash_slot))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        free(ht);
+        return NULL;
+    }
+    ht->ht_size = HASH_SIZE_MIN;
+    return (clicon_hash_t *)ht;
 }
 
 /*! Free hash table.
@@ -141,18 +280,18 @@ clicon_hash_init(void)
 int
 clicon_hash_free(clicon_hash_t *hash)
 {
-    int i;
-    clicon_hash_t tmp;
-    for (i = 0; i < HASH_SIZE; i++) {
-        while (hash[i]) {
-            tmp = hash[i];
-            DELQ(tmp, hash[i], clicon_hash_t);
-            free(tmp->h_key);
-            free(tmp->h_val);
-            free(tmp);
-        }
+    struct hash_table *ht = hash_table_get(hash);
+    clicon_hash_t      h;
+
+    while ((h = ht->ht_list) != NULL) {
+        DELQ(h, ht->ht_list, clicon_hash_t);
+        free(h->h_key);
+        if (h->h_val)
+            free(h->h_val);
+        free(h);
     }
-    free(hash);
+    free(ht->ht_slots);
+    free(ht);
     return 0;
 }
 
@@ -167,19 +306,9 @@ clicon_hash_t
 clicon_hash_lookup(clicon_hash_t *hash, 
                    const char    *key)
 {
-    uint32_t      bkt;
-    clicon_hash_t h;
+    struct hash_table *ht = hash_table_get(hash);
 
-    bkt = hash_bucket(key);
-    h = hash[bkt];
-    if (h) {
-        do {
-            if (!strcmp(h->h_key, key))
-                return h;
-            h = NEXTQ(clicon_hash_t, h);
-        } while (h != hash[bkt]);
-    }
-    return NULL;
+    return ht->ht_slots[hash_slot_find(ht, key, hash_string(key))].hs_entry;
 }
 
 /*! Get value of hash
@@ -225,23 +354,35 @@ clicon_hash_add(clicon_hash_t *hash,
                 void          *val, 
                 size_t         vlen)
 {
-    void         *newval = NULL;
-    clicon_hash_t h;
-    clicon_hash_t new = NULL;
+    struct hash_table *ht;
+    void              *newval = NULL;
+    clicon_hash_t      h;
+    clicon_hash_t      new = NULL;
+    uint64_t           hv;
+    size_t             i;
     
     if (hash == NULL){
         clicon_err(OE_UNIX, EINVAL, "hash is NULL");
         return NULL;
     }
+    ht = hash_table_get(hash);
     /* Check NULL case */
     if ((val == NULL && vlen != 0) ||
         (val != NULL && vlen == 0)){
         clicon_err(OE_UNIX, EINVAL, "Mismatch in value and length, only one is zero");
         goto catch;
     }
+    hv = hash_string(key);
+    i = hash_slot_find(ht, key, hv);
     /* If variable exist, don't allocate a new. just replace value */
-    h = clicon_hash_lookup(hash, key);
+    h = ht->ht_slots[i].hs_entry;
     if (h == NULL) {
+        /* Grow before insert so that there is always an empty slot */
+        if ((ht->ht_nr + 1) * HASH_LOAD_DIV > ht->ht_size * HASH_LOAD_MAX){
+            if (hash_resize(ht, ht->ht_size * 2) < 0)
+                goto catch;
+            i = hash_slot_find(ht, key, hv);
+        }
         if ((new = (clicon_hash_t)malloc(sizeof(*new))) == NULL){
             clicon_err(OE_UNIX, errno, "malloc");
             goto catch;
@@ -273,10 +414,13 @@ clicon_hash_add(clicon_hash_t *hash,
     h->h_val = newval;
     h->h_vlen =  vlen;
 
-    /* Add to list only if new variable */
-    if (new)
-        INSQ(h, hash[hash_bucket(key)]);
-
+    /* Add to table and list only if new variable */
+    if (new){
+        ht->ht_slots[i].hs_hash = hv;
+        ht->ht_slots[i].hs_entry = h;
+        ht->ht_nr++;
+        ADDQ(h, ht->ht_list);
+    }
     return h;
 
 catch:
@@ -301,27 +445,50 @@ int
 clicon_hash_del(clicon_hash_t *hash, 
                 const char    *key)
 {
-    clicon_hash_t h;
+    struct hash_table *ht;
+    clicon_hash_t      h;
+    size_t             mask;
+    size_t             i;
+    size_t             j;
+    size_t             k;
 
     if (hash == NULL){
         clicon_err(OE_UNIX, EINVAL, "hash is NULL");
         return -1;
     }
-    h = clicon_hash_lookup(hash, key);
-    if (h == NULL)
+    ht = hash_table_get(hash);
+    mask = ht->ht_size - 1;
+    i = hash_slot_find(ht, key, hash_string(key));
+    if ((h = ht->ht_slots[i].hs_entry) == NULL)
         return -1;
-    
-    DELQ(h, hash[hash_bucket(key)], clicon_hash_t);
-  
+    /* Shift back following entries of the probe sequence that may not be found otherwise */
+    for (j = (i + 1) & mask; ht->ht_slots[j].hs_entry != NULL; j = (j + 1) & mask){
+        k = ht->ht_slots[j].hs_hash & mask; /* Home slot of entry j */
+        /* Move j to i unless its home slot k is cyclically in (i, j] */
+        if ((j > i && (k <= i || k > j)) ||
+            (j < i && (k <= i && k > j))){
+            ht->ht_slots[i] = ht->ht_slots[j];
+            i = j;
+        }
+    }
+    ht->ht_slots[i].hs_entry = NULL;
+    ht->ht_slots[i].hs_hash = 0;
+    ht->ht_nr--;
+    DELQ(h, ht->ht_list, clicon_hash_t);
     free(h->h_key);
-    free(h->h_val);
+    if (h->h_val)
+        free(h->h_val);
     free(h);
-
+    /* Shrink if sparse, failure is not an error */
+    if (ht->ht_size > HASH_SIZE_MIN &&
+        ht->ht_nr * HASH_LOAD_DIV * 4 < ht->ht_size * HASH_LOAD_MAX)
+        hash_resize(ht, ht->ht_size / 2);
     return 0;
 }
 
 /*! Return vector of keys in hash table
  *
+ * Keys are returned in insertion order
  * @param[in]   hash    Hash table
  * @param[out]  vector  Vector of keys, NULL if not found
  * @param[out]  nkeys   Size of key vector
@@ -334,32 +501,27 @@ clicon_hash_keys(clicon_hash_t *hash,
                  char        ***vector,
                  size_t        *nkeys)
 {
-    int           retval = -1;
-    int           bkt;
-    clicon_hash_t h;
-    char        **tmp;
-    char        **keys = NULL;
+    int                retval = -1;
+    struct hash_table *ht;
+    clicon_hash_t      h;
+    char             **keys = NULL;
 
     if (hash == NULL){
         clicon_err(OE_UNIX, EINVAL, "hash is NULL");
         return -1;
     }
+    ht = hash_table_get(hash);
     *nkeys = 0;
-    for (bkt = 0; bkt < HASH_SIZE; bkt++) {
-        h = hash[bkt];
+    if (ht->ht_nr &&
+        (keys = malloc(ht->ht_nr * sizeof(char *))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto catch;
+    }
+    if ((h = ht->ht_list) != NULL){
         do {
-            if (h == NULL)
-                break;
-            tmp = realloc(keys, ((*nkeys)+1) * sizeof(char *));
-            if (tmp == NULL){
-                clicon_err(OE_UNIX, errno, "realloc");
-                goto catch;
-            }
-            keys = tmp;
-            keys[*nkeys] = h->h_key;
-            (*nkeys)++;
+            keys[(*nkeys)++] = h->h_key;
             h = NEXTQ(clicon_hash_t, h);
-        } while (h != hash[bkt]);
+        } while (h != ht->ht_list);
     }
     if (vector){
         *vector = keys;
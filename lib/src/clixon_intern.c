@@ -0,0 +1,327 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2020-2023 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+ *
+ * Interned strings
+ * A process-wide table of reference counted strings. An interned string is stored once and
+ * all users of the same string share the same pointer, so that two interned strings are
+ * equal if and only if their pointers are equal.
+ * Used for XML node names and prefixes, which are few distinct strings repeated in many nodes.
+ * The table is an open-addressing hash table with linear probing.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <string.h>
+#include <stddef.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_intern.h"
+
+/* Initial number of slots in table, power of 2 */
+#define INTERN_SLOTS_MIN 1024
+
+/*! Interned string with header
+ * The interned string pointer points to is_str, the header is found by offset
+ */
+struct intern_sym{
+    uint32_t is_ref;    /* Reference count, UINT32_MAX is permanent */
+    uint32_t is_hash;   /* Hash value of string */
+    char     is_str[];  /* NULL-terminated string */
+};
+typedef struct intern_sym intern_sym;
+
+/*
+ * Variables
+ */
+static intern_sym **_intern_tab = NULL;  /* Slots, NULL is empty */
+static size_t       _intern_slots = 0;   /* Number of slots, power of 2 */
+static size_t       _intern_nr = 0;      /* Number of interned strings */
+static size_t       _intern_size = 0;    /* Allocated bytes of interned strings */
+
+/*! Get interned string header from string
+ */
+static intern_sym *
+intern_sym_get(const char *str)
+{
+    return (intern_sym *)(str - offsetof(intern_sym, is_str));
+}
+
+/*! FNV-1a hash of string
+ * @param[in]  str   String
+ * @param[out] len   String length
+ */
+static uint32_t
+intern_hash(const char *str,
+            size_t     *len)
+{
+    uint32_t h = 2166136261u;
+    const unsigned char *s = (const unsigned char *)str;
+
+    while (*s){
+        h ^= *s++;
+        h *= 16777619u;
+    }
+    *len = (const char*)s - str;
+    return h;
+}
+
+/*! Find slot of string, either where it is or the empty slot where it should be
+ */
+static size_t
+intern_slot(const char *str,
+            uint32_t    h)
+{
+    size_t      mask = _intern_slots - 1;
+    size_t      i;
+    intern_sym *is;
+
+    for (i = h & mask; (is = _intern_tab[i]) != NULL; i = (i + 1) & mask)
+        if (is->is_hash == h && strcmp(is->is_str, str) == 0)
+            break;
+    return i;
+}
+
+/*! Resize table to given number of slots and rehash
+ */
+static int
+intern_resize(size_t slots)
+{
+    intern_sym **tab0 = _intern_tab;
+    size_t       slots0 = _intern_slots;
+    size_t       i;
+    size_t       j;
+    intern_sym  *is;
+
+    if ((_intern_tab = calloc(slots, sizeof(intern_sym *))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        _intern_tab = tab0;
+        return -1;
+    }
+    _intern_slots = slots;
+    for (i=0; i<slots0; i++){
+        if ((is = tab0[i]) == NULL)
+            continue;
+        for (j = is->is_hash & (slots-1); _intern_tab[j]; j = (j + 1) & (slots-1))
+            ;
+        _intern_tab[j] = is;
+    }
+    if (tab0)
+        free(tab0);
+    return 0;
+}
+
+/*! Intern a string and return the shared copy with one more reference
+ *
+ * @param[in]  str   String
+ * @retval     istr  Interned string, release with clixon_intern_release
+ * @retval     NULL  Error
+ * @code
+ *   char *name;
+ *   if ((name = clixon_intern("interface")) == NULL)
+ *      err;
+ *   ...
+ *   clixon_intern_release(name);
+ * @endcode
+ * @note Do not modify or free the returned string
+ */
+char *
+clixon_intern(const char *str)
+{
+    uint32_t    h;
+    size_t      len;
+    size_t      i;
+    intern_sym *is;
+
+    if (str == NULL){
+        clicon_err(OE_UNIX, EINVAL, "str is NULL");
+        return NULL;
+    }
+    if (_intern_tab == NULL && intern_resize(INTERN_SLOTS_MIN) < 0)
+        return NULL;
+    h = intern_hash(str, &len);
+    i = intern_slot(str, h);
+    if ((is = _intern_tab[i]) != NULL){
+        if (is->is_ref != UINT32_MAX)
+            is->is_ref++;
+        return is->is_str;
+    }
+    /* Keep load below 3/4 */
+    if ((_intern_nr+1)*4 > _intern_slots*3){
+        if (intern_resize(_intern_slots*2) < 0)
+            return NULL;
+        i = intern_slot(str, h);
+    }
+    if ((is = malloc(sizeof(*is) + len + 1)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    is->is_ref = 1;
+    is->is_hash = h;
+    memcpy(is->is_str, str, len + 1);
+    _intern_tab[i] = is;
+    _intern_nr++;
+    _intern_size += sizeof(*is) + len + 1;
+    return is->is_str;
+}
+
+/*! Intern a string permanently, it is not freed until clixon_intern_exit
+ *
+ * Used for strings known in advance, such as YANG node identifiers, so that XML nodes with
+ * those names do not allocate or free interned strings
+ * @param[in]  str   String
+ * @retval     istr  Interned string
+ * @retval     NULL  Error
+ */
+char *
+clixon_intern_permanent(const char *str)
+{
+    char *istr;
+
+    if ((istr = clixon_intern(str)) == NULL)
+        return NULL;
+    intern_sym_get(istr)->is_ref = UINT32_MAX;
+    return istr;
+}
+
+/*! Find an interned string without adding a reference
+ *
+ * Use to replace a string comparison loop with pointer comparisons
+ * @param[in]  str   String
+ * @retval     istr  Interned string
+ * @retval     NULL  Not interned, no interned string is equal to str
+ */
+char *
+clixon_intern_find(const char *str)
+{
+    uint32_t    h;
+    size_t      len;
+    intern_sym *is;
+
+    if (str == NULL || _intern_tab == NULL)
+        return NULL;
+    h = intern_hash(str, &len);
+    if ((is = _intern_tab[intern_slot(str, h)]) == NULL)
+        return NULL;
+    return is->is_str;
+}
+
+/*! Release a reference of an interned string, free it if it was the last
+ *
+ * @param[in]  istr  Interned string, as returned by clixon_intern
+ * @retval     0     OK
+ */
+int
+clixon_intern_release(char *istr)
+{
+    intern_sym *is;
+    size_t      mask;
+    size_t      i;
+    size_t      j;
+    size_t      k;
+
+    if (istr == NULL || _intern_tab == NULL)
+        return 0;
+    is = intern_sym_get(istr);
+    if (is->is_ref == UINT32_MAX || --is->is_ref > 0)
+        return 0;
+    /* Remove from table with backward shift deletion */
+    mask = _intern_slots - 1;
+    for (i = is->is_hash & mask; _intern_tab[i] != is; i = (i + 1) & mask)
+        ;
+    j = i;
+    while (1){
+        j = (j + 1) & mask;
+        if (_intern_tab[j] == NULL)
+            break;
+        k = _intern_tab[j]->is_hash & mask;
+        /* Move j to i if its home slot k is not cyclically in (i, j] */
+        if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+            continue;
+        _intern_tab[i] = _intern_tab[j];
+        i = j;
+    }
+    _intern_tab[i] = NULL;
+    _intern_nr--;
+    _intern_size -= sizeof(*is) + strlen(istr) + 1;
+    free(is);
+    return 0;
+}
+
+/*! Get statistics of interned strings
+ *
+ * @param[out] nr    Number of interned strings
+ * @param[out] sz    Allocated memory of strings and table
+ * @retval     0     OK
+ */
+int
+clixon_intern_stats(uint64_t *nr,
+                    size_t   *sz)
+{
+    if (nr)
+        *nr = _intern_nr;
+    if (sz)
+        *sz = _intern_size + _intern_slots*sizeof(intern_sym *);
+    return 0;
+}
+
+/*! Free all interned strings, eg at exit
+ *
+ * @note All interned strings are freed also if they are referenced. Call after all XML trees
+ * are freed.
+ */
+void
+clixon_intern_exit(void)
+{
+    size_t i;
+
+    if (_intern_tab == NULL)
+        return;
+    for (i=0; i<_intern_slots; i++)
+        if (_intern_tab[i])
+            free(_intern_tab[i]);
+    free(_intern_tab);
+    _intern_tab = NULL;
+    _intern_slots = 0;
+    _intern_nr = 0;
+    _intern_size = 0;
+}
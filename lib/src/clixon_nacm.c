@@ -104,15 +104,391 @@ match_access(char *access_operations,
     return 0;
 }
 
+/*---------------------------------------------------------------
+ * Compiled NACM policy
+ */
+
+/* Number of NACM access operations, see enum nacm_access */
+#define NACM_ACCESS_NR (NACM_EXEC+1)
+
+/* Compiled NACM rule, copied from a rule in the NACM XML tree
+ * The XML tree is a copy made per request, see nacm_access_pre, so no pointers into
+ * it are kept.
+ */
+struct nacm_rule{
+    char        *nr_module;   /* module-name, NULL if not set */
+    char        *nr_rpc;      /* rpc-name, NULL if not set */
+    char        *nr_path;     /* Trimmed path, NULL if not set */
+    int          nr_notif;    /* notification-name is set */
+    int          nr_access;   /* Bitmask of access operations, bit is enum nacm_access */
+    int          nr_deny;     /* action is deny */
+    int          nr_permit;   /* action is permit */
+    int          nr_resolved; /* 0: path not parsed, 1: nr_cplist set, -1: path not bound to YANG */
+    clixon_path *nr_cplist;   /* Path parsed and bound to YANG on first data node access */
+    yang_stmt   *nr_ytarget;  /* YANG node of path */
+    int          nr_keyed;    /* Path has key or position predicates, match depends on instance */
+};
+typedef struct nacm_rule nacm_rule;
+
+/* Compiled NACM policy of a user
+ * The rules of all rule-lists matching the groups of the user, in order, and bucketed
+ * by access operation. Built on first access of a user and kept until the NACM
+ * configuration changes, see nacm_policy_invalidate
+ */
+struct nacm_policy{
+    qelem_t     np_q;         /* List header */
+    char       *np_username;  /* User name */
+    int         np_groups;    /* Number of groups of user */
+    nacm_rule  *np_rules;     /* All rules of user in order */
+    int         np_len;       /* Length of np_rules */
+    nacm_rule **np_access[NACM_ACCESS_NR];    /* Rules per access operation in order */
+    int         np_accesslen[NACM_ACCESS_NR]; /* Length of np_access vectors */
+    clicon_hash_t *np_ydec;   /* Read decisions per YANG node, see nacm_ydec_get */
+};
+typedef struct nacm_policy nacm_policy;
+
+/* Read access decision of a YANG data node, see nacm_ydec_get
+ * The rules are the read rules that may match a data node of the YANG node, in order.
+ * A rule with a keyed path matches only if the data node is in an instance of the path,
+ * other rules always match, and are last.
+ */
+struct nacm_ydec{
+    nacm_rule **yd_rules; /* Read rules that may match, in order */
+    int         yd_len;   /* Length of yd_rules */
+    int         yd_skip;  /* No rule matches this YANG node or any descendant */
+};
+typedef struct nacm_ydec nacm_ydec;
+
+/* Compiled policies of all users, see nacm_policy_get */
+static nacm_policy *_nacm_policy_list = NULL;
+
+/*! Free a compiled NACM policy
+ */
+static int
+nacm_policy_free(nacm_policy *np)
+{
+    nacm_rule *nr;
+    nacm_ydec *yd;
+    char     **keys = NULL;
+    size_t     klen = 0;
+    int        i;
+
+    if (np->np_ydec){
+        if (clicon_hash_keys(np->np_ydec, &keys, &klen) < 0)
+            return -1;
+        for (i=0; i<klen; i++)
+            if ((yd = clicon_hash_value(np->np_ydec, keys[i], NULL)) != NULL &&
+                yd->yd_rules)
+                free(yd->yd_rules);
+        if (keys)
+            free(keys);
+        clicon_hash_free(np->np_ydec);
+    }
+    for (i=0; i<np->np_len; i++){
+        nr = &np->np_rules[i];
+        if (nr->nr_module)
+            free(nr->nr_module);
+        if (nr->nr_rpc)
+            free(nr->nr_rpc);
+        if (nr->nr_path)
+            free(nr->nr_path);
+        if (nr->nr_cplist)
+            clixon_path_free(nr->nr_cplist);
+    }
+    if (np->np_rules)
+        free(np->np_rules);
+    for (i=0; i<NACM_ACCESS_NR; i++)
+        if (np->np_access[i])
+            free(np->np_access[i]);
+    if (np->np_username)
+        free(np->np_username);
+    free(np);
+    return 0;
+}
+
+/*! Compile one NACM rule
+ * @param[in]  xrule  NACM rule XML tree
+ * @param[out] nr     Compiled rule
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+nacm_rule_compile(cxobj     *xrule,
+                  nacm_rule *nr)
+{
+    int    retval = -1;
+    char  *str;
+    cxobj *pathobj;
+    char  *access_operations;
+
+    if ((str = xml_find_body(xrule, "module-name")) != NULL &&
+        (nr->nr_module = strdup(str)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if ((str = xml_find_body(xrule, "rpc-name")) != NULL &&
+        (nr->nr_rpc = strdup(str)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if ((pathobj = xml_find_type(xrule, NULL, "path", CX_ELMNT)) != NULL){
+        if ((str = xml_body(pathobj)) == NULL)
+            str = "";
+        if ((nr->nr_path = strdup(clixon_trim2(str, " \t\n"))) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+    }
+    nr->nr_notif = xml_find_body(xrule, "notification-name") != NULL;
+    access_operations = xml_find_body(xrule, "access-operations");
+    if (match_access(access_operations, "read", NULL))
+        nr->nr_access |= 1 << NACM_READ;
+    if (match_access(access_operations, "create", "write"))
+        nr->nr_access |= 1 << NACM_CREATE;
+    if (match_access(access_operations, "update", "write"))
+        nr->nr_access |= 1 << NACM_UPDATE;
+    if (match_access(access_operations, "delete", "write"))
+        nr->nr_access |= 1 << NACM_DELETE;
+    if (match_access(access_operations, "exec", NULL))
+        nr->nr_access |= 1 << NACM_EXEC;
+    if ((str = xml_find_body(xrule, "action")) != NULL){
+        nr->nr_deny = strcmp(str, "deny") == 0;
+        nr->nr_permit = strcmp(str, "permit") == 0;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Compile the NACM policy of a user from the NACM XML tree
+ * @param[in]  username  User name
+ * @param[in]  xnacm     NACM xml tree
+ * @param[out] npp       Compiled policy, free with nacm_policy_free
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+nacm_policy_compile(char         *username,
+                    cxobj        *xnacm,
+                    nacm_policy **npp)
+{
+    int          retval = -1;
+    nacm_policy *np = NULL;
+    nacm_rule   *nr;
+    cvec        *nsc = NULL;
+    cxobj      **gvec = NULL; /* groups */
+    size_t       glen;
+    cxobj      **rlistvec = NULL; /* rule-list */
+    size_t       rlistlen;
+    cxobj      **rvec = NULL; /* rules */
+    size_t       rlen;
+    cxobj       *rlist;
+    char        *gname;
+    int          i;
+    int          j;
+    int          a;
+
+    if ((np = malloc(sizeof(*np))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(np, 0, sizeof(*np));
+    if ((np->np_username = strdup(username)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    /* Create namespace context for with nacm namespace as default */
+    if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
+        goto done;
+    /* User's group */
+    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+        goto done;
+    np->np_groups = glen;
+    if (glen == 0)
+        goto ok;
+    /* Rule-lists in the order they appear in the configuration */
+    if (xpath_vec(xnacm, nsc, "rule-list", &rlistvec, &rlistlen) < 0)
+        goto done;
+    for (i=0; i<rlistlen; i++){
+        rlist = rlistvec[i];
+        /* Loop through user's group to find match in this rule-list */
+        for (j=0; j<glen; j++){
+            gname = xml_find_body(gvec[j], "name");
+            if (xpath_first(rlist, nsc, ".[group='%s']", gname)!=NULL)
+                break; /* found */
+        }
+        if (j==glen) /* not found */
+            continue;
+        if (xpath_vec(rlist, nsc, "rule", &rvec, &rlen) < 0)
+            goto done;
+        if (rlen){
+            if ((np->np_rules = realloc(np->np_rules, (np->np_len+rlen)*sizeof(nacm_rule))) == NULL){
+                clicon_err(OE_UNIX, errno, "realloc");
+                goto done;
+            }
+            memset(&np->np_rules[np->np_len], 0, rlen*sizeof(nacm_rule));
+            for (j=0; j<rlen; j++)
+                if (nacm_rule_compile(rvec[j], &np->np_rules[np->np_len++]) < 0)
+                    goto done;
+        }
+        if (rvec){
+            free(rvec);
+            rvec = NULL;
+        }
+    }
+    /* Bucket rules by access operation */
+    for (a=0; a<NACM_ACCESS_NR; a++){
+        if (np->np_len == 0)
+            break;
+        if ((np->np_access[a] = calloc(np->np_len, sizeof(nacm_rule *))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        for (i=0; i<np->np_len; i++){
+            nr = &np->np_rules[i];
+            if (nr->nr_access & (1 << a))
+                np->np_access[a][np->np_accesslen[a]++] = nr;
+        }
+    }
+ ok:
+    *npp = np;
+    np = NULL;
+    retval = 0;
+ done:
+    if (np)
+        nacm_policy_free(np);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (gvec)
+        free(gvec);
+    if (rlistvec)
+        free(rlistvec);
+    if (rvec)
+        free(rvec);
+    return retval;
+}
+
+/*! Get compiled NACM policy of a user, compile it from the NACM tree if not found
+ * @param[in]  username  User name
+ * @param[in]  xnacm     NACM xml tree
+ * @param[out] npp       Compiled policy, direct pointer valid until nacm_policy_invalidate
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+nacm_policy_get(char         *username,
+                cxobj        *xnacm,
+                nacm_policy **npp)
+{
+    nacm_policy *np;
+
+    if ((np = _nacm_policy_list) != NULL)
+        do {
+            if (strcmp(np->np_username, username) == 0){
+                *npp = np;
+                return 0;
+            }
+            np = NEXTQ(nacm_policy *, np);
+        } while (np && np != _nacm_policy_list);
+    if (nacm_policy_compile(username, xnacm, &np) < 0)
+        return -1;
+    ADDQ(np, _nacm_policy_list);
+    *npp = np;
+    return 0;
+}
+
+/*! Free all compiled NACM policies, eg when the NACM configuration changes
+ *
+ * Policies are compiled again from the NACM tree on next access
+ * @retval     0    OK
+ * @see nacm_policy_changed
+ */
+int
+nacm_policy_invalidate(void)
+{
+    nacm_policy *np;
+
+    while ((np = _nacm_policy_list) != NULL){
+        DELQ(np, _nacm_policy_list, nacm_policy *);
+        nacm_policy_free(np);
+    }
+    return 0;
+}
+
+/*! Free all compiled NACM policies if the NACM configuration differs between two trees
+ *
+ * Used when a datastore tree replaces running, eg on commit
+ * @param[in]  x0     Old running tree, or NULL if not known
+ * @param[in]  x1     New running tree, or NULL if not known
+ * @param[in]  dirty  Edits of x1 relative to x0 are marked with XML_FLAG_DIRTY
+ * @retval     0      OK
+ * @see xmldb_dirty_get
+ */
+int
+nacm_policy_changed(cxobj *x0,
+                    cxobj *x1,
+                    int    dirty)
+{
+    cxobj *xn0;
+    cxobj *xn1;
+
+    if (_nacm_policy_list == NULL)
+        return 0;
+    if (x0 == NULL || x1 == NULL)
+        return nacm_policy_invalidate();
+    xn0 = xml_find_type(x0, NULL, "nacm", CX_ELMNT);
+    xn1 = xml_find_type(x1, NULL, "nacm", CX_ELMNT);
+    if (xn0 == xn1) /* Both NULL or shared tree */
+        return 0;
+    if (xn0 && xn1){
+        if (dirty && xml_flag(xn1, XML_FLAG_DIRTY) == 0)
+            return 0;
+        if (xml_tree_equal(xn0, xn1) == 0)
+            return 0;
+    }
+    return nacm_policy_invalidate();
+}
+
+/*! Get path of a compiled rule parsed and bound to YANG, parse it on first call
+ * @param[in]  nr     Compiled rule with path
+ * @param[in]  yspec  YANG spec
+ * @retval     1      OK, nr_cplist is set
+ * @retval     0      Path is not bound to YANG, the rule does not match any data node
+ * @retval    -1      Error
+ */
+static int
+nacm_rule_path(nacm_rule *nr,
+               yang_stmt *yspec)
+{
+    int          ret;
+    clixon_path *cp;
+    
+    if (nr->nr_resolved == 0){
+        if ((ret = clixon_instance_id_parse(yspec, &nr->nr_cplist, NULL, "%s", nr->nr_path)) < 0)
+            return -1;
+        nr->nr_resolved = ret ? 1 : -1;
+        /* Map path onto its YANG node */
+        if ((cp = nr->nr_cplist) != NULL)
+            do {
+                nr->nr_ytarget = cp->cp_yang;
+                if (cp->cp_cvk)
+                    nr->nr_keyed = 1;
+                cp = NEXTQ(clixon_path *, cp);
+            } while (cp && cp != nr->nr_cplist);
+    }
+    return nr->nr_resolved == 1;
+}
+
+/*---------------------------------------------------------------
+ * RPC
+ */
+
 /*! Match nacm single rule. Either match with access or deny. Or not match.
  * @param[in]  rpc    rpc name
  * @param[in]  module Yang module name
- * @param[in]  xrule  NACM rule XML tree
- * @param[out] cbret  Cligen buffer result. Set to an error msg if retval=0.
- * @retval -1  Error
- * @retval  0  Matching rule AND Not access and cbret set
- * @retval  1  Matching rule AND Access
- * @retval  2  No matching rule Goto step 10
+ * @param[in]  nr     Compiled NACM rule with exec access
+ * @retval  0  No matching rule
+ * @retval  1  Matching rule
  * @see RFC8341 3.4.4.  Incoming RPC Message Validation
  7.(cont) A rule matches if all of the following criteria are met: 
         *  The rule's "module-name" leaf is "*" or equals the name of
@@ -127,42 +503,29 @@ match_access(char *access_operations,
            has the special value "*".
  */
 static int
-nacm_rule_rpc(char         *rpc,
-              char         *module,
-              cxobj        *xrule)
+nacm_rule_rpc(char      *rpc,
+              char      *module,
+              nacm_rule *nr)
 {
-    int    retval = -1;
-    char  *module_rule; /* rule module name */
-    char  *rpc_rule;
-    char  *access_operations;
-    
     /*  7a) The rule's "module-name" leaf is "*" or equals the name of
         the YANG module where the protocol operation is defined. */
-    if ((module_rule = xml_find_body(xrule, "module-name")) == NULL)
-        goto nomatch;
-    if (strcmp(module_rule,"*") && strcmp(module_rule,module))
-        goto nomatch;
+    if (nr->nr_module == NULL)
+        return 0;
+    if (strcmp(nr->nr_module, "*") && strcmp(nr->nr_module, module))
+        return 0;
     /*  7b) Either (1) the rule does not have a "rule-type" defined or
         (2) the "rule-type" is "protocol-operation" and the
         "rpc-name" is "*" or equals the name of the requested
         protocol operation. */
-    if ((rpc_rule = xml_find_body(xrule, "rpc-name")) == NULL){
-        if (xml_find_body(xrule, "path") || xml_find_body(xrule, "notification-name"))
-            goto nomatch;
+    if (nr->nr_rpc == NULL){
+        if (nr->nr_path || nr->nr_notif)
+            return 0;
     }
-    if (rpc_rule && (strcmp(rpc_rule, "*") && strcmp(rpc_rule, rpc)))
-        goto nomatch;
+    else if (strcmp(nr->nr_rpc, "*") && strcmp(nr->nr_rpc, rpc))
+        return 0;
     /* 7c) The rule's "access-operations" leaf has the "exec" bit set or
-        has the special value "*". */
-    access_operations = xml_find_body(xrule, "access-operations");
-    if (!match_access(access_operations, "exec", NULL))
-        goto nomatch;
-    retval = 1;
- done:
-    return retval;
- nomatch:
-    retval = 0;
-    goto done;
+        has the special value "*": only rules with exec access are checked */
+    return 1;
 }
 
 /*! Process nacm incoming RPC message validation steps
@@ -185,25 +548,12 @@ nacm_rpc(char         *rpc,
          cxobj        *xnacm,
          cbuf         *cbret)
 {
-    int     retval = -1;
-    cxobj  *xrule;
-    cxobj **gvec = NULL; /* groups */
-    size_t  glen;
-    cxobj  *rlist;
-    cxobj **rlistvec = NULL; /* rule-list */
-    size_t  rlistlen;
-    cxobj **rvec = NULL; /* rules */
-    size_t  rlen;
-    int     i, j;
-    char   *exec_default = NULL;
-    char   *gname;
-    char   *action;
-    int     match= 0;
-    cvec   *nsc = NULL;
+    int          retval = -1;
+    nacm_policy *np;
+    nacm_rule   *nr = NULL;
+    int          i;
+    char        *exec_default = NULL;
     
-    /* Create namespace context for with nacm namespace as default */
-    if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
-        goto done;
     /* 3.   If the requested operation is the NETCONF <close-session>
        protocol operation, then the protocol operation is permitted.
     */
@@ -216,60 +566,33 @@ nacm_rpc(char         *rpc,
        transport layer.)               */
     if (username == NULL)
         goto step10;
-
-    /* User's group */
-    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+    /* User's groups and rules are compiled once per NACM configuration */
+    if (nacm_policy_get(username, xnacm, &np) < 0)
         goto done;
     /* 5. If no groups are found, continue with step 10. */
-    if (glen == 0)
+    if (np->np_groups == 0)
         goto step10;
     /* 6. Process all rule-list entries, in the order they appear in the
         configuration.  If a rule-list's "group" leaf-list does not
         match any of the user's groups, proceed to the next rule-list
-        entry. */
-    if (xpath_vec(xnacm, nsc, "rule-list", &rlistvec, &rlistlen) < 0)
-        goto done;
-    for (i=0; i<rlistlen; i++){
-        rlist = rlistvec[i];
-        /* Loop through user's group to find match in this rule-list */
-        for (j=0; j<glen; j++){
-            gname = xml_find_body(gvec[j], "name");
-            if (xpath_first(rlist, nsc, ".[group='%s']", gname)!=NULL)
-                break; /* found */
-        }
-        if (j==glen) /* not found */
-            continue;
-        /* 7. For each rule-list entry found, process all rules, in order,
-           until a rule that matches the requested access operation is
-           found. 
-        */
-        if (xpath_vec(rlist, nsc, "rule", &rvec, &rlen) < 0)
-            goto done;
-        for (j=0; j<rlen; j++){
-            xrule = rvec[j];
-            if ((match = nacm_rule_rpc(rpc, module, xrule)) < 0)
-                goto done;
-            if (match)
-                break;
-        }
-        if (match)
+        entry. 
+       7. For each rule-list entry found, process all rules, in order,
+          until a rule that matches the requested access operation is
+          found. 
+    */
+    for (i=0; i<np->np_accesslen[NACM_EXEC]; i++){
+        if (nacm_rule_rpc(rpc, module, np->np_access[NACM_EXEC][i]))
             break;
-        if (rvec){
-            free(rvec);
-            rvec=NULL;
-        }
     }
-    if (match){
-        if ((action = xml_find_body(xrule, "action")) == NULL)
-            goto step10;
-        if (strcmp(action, "deny")==0){
+    if (i < np->np_accesslen[NACM_EXEC]){
+        nr = np->np_access[NACM_EXEC][i];
+        if (nr->nr_deny){
             if (netconf_access_denied(cbret, "application", "access denied") < 0)
                 goto done;
             goto deny;
         }
-        else if (strcmp(action, "permit")==0)
+        else if (nr->nr_permit)
             goto permit;
-
     }
  step10:
     /*   10.  If the requested protocol operation is defined in a YANG module
@@ -296,14 +619,6 @@ nacm_rpc(char         *rpc,
     retval = 1;
  done:
     clicon_debug(1, "%s retval:%d (0:deny 1:permit)", __FUNCTION__, retval);
-    if (nsc)
-        xml_nsctx_free(nsc);
-    if (gvec)
-        free(gvec);
-    if (rlistvec)
-        free(rlistvec);
-    if (rvec)
-        free(rvec);
     return retval;
  deny: /* Here, cbret must contain a netconf error msg */
     assert(cbuf_len(cbret));
@@ -314,7 +629,7 @@ nacm_rpc(char         *rpc,
 /* Local struct for keeping preparation/compiled data in NACM data path code */
 struct prepvec{
     qelem_t       pv_q;
-    cxobj        *pv_xrule;
+    nacm_rule    *pv_rule;
     clixon_xvec  *pv_xpathvec;
 };
 typedef struct prepvec prepvec;
@@ -337,7 +652,7 @@ prepvec_free(prepvec *pv_list)
 
 prepvec *
 prepvec_add(prepvec  **pv_listp,
-            cxobj     *xrule)
+            nacm_rule *nr)
 {
     prepvec *pv;
 
@@ -347,7 +662,7 @@ prepvec_add(prepvec  **pv_listp,
     }
     memset(pv, 0, sizeof(*pv));
     ADDQ(pv, *pv_listp);
-    pv->pv_xrule = xrule;
+    pv->pv_rule = nr;
     if ((pv->pv_xpathvec = clixon_xvec_new()) == NULL)
         return NULL;
     return pv;
@@ -359,168 +674,111 @@ prepvec_add(prepvec  **pv_listp,
  *  - user/group
  *  - have read access-op, etc
  * Also make instance-id lookups on top object for each rule. Assume at most one result
+ * @param[in]  h        Clixon handle
+ * @param[in]  xt       XML root tree
+ * @param[in]  access   NACM access
+ * @param[in]  np       Compiled NACM policy of user
+ * @param[out] pv_listp Rules matching access with instance-id lookups
  */
 static int
 nacm_datanode_prepare(clicon_handle     h,
                       cxobj            *xt,
                       enum nacm_access  access,
-                      cxobj           **gvec,
-                      size_t            glen,
-                      cxobj           **rlistvec,
-                      size_t            rlistlen,
-                      cvec             *nsc,
+                      nacm_policy      *np,
                       prepvec         **pv_listp)
 {
     int        retval = -1;
-    cxobj     *rlist;
     int        i;
-    int        j;
     int        k;
-    char      *gname;
-    cxobj    **rvec = NULL; /* rules */
-    size_t     rlen;    
-    cxobj     *xrule;
-    cxobj     *pathobj;
-    char      *access_operations;
-    char      *path0;         /* Non-canonical path */
-    char      *path=NULL;     /* Canonical path */
-    cvec      *nsc0 = NULL;   /* Non-canonical namespace context */
+    nacm_rule *nr;
     yang_stmt *yspec;
-    cxobj   **xvec = NULL;
-    int       xlen = 0;
-    int       ret;
-    prepvec *pv;
+    cxobj    **xvec = NULL;
+    int        xlen = 0;
+    int        ret;
+    prepvec   *pv;
 
+    if (access >= NACM_EXEC){
+        clicon_err(OE_XML, EINVAL, "Access %d unupported (shouldnt happen)", access);
+        goto done;
+    }
     yspec = clicon_dbspec_yang(h);
-    for (i=0; i<rlistlen; i++){         /* Loop through rule list */
-        rlist = rlistvec[i];
-        /* Loop through user's group to find match in this rule-list */
-        for (j=0; j<glen; j++){
-            gname = xml_find_body(gvec[j], "name");
-            if (xpath_first(rlist, nsc, ".[group='%s']", gname)!=NULL)
-                break; /* found */
+    /* 6. For each rule-list entry found, process all rules, in order,
+       until a rule that matches the requested access operation is
+       found. (see 6 sub rules in nacm_rule_datanode)
+       6c-f) The rule's "access-operations" leaf has the access bit set or
+       has the special value "*", see nacm_rule_compile
+    */
+    for (i=0; i<np->np_accesslen[access]; i++){ /* Loop through rules */
+        nr = np->np_access[access][i];
+        /*  6b) Either (1) the rule does not have a "rule-type" defined or
+            (2) the "rule-type" is "data-node" and the "path" matches the
+            requested data node, action node, or notification node. */    
+        if (nr->nr_path == NULL){
+            if (nr->nr_rpc || nr->nr_notif)
+                continue;
+            /* Here a new rule is found, add it */
+            if (prepvec_add(pv_listp, nr) == NULL)
+                goto done;
         }
-        if (j==glen) /* not found */
-            continue;
-        /* 6. For each rule-list entry found, process all rules, in order,
-           until a rule that matches the requested access operation is
-           found. (see 6 sub rules in nacm_rule_datanode
-        */
-        if (xpath_vec(rlist, nsc, "rule", &rvec, &rlen) < 0)
-            goto done;
-        for (j=0; j<rlen; j++){ /* Loop through rules */
-            xrule = rvec[j];
-            /* 6c) For a "read" access operation, the rule's "access-operations"
-               leaf has the "read" bit set or has the special value "*" */
-            access_operations = xml_find_body(xrule, "access-operations");
-            switch (access){
-            case NACM_READ: 
-                /* 6c) For a "read" access operation, the rule's "access-operations"
-                   leaf has the "read" bit set or has the special value "*" */
-                if (!match_access(access_operations, "read", NULL))
-                    continue;
-                break;
-            case NACM_CREATE:
-                /* 6d) For a "create" access operation, the rule's "access-operations" 
-                   leaf has the "create" bit set or has the special value "*". */
-                if (!match_access(access_operations, "create", "write"))
-                    continue;
-                break;
-            case NACM_DELETE:
-                /* 6e) For a "delete" access operation, the rule's "access-operations" 
-                   leaf has the "delete" bit set or has the  special value "*". */
-                if (!match_access(access_operations, "delete", "write"))
-                    continue;
-                break;
-            case NACM_UPDATE:
-                /* 6f) For an "update" access operation, the rule's "access-operations"
-                   leaf has the "update" bit set or has the special value "*". */ 
-                if (!match_access(access_operations, "update", "write"))
-                    continue;
-                break;
-            default:
-                clicon_err(OE_XML, EINVAL, "Access %d unupported (shouldnt happen)", access);
+        else{
+            /* Path is parsed and bound to YANG once per compiled policy */
+            if ((ret = nacm_rule_path(nr, yspec)) < 0)
                 goto done;
-                break;
-            }
-            /*  6b) Either (1) the rule does not have a "rule-type" defined or
-                (2) the "rule-type" is "data-node" and the "path" matches the
-                requested data node, action node, or notification node. */    
-            if ((pathobj = xml_find_type(xrule, NULL, "path", CX_ELMNT)) == NULL){
-                if (xml_find_body(xrule, "rpc-name") || xml_find_body(xrule, "notification-name"))
-                    continue;
-                /* Here a new xrule is found, add it */
-                if (prepvec_add(pv_listp, xrule) == NULL)
+            if (ret == 0)
+                continue;
+            if ((ret = clixon_xml_find_instance_id_path(xt, yspec, nr->nr_cplist, &xvec, &xlen)) < 0)
+                goto done;
+            if (ret == 0)
+                continue;
+            /* Here a new rule is found, add it */
+            if ((pv = prepvec_add(pv_listp, nr)) == NULL)
+                goto done;
+            for (k=0; k<xlen; k++){
+                if (clixon_xvec_append(pv->pv_xpathvec, xvec[k]) < 0)
                     goto done;
             }
-            else{
-                path0 = clixon_trim2(xml_body(pathobj), " \t\n");
-                /* Get canonical namespace context for nacm paths */
-                if ((path = strdup(path0)) == NULL){
-                    clicon_err(OE_UNIX, errno, "strdup");
-                    goto done;
-                }
-#if 0
-                /* See https://github.com/clicon/clixon/issues/129:
-                 * If this is enabled, you are back to the problem of JSON encodings
-                 */
-                /* Create namespace context for with nacm namespace as default */
-                if (xml_nsctx_node(pathobj, &nsc0) < 0)
-                    goto done;
-                /* instance-id requires canonical paths */
-                if (xpath2canonical(path0, nsc0, yspec, &path, NULL) < 0)
-                    goto done;
-#endif
-                if ((ret = clixon_xml_find_instance_id(xt, yspec, &xvec, &xlen, "%s", path)) < 0)
-                    goto done;
-                if (ret == 0)
-                    continue;
-                /* Here a new xrule is found, add it */
-                if ((pv = prepvec_add(pv_listp, xrule)) == NULL)
-                    goto done;
-                for (k=0; k<xlen; k++){
-                    if (clixon_xvec_append(pv->pv_xpathvec, xvec[k]) < 0)
-                        goto done;
-                }
-                if (xvec){
-                    free(xvec);
-                    xvec = NULL;
-                }
-                if (nsc0){
-                    cvec_free(nsc0);
-                    nsc0 = NULL;
-                }
-                if (path){
-                    free(path);
-                    path = NULL;
-                }
+            if (xvec){
+                free(xvec);
+                xvec = NULL;
             }
         }
-        if (rvec){
-            free(rvec);
-            rvec=NULL;
-        }       
     }
     retval = 0;
  done:
     if (xvec)
         free(xvec);
-    if (path)
-        free(path);
-    if (nsc0)
-        cvec_free(nsc0);
     return retval;
 }
 
+/*! Match rule module-name with the YANG module of a data node
+ * @param[in]  nr    Compiled NACM rule
+ * @param[in]  ymod  YANG module of data node, or NULL if not known
+ * @retval     0     No match
+ * @retval     1     Match
+ * 6a) The rule's "module-name" leaf is "*" or equals the name of
+ * the YANG module where the requested data node is defined. 
+ */
+static int
+nacm_rule_module(nacm_rule *nr,
+                 yang_stmt *ymod)
+{
+    if (nr->nr_module == NULL)
+        return 0;
+    if (strcmp(nr->nr_module, "*") == 0)
+        return 1;
+    /* ymod is NULL (xn is "config") Can this breach the NACM rule? */
+    return ymod == NULL || strcmp(yang_argument_get(ymod), nr->nr_module) == 0;
+}
+
 /*---------------------------------------------------------------
  * Datanode write
  */
 
 /*! Match specific rule to specific requested node
  * @param[in]  xn       XML node (requested node)
- * @param[in]  xrule    NACM rule
- * @param[in]  xp       Xpath match
- * @param[in]  yspec    YANG spec
+ * @param[in]  ymod     YANG module of requested node
+ * @param[in]  nr       Compiled NACM rule
+ * @param[in]  xpathvec Xpath match
  * @retval -1  Error
  * @retval  0  OK and rule does not match
  * @retval  1  OK and rule matches deny
@@ -528,35 +786,24 @@ nacm_datanode_prepare(clicon_handle     h,
  */
 static int
 nacm_data_write_xrule_xml(cxobj       *xn,
-                          cxobj       *xrule,
-                          clixon_xvec *xpathvec,
-                          yang_stmt   *yspec)
+                          yang_stmt   *ymod,
+                          nacm_rule   *nr,
+                          clixon_xvec *xpathvec)
 {
     int        retval = -1;
-    yang_stmt *ymod;
-    char      *module_pattern; /* rule module name */
-    char      *action;
     cxobj     *xp;
     int        i;
 
-    if ((module_pattern = xml_find_body(xrule, "module-name")) == NULL)
-        goto nomatch;
     /* 6a) The rule's "module-name" leaf is "*" or equals the name of
      * the YANG module where the requested data node is defined. 
      */
-    if (strcmp(module_pattern, "*") != 0){
-        if (ys_module_by_xml(yspec, xn, &ymod) < 0)
-            goto done;
-        /* ymod is NULL (xn is "config") Can this breach the NACM rule? */
-        if (ymod && strcmp(yang_argument_get(ymod), module_pattern) != 0)
-            goto nomatch;
-    }
-    action = xml_find_body(xrule, "action"); /* mandatory */
+    if (!nacm_rule_module(nr, ymod))
+        goto nomatch;
     /*  6b) Either (1) the rule does not have a "rule-type" defined or
         (2) the "rule-type" is "data-node" and the "path" matches the
         Requested data node, action node, or notification node. */    
-    if (xml_find_type(xrule, NULL, "path", CX_ELMNT) == NULL){
-        if (strcmp(action, "deny")==0)
+    if (nr->nr_path == NULL){
+        if (nr->nr_deny)
             goto deny;
         goto permit;
     }
@@ -564,7 +811,7 @@ nacm_data_write_xrule_xml(cxobj       *xn,
         xp = clixon_xvec_i(xpathvec, i);
         /* Check if ancestor is xp (for every xpathvec?) */
         if (xn == xp || xml_isancestor(xn, xp)){
-            if (strcmp(action, "deny")==0)
+            if (nr->nr_deny)
                 goto deny;
             goto permit;
         }
@@ -606,17 +853,21 @@ nacm_datanode_write_recurse(clicon_handle h,
                             yang_stmt    *yspec,
                             cbuf         *cbret)
 {
-    int       retval = -1;
-    cxobj   *x;
-    int      ret = 0;
-    prepvec *pv;
+    int        retval = -1;
+    cxobj     *x;
+    int        ret = 0;
+    prepvec   *pv;
+    yang_stmt *ymod = NULL;
     
     pv = pv_list;
     if (pv){
+        /* Module of node is looked up once for all rules */
+        if (ys_module_by_xml(yspec, xn, &ymod) < 0)
+            goto done;
         do {
             /* return values: -1:Error /0:no match /1: deny /2: permit
              */
-            if ((ret = nacm_data_write_xrule_xml(xn, pv->pv_xrule, pv->pv_xpathvec, yspec)) < 0) 
+            if ((ret = nacm_data_write_xrule_xml(xn, ymod, pv->pv_rule, pv->pv_xpathvec)) < 0) 
                 goto done;
             switch(ret){
             case 0: /* No match, continue with next rule */
@@ -684,19 +935,11 @@ nacm_datanode_write(clicon_handle    h,
                     cbuf            *cbret)
 {
     int             retval = -1;
-    cxobj         **gvec = NULL; /* groups */
-    size_t          glen;
-    cxobj         **rlistvec = NULL; /* rule-list */
-    size_t          rlistlen;
-    cxobj         **rvec = NULL; /* rules */
     char           *write_default = NULL;
-    cvec           *nsc = NULL;
     int             ret;
     prepvec        *pv_list = NULL;
+    nacm_policy    *np;
 
-    /* Create namespace context for with nacm namespace as default */
-    if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
-        goto done;
     if (xnacm == NULL)
         goto permit;
     /* write-default (create, update, or delete) has default deny so should never be NULL */
@@ -711,21 +954,19 @@ nacm_datanode_write(clicon_handle    h,
        transport layer.)               */
     if (username == NULL)
         goto step9;
-    /* User's group */
-    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+    /* User's groups and rules are compiled once per NACM configuration */
+    if (nacm_policy_get(username, xnacm, &np) < 0)
         goto done;
     /* 4. If no groups are found, continue with step 9. */
-    if (glen == 0)
+    if (np->np_groups == 0)
         goto step9;
     /* 5. Process all rule-list entries, in the order they appear in the
         configuration.  If a rule-list's "group" leaf-list does not
         match any of the user's groups, proceed to the next rule-list
-        entry. */
-    if (xpath_vec(xnacm, nsc, "rule-list", &rlistvec, &rlistlen) < 0)
-        goto done;
-    /* First run through rules and cache rules as well as lookup objects in xt. 
+        entry. 
+       First run through rules and cache rules as well as lookup objects in xt. 
      */
-    if (nacm_datanode_prepare(h, xt, access, gvec, glen, rlistvec, rlistlen, nsc, &pv_list) < 0)
+    if (nacm_datanode_prepare(h, xt, access, np, &pv_list) < 0)
         goto done;
     /* Then recursivelyy traverse all requested nodes */
     if ((ret = nacm_datanode_write_recurse(h, xreq, pv_list,
@@ -762,14 +1003,6 @@ nacm_datanode_write(clicon_handle    h,
     clicon_debug(1, "%s retval:%d (0:deny 1:permit)", __FUNCTION__, retval);
     if (pv_list)
         prepvec_free(pv_list);
-    if (nsc)
-        xml_nsctx_free(nsc);
-    if (gvec)
-        free(gvec);
-    if (rlistvec)
-        free(rlistvec);
-    if (rvec)
-        free(rvec);
     return retval;
  deny: /* Here, cbret must contain a netconf error msg */
     assert(cbuf_len(cbret));
@@ -782,141 +1015,272 @@ nacm_datanode_write(clicon_handle    h,
  */
 
 /*! Perform NACM action: mark if permit, del if deny
- * @param[in] xrule    NACM rule
+ * @param[in] nr       Compiled NACM rule
  * @param[in] xn       XML node (requested node)
  * @retval    -1       Error
  * @retval    0        OK
  */
 static int
-nacm_data_read_action(cxobj *xrule,
-                      cxobj *xn)
+nacm_data_read_action(nacm_rule *nr,
+                      cxobj     *xn)
 {
     int   retval = -1;
-    char *action;
 
-    if ((action = xml_find_body(xrule, "action")) != NULL){
-        if (strcmp(action, "deny")==0)
-            xml_flag_set(xn, XML_FLAG_DEL);
-        else if (strcmp(action, "permit")==0)
-            xml_flag_set(xn, XML_FLAG_MARK);
-    }
+    if (nr->nr_deny)
+        xml_flag_set(xn, XML_FLAG_DEL);
+    else if (nr->nr_permit)
+        xml_flag_set(xn, XML_FLAG_MARK);
     retval = 0;
     //done:
     return retval;
 }
 
-/*! Match specific rule to specific requested node
- * @param[in]  xn       XML node (requested node)
- * @param[in]  xrule    NACM rule
- * @param[in]  yspec    YANG spec
- * @retval -1  Error
- * @retval  0  OK and rule does not match
- * @retval  1  OK and rule matches
- * Two distinct cases:
- * (1) read_default is permit
- *     mark all deny rules and remove them
- * (2) read_default is deny:
- *     mark all permit rules and ancestors, remove everything else
+/*! Check if YANG node is ancestor of, or same as, another YANG node
+ * @param[in]  ya   YANG ancestor, NULL is ancestor of all nodes
+ * @param[in]  y    YANG node
+ * @retval     1    ya is ancestor of y or same as y
+ * @retval     0    No
+ */
+static int
+nacm_yang_ancestor(yang_stmt *ya,
+                   yang_stmt *y)
+{
+    if (ya == NULL)
+        return 1;
+    while (y != NULL){
+        if (y == ya)
+            return 1;
+        y = yang_parent_get(y);
+    }
+    return 0;
+}
+
+/*! Get read decision of a YANG node in a compiled policy, create it on first call
+ *
+ * Rule paths are mapped to YANG nodes, so that the rules that may match a data node
+ * are found once per YANG node, and not by evaluating the paths of all rules for
+ * every data node.
+ * @param[in]  np     Compiled NACM policy
+ * @param[in]  ys     YANG node of data node
+ * @param[in]  yspec  YANG spec
+ * @param[out] ydp    Decision, direct pointer into policy
+ * @retval     0      OK
+ * @retval    -1      Error
  */
 static int
-nacm_data_read_xrule_xml(cxobj        *xn,
-                         cxobj        *xrule,
-                         clixon_xvec  *xpathvec,
-                         yang_stmt    *yspec)
+nacm_ydec_get(nacm_policy *np,
+              yang_stmt   *ys,
+              yang_stmt   *yspec,
+              nacm_ydec  **ydp)
 {
     int        retval = -1;
-    yang_stmt *ymod;
-    char      *module_pattern; /* rule module name */
-    cxobj     *xp;
+    char       key[32];
+    nacm_ydec  yd0 = {0,};
+    nacm_ydec *yd;
+    nacm_rule *nr;
+    yang_stmt *ymod = NULL;
     int        i;
-    
-    if ((module_pattern = xml_find_body(xrule, "module-name")) == NULL)
-        goto nomatch;
-    /* 6a) The rule's "module-name" leaf is "*" or equals the name of
-     * the YANG module where the requested data node is defined. 
-     */
-    if (strcmp(module_pattern, "*") != 0){
-        if (ys_module_by_xml(yspec, xn, &ymod) < 0)
-            goto done;
-        if (strcmp(yang_argument_get(ymod), module_pattern) != 0)
-            goto nomatch;
+    int        ret;
+
+    snprintf(key, sizeof(key), "%p", ys);
+    if (np->np_ydec == NULL &&
+        (np->np_ydec = clicon_hash_init()) == NULL)
+        goto done;
+    if ((yd = clicon_hash_value(np->np_ydec, key, NULL)) != NULL)
+        goto ok;
+    if (ys_real_module(ys, &ymod) < 0)
+        goto done;
+    yd0.yd_skip = 1;
+    if (np->np_accesslen[NACM_READ] &&
+        (yd0.yd_rules = calloc(np->np_accesslen[NACM_READ], sizeof(nacm_rule *))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
     }
-    /*  6b) Either (1) the rule does not have a "rule-type" defined or
-        (2) the "rule-type" is "data-node" and the "path" matches the
-        requested data node, action node, or notification node. */    
-    if (xml_find_type(xrule, NULL, "path", CX_ELMNT) == NULL){
-        if (nacm_data_read_action(xrule, xn) < 0)
-            goto done;
-        goto match;
+    for (i=0; i<np->np_accesslen[NACM_READ]; i++){
+        nr = np->np_access[NACM_READ][i];
+        /*  6b) Either (1) the rule does not have a "rule-type" defined or
+            (2) the "rule-type" is "data-node" and the "path" matches the
+            requested data node, action node, or notification node. */    
+        if (nr->nr_path == NULL){
+            if (nr->nr_rpc || nr->nr_notif)
+                continue;
+            yd0.yd_skip = 0;
+        }
+        else {
+            if ((ret = nacm_rule_path(nr, yspec)) < 0)
+                goto done;
+            if (ret == 0)
+                continue;
+            if (!nacm_yang_ancestor(nr->nr_ytarget, ys)){
+                /* Path is below this node */
+                if (nacm_yang_ancestor(ys, nr->nr_ytarget))
+                    yd0.yd_skip = 0;
+                continue;
+            }
+            yd0.yd_skip = 0;
+        }
+        /* 6a) The rule's "module-name" leaf is "*" or equals the name of
+         * the YANG module where the requested data node is defined. 
+         */
+        if (!nacm_rule_module(nr, ymod))
+            continue;
+        yd0.yd_rules[yd0.yd_len++] = nr;
+        if (nr->nr_path == NULL || !nr->nr_keyed)
+            break; /* Always matches, later rules are not used */
     }
-    for (i=0; i<clixon_xvec_len(xpathvec); i++){
-        xp = clixon_xvec_i(xpathvec, i);
-        /* Check if ancestor is xp (for every xpathvec?) */
-        if (xn == xp || xml_isancestor(xn, xp)){
-            if (nacm_data_read_action(xrule, xn) < 0)
+    if (clicon_hash_add(np->np_ydec, key, &yd0, sizeof(yd0)) == NULL)
+        goto done;
+    yd0.yd_rules = NULL;
+    if ((yd = clicon_hash_value(np->np_ydec, key, NULL)) == NULL){
+        clicon_err(OE_UNIX, ENOENT, "nacm decision %s not found", key);
+        goto done;
+    }
+ ok:
+    *ydp = yd;
+    retval = 0;
+ done:
+    if (yd0.yd_rules)
+        free(yd0.yd_rules);
+    return retval;
+}
+
+/*! Prepare instances of keyed rule paths before running through XML tree
+ *
+ * Only rules whose paths have key predicates depend on the data tree, other rule
+ * paths are matched by YANG node, see nacm_ydec_get
+ * @param[in]  h        Clixon handle
+ * @param[in]  xt       XML root tree
+ * @param[in]  np       Compiled NACM policy
+ * @param[out] xvecs    Instances per rule in np_rules, or NULL. Free with free() and clixon_xvec_free
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+nacm_datanode_read_prepare(clicon_handle  h,
+                           cxobj         *xt,
+                           nacm_policy   *np,
+                           clixon_xvec ***xvecs)
+{
+    int          retval = -1;
+    clixon_xvec **xv = NULL;
+    nacm_rule   *nr;
+    yang_stmt   *yspec;
+    cxobj      **xvec = NULL;
+    int          xlen = 0;
+    int          i;
+    int          k;
+    int          ret;
+
+    yspec = clicon_dbspec_yang(h);
+    for (i=0; i<np->np_accesslen[NACM_READ]; i++){
+        nr = np->np_access[NACM_READ][i];
+        if (nr->nr_path == NULL)
+            continue;
+        if ((ret = nacm_rule_path(nr, yspec)) < 0)
+            goto done;
+        if (ret == 0 || !nr->nr_keyed)
+            continue;
+        if (xv == NULL &&
+            (xv = calloc(np->np_len, sizeof(clixon_xvec *))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        if ((xv[nr - np->np_rules] = clixon_xvec_new()) == NULL)
+            goto done;
+        if ((ret = clixon_xml_find_instance_id_path(xt, yspec, nr->nr_cplist, &xvec, &xlen)) < 0)
+            goto done;
+        for (k=0; k<xlen; k++)
+            if (clixon_xvec_append(xv[nr - np->np_rules], xvec[k]) < 0)
                 goto done;
-            goto match;
+        if (xvec){
+            free(xvec);
+            xvec = NULL;
         }
     }
- nomatch:
+    *xvecs = xv;
+    xv = NULL;
     retval = 0;
  done:
+    if (xvec)
+        free(xvec);
+    if (xv){
+        for (i=0; i<np->np_len; i++)
+            if (xv[i])
+                clixon_xvec_free(xv[i]);
+        free(xv);
+    }
     return retval;
- match:
-    retval = 1; /* match */
-    goto done;
+}
+
+/*! Check if a data node is in an instance of a keyed rule path
+ * @param[in]  xn       XML node (requested node)
+ * @param[in]  xpathvec Instances of path
+ * @retval     1        xn is an instance or descendant of an instance
+ * @retval     0        No
+ */
+static int
+nacm_data_read_instance(cxobj       *xn,
+                        clixon_xvec *xpathvec)
+{
+    cxobj *xp;
+    int    i;
+
+    for (i=0; i<clixon_xvec_len(xpathvec); i++){
+        xp = clixon_xvec_i(xpathvec, i);
+        /* Check if ancestor is xp (for every xpathvec?) */
+        if (xn == xp || xml_isancestor(xn, xp))
+            return 1;
+    }
+    return 0;
 }
 
 /*! Recursive check for NACM read rules among all XML nodes
  * @param[in]  h        Clicon handle
  * @param[in]  xn       XML node (requested node)
- * @param[in]  rulevec  Precomputed rules that apply to this user group
- * @param[in]  xpathvec Precomputed xpath results that apply to this XML tree
+ * @param[in]  np       Compiled NACM policy
+ * @param[in]  xvecs    Instances of keyed rule paths, see nacm_datanode_read_prepare
  * @param[in]  yspec    YANG spec
  * @retval  0  OK
  * @retval -1  Error
+ * The rules of a node are given by the decision of its YANG node, and subtrees where no
+ * rule can match are not traversed
  */
 static int
 nacm_datanode_read_recurse(clicon_handle h,
                            cxobj        *xn,
-                           prepvec      *pv_list,
+                           nacm_policy  *np,
+                           clixon_xvec **xvecs,
                            yang_stmt    *yspec)
 {
-    int      retval = -1;
-    cxobj   *x;
-    cxobj   *xprev;
-    int      ret;
-    prepvec *pv;
+    int        retval = -1;
+    cxobj     *x;
+    cxobj     *xprev;
+    yang_stmt *ys;
+    nacm_ydec *yd;
+    nacm_rule *nr;
+    int        i;
     
-    if (xml_spec(xn)){ /* Check this node */
-        pv = pv_list;
-        if (pv){
-            do {
-                if ((ret = nacm_data_read_xrule_xml(xn,
-                                                    pv->pv_xrule,
-                                                    pv->pv_xpathvec,
-                                                    yspec)) < 0) 
-                    goto done;      
-                if (ret == 1)
-                    break; /* stop at first match */                
-                pv = NEXTQ(prepvec *, pv);
-            } while (pv && pv != pv_list);
-        }
-
-#if 0 /* 6(A) in algorithm 
-       * If N did not match any rule R, and default rule is deny, remove that subtree */
-        if (strcmp(read_default, "deny") == 0)
-            if (xml_tree_prune_flagged_sub(xt, XML_FLAG_MARK, 1, NULL) < 0)
+    if ((ys = xml_spec(xn)) != NULL){ /* Check this node */
+        if (nacm_ydec_get(np, ys, yspec, &yd) < 0)
+            goto done;
+        if (yd->yd_skip)
+            goto ok;
+        for (i=0; i<yd->yd_len; i++){
+            nr = yd->yd_rules[i];
+            if (nr->nr_keyed &&
+                (xvecs == NULL || !nacm_data_read_instance(xn, xvecs[nr - np->np_rules])))
+                continue;
+            if (nacm_data_read_action(nr, xn) < 0)
                 goto done;
-#endif
+            break; /* stop at first match */
+        }
     }
-
     /* If node should be purged, dont recurse and defer removal to caller */
     if (xml_flag(xn, XML_FLAG_DEL) == 0){
         x = NULL;       /* Recursively check XML */
         xprev = NULL;
         while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL) {
-            if (nacm_datanode_read_recurse(h, x, pv_list, yspec) < 0)
+            if (nacm_datanode_read_recurse(h, x, np, xvecs, yspec) < 0)
                 goto done;
             /* check for delayed remove */
             if (xml_flag(x, XML_FLAG_DEL)){
@@ -924,8 +1288,11 @@ nacm_datanode_read_recurse(clicon_handle h,
                     goto done;
                 x = xprev;
             }
+            else
+                xprev = x;
         }
     }
+ ok:
     retval = 0;
  done:
     return retval;
@@ -988,18 +1355,11 @@ nacm_datanode_read(clicon_handle h,
                    cxobj        *xnacm)
 {
     int             retval = -1;
-    cxobj         **gvec = NULL; /* groups */
-    size_t          glen;
-    cxobj         **rlistvec = NULL; /* rule-list */
-    size_t          rlistlen;
     int             i;
     char           *read_default = NULL;
-    cvec           *nsc = NULL;
-    prepvec        *pv_list = NULL;
+    clixon_xvec   **xvecs = NULL;
+    nacm_policy    *np = NULL;
     
-    /* Create namespace context for with nacm namespace as default */
-    if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
-        goto done;
     /* 3.   Check all the "group" entries to see if any of them contain a
        "user-name" entry that equals the username for the session
        making the request.  (If the "enable-external-groups" leaf is
@@ -1007,17 +1367,15 @@ nacm_datanode_read(clicon_handle h,
        transport layer.)               */
     if (username == NULL)
         goto step9;
-    /* User's group */
-    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+    /* User's groups and rules are compiled once per NACM configuration */
+    if (nacm_policy_get(username, xnacm, &np) < 0)
         goto done;
-    /* 4. If no groups are found (glen=0), continue and check read-default 
+    /* 4. If no groups are found, continue and check read-default 
           in step 11. */
     /* 5. Process all rule-list entries, in the order they appear in the
         configuration.  If a rule-list's "group" leaf-list does not
         match any of the user's groups, proceed to the next rule-list
         entry. */
-    if (xpath_vec(xnacm, nsc, "rule-list", &rlistvec, &rlistlen) < 0)
-        goto done;
     /* read-default has default permit so should never be NULL */
     if ((read_default = xml_find_body(xnacm, "read-default")) == NULL){
         clicon_err(OE_XML, EINVAL, "No nacm read-default rule");
@@ -1026,10 +1384,10 @@ nacm_datanode_read(clicon_handle h,
     /* First run through rules and cache rules as well as lookup objects in xt. 
      * DANGER: objects could be stale if they are removed?
      */
-    if (nacm_datanode_prepare(h, xt, NACM_READ, gvec, glen, rlistvec, rlistlen, nsc, &pv_list) < 0)
+    if (nacm_datanode_read_prepare(h, xt, np, &xvecs) < 0)
         goto done;
     /* Then recursivelyy traverse all nodes */
-    if (nacm_datanode_read_recurse(h, xt, pv_list, clicon_dbspec_yang(h)) < 0)
+    if (nacm_datanode_read_recurse(h, xt, np, xvecs, clicon_dbspec_yang(h)) < 0)
         goto done;
 #if 1
     /* Step 8(B) above:
@@ -1060,14 +1418,12 @@ nacm_datanode_read(clicon_handle h,
     retval = 0;
  done:
     clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
-    if (pv_list)
-        prepvec_free(pv_list);
-    if (nsc)
-        xml_nsctx_free(nsc);
-    if (gvec)
-        free(gvec);
-    if (rlistvec)
-        free(rlistvec);
+    if (xvecs){
+        for (i=0; i<np->np_len; i++)
+            if (xvecs[i])
+                clixon_xvec_free(xvecs[i]);
+        free(xvecs);
+    }
     return retval;
 }
 
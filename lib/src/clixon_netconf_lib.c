@@ -2204,6 +2204,93 @@ netconf_output_encap(netconf_framing_type framing,
     return retval;
 }
 
+/*! Argument to netconf_output_chunk
+ */
+struct netconf_output_arg {
+    int                  noa_s;       /* Socket */
+    netconf_framing_type noa_framing; /* EOM(1.0) or chunked (1.1) */
+};
+
+/*! Write one chunk of a netconf message, with RFC6242 chunk header if chunked framing
+ *
+ * @param[in]  buf   Chunk of XML text, not NULL-terminated
+ * @param[in]  len   Length of chunk
+ * @param[in]  arg   struct netconf_output_arg
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see netconf_output_xml
+ */
+static int
+netconf_output_chunk(char  *buf,
+                     size_t len,
+                     void  *arg)
+{
+    int                        retval = -1;
+    struct netconf_output_arg *noa = (struct netconf_output_arg *)arg;
+    char                       hdr[32];
+    int                        hlen;
+
+    clicon_debug(CLIXON_DBG_MSG, "Send ext chunk: %.*s", (int)len, buf);
+    if (noa->noa_framing == NETCONF_SSH_CHUNKED){
+        hlen = snprintf(hdr, sizeof(hdr), "\n#%zu\n", len);
+        if (write(noa->noa_s, hdr, hlen) < 0)
+            goto err;
+    }
+    if (write(noa->noa_s, buf, len) < 0)
+        goto err;
+    retval = 0;
+ done:
+    return retval;
+ err:
+    if (errno == EPIPE)
+        clicon_debug(1, "%s write err SIGPIPE", __FUNCTION__);
+    else
+        clicon_log(LOG_ERR, "%s: write: %s", __FUNCTION__, strerror(errno));
+    goto done;
+}
+
+/*! Print an XML tree as an encapsulated netconf message in chunks to a socket
+ *
+ * Same output as clixon_xml2cbuf followed by netconf_output_encap and netconf_output, but
+ * the message is not kept in one buffer. It is printed and written in chunks of size
+ * NETCONF_REPLY_CHUNK_SIZE, each chunk framed as an RFC6242 chunk if chunked framing.
+ * @param[in]   s       Socket
+ * @param[in]   framing Framing type, ie EOM(1.0) or chunked (1.1)
+ * @param[in]   xn      XML message, eg <rpc-reply>
+ * @param[in]   msg     Only for debug
+ * @retval      0       OK
+ * @retval     -1       Error
+ * @see netconf_output_encap
+ */
+int
+netconf_output_xml(int                  s,
+                   netconf_framing_type framing,
+                   cxobj               *xn,
+                   char                *msg)
+{
+    int                       retval = -1;
+    struct netconf_output_arg noa = {s, framing};
+    cbuf                     *cb = NULL;
+
+    clicon_debug(CLIXON_DBG_MSG, "%s %s", __FUNCTION__, msg);
+    if (clixon_xml2chunks(xn, 0, 0, -1, 0, NETCONF_REPLY_CHUNK_SIZE,
+                          netconf_output_chunk, &noa) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (netconf_framing_postamble(framing, cb) < 0)
+        goto done;
+    if (netconf_output(s, cb, msg) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! Track chunked framing defined in RFC6242
  *
  * The function works by calling sequentially each received char and using 
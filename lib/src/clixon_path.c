@@ -1814,6 +1814,48 @@ clixon_xml_find_instance_id(cxobj     *xt,
     goto done;
 }
 
+/*! Given a parsed (instance-id) path, return xml node vector
+ *
+ * As clixon_xml_find_instance_id but the path is parsed and resolved in advance with
+ * clixon_instance_id_parse, eg when the same path is searched in many trees
+ * @param[in]  xt       Top xml-tree where to search
+ * @param[in]  yt       Yang statement of top symbol (can be yang-spec if top-level)
+ * @param[in]  cplist   Path parse-tree, see clixon_instance_id_parse
+ * @param[out] xvec     Vector of xml-trees. Vector must be free():d after use
+ * @param[out] xlen     Returns length of vector in return value
+ * @retval    -1        Error
+ * @retval     0        Non-fatal failure, yang bind failures, etc, 
+ * @retval     1        OK with found xml nodes in xvec (if any)
+ * @see clixon_xml_find_instance_id
+ */
+int
+clixon_xml_find_instance_id_path(cxobj       *xt,
+                                 yang_stmt   *yt,
+                                 clixon_path *cplist,
+                                 cxobj     ***xvec,
+                                 int         *xlen)
+{
+    int          retval = -1;
+    int          ret;
+    clixon_xvec *xv = NULL;
+
+    if ((ret = clixon_path_search(xt, yt, cplist, &xv)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    /* Convert to api xvec format */
+    if (xv && clixon_xvec_extract(xv, xvec, xlen, NULL) < 0)
+        goto done;
+    retval = 1;
+ done:
+    if (xv)
+        clixon_xvec_free(xv);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Given (instance-id) path and YANG, parse path, resolve YANG and return namespace binding
  *
  * Instance-identifier is a subset of XML XPaths and defined in Yang, used in NACM for 
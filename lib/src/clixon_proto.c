@@ -48,6 +48,7 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
+#include <stdint.h>
 #include <string.h>
 #include <syslog.h>
 #include <signal.h>
@@ -80,6 +81,25 @@
 
 static int _atomicio_sig = 0;
 
+/* Initial size of per-connection receive buffer */
+#define RBUF_SIZE_MIN  4096
+
+/* A drained receive buffer larger than this is shrunk back to RBUF_SIZE_MIN */
+#define RBUF_SIZE_KEEP (1024*1024)
+
+/*! Per-connection receive buffer for non-blocking framed IPC messages
+ *
+ * Data in [rb_start, rb_end) has been read from the socket but not yet handed out.
+ * Complete messages are returned as pointers into the buffer, no copying
+ * @see clicon_msg_rcv_buf
+ */
+struct clicon_msg_rbuf {
+    char   *rb_buf;   /* Buffer, always aligned from malloc */
+    size_t  rb_size;  /* Allocated size of rb_buf */
+    size_t  rb_start; /* Start of first unconsumed message */
+    size_t  rb_end;   /* End of received data */
+};
+
 /*! Formats (showas) derived from XML
  */
 struct formatvec{
@@ -195,7 +215,11 @@ clicon_msg_decode(struct clicon_msg *msg,
     /* body */
     xmlstr = msg->op_body;
     // XXX    clicon_debug(CLIXON_DBG_MSG, "Recv: %s", xmlstr);
-    if ((ret = clixon_xml_parse_string(xmlstr, yspec?YB_RPC:YB_NONE, yspec, xml, xerr)) < 0)
+    /* Message tree is transient, allocate in arena */
+    xml_arena_push();
+    ret = clixon_xml_parse_string(xmlstr, yspec?YB_RPC:YB_NONE, yspec, xml, xerr);
+    xml_arena_pop();
+    if (ret < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -365,6 +389,35 @@ clicon_msg_send(int                s,
     return retval;
 }
 
+/*! Write a buffer on socket, part of a clicon_msg
+ *
+ * @param[in]  s     Socket
+ * @param[in]  buf   Buffer to write
+ * @param[in]  len   Length of buffer
+ * @retval     0     OK
+ * @retval     -1    Error, errno set
+ * @see clicon_msg_send  for a whole message
+ */
+static int
+send_msg_write(int    s,
+               char  *buf,
+               size_t len)
+{
+    int retval = -1;
+    int e;
+
+    if (atomicio((ssize_t (*)(int, void *, size_t))write, s, buf, len) < 0){
+        e = errno;
+        clicon_err(OE_CFG, e, "atomicio");
+        clicon_log(LOG_WARNING, "%s: write: %s len:%zu", __FUNCTION__, strerror(e), len);
+        errno = e;
+        goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Receive a CLICON message using IPC message struct
  *
  * XXX: timeout? and signals?
@@ -460,6 +513,293 @@ clicon_msg_rcv(int                s,
     return retval;
 }
 
+/*! Create a per-connection receive buffer
+ *
+ * @retval  rb    Receive buffer, free with clicon_msg_rbuf_free
+ * @retval  NULL  Error
+ * @see clicon_msg_rcv_buf
+ */
+clicon_msg_rbuf *
+clicon_msg_rbuf_new(void)
+{
+    clicon_msg_rbuf *rb;
+
+    if ((rb = malloc(sizeof(*rb))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(rb, 0, sizeof(*rb));
+    if ((rb->rb_buf = malloc(RBUF_SIZE_MIN)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        free(rb);
+        return NULL;
+    }
+    rb->rb_size = RBUF_SIZE_MIN;
+    return rb;
+}
+
+/*! Free a per-connection receive buffer
+ *
+ * @param[in]  rb  Receive buffer
+ * @note Messages returned by clicon_msg_rcv_next are invalid after this call
+ */
+int
+clicon_msg_rbuf_free(clicon_msg_rbuf *rb)
+{
+    if (rb){
+        if (rb->rb_buf)
+            free(rb->rb_buf);
+        free(rb);
+    }
+    return 0;
+}
+
+/*! Get length of message at start of receive buffer from its header
+ * @param[in]  rb   Receive buffer
+ * @retval     len  Length of whole message including header
+ * @retval     0    Header not complete
+ */
+static uint32_t
+rbuf_msglen(clicon_msg_rbuf *rb)
+{
+    struct clicon_msg hdr;
+
+    if (rb->rb_end - rb->rb_start < sizeof(hdr))
+        return 0;
+    memcpy(&hdr, rb->rb_buf + rb->rb_start, sizeof(hdr));
+    return ntohl(hdr.op_len);
+}
+
+/*! Move unconsumed data to start of receive buffer
+ * @param[in]  rb   Receive buffer
+ */
+static void
+rbuf_compact(clicon_msg_rbuf *rb)
+{
+    if (rb->rb_start == 0)
+        return;
+    if (rb->rb_end > rb->rb_start)
+        memmove(rb->rb_buf, rb->rb_buf + rb->rb_start, rb->rb_end - rb->rb_start);
+    rb->rb_end -= rb->rb_start;
+    rb->rb_start = 0;
+}
+
+/*! Non-blocking receive of CLICON messages into a per-connection buffer
+ *
+ * Make one non-blocking read of as much data as is available and fits in the buffer.
+ * The buffer is grown to hold the pending message if its header says it is larger.
+ * Several pipelined messages may be received by one call. Call clicon_msg_rcv_next
+ * repeatedly after this call to get the complete messages.
+ * Intended for event-driven servers, ie when called from a clixon_event_reg_fd callback.
+ * @param[in]   s      Socket (unix or inet) with data to read
+ * @param[in]   rb     Per-connection receive buffer
+ * @param[out]  eof    Set if eof encountered, caller should close the socket
+ * @retval      0      OK (check eof)
+ * @retval     -1      Error
+ * @code
+ *   if (clicon_msg_rcv_buf(s, rb, &eof) < 0)
+ *      err;
+ *   while (!eof){
+ *      if (clicon_msg_rcv_next(rb, &msg, &eof) < 0)
+ *         err;
+ *      if (msg == NULL)
+ *         break;
+ *      handle(msg); // No free
+ *   }
+ * @endcode
+ * @see clicon_msg_rcv  blocking variant, allocates each message
+ */
+int
+clicon_msg_rcv_buf(int              s,
+                   clicon_msg_rbuf *rb,
+                   int             *eof)
+{
+    int      retval = -1;
+    size_t   need;
+    size_t   size;
+    uint32_t mlen;
+    ssize_t  len;
+    char    *buf;
+
+    *eof = 0;
+    if (rb->rb_start == rb->rb_end){ /* Drained: reuse from start */
+        rb->rb_start = rb->rb_end = 0;
+        if (rb->rb_size > RBUF_SIZE_KEEP){
+            if ((buf = realloc(rb->rb_buf, RBUF_SIZE_MIN)) == NULL){
+                clicon_err(OE_UNIX, errno, "realloc");
+                goto done;
+            }
+            rb->rb_buf = buf;
+            rb->rb_size = RBUF_SIZE_MIN;
+        }
+    }
+    if ((mlen = rbuf_msglen(rb)) > sizeof(struct clicon_msg))
+        need = mlen;
+    else
+        need = sizeof(struct clicon_msg);
+    /* Make room for the pending message at least */
+    if (rb->rb_start + need > rb->rb_size || rb->rb_end == rb->rb_size)
+        rbuf_compact(rb);
+    if (need > rb->rb_size || rb->rb_end == rb->rb_size){
+        size = rb->rb_size;
+        while (size < need || size == rb->rb_end)
+            size *= 2;
+        if ((buf = realloc(rb->rb_buf, size)) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            goto done;
+        }
+        rb->rb_buf = buf;
+        rb->rb_size = size;
+    }
+    if ((len = recv(s, rb->rb_buf + rb->rb_end, rb->rb_size - rb->rb_end, MSG_DONTWAIT)) < 0){
+        switch (errno){
+        case EINTR:
+        case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+        case EWOULDBLOCK:
+#endif
+            goto ok;
+            break;
+        case ECONNRESET: /* Connection reset by peer */
+        case EPIPE:      /* Client shutdown */
+        case EBADF:      /* Client shutdown - freebsd */
+            len = 0;
+            break;
+        default:
+            clicon_err(OE_CFG, errno, "recv");
+            goto done;
+        }
+    }
+    if (len == 0){
+        *eof = 1;
+        goto ok;
+    }
+    msg_hex(CLIXON_DBG_EXTRA, rb->rb_buf + rb->rb_end, len, __FUNCTION__);
+    rb->rb_end += len;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get next complete CLICON message from a per-connection receive buffer
+ *
+ * The message is parsed in place and not copied. It is valid until the next call to
+ * clicon_msg_rcv_next, clicon_msg_rcv_buf or clicon_msg_rbuf_free on the same buffer,
+ * and must not be freed.
+ * @param[in]   rb     Per-connection receive buffer
+ * @param[out]  msg    Complete message or NULL if no complete message is buffered
+ * @param[out]  eof    Set if the message is malformed, caller should close the socket
+ * @retval      0      OK (check msg and eof)
+ * @see clicon_msg_rcv_buf
+ */
+int
+clicon_msg_rcv_next(clicon_msg_rbuf    *rb,
+                    struct clicon_msg **msg,
+                    int                *eof)
+{
+    uint32_t mlen;
+
+    *msg = NULL;
+    *eof = 0;
+    if ((mlen = rbuf_msglen(rb)) == 0)
+        return 0;
+    clicon_debug(CLIXON_DBG_EXTRA, "%s: op-len:%u", __FUNCTION__, mlen);
+    if (mlen <= sizeof(struct clicon_msg)){
+        clicon_err(OE_PROTO, 0, "op_len:%u too short", mlen);
+        *eof = 1;
+        return 0;
+    }
+    if (rb->rb_end - rb->rb_start < mlen) /* Not complete */
+        return 0;
+    if (rb->rb_buf[rb->rb_start + mlen - 1] != '\0'){
+        clicon_err(OE_PROTO, 0, "body not NULL terminated");
+        *eof = 1;
+        return 0;
+    }
+    /* Pipelined message after odd-sized message: align header fields */
+    if (rb->rb_start % sizeof(uint32_t))
+        rbuf_compact(rb);
+    *msg = (struct clicon_msg *)(rb->rb_buf + rb->rb_start);
+    rb->rb_start += mlen;
+    clicon_debug(CLIXON_DBG_DETAIL, "%s: rcv msg len=%u", __FUNCTION__, mlen);
+    clicon_debug(CLIXON_DBG_MSG, "Recv: %s", (*msg)->op_body);
+    return 0;
+}
+
+/*! Blocking receive of a CLICON message body directly into an allocated string
+ *
+ * The header is read on the stack and the body is read into its final buffer, ie no copy
+ * @param[in]   s      Socket (unix or inet) to communicate with backend
+ * @param[out]  data   Message body, NULL-terminated. Free with free()
+ * @param[out]  eof    Set if eof encountered
+ * @retval      0      OK (check eof)
+ * @retval     -1      Error
+ * @see clicon_msg_rcv  which returns the whole message including header
+ */
+static int
+clicon_msg_rcv_body(int    s,
+                    char **data,
+                    int   *eof)
+{
+    int               retval = -1;
+    struct clicon_msg hdr;
+    ssize_t           hlen;
+    ssize_t           len;
+    uint32_t          mlen;
+    size_t            blen;
+    char             *body = NULL;
+
+    *eof = 0;
+    if ((hlen = atomicio(read, s, &hdr, sizeof(hdr))) < 0){
+        clicon_err(OE_CFG, errno, "atomicio");
+        goto done;
+    }
+    if (hlen == 0){
+        *eof = 1;
+        goto ok;
+    }
+    if (hlen != sizeof(hdr)){
+        clicon_err(OE_PROTO, errno, "header too short (%zd)", hlen);
+        goto done;
+    }
+    mlen = ntohl(hdr.op_len);
+    clicon_debug(CLIXON_DBG_DETAIL, "%s: rcv msg len=%u", __FUNCTION__, mlen);
+    if (mlen <= sizeof(hdr)){
+        clicon_err(OE_PROTO, 0, "op_len:%u too short", mlen);
+        *eof = 1;
+        goto ok;
+    }
+    blen = mlen - sizeof(hdr);
+    if ((body = malloc(blen)) == NULL){
+        clicon_err(OE_PROTO, errno, "malloc");
+        goto done;
+    }
+    if ((len = atomicio(read, s, body, blen)) < 0){
+        clicon_err(OE_PROTO, errno, "read");
+        goto done;
+    }
+    if (len != blen){
+        clicon_err(OE_PROTO, 0, "body too short");
+        *eof = 1;
+        goto ok;
+    }
+    if (body[blen-1] != '\0'){
+        clicon_err(OE_PROTO, 0, "body not NULL terminated");
+        *eof = 1;
+        goto ok;
+    }
+    clicon_debug(CLIXON_DBG_MSG, "Recv: %s", body);
+    *data = body;
+    body = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (body)
+        free(body);
+    return retval;
+}
+
 /*! Receive a message using plain NETCONF
  *
  * @param[in]   s      socket (unix or inet) to communicate with backend
@@ -662,28 +1002,25 @@ clicon_rpc(int                sock,
            int               *eof)
 {
     int                retval = -1;
-    struct clicon_msg *reply = NULL;
     char              *data = NULL;
 
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
     if (clicon_msg_send(sock, msg) < 0)
         goto done;
-    if (clicon_msg_rcv(sock, 0, &reply, eof) < 0)
+    if (clicon_msg_rcv_body(sock, &data, eof) < 0)
         goto done;
     if (*eof)
         goto ok;
-    data = reply->op_body; /* assume string */
-    if (ret && data)
-        if ((*ret = strdup(data)) == NULL){
-            clicon_err(OE_UNIX, errno, "strdup");
-            goto done;
-        }
+    if (ret){
+        *ret = data;
+        data = NULL;
+    }
  ok:
     retval = 0;
   done:
     clicon_debug(CLIXON_DBG_DETAIL, "%s retval:%d", __FUNCTION__, retval);
-    if (reply)
-        free(reply);
+    if (data)
+        free(data);
     return retval;
 }
 
@@ -724,47 +1061,126 @@ clicon_rpc1(int   sock,
 
 /*! Send a clicon_msg message as reply to a clicon rpc request
  *
+ * The header and data are written separately, data is not copied to a message buffer
  * @param[in]  s       Socket to communicate with client
  * @param[in]  data    Returned data as byte-string.
  * @param[in]  datalen Length of returned data XXX  may be unecessary if always string?
  * @retval     0       OK
  * @retval     -1      Error
+ * @see send_msg_reply_xml  for XML tree data
  */
 int 
 send_msg_reply(int      s, 
                char    *data, 
                uint32_t datalen)
 {
-    int                retval = -1;
-    struct clicon_msg *reply = NULL;
-    uint32_t           len;
+    int               retval = -1;
+    struct clicon_msg hdr;
 
-    len = sizeof(*reply) + datalen;
-    if ((reply = (struct clicon_msg *)malloc(len)) == NULL)
-        goto done;
-    memset(reply, 0, len);
-    reply->op_len = htonl(len);
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.op_len = htonl(sizeof(hdr) + datalen);
+    clicon_debug(CLIXON_DBG_DETAIL, "%s: send msg len=%d", __FUNCTION__, ntohl(hdr.op_len));
     if (datalen > 0)
-      memcpy(reply->op_body, data, datalen);
-    if (clicon_msg_send(s, reply) < 0)
+        clicon_debug(CLIXON_DBG_MSG, "Send: %s", data);
+    if (send_msg_write(s, (char*)&hdr, sizeof(hdr)) < 0)
+        goto done;
+    if (datalen > 0 && send_msg_write(s, data, datalen) < 0)
+        goto done;
+    retval = 0;
+  done:
+    return retval;
+}
+
+/*! Chunk callback for counting length of XML output
+ * @see send_msg_reply_xml
+ */
+static int
+send_msg_chunk_len(char  *buf,
+                   size_t len,
+                   void  *arg)
+{
+    *(size_t*)arg += len;
+    return 0;
+}
+
+/*! Chunk callback for writing XML output on socket
+ * @see send_msg_reply_xml
+ */
+static int
+send_msg_chunk_write(char  *buf,
+                     size_t len,
+                     void  *arg)
+{
+    return send_msg_write(*(int*)arg, buf, len);
+}
+
+/*! Send a clicon_msg reply to a clicon rpc request with an XML tree written in chunks
+ *
+ * The reply is: <pre><xml tree><post>
+ * The XML tree is not printed to one string buffer. It is printed twice in chunks of
+ * BACKEND_REPLY_CHUNK_SIZE bytes: first to compute the message length of the header,
+ * and then writing each chunk to the socket. The socket is blocking so a slow client
+ * throttles the writer, and memory is bounded by the chunk size, not by the tree size.
+ * @param[in]  s       Socket to communicate with client
+ * @param[in]  pre     String before XML tree, or NULL
+ * @param[in]  xn      XML tree
+ * @param[in]  depth   Limit levels of child resources: -1: all, 0: none, 1: node itself
+ * @param[in]  post    String after XML tree, or NULL
+ * @retval     0       OK
+ * @retval     -1      Error
+ * @see send_msg_reply
+ */
+int
+send_msg_reply_xml(int    s,
+                   char  *pre,
+                   cxobj *xn,
+                   int32_t depth,
+                   char  *post)
+{
+    int               retval = -1;
+    struct clicon_msg hdr;
+    size_t            prelen;
+    size_t            postlen;
+    size_t            xlen = 0;
+    size_t            len;
+
+    prelen = pre?strlen(pre):0;
+    postlen = post?strlen(post):0;
+    if (clixon_xml2chunks(xn, 0, 0, depth, 0, BACKEND_REPLY_CHUNK_SIZE,
+                          send_msg_chunk_len, &xlen) < 0)
+        goto done;
+    len = sizeof(hdr) + prelen + xlen + postlen + 1; /* Include NULL-termination */
+    if (len > UINT32_MAX){
+        clicon_err(OE_PROTO, EMSGSIZE, "Reply too large: %zu bytes", len);
+        goto done;
+    }
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.op_len = htonl(len);
+    clicon_debug(CLIXON_DBG_DETAIL, "%s: send msg len=%zu", __FUNCTION__, len);
+    if (send_msg_write(s, (char*)&hdr, sizeof(hdr)) < 0)
+        goto done;
+    if (prelen && send_msg_write(s, pre, prelen) < 0)
+        goto done;
+    if (clixon_xml2chunks(xn, 0, 0, depth, 0, BACKEND_REPLY_CHUNK_SIZE,
+                          send_msg_chunk_write, &s) < 0)
+        goto done;
+    /* Write also NULL-termination */
+    if (send_msg_write(s, post?post:"", postlen+1) < 0)
         goto done;
     retval = 0;
   done:
-    if (reply)
-        free(reply);
     return retval;
 }
 
 /*! Send a clicon_msg NOTIFY message asynchronously to client
  *
  * @param[in]  s       Socket to communicate with client
- * @param[in]  level
- * @param[in]  event
+ * @param[in]  event   Event as XML string
  * @retval     0       OK
  * @retval     -1      Error
  * @see send_msg_notify_xml
  */
-static int
+int
 send_msg_notify(int           s, 
                 char         *event)
 {
@@ -49,6 +49,7 @@
 #include <errno.h>
 #include <assert.h>
 #include <unistd.h>
+#include <poll.h>
 #include <sys/param.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
@@ -182,26 +183,23 @@ clicon_rpc_msg_once(clicon_handle      h,
     return retval;
 }
 
-/*! Send internal netconf rpc from client to backend
+/*! Send internal netconf rpc from client to backend and return reply as string
  *
- * @param[in]    h      CLICON handle
- * @param[in]    msg    Encoded message. Deallocate with free
- * @param[out]   xret0  Return value from backend as xml tree. Free w xml_free
- * @retval       0      OK
- * @retval      -1      Error
- * @note xret is populated with yangspec according to standard handle yangspec
+ * @param[in]    h        CLICON handle
+ * @param[in]    msg      Encoded message. Deallocate with free
+ * @param[out]   retdata0 Reply from backend as string, or NULL. Free with free
+ * @retval       0        OK
+ * @retval      -1        Error
  * @note side-effect, a socket created here is cached
- * @see clicon_rpc_msg_persistent
- * @see clicon_rpc_close_session
+ * @see clicon_rpc_msg  which parses the reply
  */
-int
-clicon_rpc_msg(clicon_handle      h, 
-               struct clicon_msg *msg, 
-               cxobj            **xret0)
+static int
+rpc_msg_data(clicon_handle      h, 
+             struct clicon_msg *msg, 
+             char             **retdata0)
 {
     int     retval = -1;
     char   *retdata = NULL;
-    cxobj  *xret = NULL;
     int     s = -1;
     int     eof = 0;
 
@@ -209,6 +207,9 @@ clicon_rpc_msg(clicon_handle      h,
 #ifdef RPC_USERNAME_ASSERT
     assert(strstr(msg->op_body, "username")!=NULL); /* XXX */
 #endif
+    /* Replies to outstanding asynchronous rpcs on the same socket come first */
+    if (clicon_rpc_async_wait(h) < 0)
+        goto done;
     /* Create a socket and connect to it, either UNIX, IPv4 or IPv6 per config options */
     if (clicon_rpc_msg_once(h, msg, 1, &retdata, &eof, &s) < 0)
         goto done;
@@ -239,12 +240,48 @@ clicon_rpc_msg(clicon_handle      h,
         goto done;
 #endif
     }
+    *retdata0 = retdata;
+    retdata = NULL;
+    retval = 0;
+ done:
+    clicon_debug(CLIXON_DBG_DETAIL, "%s %d", __FUNCTION__, retval);
+    if (retdata)
+        free(retdata);
+    return retval;
+}
 
+/*! Send internal netconf rpc from client to backend
+ *
+ * @param[in]    h      CLICON handle
+ * @param[in]    msg    Encoded message. Deallocate with free
+ * @param[out]   xret0  Return value from backend as xml tree. Free w xml_free
+ * @retval       0      OK
+ * @retval      -1      Error
+ * @note xret is populated with yangspec according to standard handle yangspec
+ * @note side-effect, a socket created here is cached
+ * @see clicon_rpc_msg_persistent
+ * @see clicon_rpc_close_session
+ */
+int
+clicon_rpc_msg(clicon_handle      h, 
+               struct clicon_msg *msg, 
+               cxobj            **xret0)
+{
+    int     retval = -1;
+    char   *retdata = NULL;
+    cxobj  *xret = NULL;
+    int     ret;
+
+    if (rpc_msg_data(h, msg, &retdata) < 0)
+        goto done;
     if (retdata){
         /* Cannot populate xret here because need to know RPC name (eg "lock") in order to associate yang
          * to reply.
          */
-        if (clixon_xml_parse_string(retdata, YB_NONE, NULL, &xret, NULL) < 0)
+        xml_arena_push();
+        ret = clixon_xml_parse_string(retdata, YB_NONE, NULL, &xret, NULL);
+        xml_arena_pop();
+        if (ret < 0)
             goto done;
     }
     if (xret0){
@@ -253,7 +290,6 @@ clicon_rpc_msg(clicon_handle      h,
     }
     retval = 0;
  done:
-    clicon_debug(CLIXON_DBG_DETAIL, "%s %d", __FUNCTION__, retval);
     if (retdata)
         free(retdata);
     if (xret)
@@ -283,6 +319,7 @@ clicon_rpc_msg_persistent(clicon_handle      h,
     cxobj  *xret = NULL;
     int     s = -1;
     int     eof = 0;
+    int     ret;
 
     if (sock0 == NULL){
         clicon_err(OE_NETCONF, EINVAL, "Missing socket pointer");
@@ -312,7 +349,10 @@ clicon_rpc_msg_persistent(clicon_handle      h,
         /* Cannot populate xret here because need to know RPC name (eg "lock") in order to associate yang
          * to reply.
          */
-        if (clixon_xml_parse_string(retdata, YB_NONE, NULL, &xret, NULL) < 0)
+        xml_arena_push();
+        ret = clixon_xml_parse_string(retdata, YB_NONE, NULL, &xret, NULL);
+        xml_arena_pop();
+        if (ret < 0)
             goto done;
     }
     if (xret0){
@@ -408,6 +448,47 @@ clicon_rpc_netconf(clicon_handle  h,
     return retval;
 }
 
+/*! Bind rpc-reply to yang of the rpc, replace reply with error if binding fails
+ * @param[in]  h       Clixon handle
+ * @param[in]  rpcname Name of rpc the reply is for
+ * @param[in]  xret    Return XML netconf tree
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+rpc_reply_bind(clicon_handle h,
+               char         *rpcname,
+               cxobj        *xret)
+{
+    int        retval = -1;
+    cxobj     *xreply;
+    yang_stmt *yspec;
+    cxobj     *xerr = NULL;
+    cxobj     *xc;
+    int        ret;
+
+    if ((xreply = xml_find_type(xret, NULL, "rpc-reply", CX_ELMNT)) != NULL &&
+        xml_find_type(xreply, NULL, "rpc-error", CX_ELMNT) == NULL){
+        yspec = clicon_dbspec_yang(h);
+        /* Here use rpc name to bind to yang */
+        if ((ret = xml_bind_yang_rpc_reply(h, xreply, rpcname, yspec, &xerr)) < 0) 
+            goto done;
+        if (ret == 0){
+            /* Replace reply with error */
+            if ((xc = xml_child_i(xret, 0)) != NULL)
+                xml_purge(xc);
+            if (xml_addsub(xret, xerr) < 0)
+                goto done;
+            xerr = NULL;
+        }
+    }
+    retval = 0;
+ done:
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
 /*! Generic xml netconf clicon rpc
  *
  * Want to go over to use netconf directly between client and server,...
@@ -436,10 +517,6 @@ clicon_rpc_netconf_xml(clicon_handle  h,
     cbuf      *cb = NULL;
     cxobj     *xname;
     char      *rpcname;
-    cxobj     *xreply;
-    yang_stmt *yspec;
-    cxobj     *xerr = NULL;
-    int        ret;
 
     if ((cb = cbuf_new()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
@@ -454,33 +531,499 @@ clicon_rpc_netconf_xml(clicon_handle  h,
         goto done;
     if (clicon_rpc_netconf(h, cbuf_get(cb), xret, sp) < 0)
         goto done;
-    if ((xreply = xml_find_type(*xret, NULL, "rpc-reply", CX_ELMNT)) != NULL &&
-        xml_find_type(xreply, NULL, "rpc-error", CX_ELMNT) == NULL){
-        yspec = clicon_dbspec_yang(h);
-        /* Here use rpc name to bind to yang */
-        if ((ret = xml_bind_yang_rpc_reply(h, xreply, rpcname, yspec, &xerr)) < 0) 
-            goto done;
-        if (ret == 0){
-            /* Replace reply with error */
-            if (*xret) {
-                cxobj *xc;
-                if ((xc = xml_child_i(*xret, 0)) != NULL)
-                    xml_purge(xc);
-                if (xml_addsub(*xret, xerr) < 0)
-                    goto done;
-                xerr = NULL;
+    if (rpc_reply_bind(h, rpcname, *xret) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*
+ * Asynchronous rpc
+ * Requests are sent on the cached client socket, ie the same socket and backend session
+ * as synchronous rpcs, and several requests may be outstanding. Replies are read by an
+ * event callback on the socket.
+ * The backend handles the messages of a socket one at a time in the order they arrive,
+ * therefore replies arrive in request order and each reply belongs to the oldest
+ * outstanding request. The op_id header field carries the session-id and is not used
+ * to match replies.
+ */
+
+/* Outstanding asynchronous request */
+struct rpc_async_req{
+    qelem_t              ar_q;       /* List header */
+    uint32_t             ar_id;      /* Request id, local to this client */
+    char                *ar_rpcname; /* If set, bind reply to yang of this rpc */
+    clicon_rpc_async_cb *ar_fn;      /* Reply callback, NULL if cancelled */
+    clicon_rpc_async_data_cb *ar_datafn; /* Unparsed reply callback, used instead of ar_fn */
+    void                *ar_arg;     /* Callback argument */
+};
+
+/* Asynchronous rpc state of a client, stored in handle as "rpc-async" while there are
+ * outstanding requests */
+struct rpc_async{
+    int                   as_s;      /* Client socket */
+    clicon_msg_rbuf      *as_rbuf;   /* Receive buffer of as_s */
+    struct rpc_async_req *as_reqs;   /* Outstanding requests in send order */
+    int                   as_nr;     /* Number of outstanding requests */
+};
+
+/* Last request id */
+static uint32_t _rpc_async_id = 0;
+
+static int rpc_async_input(int s, void *arg);
+
+/*! Get asynchronous rpc state of client
+ * @param[in]  h   Clixon handle
+ * @retval     as  Asynchronous state
+ * @retval     NULL No outstanding requests
+ */
+static struct rpc_async *
+rpc_async_get(clicon_handle h)
+{
+    struct rpc_async *as = NULL;
+
+    if (clicon_ptr_get(h, "rpc-async", (void**)&as) < 0)
+        return NULL;
+    return as;
+}
+
+/*! Free an asynchronous request
+ * @param[in]  ar  Request, removed from list
+ */
+static void
+rpc_async_req_free(struct rpc_async_req *ar)
+{
+    if (ar->ar_rpcname)
+        free(ar->ar_rpcname);
+    free(ar);
+}
+
+/*! Free asynchronous rpc state, its requests and event registration, but not the socket
+ * @param[in]  h   Clixon handle
+ * @param[in]  as  Asynchronous state
+ */
+static int
+rpc_async_free(clicon_handle     h,
+               struct rpc_async *as)
+{
+    struct rpc_async_req *ar;
+
+    clixon_event_unreg_fd(as->as_s, rpc_async_input);
+    while ((ar = as->as_reqs) != NULL){
+        DELQ(ar, as->as_reqs, struct rpc_async_req *);
+        rpc_async_req_free(ar);
+    }
+    if (as->as_rbuf)
+        clicon_msg_rbuf_free(as->as_rbuf);
+    if (rpc_async_get(h) == as)
+        clicon_ptr_del(h, "rpc-async");
+    free(as);
+    return 0;
+}
+
+/*! Backend closed the socket: close it and fail all outstanding requests
+ *
+ * Each callback is called with no reply and clicon_err set
+ * @param[in]  h   Clixon handle
+ * @param[in]  as  Asynchronous state, freed
+ * @retval     0   OK
+ * @retval    -1   Error in callback
+ */
+static int
+rpc_async_close(clicon_handle     h,
+                struct rpc_async *as)
+{
+    int                   retval = -1;
+    struct rpc_async_req *ar;
+    int                   ret;
+
+    /* Detach state and socket first, callbacks may make new requests on a new socket */
+    clicon_ptr_del(h, "rpc-async");
+    clixon_event_unreg_fd(as->as_s, rpc_async_input);
+    close(as->as_s);
+    if (clicon_client_socket_get(h) == as->as_s)
+        clicon_client_socket_set(h, -1);
+    while ((ar = as->as_reqs) != NULL){
+        DELQ(ar, as->as_reqs, struct rpc_async_req *);
+        as->as_nr--;
+        if (ar->ar_fn || ar->ar_datafn){
+            clicon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+            if (ar->ar_fn)
+                ret = ar->ar_fn(h, ar->ar_id, NULL, ar->ar_arg);
+            else
+                ret = ar->ar_datafn(h, ar->ar_id, NULL, ar->ar_arg);
+            if (ret < 0){
+                rpc_async_req_free(ar);
+                goto done;
             }
         }
+        rpc_async_req_free(ar);
     }
     retval = 0;
  done:
-    if (xerr)
-        xml_free(xerr);
+    while ((ar = as->as_reqs) != NULL){
+        DELQ(ar, as->as_reqs, struct rpc_async_req *);
+        rpc_async_req_free(ar);
+    }
+    clicon_msg_rbuf_free(as->as_rbuf);
+    free(as);
+    return retval;
+}
+
+/*! Handle a reply message: call callback of oldest outstanding request with parsed reply
+ * @param[in]  h   Clixon handle
+ * @param[in]  as  Asynchronous state
+ * @param[in]  msg Reply message
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+rpc_async_reply(clicon_handle      h,
+                struct rpc_async  *as,
+                struct clicon_msg *msg)
+{
+    int                   retval = -1;
+    struct rpc_async_req *ar;
+    cxobj                *xret = NULL;
+    int                   ret;
+
+    if ((ar = as->as_reqs) == NULL){
+        clicon_err(OE_PROTO, EFAULT, "Reply without outstanding request");
+        goto done;
+    }
+    DELQ(ar, as->as_reqs, struct rpc_async_req *);
+    as->as_nr--;
+    if (ar->ar_datafn){
+        if (ar->ar_datafn(h, ar->ar_id, msg->op_body, ar->ar_arg) < 0)
+            goto done;
+        goto ok;
+    }
+    if (ar->ar_fn == NULL) /* Cancelled */
+        goto ok;
+    xml_arena_push();
+    ret = clixon_xml_parse_string(msg->op_body, YB_NONE, NULL, &xret, NULL);
+    xml_arena_pop();
+    if (ret < 0)
+        goto done;
+    if (ar->ar_rpcname && rpc_reply_bind(h, ar->ar_rpcname, xret) < 0)
+        goto done;
+    if (ar->ar_fn(h, ar->ar_id, xret, ar->ar_arg) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (xret)
+        xml_free(xret);
+    rpc_async_req_free(ar);
+    return retval;
+}
+
+/*! Read replies available on the socket and handle them
+ * @param[in]  h   Clixon handle
+ * @param[in]  as  Asynchronous state, may be freed
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+rpc_async_read(clicon_handle     h,
+               struct rpc_async *as)
+{
+    int                retval = -1;
+    struct clicon_msg *msg;
+    int                eof = 0;
+
+    if (clicon_msg_rcv_buf(as->as_s, as->as_rbuf, &eof) < 0)
+        goto done;
+    while (!eof){
+        /* msg points into as_rbuf, no free */
+        if (clicon_msg_rcv_next(as->as_rbuf, &msg, &eof) < 0)
+            goto done;
+        if (msg == NULL)
+            break;
+        if (rpc_async_reply(h, as, msg) < 0)
+            goto done;
+        /* Callback may have waited for or closed the remaining requests */
+        if (rpc_async_get(h) != as)
+            goto ok;
+        if (as->as_nr == 0){
+            rpc_async_free(h, as);
+            goto ok;
+        }
+    }
+    if (eof && rpc_async_close(h, as) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Event callback for replies to asynchronous rpcs
+ * @param[in]  s    Client socket
+ * @param[in]  arg  Clixon handle
+ */
+static int
+rpc_async_input(int   s,
+                void *arg)
+{
+    clicon_handle     h = (clicon_handle)arg;
+    struct rpc_async *as;
+
+    if ((as = rpc_async_get(h)) == NULL || as->as_s != s){
+        clixon_event_unreg_fd(s, rpc_async_input);
+        return 0;
+    }
+    return rpc_async_read(h, as);
+}
+
+/*! Send an encoded message on the client socket without waiting for the reply
+ * @param[in]  h       Clixon handle
+ * @param[in]  msg     Encoded message
+ * @param[in]  rpcname If set, bind the reply to the yang of this rpc
+ * @param[in]  fn      Reply callback, or NULL
+ * @param[in]  datafn  Unparsed reply callback if fn is NULL
+ * @param[in]  arg     Callback argument
+ * @param[out] reqid   Request id (if not NULL)
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+rpc_async_send(clicon_handle             h,
+               struct clicon_msg        *msg,
+               char                     *rpcname,
+               clicon_rpc_async_cb      *fn,
+               clicon_rpc_async_data_cb *datafn,
+               void                     *arg,
+               uint32_t            *reqid)
+{
+    int                   retval = -1;
+    struct rpc_async     *as;
+    struct rpc_async_req *ar = NULL;
+    int                   s;
+
+    if ((s = clicon_client_socket_get(h)) < 0){
+        if (clicon_rpc_connect(h, &s) < 0)
+            goto done;
+        clicon_client_socket_set(h, s);
+    }
+    if ((as = rpc_async_get(h)) == NULL){
+        if ((as = malloc(sizeof(*as))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memset(as, 0, sizeof(*as));
+        as->as_s = s;
+        if ((as->as_rbuf = clicon_msg_rbuf_new()) == NULL){
+            free(as);
+            goto done;
+        }
+        if (clicon_ptr_set(h, "rpc-async", as) < 0){
+            clicon_msg_rbuf_free(as->as_rbuf);
+            free(as);
+            goto done;
+        }
+        if (clixon_event_reg_fd(s, rpc_async_input, h, "backend rpc replies") < 0){
+            rpc_async_free(h, as);
+            goto done;
+        }
+    }
+    if ((ar = malloc(sizeof(*ar))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(ar, 0, sizeof(*ar));
+    if (rpcname && (ar->ar_rpcname = strdup(rpcname)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if (++_rpc_async_id == 0) /* Skip 0 on wrap */
+        _rpc_async_id++;
+    ar->ar_id = _rpc_async_id;
+    ar->ar_fn = fn;
+    ar->ar_datafn = datafn;
+    ar->ar_arg = arg;
+    if (clicon_msg_send(s, msg) < 0){
+        /* Socket is broken, fail the requests already sent on it */
+        rpc_async_close(h, as);
+        goto done;
+    }
+    ADDQ(ar, as->as_reqs);
+    as->as_nr++;
+    if (reqid)
+        *reqid = ar->ar_id;
+    ar = NULL;
+    retval = 0;
+ done:
+    if (ar)
+        rpc_async_req_free(ar);
+    return retval;
+}
+
+/*! Send internal netconf rpc from client to backend without waiting for the reply
+ *
+ * The reply is handled by the callback when it arrives, from the event loop or from
+ * clicon_rpc_async_wait. If the backend closes the socket, outstanding callbacks are
+ * called with xret NULL and clicon_err set.
+ * The callback must not free xret.
+ * @param[in]  h      Clixon handle
+ * @param[in]  msg    Encoded message. Deallocate with free
+ * @param[in]  fn     Reply callback
+ * @param[in]  arg    Callback argument
+ * @param[out] reqid  Request id, can be used in clicon_rpc_async_cancel (if not NULL)
+ * @retval     0      OK, request sent
+ * @retval    -1      Error
+ * @note Uses the cached client socket, a synchronous rpc first waits for all
+ *       outstanding asynchronous replies
+ * @see clicon_rpc_msg  synchronous variant
+ */
+int
+clicon_rpc_msg_async(clicon_handle        h,
+                     struct clicon_msg   *msg,
+                     clicon_rpc_async_cb *fn,
+                     void                *arg,
+                     uint32_t            *reqid)
+{
+    return rpc_async_send(h, msg, NULL, fn, NULL, arg, reqid);
+}
+
+/*! Generic xml netconf clicon rpc without waiting for the reply
+ *
+ * The reply is bound to yang as in clicon_rpc_netconf_xml
+ * @param[in]  h      Clixon handle
+ * @param[in]  xml    XML netconf tree
+ * @param[in]  fn     Reply callback
+ * @param[in]  arg    Callback argument
+ * @param[out] reqid  Request id (if not NULL)
+ * @retval     0      OK, request sent
+ * @retval    -1      Error
+ * @code
+ *   static int
+ *   reply_cb(clicon_handle h, uint32_t reqid, cxobj *xret, void *arg)
+ *   {
+ *      if (xret == NULL)
+ *         return -1; // Backend closed
+ *      ...
+ *   }
+ *   if (clicon_rpc_netconf_xml_async(h, x, reply_cb, arg, NULL) < 0)
+ *      err;
+ * @endcode
+ * @see clicon_rpc_netconf_xml  synchronous variant
+ */
+int
+clicon_rpc_netconf_xml_async(clicon_handle        h,
+                             cxobj               *xml,
+                             clicon_rpc_async_cb *fn,
+                             void                *arg,
+                             uint32_t            *reqid)
+{
+    int                retval = -1;
+    uint32_t           session_id;
+    struct clicon_msg *msg = NULL;
+    cbuf              *cb = NULL;
+    cxobj             *xname;
+
+    if ((xname = xml_child_i_type(xml, 0, 0)) == NULL){
+        clicon_err(OE_NETCONF, EINVAL, "Missing rpc name");
+        goto done;
+    }
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2cbuf(cb, xml, 0, 0, -1, 0) < 0)
+        goto done;
+    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
+        goto done;
+    if (rpc_async_send(h, msg, xml_name(xname), fn, NULL, arg, reqid) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (msg)
+        free(msg);
     if (cb)
         cbuf_free(cb);
     return retval;
 }
 
+/*! Cancel an outstanding asynchronous rpc
+ *
+ * The request is still processed by the backend but its callback is not called
+ * @param[in]  h      Clixon handle
+ * @param[in]  reqid  Request id
+ * @retval     1      Cancelled
+ * @retval     0      No such outstanding request
+ */
+int
+clicon_rpc_async_cancel(clicon_handle h,
+                        uint32_t      reqid)
+{
+    struct rpc_async     *as;
+    struct rpc_async_req *ar;
+
+    if ((as = rpc_async_get(h)) == NULL)
+        return 0;
+    if ((ar = as->as_reqs) != NULL)
+        do {
+            if (ar->ar_id == reqid){
+                ar->ar_fn = NULL;
+                ar->ar_datafn = NULL;
+                return 1;
+            }
+            ar = NEXTQ(struct rpc_async_req *, ar);
+        } while (ar && ar != as->as_reqs);
+    return 0;
+}
+
+/*! Get number of outstanding asynchronous rpcs
+ * @param[in]  h   Clixon handle
+ * @retval     nr  Number of requests sent without reply
+ */
+int
+clicon_rpc_async_pending(clicon_handle h)
+{
+    struct rpc_async *as;
+
+    if ((as = rpc_async_get(h)) == NULL)
+        return 0;
+    return as->as_nr;
+}
+
+/*! Block until all outstanding asynchronous rpcs are replied and their callbacks called
+ *
+ * Use before any action that must be ordered after the outstanding requests
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+clicon_rpc_async_wait(clicon_handle h)
+{
+    int               retval = -1;
+    struct rpc_async *as;
+    struct pollfd     pfd = {0,};
+
+    while ((as = rpc_async_get(h)) != NULL){
+        pfd.fd = as->as_s;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, -1) < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_EVENTS, errno, "poll");
+            goto done;
+        }
+        if (rpc_async_read(h, as) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Get database configuration
  *
  * Same as clicon_proto_change just with a cvec instead of lvec
@@ -914,63 +1457,34 @@ clicon_rpc_unlock(clicon_handle h,
     return retval;
 }
 
-/*! Get database configuration and state data
+/*! Encode a get request
+ *
  * @param[in]  h         Clicon handle
  * @param[in]  xpath     XPath in a filter stmt (or NULL/"" for no filter)
- * @param[in]  namespace Namespace associated w xpath
  * @param[in]  nsc       Namespace context for filter
  * @param[in]  content   Clixon extension: all, config, noconfig. -1 means all
  * @param[in]  depth     Nr of XML levels to get, -1 is all, 0 is none
  * @param[in]  defaults  Value of the with-defaults mode, rfc6243, or NULL
- * @param[out] xt        XML tree. Free with xml_free. 
- *                       Either <config> or <rpc-error>. 
- * @retval     0         OK
- * @retval    -1         Error, fatal or xml
- * @note if xpath is set but namespace is NULL, the default, netconf base 
- *       namespace will be used which is most probably wrong.
- * @code
- *  cxobj *xt = NULL;
- *  cvec *nsc = NULL;
- *
- *  if ((nsc = xml_nsctx_init(NULL, "urn:example:hello")) == NULL)
- *     err;
- *  if (clicon_rpc_get(h, "/hello/world", nsc, CONTENT_ALL, -1, &xt) < 0)
- *     err;
- *  if ((xerr = xpath_first(xt, NULL, "/rpc-error")) != NULL){
- *     clixon_netconf_error(xerr, "clicon_rpc_get", NULL);
- *     err;
- *  }
- *  if (xt)
- *     xml_free(xt);
- *  if (nsc)
- *     xml_nsctx_free(nsc);
- * @endcode
- * @see clicon_rpc_get_config which is almost the same as with content=config, but you can also select dbname
- * @see clixon_netconf_error
- * @note the netconf return message is yang populated, as well as the return data
+ * @param[in]  format    Clixon extension: data only reply in FORMAT_XML/FORMAT_JSON, -1 is netconf
+ * @param[in]  pretty    Clixon extension: pretty-print data only reply
+ * @retval     msg       Encoded message. Free with free
+ * @retval     NULL      Error
  */
-int
-clicon_rpc_get(clicon_handle   h,
+static struct clicon_msg *
+rpc_get_encode(clicon_handle   h,
                char           *xpath,
-               cvec           *nsc, /* namespace context for filter */
+               cvec           *nsc,
                netconf_content content,
                int32_t         depth,
                char           *defaults,
-               cxobj         **xt)
+               int             format,
+               int             pretty)
 {
-    int                retval = -1;
     struct clicon_msg *msg = NULL;
     cbuf              *cb = NULL;
-    cxobj             *xret = NULL;
-    cxobj             *xerr = NULL;
-    cxobj             *xd = NULL;
     char              *username;
     uint32_t           session_id;
-    int                ret;
-    yang_stmt         *yspec;
-    cvec              *nscd = NULL;
-    
-    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+
     if (session_id_check(h, &session_id) < 0)
         goto done;
     if ((cb = cbuf_new()) == NULL){
@@ -997,6 +1511,15 @@ clicon_rpc_get(clicon_handle   h,
                 CLIXON_LIB_PREFIX,
                 depth,
                 CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    /* Clixon extension, format=xml|json and pretty=true */
+    if (format != -1){
+        cprintf(cb, " %s:format=\"%s\" xmlns:%s=\"%s\"",
+                CLIXON_LIB_PREFIX,
+                format_int2str(format),
+                CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+        if (pretty)
+            cprintf(cb, " %s:pretty=\"true\"", CLIXON_LIB_PREFIX);
+    }
     cprintf(cb, ">"); /* get */
     /* If xpath, add a filter */
     if (xpath && strlen(xpath)) {
@@ -1012,8 +1535,68 @@ clicon_rpc_get(clicon_handle   h,
                 IETF_NETCONF_WITH_DEFAULTS_YANG_NAMESPACE,
                 defaults);
     cprintf(cb, "</get></rpc>");
-    if ((msg = clicon_msg_encode(session_id,
-                                 "%s", cbuf_get(cb))) == NULL)
+    msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb));
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return msg;
+}
+
+/*! Get database configuration and state data
+ * @param[in]  h         Clicon handle
+ * @param[in]  xpath     XPath in a filter stmt (or NULL/"" for no filter)
+ * @param[in]  namespace Namespace associated w xpath
+ * @param[in]  nsc       Namespace context for filter
+ * @param[in]  content   Clixon extension: all, config, noconfig. -1 means all
+ * @param[in]  depth     Nr of XML levels to get, -1 is all, 0 is none
+ * @param[in]  defaults  Value of the with-defaults mode, rfc6243, or NULL
+ * @param[out] xt        XML tree. Free with xml_free. 
+ *                       Either <config> or <rpc-error>. 
+ * @retval     0         OK
+ * @retval    -1         Error, fatal or xml
+ * @note if xpath is set but namespace is NULL, the default, netconf base 
+ *       namespace will be used which is most probably wrong.
+ * @code
+ *  cxobj *xt = NULL;
+ *  cvec *nsc = NULL;
+ *
+ *  if ((nsc = xml_nsctx_init(NULL, "urn:example:hello")) == NULL)
+ *     err;
+ *  if (clicon_rpc_get(h, "/hello/world", nsc, CONTENT_ALL, -1, &xt) < 0)
+ *     err;
+ *  if ((xerr = xpath_first(xt, NULL, "/rpc-error")) != NULL){
+ *     clixon_netconf_error(xerr, "clicon_rpc_get", NULL);
+ *     err;
+ *  }
+ *  if (xt)
+ *     xml_free(xt);
+ *  if (nsc)
+ *     xml_nsctx_free(nsc);
+ * @endcode
+ * @see clicon_rpc_get_config which is almost the same as with content=config, but you can also select dbname
+ * @see clixon_netconf_error
+ * @note the netconf return message is yang populated, as well as the return data
+ */
+int
+clicon_rpc_get(clicon_handle   h,
+               char           *xpath,
+               cvec           *nsc, /* namespace context for filter */
+               netconf_content content,
+               int32_t         depth,
+               char           *defaults,
+               cxobj         **xt)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+    cxobj             *xret = NULL;
+    cxobj             *xerr = NULL;
+    cxobj             *xd = NULL;
+    int                ret;
+    yang_stmt         *yspec;
+    cvec              *nscd = NULL;
+    
+    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    if ((msg = rpc_get_encode(h, xpath, nsc, content, depth, defaults, -1, 0)) == NULL)
         goto done;
     if (clicon_rpc_msg(h, msg, &xret) < 0)
         goto done;
@@ -1057,8 +1640,6 @@ clicon_rpc_get(clicon_handle   h,
     clicon_debug(CLIXON_DBG_DETAIL, "%s %d", __FUNCTION__, retval);
     if (nscd)
         cvec_free(nscd);
-    if (cb)
-        cbuf_free(cb);
     if (xerr)
         xml_free(xerr);
     if (xret)
@@ -1068,6 +1649,183 @@ clicon_rpc_get(clicon_handle   h,
     return retval;
 }
 
+/*! Get database configuration and state data printed by the backend in XML or JSON
+ *
+ * The backend replies with the data selected by xpath only, printed in the requested
+ * format as a RESTCONF data resource, and the reply is not parsed. The data of the
+ * datastore root is the data element, eg {"ietf-restconf:data":...}
+ * @param[in]  h         Clicon handle
+ * @param[in]  xpath     XPath in a filter stmt (or NULL/"" for no filter)
+ * @param[in]  nsc       Namespace context for filter
+ * @param[in]  content   Clixon extension: all, config, noconfig. -1 means all
+ * @param[in]  depth     Nr of XML levels to get, -1 is all, 0 is none
+ * @param[in]  defaults  Value of the with-defaults mode, rfc6243, or NULL
+ * @param[in]  format    FORMAT_XML or FORMAT_JSON
+ * @param[in]  pretty    Pretty-print
+ * @param[out] cbdata    Data, empty if xpath selects no data
+ * @param[out] xerr      Error reply on the form <rpc-reply><rpc-error>... Free with xml_free
+ * @retval     1         OK, data in cbdata
+ * @retval     0         Error reply in xerr
+ * @retval    -1         Error, fatal
+ * @code
+ *  cbuf  *cb = cbuf_new();
+ *  cxobj *xerr = NULL;
+ *
+ *  if ((ret = clicon_rpc_get_format(h, "/hello/world", nsc, CONTENT_ALL, -1, NULL,
+ *                                   FORMAT_JSON, 0, cb, &xerr)) < 0)
+ *     err;
+ *  if (ret == 0)
+ *     clixon_netconf_error(xpath_first(xerr, NULL, "rpc-reply/rpc-error"), "Get", NULL);
+ * @endcode
+ * @see clicon_rpc_get  which returns parsed XML
+ * @see clicon_rpc_get_format_async  asynchronous variant
+ */
+int
+clicon_rpc_get_format(clicon_handle   h,
+                      char           *xpath,
+                      cvec           *nsc,
+                      netconf_content content,
+                      int32_t         depth,
+                      char           *defaults,
+                      enum format_enum format,
+                      int             pretty,
+                      cbuf           *cbdata,
+                      cxobj         **xerr)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+    char              *retdata = NULL;
+
+    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    if (format != FORMAT_XML && format != FORMAT_JSON){
+        clicon_err(OE_PROTO, EINVAL, "Unsupported format: %s", format_int2str(format));
+        goto done;
+    }
+    if ((msg = rpc_get_encode(h, xpath, nsc, content, depth, defaults, format, pretty)) == NULL)
+        goto done;
+    if (rpc_msg_data(h, msg, &retdata) < 0)
+        goto done;
+    retval = clicon_rpc_get_format_reply(retdata, cbdata, xerr);
+ done:
+    clicon_debug(CLIXON_DBG_DETAIL, "%s %d", __FUNCTION__, retval);
+    if (retdata)
+        free(retdata);
+    if (msg)
+        free(msg);
+    return retval;
+}
+
+/*! Get data printed by the backend in XML or JSON without waiting for the reply
+ *
+ * The callback is called with the unparsed reply, split it with
+ * clicon_rpc_get_format_reply
+ * @param[in]  h         Clicon handle
+ * @param[in]  xpath     XPath in a filter stmt (or NULL/"" for no filter)
+ * @param[in]  nsc       Namespace context for filter
+ * @param[in]  content   Clixon extension: all, config, noconfig. -1 means all
+ * @param[in]  depth     Nr of XML levels to get, -1 is all, 0 is none
+ * @param[in]  defaults  Value of the with-defaults mode, rfc6243, or NULL
+ * @param[in]  format    FORMAT_XML or FORMAT_JSON
+ * @param[in]  pretty    Pretty-print
+ * @param[in]  fn        Reply callback
+ * @param[in]  arg       Callback argument
+ * @param[out] reqid     Request id, can be used in clicon_rpc_async_cancel (if not NULL)
+ * @retval     0         OK, request sent
+ * @retval    -1         Error
+ * @code
+ *   static int
+ *   get_cb(clicon_handle h, uint32_t reqid, char *data, void *arg)
+ *   {
+ *      if (data == NULL)
+ *         return -1; // Backend closed
+ *      if ((ret = clicon_rpc_get_format_reply(data, cb, &xerr)) < 0)
+ *         return -1;
+ *      ...
+ *   }
+ *   if (clicon_rpc_get_format_async(h, "/hello/world", nsc, CONTENT_ALL, -1, NULL,
+ *                                   FORMAT_JSON, 0, get_cb, arg, NULL) < 0)
+ *      err;
+ * @endcode
+ * @see clicon_rpc_get_format  synchronous variant
+ */
+int
+clicon_rpc_get_format_async(clicon_handle             h,
+                            char                     *xpath,
+                            cvec                     *nsc,
+                            netconf_content           content,
+                            int32_t                   depth,
+                            char                     *defaults,
+                            enum format_enum          format,
+                            int                       pretty,
+                            clicon_rpc_async_data_cb *fn,
+                            void                     *arg,
+                            uint32_t                 *reqid)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+
+    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    if (format != FORMAT_XML && format != FORMAT_JSON){
+        clicon_err(OE_PROTO, EINVAL, "Unsupported format: %s", format_int2str(format));
+        goto done;
+    }
+    if ((msg = rpc_get_encode(h, xpath, nsc, content, depth, defaults, format, pretty)) == NULL)
+        goto done;
+    if (rpc_async_send(h, msg, NULL, NULL, fn, arg, reqid) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (msg)
+        free(msg);
+    return retval;
+}
+
+/*! Split reply to a get with format into data or error
+ *
+ * @param[in]  data      Reply from the backend, or NULL
+ * @param[out] cbdata    Data, empty if xpath selects no data
+ * @param[out] xerr      Error reply on the form <rpc-reply><rpc-error>... Free with xml_free
+ * @retval     1         OK, data appended to cbdata
+ * @retval     0         Error reply in xerr
+ * @retval    -1         Error, fatal
+ * @see clicon_rpc_get_format
+ */
+int
+clicon_rpc_get_format_reply(char   *data,
+                            cbuf   *cbdata,
+                            cxobj **xerr)
+{
+    int    retval = -1;
+    cxobj *xret = NULL;
+    cbuf  *cbprefix = NULL;
+
+    if ((cbprefix = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    /* Errors are netconf replies, data is printed in data node namespaces */
+    cprintf(cbprefix, "<rpc-reply xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    if (data && strncmp(data, cbuf_get(cbprefix), cbuf_len(cbprefix)) == 0){
+        if (clixon_xml_parse_string(data, YB_NONE, NULL, &xret, NULL) < 0)
+            goto done;
+        if (xerr){
+            *xerr = xret;
+            xret = NULL;
+        }
+        retval = 0;
+        goto done;
+    }
+    if (data)
+        cbuf_append_str(cbdata, data);
+    retval = 1;
+ done:
+    if (cbprefix)
+        cbuf_free(cbprefix);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
 /*! Get database configuration and state data collection
  *
  * @param[in]  h         Clicon handle
@@ -38,6 +38,9 @@
  * 1) Base stream handling: stream_find/register/delete_all/get_xml
  * 2) Stream subscription handling (stream_ss_add/delete/timeout, stream_notify, etc
  * 3) Stream replay: stream_replay/_add
+ *    Replayable events are serialized and appended to segment files with a sparse time
+ *    index. Segments are files in CLICON_STREAM_REPLAY_DIR, and are then kept over a
+ *    restart, or else unlinked temporary files.
  * 4) nginx/nchan publish code (use --enable-publish config option)
  *
  *
@@ -64,7 +67,13 @@
 #include <errno.h>
 #include <inttypes.h>
 #include <syslog.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/uio.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -90,6 +99,30 @@
 /* Go through and timeout subscription timers [s] */
 #define STREAM_TIMER_TIMEOUT_S 5
 
+/* Max size of a replay segment file before a new segment is started [bytes] */
+#define STREAM_REPLAY_SEGMENT_SIZE (1024*1024)
+
+/* A replay segment is at most this part of the max replay size, since the max size is
+ * upheld by removing whole segments */
+#define STREAM_REPLAY_SEGMENT_PART 4
+
+/* Number of events between entries of the sparse replay time index */
+#define STREAM_REPLAY_INDEX_INTERVAL 32
+
+/* Magic number of replay event records, "CLRP" */
+#define STREAM_REPLAY_MAGIC 0x434c5250
+
+/* Replay event record header in a segment file, followed by the event as XML string */
+struct stream_replay_hdr{
+    uint32_t rh_magic; /* STREAM_REPLAY_MAGIC */
+    uint32_t rh_len;   /* Length of event XML string */
+    int64_t  rh_sec;   /* Event timestamp */
+    int64_t  rh_usec;
+};
+
+static int stream_replay_load(event_stream_t *es);
+static int stream_replay_free(event_stream_t *es, struct stream_replay *r, int rm);
+
 /*! Find an event notification stream given name
  * @param[in]  h    Clicon handle
  * @param[in]  name Name of stream
@@ -129,6 +162,8 @@ stream_add(clicon_handle   h,
 {
     int             retval = -1;
     event_stream_t *es;
+    char           *dir;
+    char           *str;
 
     if ((es = stream_find(h, name)) != NULL)
         goto ok;
@@ -149,6 +184,18 @@ stream_add(clicon_handle   h,
     if (retention)
         es->es_retention = *retention;
     clicon_stream_append(h, es);
+    if (replay_enabled){
+        if ((dir = clicon_option_str(h, "CLICON_STREAM_REPLAY_DIR")) != NULL &&
+            (es->es_replay_dir = strdup(dir)) == NULL){
+            clicon_err(OE_XML, errno, "strdup");
+            goto done;
+        }
+        if ((str = clicon_option_str(h, "CLICON_STREAM_REPLAY_MAXSIZE")) != NULL)
+            es->es_replay_maxsize = strtoul(str, NULL, 10);
+        /* Read replay segments of earlier runs */
+        if (es->es_replay_dir && stream_replay_load(es) < 0)
+            goto done;
+    }
  ok:
     retval = 0;
  done:
@@ -177,12 +224,10 @@ stream_delete_all(clicon_handle h,
             free(es->es_description);
         while ((ss = es->es_subscription) != NULL)
             stream_ss_rm(h, es, ss, force); /* XXX in some cases leaks memory due to DONT clause in stream_ss_rm() */
-        while ((r = es->es_replay) != NULL){
-            DELQ(r, es->es_replay, struct stream_replay *);
-            if (r->r_xml)
-                xml_free(r->r_xml);
-            free(r);
-        }
+        while ((r = es->es_replay) != NULL)
+            stream_replay_free(es, r, 0);
+        if (es->es_replay_dir)
+            free(es->es_replay_dir);
         free(es);
     }
     return 0;
@@ -249,7 +294,6 @@ stream_timer_setup(int   fd,
     struct stream_subscription  *ss;
     struct stream_subscription  *ss1;
     struct stream_replay        *r;
-    struct stream_replay        *r1;
     
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
     /* Go thru callbacks and see if any have timed out, if so remove them 
@@ -276,22 +320,14 @@ stream_timer_setup(int   fd,
                     else
                         ss = NEXTQ(struct stream_subscription *, ss);
                 } while (ss && ss != es->es_subscription);
-  /* 2) Go throughreplay buffer and remove entries with passed retention time */
-            if (timerisset(&es->es_retention) &&
-                (r = es->es_replay) != NULL){
+  /* 2) Go through replay segments and remove those whose last entry has passed
+   *    retention time. Older entries in remaining segments are skipped on replay */
+            if (timerisset(&es->es_retention)){
                 timersub(&now, &es->es_retention, &tret);
-                do {
-                    if (timercmp(&r->r_tv, &tret, <)){
-                        r1 = NEXTQ(struct stream_replay *, r);
-                        DELQ(r, es->es_replay, struct stream_replay *);
-                        if (r->r_xml)
-                            xml_free(r->r_xml);
-                        free(r);
-                        r = r1;
-                    }
-                    else
-                        r = NEXTQ(struct stream_replay *, r);
-                } while (r && r!=es->es_replay);
+                while ((r = es->es_replay) != NULL &&
+                       timercmp(&r->r_last, &tret, <))
+                    if (stream_replay_free(es, r, 1) < 0)
+                        goto done;
             }
             es = NEXTQ(struct event_stream *, es);
         } while (es && es != clicon_stream(h));
@@ -593,11 +629,9 @@ stream_notify(clicon_handle h,
         goto done;
     if (stream_notify1(h, es, &tv, xev) < 0)
         goto done;
-    if (es->es_replay_enabled){
-        if (stream_replay_add(es, &tv, xev) < 0)
-            goto done;
-        xev = NULL; /* xml stored in replay_add and should not be freed */
-    }
+    if (es->es_replay_enabled &&
+        stream_replay_add(es, &tv, xev) < 0)
+        goto done;
  ok:
     retval = 0;
   done:
@@ -662,11 +696,9 @@ stream_notify_xml(clicon_handle h,
         goto done;
     if (stream_notify1(h, es, &tv, xev) < 0)
         goto done;
-    if (es->es_replay_enabled){
-        if (stream_replay_add(es, &tv, xev) < 0)
-            goto done;
-        xev = NULL; /* xml stored in replay_add and should not be freed */
-    }
+    if (es->es_replay_enabled &&
+        stream_replay_add(es, &tv, xev) < 0)
+        goto done;
  ok:
     retval = 0;
   done:
@@ -680,6 +712,388 @@ stream_notify_xml(clicon_handle h,
 }
 
 
+/*! Get file name of a replay segment
+ * @param[in]  es   Stream
+ * @param[in]  nr   Segment sequence number
+ * @param[out] cb   File name
+ */
+static int
+stream_replay_path(event_stream_t *es,
+                   uint32_t        nr,
+                   cbuf           *cb)
+{
+    cprintf(cb, "%s/%s-%08u.replay", es->es_replay_dir, es->es_name, nr);
+    return 0;
+}
+
+/*! Remove replay segment from stream and free it
+ * @param[in]  es   Stream
+ * @param[in]  r    Replay segment
+ * @param[in]  rm   If set, also remove segment file
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+stream_replay_free(event_stream_t       *es,
+                   struct stream_replay *r,
+                   int                   rm)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+
+    DELQ(r, es->es_replay, struct stream_replay *);
+    es->es_replay_size -= r->r_size;
+    if (r->r_fd != -1)
+        close(r->r_fd);
+    if (rm && es->es_replay_dir){
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        stream_replay_path(es, r->r_nr, cb);
+        if (unlink(cbuf_get(cb)) < 0 && errno != ENOENT){
+            clicon_err(OE_UNIX, errno, "unlink %s", cbuf_get(cb));
+            goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (r->r_index)
+        free(r->r_index);
+    free(r);
+    return retval;
+}
+
+/*! Account for an event record in a replay segment, and add it to the time index
+ * @param[in]  r    Replay segment
+ * @param[in]  tv   Timestamp of event
+ * @param[in]  off  File offset of event record
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+stream_replay_index_add(struct stream_replay *r,
+                        struct timeval       *tv,
+                        off_t                 off)
+{
+    int                         retval = -1;
+    struct stream_replay_index *ri;
+
+    if (r->r_count % STREAM_REPLAY_INDEX_INTERVAL == 0){
+        if ((ri = realloc(r->r_index, (r->r_ilen+1)*sizeof(*ri))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            goto done;
+        }
+        r->r_index = ri;
+        ri[r->r_ilen].ri_tv = *tv;
+        ri[r->r_ilen].ri_off = off;
+        r->r_ilen++;
+    }
+    if (r->r_count == 0)
+        r->r_first = *tv;
+    r->r_last = *tv;
+    r->r_count++;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Read event record header from replay segment
+ * @param[in]  r    Replay segment
+ * @param[in]  off  File offset of event record
+ * @param[out] rh   Event record header
+ * @retval     1    OK
+ * @retval     0    No complete record at offset
+ * @retval    -1    Error
+ */
+static int
+stream_replay_hdr_read(struct stream_replay     *r,
+                       off_t                     off,
+                       struct stream_replay_hdr *rh)
+{
+    ssize_t n;
+
+    if ((n = pread(r->r_fd, rh, sizeof(*rh), off)) < 0){
+        clicon_err(OE_UNIX, errno, "pread");
+        return -1;
+    }
+    if (n != sizeof(*rh) ||
+        rh->rh_magic != STREAM_REPLAY_MAGIC ||
+        off + sizeof(*rh) + rh->rh_len > r->r_size)
+        return 0;
+    return 1;
+}
+
+/*! Create replay segment and add it last in stream
+ * @param[in]  es   Stream
+ * @param[in]  nr   Segment sequence number
+ * @param[in]  load If set, open existing segment file and read its time index
+ * @retval     r    Replay segment
+ * @retval     NULL Error
+ * A segment file without replay directory is an unlinked temporary file.
+ * A loaded segment is truncated after its last complete event record.
+ */
+static struct stream_replay *
+stream_replay_segment(event_stream_t *es,
+                      uint32_t        nr,
+                      int             load)
+{
+    struct stream_replay    *r = NULL;
+    struct stream_replay_hdr rh;
+    cbuf                    *cb = NULL;
+    FILE                    *f;
+    struct stat              st;
+    struct timeval           tv;
+    off_t                    off;
+    int                      ret;
+
+    if ((r = malloc(sizeof(*r))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(r, 0, sizeof(*r));
+    r->r_nr = nr;
+    r->r_fd = -1;
+    ADDQ(r, es->es_replay);
+    if (es->es_replay_dir == NULL){
+        if ((f = tmpfile()) == NULL){
+            clicon_err(OE_UNIX, errno, "tmpfile");
+            goto fail;
+        }
+        r->r_fd = dup(fileno(f));
+        fclose(f);
+        if (r->r_fd < 0){
+            clicon_err(OE_UNIX, errno, "dup");
+            goto fail;
+        }
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto fail;
+    }
+    stream_replay_path(es, nr, cb);
+    if ((r->r_fd = open(cbuf_get(cb), O_RDWR|O_CREAT|(load?0:O_TRUNC), S_IRUSR|S_IWUSR)) < 0){
+        clicon_err(OE_UNIX, errno, "open %s", cbuf_get(cb));
+        goto fail;
+    }
+    if (!load)
+        goto done;
+    if (fstat(r->r_fd, &st) < 0){
+        clicon_err(OE_UNIX, errno, "fstat %s", cbuf_get(cb));
+        goto fail;
+    }
+    r->r_size = st.st_size;
+    off = 0;
+    while ((ret = stream_replay_hdr_read(r, off, &rh)) == 1){
+        tv.tv_sec = rh.rh_sec;
+        tv.tv_usec = rh.rh_usec;
+        if (stream_replay_index_add(r, &tv, off) < 0)
+            goto fail;
+        off += sizeof(rh) + rh.rh_len;
+    }
+    if (ret < 0)
+        goto fail;
+    if (off < r->r_size){
+        clicon_log(LOG_WARNING, "%s: truncating replay segment %s at %jd",
+                   __FUNCTION__, cbuf_get(cb), (intmax_t)off);
+        if (ftruncate(r->r_fd, off) < 0){
+            clicon_err(OE_UNIX, errno, "ftruncate %s", cbuf_get(cb));
+            goto fail;
+        }
+        r->r_size = off;
+    }
+ done:
+    if (r)
+        es->es_replay_size += r->r_size;
+    if (cb)
+        cbuf_free(cb);
+    return r;
+ fail:
+    es->es_replay_size += r->r_size;
+    stream_replay_free(es, r, 0);
+    r = NULL;
+    goto done;
+}
+
+/*! Sort replay segment numbers
+ */
+static int
+stream_replay_nr_cmp(const void *a,
+                     const void *b)
+{
+    uint32_t na = *(uint32_t*)a;
+    uint32_t nb = *(uint32_t*)b;
+
+    return na < nb ? -1 : na > nb;
+}
+
+/*! Read replay segments of stream in replay directory, eg from an earlier run
+ * @param[in]  es   Stream
+ * @retval     0    OK
+ * @retval    -1    Error
+ * Segment files are named <dir>/<stream>-<nr>.replay and are added in number order.
+ * The time index of each segment is built by reading its record headers.
+ */
+static int
+stream_replay_load(event_stream_t *es)
+{
+    int            retval = -1;
+    DIR           *dirp = NULL;
+    struct dirent *de;
+    uint32_t      *vec = NULL;
+    uint32_t      *v;
+    size_t         len = 0;
+    size_t         nlen;
+    unsigned long  nr;
+    char          *end;
+    int            i;
+
+    if ((dirp = opendir(es->es_replay_dir)) == NULL){
+        clicon_err(OE_UNIX, errno, "opendir %s", es->es_replay_dir);
+        goto done;
+    }
+    nlen = strlen(es->es_name);
+    while ((de = readdir(dirp)) != NULL){
+        if (strncmp(de->d_name, es->es_name, nlen) != 0 ||
+            de->d_name[nlen] != '-')
+            continue;
+        nr = strtoul(de->d_name+nlen+1, &end, 10);
+        if (end == de->d_name+nlen+1 || strcmp(end, ".replay") != 0)
+            continue;
+        if ((v = realloc(vec, (len+1)*sizeof(*vec))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            goto done;
+        }
+        vec = v;
+        vec[len++] = nr;
+    }
+    if (vec)
+        qsort(vec, len, sizeof(*vec), stream_replay_nr_cmp);
+    for (i=0; i<len; i++)
+        if (stream_replay_segment(es, vec[i], 1) == NULL)
+            goto done;
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    if (dirp)
+        closedir(dirp);
+    return retval;
+}
+
+/*! Get file offset in replay segment to start reading events at a given time
+ * @param[in]  r      Replay segment
+ * @param[in]  start  Start time
+ * @retval     off    Offset of an event record before the first event at or after start
+ * Binary search of the sparse time index for the last entry before start
+ */
+static off_t
+stream_replay_seek(struct stream_replay *r,
+                   struct timeval       *start)
+{
+    size_t lo = 0;
+    size_t hi = r->r_ilen;
+    size_t mid;
+
+    while (lo < hi){
+        mid = (lo + hi)/2;
+        if (timercmp(&r->r_index[mid].ri_tv, start, <))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo ? r->r_index[lo-1].ri_off : 0;
+}
+
+/*! Replay events of one segment to a subscription, from file without parsing if possible
+ * @param[in]     h      Clicon handle
+ * @param[in]     ss     Subscription
+ * @param[in]     r      Replay segment
+ * @param[in]     start  Skip events before this time
+ * @param[in,out] buf    Event buffer, realloced
+ * @param[in,out] buflen Size of event buffer
+ * @retval        1      OK, continue with next segment
+ * @retval        0      OK, stoptime passed
+ * @retval       -1      Error
+ * Events are sent as strings if the subscription has a string callback, otherwise they
+ * are parsed to XML
+ */
+static int
+stream_replay_segment_notify(clicon_handle               h,
+                             struct stream_subscription *ss,
+                             struct stream_replay       *r,
+                             struct timeval             *start,
+                             char                      **buf,
+                             size_t                     *buflen)
+{
+    int                      retval = -1;
+    struct stream_replay_hdr rh;
+    struct timeval           tv;
+    off_t                    off;
+    char                    *b;
+    cxobj                   *xev = NULL;
+    yang_stmt               *yspec;
+    int                      ret;
+
+    off = stream_replay_seek(r, start);
+    while ((ret = stream_replay_hdr_read(r, off, &rh)) == 1){
+        tv.tv_sec = rh.rh_sec;
+        tv.tv_usec = rh.rh_usec;
+        if (timercmp(&tv, start, <)){
+            off += sizeof(rh) + rh.rh_len;
+            continue;
+        }
+        if (timerisset(&ss->ss_stoptime) &&
+            timercmp(&tv, &ss->ss_stoptime, >))
+            goto stop;
+        if (*buflen < rh.rh_len + 1){
+            if ((b = realloc(*buf, rh.rh_len + 1)) == NULL){
+                clicon_err(OE_UNIX, errno, "realloc");
+                goto done;
+            }
+            *buf = b;
+            *buflen = rh.rh_len + 1;
+        }
+        if (pread(r->r_fd, *buf, rh.rh_len, off + sizeof(rh)) != rh.rh_len){
+            clicon_err(OE_UNIX, errno, "pread");
+            goto done;
+        }
+        (*buf)[rh.rh_len] = '\0';
+        if (ss->ss_strfn){
+            if ((*ss->ss_strfn)(h, *buf, ss->ss_arg) < 0)
+                goto done;
+        }
+        else {
+            if ((yspec = clicon_dbspec_yang(h)) == NULL){
+                clicon_err(OE_YANG, 0, "No yang spec");
+                goto done;
+            }
+            if (clixon_xml_parse_string(*buf, YB_MODULE, yspec, &xev, NULL) < 0)
+                goto done;
+            if (xml_rootchild(xev, 0, &xev) < 0)
+                goto done;
+            if ((*ss->ss_fn)(h, 0, xev, ss->ss_arg) < 0)
+                goto done;
+            xml_free(xev);
+            xev = NULL;
+        }
+        off += sizeof(rh) + rh.rh_len;
+    }
+    if (ret < 0)
+        goto done;
+    retval = 1;
+ done:
+    if (xev)
+        xml_free(xev);
+    return retval;
+ stop:
+    retval = 0;
+    goto done;
+}
+
 /*! Replay a stream by sending notification messages
  * @see RFC5277 Sec 2.1.1:
  *  Start Time:
@@ -712,61 +1126,118 @@ stream_replay_notify(clicon_handle               h,
 {
     int                   retval = -1;
     struct stream_replay *r;
+    struct timeval        start;
+    struct timeval        now;
+    struct timeval        tret;
+    char                 *buf = NULL;
+    size_t                buflen = 0;
+    int                   ret;
 
     /* If <startTime> is not present, this is not a replay */
     if (!timerisset(&ss->ss_starttime))
         goto ok;
     if (!es->es_replay_enabled)
         goto ok;
-    /* Get replay linked list */
+    /* Get replay segments */
     if ((r = es->es_replay) == NULL)
         goto ok;
-    /* First loop to skip until start */
-    do {
-        if (timercmp(&r->r_tv, &ss->ss_starttime, >=))
-            break;
-        r = NEXTQ(struct stream_replay *, r);
-    } while (r && r!=es->es_replay);
-    if (r == NULL)
-        goto ok; /* No samples to replay */
-    /* Then notify until stop */
+    /* Do not replay entries past retention time that remain in segments */
+    start = ss->ss_starttime;
+    if (timerisset(&es->es_retention)){
+        gettimeofday(&now, NULL);
+        timersub(&now, &es->es_retention, &tret);
+        if (timercmp(&start, &tret, <))
+            start = tret;
+    }
+    /* Skip segments ending before start, then notify until stop */
     do {
-        if (timerisset(&ss->ss_stoptime) &&
-            timercmp(&r->r_tv, &ss->ss_stoptime, >))
-            break;
-        if ((*ss->ss_fn)(h, 0, r->r_xml, ss->ss_arg) < 0)
-            goto done;
+        if (r->r_count && !timercmp(&r->r_last, &start, <)){
+            if ((ret = stream_replay_segment_notify(h, ss, r, &start, &buf, &buflen)) < 0)
+                goto done;
+            if (ret == 0)
+                break;
+        }
         r = NEXTQ(struct stream_replay *, r);
     } while (r && r!=es->es_replay);
  ok:
     retval = 0;
  done:
+    if (buf)
+        free(buf);
     return retval;
 }
 
 /*! Add replay sample to stream with timestamp
  * @param[in] es   Stream
  * @param[in] tv   Timestamp
- * @param[in] xv   XML
+ * @param[in] xv   XML, not consumed
+ * @retval    0    OK
+ * @retval   -1    Error
+ * The event is serialized and appended last in the newest segment. A new segment is
+ * started when the newest segment is full, and the oldest segments are removed if the
+ * max replay size is exceeded.
  */
 int
 stream_replay_add(event_stream_t *es,
                   struct timeval *tv,
                   cxobj          *xv)
 {
-    int                   retval = -1;
-    struct stream_replay *new;
+    int                      retval = -1;
+    struct stream_replay    *r;
+    struct stream_replay_hdr rh;
+    struct iovec             iov[2];
+    cbuf                    *cb = NULL;
+    size_t                   segsize;
+    ssize_t                  n;
 
-    if ((new = malloc(sizeof *new)) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2cbuf(cb, xv, 0, 0, -1, 0) < 0)
+        goto done;
+    segsize = STREAM_REPLAY_SEGMENT_SIZE;
+    if (es->es_replay_maxsize &&
+        es->es_replay_maxsize/STREAM_REPLAY_SEGMENT_PART < segsize)
+        segsize = es->es_replay_maxsize/STREAM_REPLAY_SEGMENT_PART;
+    r = PREVQ(struct stream_replay *, es->es_replay);
+    if (r == NULL || (r->r_count && r->r_size >= segsize))
+        if ((r = stream_replay_segment(es, r?r->r_nr+1:0, 0)) == NULL)
+            goto done;
+    memset(&rh, 0, sizeof(rh));
+    rh.rh_magic = STREAM_REPLAY_MAGIC;
+    rh.rh_len = cbuf_len(cb);
+    rh.rh_sec = tv->tv_sec;
+    rh.rh_usec = tv->tv_usec;
+    iov[0].iov_base = &rh;
+    iov[0].iov_len = sizeof(rh);
+    iov[1].iov_base = cbuf_get(cb);
+    iov[1].iov_len = rh.rh_len;
+    if (lseek(r->r_fd, r->r_size, SEEK_SET) < 0){
+        clicon_err(OE_UNIX, errno, "lseek");
         goto done;
     }
-    memset(new, 0, (sizeof *new));
-    new->r_tv = *tv;
-    new->r_xml = xv;
-    ADDQ(new, es->es_replay);
+    if ((n = writev(r->r_fd, iov, 2)) != sizeof(rh) + rh.rh_len){
+        clicon_err(OE_UNIX, errno, "writev");
+        /* Remove partial record */
+        if (n > 0 && ftruncate(r->r_fd, r->r_size) < 0)
+            clicon_err(OE_UNIX, errno, "ftruncate");
+        goto done;
+    }
+    if (stream_replay_index_add(r, tv, r->r_size) < 0)
+        goto done;
+    r->r_size += n;
+    es->es_replay_size += n;
+    /* Remove oldest segments exceeding max size, keep newest */
+    if (es->es_replay_maxsize)
+        while (es->es_replay_size > es->es_replay_maxsize &&
+               es->es_replay != r)
+            if (stream_replay_free(es, es->es_replay, 1) < 0)
+                goto done;
     retval = 0;
  done:
+    if (cb)
+        cbuf_free(cb);
     return retval;
 }
 
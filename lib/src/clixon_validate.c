@@ -48,8 +48,10 @@
 #include <string.h>
 #include <syslog.h>
 #include <fcntl.h>
+#include <signal.h>
 #include <arpa/inet.h>
 #include <sys/param.h>
+#include <sys/wait.h>
 #include <netinet/in.h>
 
 /* cligen */
@@ -64,6 +66,7 @@
 #include "clixon_string.h"
 #include "clixon_err.h"
 #include "clixon_log.h"
+#include "clixon_sig.h"
 #include "clixon_yang.h"
 #include "clixon_xml.h"
 #include "clixon_data.h"
@@ -82,6 +85,126 @@
 #include "clixon_validate_minmax.h"
 #include "clixon_validate.h"
 
+/*
+ * Leafref target index
+ * The values of absolute leafref paths are collected once per validation in a hash set, so
+ * that each referring leaf is checked with a lookup instead of evaluating the path and
+ * scanning the result. Only active between validate_leafref_index_begin and _end, since
+ * the data tree must not change while the index is in use.
+ */
+struct leafref_index{
+    qelem_t        li_q;       /* List header */
+    cxobj         *li_xtop;    /* Top of data tree */
+    yang_stmt     *li_ypath;   /* Yang path statement */
+    cvec          *li_nsc;     /* Namespace context of path */
+    clicon_hash_t *li_values;  /* Set of referred leaf values */
+};
+typedef struct leafref_index leafref_index;
+
+static leafref_index *_leafref_index = NULL;
+static int            _leafref_index_active = 0;
+
+/*! Start using leafref target index, see validate_leafref
+ */
+static void
+validate_leafref_index_begin(void)
+{
+    _leafref_index_active++;
+}
+
+/*! Stop using leafref target index and free it when leaving outermost validation
+ */
+static void
+validate_leafref_index_end(void)
+{
+    leafref_index *li;
+
+    if (_leafref_index_active > 0 && --_leafref_index_active > 0)
+        return;
+    while ((li = _leafref_index) != NULL){
+        DELQ(li, _leafref_index, leafref_index *);
+        if (li->li_values)
+            clicon_hash_free(li->li_values);
+        free(li);
+    }
+}
+
+/*! Check if a leafref path can be indexed: absolute and not dependent on context node
+ * @param[in]  path_arg  Leafref path argument
+ * @retval     1         Yes, the path gives the same node set from any node in the tree
+ * @retval     0         No
+ */
+static int
+leafref_index_path(char *path_arg)
+{
+    return path_arg[0] == '/' &&
+        strstr(path_arg, "current") == NULL &&
+        strstr(path_arg, "..") == NULL;
+}
+
+/*! Lookup a leafref value in the index, build the index of the path on first use
+ * @param[in]  xt     XML leaf node of type leafref
+ * @param[in]  nsc    Namespace context of path
+ * @param[in]  ypath  Yang path statement
+ * @param[in]  xpt    Parsed xpath of path
+ * @param[in]  body   Leafref value
+ * @retval     1      Found
+ * @retval     0      Not found
+ * @retval    -1      Error
+ */
+static int
+leafref_index_lookup(cxobj      *xt,
+                     cvec       *nsc,
+                     yang_stmt  *ypath,
+                     xpath_tree *xpt,
+                     char       *body)
+{
+    int            retval = -1;
+    cxobj         *xtop;
+    leafref_index *li = NULL;
+    leafref_index *lif;
+    xp_ctx        *xr = NULL;
+    char          *leafbody;
+    int            i;
+
+    xtop = xml_root(xt);
+    if ((lif = _leafref_index) != NULL)
+        do {
+            if (lif->li_xtop == xtop && lif->li_ypath == ypath && lif->li_nsc == nsc){
+                li = lif;
+                break;
+            }
+            lif = NEXTQ(leafref_index *, lif);
+        } while (lif != _leafref_index);
+    if (li == NULL){
+        if ((li = malloc(sizeof(*li))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memset(li, 0, sizeof(*li));
+        li->li_xtop = xtop;
+        li->li_ypath = ypath;
+        li->li_nsc = nsc;
+        ADDQ(li, _leafref_index);
+        if ((li->li_values = clicon_hash_init()) == NULL)
+            goto done;
+        if (xpath_tree_vec_ctx(xt, nsc, xpt, 0, &xr) < 0)
+            goto done;
+        if (xr && xr->xc_type == XT_NODESET)
+            for (i = 0; i < xr->xc_size; i++){
+                if ((leafbody = xml_body(xr->xc_nodeset[i])) == NULL)
+                    continue;
+                if (clicon_hash_add(li->li_values, leafbody, NULL, 0) == NULL)
+                    goto done;
+            }
+    }
+    retval = clicon_hash_lookup(li->li_values, body) != NULL;
+ done:
+    if (xr)
+        ctx_free(xr);
+    return retval;
+}
+
 /*! Validate xml node of type leafref, ensure the value is one of that path's reference
  * @param[in]  xt    XML leaf node of type leafref
  * @param[in]  ys    Yang spec of leaf
@@ -129,12 +252,15 @@ validate_leafref(cxobj     *xt,
     size_t       xlen = 0;
     char        *leafrefbody;
     char        *leafbody;
-    cvec        *nsc = NULL;
+    cvec        *nsc;
     cbuf        *cberr = NULL;
     char        *path_arg;
     yang_stmt   *ymod;
     cg_var      *cv;
     int          require_instance = 1;
+    xpath_tree  *xpt;
+    xp_ctx      *xr = NULL;
+    int          found;
     
     /* require instance */
     if ((yreqi = yang_find(ytype, Y_REQUIRE_INSTANCE, NULL)) != NULL){
@@ -162,18 +288,32 @@ validate_leafref(cxobj     *xt,
     }
     if ((leafrefbody = xml_body(xt)) == NULL)
         goto ok;
-    if (xml_nsctx_yang(ys, &nsc) < 0)
+    if ((nsc = yang_xpath_nsc_get(ys)) == NULL)
         goto done;
-    if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, path_arg) < 0) 
+    if ((xpt = yang_xpath_tree_get(ypath)) == NULL)
         goto done;
-    for (i = 0; i < xlen; i++) {
-        x = xvec[i];
-        if ((leafbody = xml_body(x)) == NULL)
-            continue;
-        if (strcmp(leafbody, leafrefbody) == 0)
-            break;
+    if (_leafref_index_active && leafref_index_path(path_arg)){
+        if ((found = leafref_index_lookup(xt, nsc, ypath, xpt, leafrefbody)) < 0)
+            goto done;
+    }
+    else {
+        if (xpath_tree_vec_ctx(xt, nsc, xpt, 0, &xr) < 0)
+            goto done;
+        if (xr && xr->xc_type == XT_NODESET){
+            xvec = xr->xc_nodeset;
+            xr->xc_nodeset = NULL;
+            xlen = xr->xc_size;
+        }
+        for (i = 0; i < xlen; i++) {
+            x = xvec[i];
+            if ((leafbody = xml_body(x)) == NULL)
+                continue;
+            if (strcmp(leafbody, leafrefbody) == 0)
+                break;
+        }
+        found = i < xlen;
     }
-    if (i==xlen){
+    if (!found){
         if ((cberr = cbuf_new()) == NULL){
             clicon_err(OE_UNIX, errno, "cbuf_new");
             goto done;
@@ -193,8 +333,8 @@ validate_leafref(cxobj     *xt,
  done:
     if (cberr)
         cbuf_free(cberr);
-    if (nsc)
-        xml_nsctx_free(nsc);
+    if (xr)
+        ctx_free(xr);
     if (xvec)
         free(xvec);
     return retval;
@@ -1216,13 +1356,14 @@ xml_yang_validate_all(clicon_handle h,
     yang_stmt *yc;  /* yang child */
     yang_stmt *ye;  /* yang must error-message */
     char      *xpath;
+    xpath_tree *xpt;
     int        nr;
     int        ret;
     cxobj     *x;
     cxobj     *xp;
     char      *ns = NULL;
     cbuf      *cb = NULL;
-    cvec      *nsc = NULL;
+    cvec      *nsc;
     int        hit = 0;
     validate_level vl = VL_NONE;
 
@@ -1326,9 +1467,11 @@ xml_yang_validate_all(clicon_handle h,
              * which the "must" statement is defined. 
              * The set of namespace declarations is the set of all "import" statements' 
              */
-           if (xml_nsctx_yang(yc, &nsc) < 0)
-               goto done;
-            if ((nr = xpath_vec_bool(xt, nsc, "%s", xpath)) < 0)
+            if ((nsc = yang_xpath_nsc_get(yc)) == NULL)
+                goto done;
+            if ((xpt = yang_xpath_tree_get(yc)) == NULL)
+                goto done;
+            if ((nr = xpath_tree_vec_bool(xt, nsc, xpt)) < 0)
                 goto done;
             if (!nr){
                 ye = yang_find(yc, Y_ERROR_MESSAGE, NULL);
@@ -1343,10 +1486,6 @@ xml_yang_validate_all(clicon_handle h,
                     goto done;
                 goto fail;
             }
-            if (nsc){
-                xml_nsctx_free(nsc);
-                nsc = NULL;
-            }
         }
     }
     x = NULL;
@@ -1369,8 +1508,6 @@ xml_yang_validate_all(clicon_handle h,
  done:
     if (cb)
         cbuf_free(cb);
-    if (nsc)
-        xml_nsctx_free(nsc);
     return retval;
  fail:
     retval = 0;
@@ -1388,19 +1525,346 @@ xml_yang_validate_all_top(clicon_handle h,
                           cxobj        *xt, 
                           cxobj       **xret)
 {
-    int    ret;
+    int    ret = 1;
     cxobj *x;
 
+    validate_leafref_index_begin();
     x = NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
         if ((ret = xml_yang_validate_all(h, x, xret)) < 1)
-            return ret;
+            break;
     }
+    validate_leafref_index_end();
+    if (ret < 1)
+        return ret;
     if ((ret = xml_yang_minmax_recurse(xt, 0, xret)) < 1)
         return ret;
     return 1;
 }
 
+/* Validate function of one node, xml_yang_validate_all or xml_yang_validate_add */
+typedef int (validate_fn_t)(clicon_handle h, cxobj *x, cxobj **xret);
+
+/*! Validate a range of nodes in a child process and write the result to a pipe
+ *
+ * The result is a status character: '1' OK, '0' failed followed by the error tree, or 'E'
+ * error followed by the error message.
+ * @param[in]  h      Clixon handle
+ * @param[in]  fn     Validate function
+ * @param[in]  vec    Nodes
+ * @param[in]  lo     First node in range
+ * @param[in]  hi     Last node in range +1
+ * @param[in]  fd     Write end of pipe
+ * @note Does not return
+ */
+static void
+validate_vec_child(clicon_handle  h,
+                   validate_fn_t *fn,
+                   cxobj        **vec,
+                   int            lo,
+                   int            hi,
+                   int            fd)
+{
+    cbuf   *cb = NULL;
+    cxobj  *xret = NULL;
+    int     ret = 1;
+    int     i;
+    char   *buf;
+    size_t  len;
+    ssize_t n;
+
+    set_signal(SIGTERM, SIG_DFL, NULL);
+    set_signal(SIGINT, SIG_DFL, NULL);
+    if ((cb = cbuf_new()) == NULL)
+        _exit(1);
+    validate_leafref_index_begin();
+    for (i=lo; i<hi; i++)
+        if ((ret = fn(h, vec[i], &xret)) < 1)
+            break;
+    validate_leafref_index_end();
+    if (ret == 1)
+        cprintf(cb, "1");
+    else if (ret == 0){
+        cprintf(cb, "0");
+        if (xret && clixon_xml2cbuf(cb, xret, 0, 0, -1, 0) < 0)
+            ret = -1;
+    }
+    if (ret < 0){
+        cbuf_reset(cb);
+        cprintf(cb, "E%s", clicon_err_reason);
+    }
+    buf = cbuf_get(cb);
+    len = cbuf_len(cb);
+    while (len > 0){
+        if ((n = write(fd, buf, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            _exit(1);
+        }
+        buf += n;
+        len -= n;
+    }
+    _exit(0);
+}
+
+/*! Read result of a validate child process, see validate_vec_child
+ *
+ * @param[in]  fd     Read end of pipe
+ * @param[out] xret   Error XML tree (if ret == 0). Free with xml_free after use
+ * @retval     1      Validation OK
+ * @retval     0      Validation failed (xret set)
+ * @retval    -1      Error
+ */
+static int
+validate_vec_child_result(int     fd,
+                          cxobj **xret)
+{
+    int     retval = -1;
+    cbuf   *cb = NULL;
+    char    buf[4096];
+    ssize_t n;
+    char   *str;
+    cxobj  *xt = NULL;
+    cxobj  *xr;
+    cxobj  *x;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    while ((n = read(fd, buf, sizeof(buf))) != 0){
+        if (n < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_UNIX, errno, "read");
+            goto done;
+        }
+        if (cbuf_append_buf(cb, buf, n) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+            goto done;
+        }
+    }
+    str = cbuf_get(cb);
+    switch (*str){
+    case '1':
+        retval = 1;
+        break;
+    case '0':
+        if (clixon_xml_parse_string(str+1, YB_NONE, NULL, &xt, NULL) < 0)
+            goto done;
+        if ((xr = xml_child_i_type(xt, 0, CX_ELMNT)) == NULL){
+            clicon_err(OE_XML, 0, "Validate process: no error tree");
+            goto done;
+        }
+        if (*xret == NULL){
+            if (xml_rootchild_node(xt, xr) < 0)
+                goto done;
+            xt = NULL;
+            *xret = xr;
+        }
+        else{ /* Append errors to existing error tree */
+            while ((x = xml_child_i_type(xr, 0, CX_ELMNT)) != NULL)
+                if (xml_addsub(*xret, x) < 0)
+                    goto done;
+        }
+        retval = 0;
+        break;
+    case 'E':
+        clicon_err(OE_XML, 0, "Validate process: %s", str+1);
+        break;
+    default:
+        clicon_err(OE_XML, 0, "Validate process terminated without result");
+        break;
+    }
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+/*! Validate a vector of nodes in parallel processes
+ *
+ * The vector is split in contiguous ranges, one per process, and each process validates its
+ * range in order. The result of the first range that does not pass is returned, which is the
+ * same result as validating all nodes in order in one process.
+ * Processes are used rather than threads since validation writes to caches in the shared XML
+ * tree, yang specs and xpath module, and to the global clicon_err state.
+ * The caller's tree is not changed by the processes, except that its caches are not populated.
+ * @param[in]  h       Clixon handle
+ * @param[in]  fn      Validate function
+ * @param[in]  vec     Nodes
+ * @param[in]  veclen  Number of nodes
+ * @param[in]  nproc   Number of processes, at least 2 and at most veclen
+ * @param[out] xret    Error XML tree (if ret == 0). Free with xml_free after use
+ * @retval     1       Validation OK
+ * @retval     0       Validation failed (xret set)
+ * @retval    -1       Error
+ */
+static int
+validate_vec_parallel(clicon_handle  h,
+                      validate_fn_t *fn,
+                      cxobj        **vec,
+                      int            veclen,
+                      int            nproc,
+                      cxobj        **xret)
+{
+    int     retval = -1;
+    pid_t  *pids = NULL;
+    int    *fds = NULL;
+    int     p[2];
+    int     k;
+    int     started = 0;
+    int     ret = 1;
+    int     status;
+
+    if ((pids = calloc(nproc, sizeof(pid_t))) == NULL ||
+        (fds = calloc(nproc, sizeof(int))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    clicon_debug(1, "%s %d nodes %d processes", __FUNCTION__, veclen, nproc);
+    for (k=0; k<nproc; k++){
+        if (pipe(p) < 0){
+            clicon_err(OE_UNIX, errno, "pipe");
+            goto done;
+        }
+        if ((pids[k] = fork()) < 0){
+            clicon_err(OE_UNIX, errno, "fork");
+            close(p[0]);
+            close(p[1]);
+            goto done;
+        }
+        if (pids[k] == 0){ /* Child */
+            close(p[0]);
+            validate_vec_child(h, fn, vec, k*veclen/nproc, (k+1)*veclen/nproc, p[1]);
+        }
+        close(p[1]);
+        fds[k] = p[0];
+        started++;
+    }
+    /* Results in order: the first range that does not pass decides, the rest are killed */
+    for (k=0; k<nproc; k++){
+        if ((ret = validate_vec_child_result(fds[k], xret)) < 1)
+            break;
+    }
+    if (ret < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    retval = 1;
+ done:
+    for (k=0; k<started; k++){
+        if (retval != 1)
+            kill(pids[k], SIGKILL);
+        close(fds[k]);
+        while (waitpid(pids[k], &status, 0) < 0 && errno == EINTR)
+            ;
+    }
+    if (pids)
+        free(pids);
+    if (fds)
+        free(fds);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Validate all top-level elements of an XML tree in parallel processes
+ *
+ * The top-level elements are validated with xml_yang_validate_all in parallel, see
+ * validate_vec_parallel, then top-level min/max-elements in this process. The result is the
+ * same as with xml_yang_validate_all_top.
+ * @param[in]  h       Clixon handle
+ * @param[in]  xt      XML top of tree
+ * @param[in]  nproc   Max number of processes, if < 2 validate in this process
+ * @param[out] xret    Error XML tree (if ret == 0). Free with xml_free after use
+ * @retval     1       Validation OK
+ * @retval     0       Validation failed (xret set)
+ * @retval    -1       Error
+ * @see CLICON_VALIDATE_PROCESSES
+ */
+int
+xml_yang_validate_all_parallel(clicon_handle h,
+                               cxobj        *xt,
+                               int           nproc,
+                               cxobj       **xret)
+{
+    int     retval = -1;
+    cxobj **vec = NULL;
+    int     veclen = 0;
+    int     ret;
+    cxobj  *x;
+
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL)
+        veclen++;
+    if (nproc > veclen)
+        nproc = veclen;
+    if (nproc < 2)
+        return xml_yang_validate_all_top(h, xt, xret);
+    if ((vec = calloc(veclen, sizeof(cxobj *))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    veclen = 0;
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL)
+        vec[veclen++] = x;
+    if ((ret = validate_vec_parallel(h, xml_yang_validate_all, vec, veclen, nproc, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if ((ret = xml_yang_minmax_recurse(xt, 0, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    retval = 1;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Validate a vector of added or changed nodes with xml_yang_validate_add in parallel processes
+ *
+ * The nodes are validated in parallel, see validate_vec_parallel. The result is the same as
+ * calling xml_yang_validate_add on each node in order and stopping at the first that fails.
+ * @param[in]  h       Clixon handle
+ * @param[in]  vec     Nodes
+ * @param[in]  veclen  Number of nodes
+ * @param[in]  nproc   Max number of processes, if < 2 validate in this process
+ * @param[out] xret    Error XML tree (if ret == 0). Free with xml_free after use
+ * @retval     1       Validation OK
+ * @retval     0       Validation failed (xret set)
+ * @retval    -1       Error
+ * @see CLICON_VALIDATE_PROCESSES
+ */
+int
+xml_yang_validate_add_parallel(clicon_handle h,
+                               cxobj       **vec,
+                               int           veclen,
+                               int           nproc,
+                               cxobj       **xret)
+{
+    int ret = 1;
+    int i;
+
+    if (nproc > veclen)
+        nproc = veclen;
+    if (nproc >= 2)
+        return validate_vec_parallel(h, xml_yang_validate_add, vec, veclen, nproc, xret);
+    for (i=0; i<veclen; i++)
+        if ((ret = xml_yang_validate_add(h, vec[i], xret)) < 1)
+            break;
+    return ret;
+}
+
 /*! Check validity of outgoing RPC
  *
  * Rewrite return message if errors
@@ -326,7 +326,7 @@ check_unique_list(cxobj     *x,
     char      *xpath1 = NULL;
     int        ret;
     cvec      *cvk;
-    cvec      *nsc0 = NULL;
+    cvec      *nsc0;
     cvec      *nsc1 = NULL;
 
     /* Check if multiple direct children */
@@ -346,7 +346,7 @@ check_unique_list(cxobj     *x,
         goto done;
     }
     /* Here proper xpath with at least one slash (can there be a descendant schemanodeid w/o slash?) */
-    if (xml_nsctx_yang(yu, &nsc0) < 0)
+    if ((nsc0 = yang_xpath_nsc_get(yu)) == NULL)
         goto done;
     if ((ret = xpath2canonical(xpath0, nsc0, ys_spec(y),
                                &xpath1, &nsc1, NULL)) < 0)
@@ -368,8 +368,6 @@ check_unique_list(cxobj     *x,
     /* It would be possible to cache vec here as an optimization */
     retval = 1;
  done:
-    if (nsc0)
-        cvec_free(nsc0);
     if (nsc1)
         cvec_free(nsc1);
     if (xpath1)
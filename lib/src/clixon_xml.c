@@ -64,6 +64,7 @@
 #include "clixon_hash.h"
 #include "clixon_handle.h"
 #include "clixon_log.h"
+#include "clixon_intern.h"
 #include "clixon_yang.h"
 #include "clixon_xml.h"
 #include "clixon_options.h" /* xml_bind_yang */
@@ -160,11 +161,27 @@ struct search_index{
  * vocabulary's local names that is effective in avoiding name clashes.
  * @see struct xmlbody    For XML body and attributes
  */
+
+/* Size of value stored inline in body and attribute nodes, including NULL-termination */
+#define XML_VALUE_INLINE 16
+
+/*! Value of body and attribute nodes
+ * Values shorter than XML_VALUE_INLINE are stored in the node, longer values are malloced
+ * with a capacity given by the value length, see xml_value_cap
+ */
+union xml_value{
+    char             *xv_ptr;       /* Malloced value, if length >= XML_VALUE_INLINE */
+    char              xv_inline[XML_VALUE_INLINE]; /* Short value */
+};
+
 struct xml{
     enum cxobj_type   x_type;       /* type of node: element, attribute, body */
-    char             *x_name;       /* name of node */
-    char             *x_prefix;     /* namespace localname N, called prefix */
+    char             *x_name;       /* name of node, interned */
+    char             *x_prefix;     /* namespace localname N, called prefix, interned */
     uint16_t          x_flags;      /* Flags according to XML_FLAG_* */
+    uint8_t           x_arena;      /* Allocated in an arena, see XML_ARENA_* */
+    uint8_t           x_hasvalue;   /* Body/attribute value is set, see xml_value_set */
+    uint32_t          x_value_len;  /* Length of body/attribute value */
     struct xml       *x_up;         /* parent node in hierarchy if any */
 #ifdef XML_PARENT_CANDIDATE
     struct xml       *x_up_candidate; /* Candidate parent node for special cases (when+xpath) */
@@ -172,10 +189,7 @@ struct xml{
     int              _x_vector_i;   /* internal use: xml_child_each */
     int              _x_i;          /* internal use for stable sorting: 
                                        see xml_enumerate and xml_cmp */
-    /*----- next is body/attribute only */
-    cbuf             *x_value_cb;  /* attribute and body nodes have values (XXX: this consumes 
-                                       memory) cv? */
-    /*----- up to here is common to all next is element only */
+    /*----- up to here is common to all next is element only, see struct xmlbody */
     struct xml      **x_childvec;   /* vector of children nodes (XXX: use clixon_vec ) */
     int               x_childvec_len;/* Number of children */
     int               x_childvec_max;/* Length of allocated vector */
@@ -195,9 +209,12 @@ struct xml{
  */
 struct xmlbody{
     enum cxobj_type   xb_type;       /* type of node: element, attribute, body */
-    char             *xb_name;       /* name of node */
-    char             *xb_prefix;     /* namespace localname N, called prefix */
+    char             *xb_name;       /* name of node, interned */
+    char             *xb_prefix;     /* namespace localname N, called prefix, interned */
     uint16_t          xb_flags;      /* Flags according to XML_FLAG_* */
+    uint8_t           xb_arena;      /* Allocated in an arena, see XML_ARENA_* */
+    uint8_t           xb_hasvalue;   /* Value is set, see xml_value_set */
+    uint32_t          xb_value_len;  /* Length of value */
     struct xml       *xb_up;         /* parent node in hierarchy if any */
 #ifdef XML_PARENT_CANDIDATE
     struct xml       *xb_up_candidate; /* Candidate parent node for special cases (when+xpath) */
@@ -205,7 +222,7 @@ struct xmlbody{
     int              _xb_vector_i;   /* internal use: xml_child_each */
     int              _xb_i;          /* internal use for sorting: 
                                        see xml_enumerate and xml_cmp */
-    cbuf             *xb_value_cb;  /* attribute and body nodes have values */
+    union xml_value   xb_value;      /* attribute and body nodes have values */
 };
 
 /*
@@ -234,6 +251,405 @@ xml_type2str(enum cxobj_type type)
 /* Stats (too low-level to hang it on handle) */
 static uint64_t _stats_xml_nr = 0;
 
+/* Values of x_arena */
+#define XML_ARENA_NODE 0x01 /* Node is allocated in an arena */
+#define XML_ARENA_SIDE 0x02 /* Node is registered in xa_side of its arena */
+
+/*! Header of an arena chunk
+ * A chunk is XML_ARENA_CHUNK_SIZE bytes aligned to its size, so the chunk of a node is
+ * found by masking the node address. Nodes, child vectors and values are allocated in
+ * sequence after the header.
+ * @see struct xml_arena
+ */
+struct xml_chunk{
+    struct xml_arena *xk_arena; /* Arena of chunk */
+    struct xml_chunk *xk_next;  /* Next chunk in xa_chunks */
+    size_t            xk_used;  /* Bytes used in chunk, including header */
+    size_t            xk_live;  /* Number of allocations in chunk that are not freed */
+};
+
+/* Size of chunk header, keeps allocations 16-byte aligned */
+#define XML_CHUNK_HDR ((sizeof(struct xml_chunk)+15) & ~(size_t)15)
+
+/* Allocations larger than this are not made in chunks */
+#define XML_ARENA_LARGE (XML_ARENA_CHUNK_SIZE/4)
+
+/*! Header of a large arena allocation, such as a long value or child vector
+ */
+struct xml_large{
+    qelem_t xl_q; /* Queue header */
+};
+
+/* Size of large allocation header, keeps allocations 16-byte aligned */
+#define XML_LARGE_HDR ((sizeof(struct xml_large)+15) & ~(size_t)15)
+
+/*! An arena of XML nodes, for transient trees such as parsed messages
+ *
+ * Nodes of an arena, and their child vectors and values, are allocated in chunks. The arena
+ * holds one reference to each interned name and prefix of its nodes, and keeps a list of
+ * nodes with a cv, namespace cache or search index.
+ * As long as no arena node has a parent outside the arena and no other node has a parent
+ * in the arena, freeing the last arena node without parent releases the arena by chunk:
+ * the nodes are not visited. When a link to another tree is made the arena escapes and
+ * its nodes are freed one by one, and a chunk is freed when its last allocation is freed.
+ * @see xml_arena_push
+ */
+struct xml_arena{
+    struct xml_chunk *xa_chunk;     /* Current chunk where new allocations are made */
+    struct xml_chunk *xa_chunks;    /* All chunks, not kept when escaped */
+    size_t            xa_nchunks;   /* Number of chunks */
+    struct xml_large *xa_large;     /* Large allocations */
+    uint64_t          xa_nr;        /* Number of nodes not freed */
+    int               xa_roots;     /* Number of nodes without parent, not kept when escaped */
+    int               xa_escaped;   /* Linked to another tree, free nodes one by one */
+    cxobj           **xa_side;      /* Nodes with cv, namespace cache or search index */
+    size_t            xa_side_len;
+    size_t            xa_side_max;
+    char            **xa_names;     /* Hash set of interned names and prefixes */
+    size_t            xa_names_len;
+    size_t            xa_names_max;
+};
+
+/* If > 0, xml_new allocates nodes without parent in an arena */
+static int _xml_arena = 0;
+
+/* Current arena, between xml_arena_push and xml_arena_pop */
+static struct xml_arena *_xml_arena_cur = NULL;
+
+static void xml_arena_chunk_free(struct xml_arena *xa, struct xml_chunk *xk);
+static void xml_arena_release(struct xml_arena *xa);
+
+/*! Get arena of an arena node
+ * @param[in]  x   XML node, or NULL
+ * @retval     xa  Arena
+ * @retval     NULL  Not an arena node
+ */
+static struct xml_arena *
+xml_arena_get(cxobj *x)
+{
+    struct xml_chunk *xk;
+
+    if (x == NULL || x->x_arena == 0)
+        return NULL;
+    xk = (struct xml_chunk *)((uintptr_t)x & ~((uintptr_t)XML_ARENA_CHUNK_SIZE-1));
+    return xk->xk_arena;
+}
+
+/*! Allocate memory in an arena, in the current chunk or start a new chunk if full
+ *
+ * @param[in]  xa    Arena
+ * @param[in]  sz    Size
+ * @retval     p     Memory, not initialized
+ * @retval     NULL  Error
+ * @see xml_arena_mfree
+ */
+static void *
+xml_arena_alloc(struct xml_arena *xa,
+                size_t            sz)
+{
+    struct xml_chunk *xk;
+    struct xml_large *xl;
+    void             *p = NULL;
+    int               ret;
+
+    sz = (sz + 15) & ~(size_t)15;
+    if (sz > XML_ARENA_LARGE){
+        if ((xl = malloc(XML_LARGE_HDR + sz)) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            return NULL;
+        }
+        ADDQ(xl, xa->xa_large);
+        return (char*)xl + XML_LARGE_HDR;
+    }
+    if ((xk = xa->xa_chunk) == NULL ||
+        xk->xk_used + sz > XML_ARENA_CHUNK_SIZE){
+        if ((ret = posix_memalign(&p, XML_ARENA_CHUNK_SIZE, XML_ARENA_CHUNK_SIZE)) != 0){
+            clicon_err(OE_XML, ret, "posix_memalign");
+            return NULL;
+        }
+        /* An empty old chunk of an escaped arena is not freed by any allocation */
+        if (xk && xa->xa_escaped && xk->xk_live == 0){
+            free(xk);
+            xa->xa_nchunks--;
+        }
+        xk = (struct xml_chunk *)p;
+        xk->xk_arena = xa;
+        xk->xk_used = XML_CHUNK_HDR;
+        xk->xk_live = 0;
+        xk->xk_next = NULL;
+        if (!xa->xa_escaped){
+            xk->xk_next = xa->xa_chunks;
+            xa->xa_chunks = xk;
+        }
+        xa->xa_nchunks++;
+        xa->xa_chunk = xk;
+    }
+    p = (char*)xk + xk->xk_used;
+    xk->xk_used += sz;
+    xk->xk_live++;
+    return p;
+}
+
+/*! Free memory allocated in an arena
+ *
+ * Memory in a chunk is only freed with the chunk, when the arena is released or, if the
+ * arena is escaped, when the last allocation of the chunk is freed.
+ * @param[in]  xa    Arena
+ * @param[in]  p     Memory allocated with xml_arena_alloc
+ * @param[in]  sz    Size given to xml_arena_alloc
+ */
+static void
+xml_arena_mfree(struct xml_arena *xa,
+                void             *p,
+                size_t            sz)
+{
+    struct xml_chunk *xk;
+    struct xml_large *xl;
+
+    sz = (sz + 15) & ~(size_t)15;
+    if (sz > XML_ARENA_LARGE){
+        xl = (struct xml_large *)((char*)p - XML_LARGE_HDR);
+        DELQ(xl, xa->xa_large, struct xml_large *);
+        free(xl);
+        return;
+    }
+    xk = (struct xml_chunk *)((uintptr_t)p & ~((uintptr_t)XML_ARENA_CHUNK_SIZE-1));
+    if (--xk->xk_live == 0 && xa->xa_escaped)
+        xml_arena_chunk_free(xa, xk);
+}
+
+/*! Free an empty chunk of an escaped arena, and the arena when it has no chunks left
+ *
+ * The current chunk of the current arena is kept for new allocations
+ * @param[in]  xa    Arena
+ * @param[in]  xk    Chunk
+ */
+static void
+xml_arena_chunk_free(struct xml_arena *xa,
+                     struct xml_chunk *xk)
+{
+    if (xk == xa->xa_chunk){
+        if (xa == _xml_arena_cur){
+            xk->xk_used = XML_CHUNK_HDR;
+            return;
+        }
+        xa->xa_chunk = NULL;
+    }
+    free(xk);
+    if (--xa->xa_nchunks == 0 && xa != _xml_arena_cur)
+        xml_arena_release(xa);
+}
+
+/*! Free all memory of an arena, and the arena itself unless it is current
+ *
+ * Side objects of registered nodes are freed, then large allocations and chunks, without
+ * visiting any other node.
+ * @param[in]  xa    Arena
+ */
+static void
+xml_arena_release(struct xml_arena *xa)
+{
+    struct xml_chunk *xk;
+    struct xml_large *xl;
+    cxobj            *x;
+    size_t            i;
+
+    for (i=0; i<xa->xa_side_len; i++){
+        x = xa->xa_side[i];
+        if (x->x_cv)
+            cv_free(x->x_cv);
+        if (x->x_ns_cache)
+            xml_nsctx_free(x->x_ns_cache);
+#ifdef XML_EXPLICIT_INDEX
+        xml_search_index_free(x);
+#endif
+    }
+    xa->xa_side_len = 0;
+    while ((xl = xa->xa_large) != NULL){
+        DELQ(xl, xa->xa_large, struct xml_large *);
+        free(xl);
+    }
+    if (xa->xa_escaped){
+        if (xa->xa_chunk)
+            free(xa->xa_chunk);
+    }
+    else
+        while ((xk = xa->xa_chunks) != NULL){
+            xa->xa_chunks = xk->xk_next;
+            free(xk);
+        }
+    xa->xa_chunk = NULL;
+    xa->xa_nchunks = 0;
+    for (i=0; i<xa->xa_names_max; i++)
+        if (xa->xa_names[i]){
+            clixon_intern_release(xa->xa_names[i]);
+            xa->xa_names[i] = NULL;
+        }
+    xa->xa_names_len = 0;
+    _stats_xml_nr -= xa->xa_nr;
+    xa->xa_nr = 0;
+    xa->xa_roots = 0;
+    xa->xa_escaped = 0;
+    if (xa != _xml_arena_cur){
+        if (xa->xa_side)
+            free(xa->xa_side);
+        if (xa->xa_names)
+            free(xa->xa_names);
+        free(xa);
+    }
+}
+
+/*! An arena is linked to another tree, free its nodes one by one from now on
+ *
+ * Chunks where all allocations are freed are freed
+ * @param[in]  xa    Arena
+ */
+static void
+xml_arena_escape(struct xml_arena *xa)
+{
+    struct xml_chunk *xk;
+
+    if (xa->xa_escaped)
+        return;
+    xa->xa_escaped = 1;
+    if (xa->xa_side){
+        free(xa->xa_side);
+        xa->xa_side = NULL;
+    }
+    xa->xa_side_len = xa->xa_side_max = 0;
+    while ((xk = xa->xa_chunks) != NULL){
+        xa->xa_chunks = xk->xk_next;
+        xk->xk_next = NULL;
+        if (xk->xk_live == 0 && xk != xa->xa_chunk){
+            free(xk);
+            xa->xa_nchunks--;
+        }
+    }
+    /* Not the current arena: no allocation will free an empty current chunk */
+    if ((xk = xa->xa_chunk) != NULL && xk->xk_live == 0 && xa != _xml_arena_cur){
+        free(xk);
+        xa->xa_chunk = NULL;
+        xa->xa_nchunks--;
+    }
+}
+
+/*! Register a node with a cv, namespace cache or search index in its arena
+ *
+ * The side objects of registered nodes are freed when the arena is released
+ * @param[in]  x     XML node
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xml_arena_side(cxobj *x)
+{
+    struct xml_arena *xa;
+    cxobj           **vec;
+    size_t            max;
+
+    if ((x->x_arena & XML_ARENA_SIDE) ||
+        (xa = xml_arena_get(x)) == NULL ||
+        xa->xa_escaped)
+        return 0;
+    if (xa->xa_side_len == xa->xa_side_max){
+        max = xa->xa_side_max ? 2*xa->xa_side_max : 64;
+        if ((vec = realloc(xa->xa_side, max*sizeof(cxobj *))) == NULL){
+            clicon_err(OE_XML, errno, "realloc");
+            return -1;
+        }
+        xa->xa_side = vec;
+        xa->xa_side_max = max;
+    }
+    xa->xa_side[xa->xa_side_len++] = x;
+    x->x_arena |= XML_ARENA_SIDE;
+    return 0;
+}
+
+/*! Intern a name or prefix of an arena node, the arena holds one reference per string
+ *
+ * @param[in]  xa    Arena
+ * @param[in]  str   String
+ * @retval     istr  Interned string, held by arena
+ * @retval     NULL  Error
+ */
+static char *
+xml_arena_intern(struct xml_arena *xa,
+                 char             *str)
+{
+    char   *istr;
+    char  **names;
+    size_t  max;
+    size_t  i;
+    size_t  j;
+
+    if ((istr = clixon_intern(str)) == NULL)
+        return NULL;
+    if (2*(xa->xa_names_len+1) > xa->xa_names_max){
+        max = xa->xa_names_max ? 2*xa->xa_names_max : 32;
+        if ((names = calloc(max, sizeof(char *))) == NULL){
+            clicon_err(OE_XML, errno, "calloc");
+            clixon_intern_release(istr);
+            return NULL;
+        }
+        for (i=0; i<xa->xa_names_max; i++)
+            if (xa->xa_names[i]){
+                j = ((uintptr_t)xa->xa_names[i] >> 4) & (max-1);
+                while (names[j])
+                    j = (j+1) & (max-1);
+                names[j] = xa->xa_names[i];
+            }
+        if (xa->xa_names)
+            free(xa->xa_names);
+        xa->xa_names = names;
+        xa->xa_names_max = max;
+    }
+    i = ((uintptr_t)istr >> 4) & (xa->xa_names_max-1);
+    while (xa->xa_names[i] && xa->xa_names[i] != istr)
+        i = (i+1) & (xa->xa_names_max-1);
+    if (xa->xa_names[i])   /* Already held by arena */
+        clixon_intern_release(istr);
+    else {
+        xa->xa_names[i] = istr;
+        xa->xa_names_len++;
+    }
+    return istr;
+}
+
+/*! Allocate memory for a child vector or value of an XML node, in its arena if any
+ * @param[in]  x     XML node
+ * @param[in]  sz    Size
+ * @retval     p     Memory, not initialized
+ * @retval     NULL  Error
+ */
+static void *
+xml_mem_alloc(cxobj *x,
+              size_t sz)
+{
+    void *p;
+
+    if (x->x_arena)
+        return xml_arena_alloc(xml_arena_get(x), sz);
+    if ((p = malloc(sz)) == NULL)
+        clicon_err(OE_XML, errno, "malloc");
+    return p;
+}
+
+/*! Free memory of an XML node allocated with xml_mem_alloc
+ * @param[in]  x     XML node
+ * @param[in]  p     Memory
+ * @param[in]  sz    Size given to xml_mem_alloc
+ */
+static void
+xml_mem_free(cxobj *x,
+             void  *p,
+             size_t sz)
+{
+    if (x->x_arena)
+        xml_arena_mfree(xml_arena_get(x), p, sz);
+    else
+        free(p);
+}
+
 /*! Get global statistics about XML objects
  *
  * @param[out]  nr  Number of existing XML objects (created - freed)
@@ -246,6 +662,21 @@ xml_stats_global(uint64_t *nr)
     return 0;
 }
 
+/*! Capacity of a malloced value given its length
+ * Power of 2 so that repeated appends are amortized
+ * @param[in]  len   Length of value, not including NULL-termination
+ * @retval     cap   Allocated size of value
+ */
+static size_t
+xml_value_cap(size_t len)
+{
+    size_t cap = 2*XML_VALUE_INLINE;
+
+    while (cap < len+1)
+        cap <<= 1;
+    return cap;
+}
+
 /*! Return the alloced memory of a single XML obj 
  * @param[in]   x    XML object
  * @param[out]  szp  Size of this XML obj
@@ -258,10 +689,7 @@ xml_stats_one(cxobj    *x,
 {
     size_t sz = 0;
 
-    if (x->x_name)
-        sz += strlen(x->x_name) + 1;
-    if (x->x_prefix)
-        sz += strlen(x->x_prefix) + 1;
+    /* Name and prefix are interned and shared, see clixon_intern_stats */
     switch (xml_type(x)){
     case CX_ELMNT:
         sz += sizeof(struct xml);
@@ -284,8 +712,8 @@ xml_stats_one(cxobj    *x,
     case CX_BODY:
     case CX_ATTR:
         sz += sizeof(struct xmlbody);
-        if (x->x_value_cb)
-            sz += cbuf_buflen(x->x_value_cb);
+        if (x->x_hasvalue && x->x_value_len >= XML_VALUE_INLINE)
+            sz += xml_value_cap(x->x_value_len);
         break;
     default:
         break;
@@ -347,26 +775,31 @@ xml_name(cxobj *xn)
     return xn->x_name;
 }
 
-/*! Set name of xnode, name is copied
+/*! Set name of xnode, name is interned
  * @param[in]  xn    xml node
  * @param[in]  name  new name, null-terminated string, copied by function
  * @retval     0     OK
  * @retval     -1    on error with clicon-err set
+ * @note Names are interned: nodes with equal names have the same name pointer
  */
 int
 xml_name_set(cxobj *xn, 
              char  *name)
 {
-    if (xn->x_name){
-        free(xn->x_name);
-        xn->x_name = NULL;
-    }
-    if (name){
-        if ((xn->x_name = strdup(name)) == NULL){
-            clicon_err(OE_XML, errno, "strdup");
+    char             *iname = NULL;
+    struct xml_arena *xa;
+
+    if ((xa = xml_arena_get(xn)) != NULL){
+        if (name && (iname = xml_arena_intern(xa, name)) == NULL)
             return -1;
-        }
+        xn->x_name = iname;
+        return 0;
     }
+    if (name && (iname = clixon_intern(name)) == NULL)
+        return -1;
+    if (xn->x_name)
+        clixon_intern_release(xn->x_name);
+    xn->x_name = iname;
     return 0;
 }
 
@@ -380,7 +813,7 @@ xml_prefix(cxobj *xn)
     return xn->x_prefix;
 }
 
-/*! Set prefix of xnode, prefix is copied
+/*! Set prefix of xnode, prefix is interned
  * @param[in]  xn      XML node
  * @param[in]  prefix  New prefix, null-terminated string, copied by function
  * @retval     0       OK
@@ -390,16 +823,20 @@ int
 xml_prefix_set(cxobj *xn, 
                char  *prefix)
 {
-    if (xn->x_prefix){
-        free(xn->x_prefix);
-        xn->x_prefix = NULL;
-    }
-    if (prefix){
-        if ((xn->x_prefix = strdup(prefix)) == NULL){
-            clicon_err(OE_XML, errno, "strdup");
+    char             *iprefix = NULL;
+    struct xml_arena *xa;
+
+    if ((xa = xml_arena_get(xn)) != NULL){
+        if (prefix && (iprefix = xml_arena_intern(xa, prefix)) == NULL)
             return -1;
-        }
+        xn->x_prefix = iprefix;
+        return 0;
     }
+    if (prefix && (iprefix = clixon_intern(prefix)) == NULL)
+        return -1;
+    if (xn->x_prefix)
+        clixon_intern_release(xn->x_prefix);
+    xn->x_prefix = iprefix;
     return 0;
 }
 
@@ -472,6 +909,8 @@ nscache_set(cxobj *x,
     if (!is_element(x))
         return 0;
     if (x->x_ns_cache == NULL){
+        if (xml_arena_side(x) < 0)
+            goto done;
         if ((x->x_ns_cache = xml_nsctx_init(prefix, namespace)) == NULL)
             goto done;
     }
@@ -501,9 +940,11 @@ nscache_replace(cxobj *x,
         xml_nsctx_free(x->x_ns_cache);
         x->x_ns_cache = NULL;
     }
+    if (xml_arena_side(x) < 0)
+        goto done;
     x->x_ns_cache = nsc;
     retval = 0;
-    // done:
+ done:
     return retval;
 }
 
@@ -550,6 +991,23 @@ int
 xml_parent_set(cxobj *xn, 
                cxobj *parent)
 {
+    struct xml_arena *xa;
+    struct xml_arena *xap;
+
+    xa = xml_arena_get(xn);
+    xap = xml_arena_get(parent);
+    if (parent && xa != xap){ /* Link between an arena and another tree */
+        if (xa)
+            xml_arena_escape(xa);
+        if (xap)
+            xml_arena_escape(xap);
+    }
+    else if (xa && !xa->xa_escaped){
+        if (xn->x_up == NULL && parent != NULL)
+            xa->xa_roots--;
+        else if (xn->x_up != NULL && parent == NULL)
+            xa->xa_roots++;
+    }
     xn->x_up = parent;
     return 0;
 }
@@ -624,9 +1082,71 @@ xml_flag_reset(cxobj   *xn,
 char*
 xml_value(cxobj *xn)
 {
-    if (!is_bodyattr(xn))
+    if (!is_bodyattr(xn) || !xn->x_hasvalue)
         return NULL;
-    return xn->x_value_cb?cbuf_get(xn->x_value_cb):NULL;
+    if (xn->x_value_len < XML_VALUE_INLINE)
+        return ((struct xmlbody *)xn)->xb_value.xv_inline;
+    return ((struct xmlbody *)xn)->xb_value.xv_ptr;
+}
+
+/*! Set value of body/attribute node to first keep bytes of its value followed by a string
+ *
+ * The value is stored inline if short, otherwise allocated, see xml_mem_alloc.
+ * The string may point into the existing value.
+ * @param[in]  xn     xml node
+ * @param[in]  keep   Number of bytes of existing value to keep
+ * @param[in]  str    String to add after kept bytes
+ * @param[in]  len    Length of str
+ * @retval     0      OK
+ * @retval     -1     Error
+ */
+static int
+xml_value_store(cxobj      *xn,
+                size_t      keep,
+                const char *str,
+                size_t      len)
+{
+    union xml_value *xv = &((struct xmlbody *)xn)->xb_value;
+    size_t newlen = keep + len;
+    int    oldheap;
+    char  *old;
+    char  *p;
+    char   buf[XML_VALUE_INLINE];
+
+    if (newlen >= UINT32_MAX){
+        clicon_err(OE_XML, EINVAL, "value too long: %zu", newlen);
+        return -1;
+    }
+    oldheap = xn->x_hasvalue && xn->x_value_len >= XML_VALUE_INLINE;
+    old = oldheap ? xv->xv_ptr : xv->xv_inline;
+    if (newlen < XML_VALUE_INLINE){
+        if (oldheap){
+            memcpy(buf, old, keep);
+            memcpy(buf+keep, str, len);
+            xml_mem_free(xn, old, xml_value_cap(xn->x_value_len));
+            memcpy(xv->xv_inline, buf, newlen);
+        }
+        else
+            memmove(xv->xv_inline+keep, str, len);
+        p = xv->xv_inline;
+    }
+    else if (oldheap && xml_value_cap(xn->x_value_len) >= newlen+1){
+        memmove(old+keep, str, len);
+        p = old;
+    }
+    else{
+        if ((p = xml_mem_alloc(xn, xml_value_cap(newlen))) == NULL)
+            return -1;
+        memcpy(p, old, keep);
+        memcpy(p+keep, str, len);
+        if (oldheap)
+            xml_mem_free(xn, old, xml_value_cap(xn->x_value_len));
+        xv->xv_ptr = p;
+    }
+    p[newlen] = '\0';
+    xn->x_value_len = newlen;
+    xn->x_hasvalue = 1;
+    return 0;
 }
 
 /*! Set value of xml node, value is copied
@@ -639,28 +1159,13 @@ int
 xml_value_set(cxobj *xn, 
               char  *val)
 {
-    int    retval = -1;
-    size_t sz;
-
     if (!is_bodyattr(xn))
         return 0;
     if (val == NULL){
         clicon_err(OE_XML, EINVAL, "value is NULL");
-        goto done;
-    }
-    sz = strlen(val)+1;
-    if (xn->x_value_cb == NULL){
-        if ((xn->x_value_cb = cbuf_new_alloc(sz)) == NULL){
-            clicon_err(OE_XML, errno, "cbuf_new");
-            goto done;
-        }
+        return -1;
     }
-    else
-        cbuf_reset(xn->x_value_cb);
-    cbuf_append_str(xn->x_value_cb, val);
-    retval = 0;
- done:
-    return retval;
+    return xml_value_store(xn, 0, val, strlen(val));
 }
 
 /*! Append value of xnode, value is copied
@@ -673,29 +1178,13 @@ int
 xml_value_append(cxobj *xn, 
                  char  *val)
 {
-    int    retval = -1;
-    size_t sz;
-
     if (!is_bodyattr(xn))
         return 0;
     if (val == NULL){
         clicon_err(OE_XML, EINVAL, "value is NULL");
-        goto done;
-    }
-    sz = strlen(val)+1;
-    if (xn->x_value_cb == NULL){
-        if ((xn->x_value_cb = cbuf_new_alloc(sz)) == NULL){
-            clicon_err(OE_XML, errno, "cbuf_new");
-            goto done;
-        }
-    }
-    if (cbuf_append_str(xn->x_value_cb, val) < 0){
-        clicon_err(OE_XML, errno, "cprintf");
-        goto done;
+        return -1;
     }
-    retval = 0;
- done:
-    return retval;
+    return xml_value_store(xn, xn->x_hasvalue?xn->x_value_len:0, val, strlen(val));
 }
 
 /*! Get type of xnode
@@ -935,6 +1424,36 @@ xml_child_each(cxobj           *xparent,
     return xn;
 }
 
+/*! Reallocate child vector to x_childvec_max
+ * @param[in]  x       XML node
+ * @param[in]  oldmax  Allocated length of child vector before x_childvec_max was changed
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+xml_childvec_realloc(cxobj *x,
+                     int    oldmax)
+{
+    cxobj **vec;
+
+    if (!x->x_arena){
+        if ((vec = realloc(x->x_childvec, x->x_childvec_max*sizeof(cxobj*))) == NULL){
+            clicon_err(OE_XML, errno, "realloc");
+            return -1;
+        }
+    }
+    else {
+        if ((vec = xml_mem_alloc(x, x->x_childvec_max*sizeof(cxobj*))) == NULL)
+            return -1;
+        if (x->x_childvec){
+            memcpy(vec, x->x_childvec, oldmax*sizeof(cxobj*));
+            xml_mem_free(x, x->x_childvec, oldmax*sizeof(cxobj*));
+        }
+    }
+    x->x_childvec = vec;
+    return 0;
+}
+
 /*! Extend child vector with one and insert xml node there
  * @note does not do anything with child, you may need to set its parent, etc
  * @see xml_child_insert_pos
@@ -945,6 +1464,7 @@ xml_child_append(cxobj *xp,
                  cxobj *xc)
 {
     size_t start;
+    int    oldmax;
 
     if (!is_element(xp))
         return 0;
@@ -956,15 +1476,13 @@ xml_child_append(cxobj *xp,
         start = XML_CHILDVEC_SIZE_START_ELMNT;
     xp->x_childvec_len++;
     if (xp->x_childvec_len > xp->x_childvec_max){
+        oldmax = xp->x_childvec_max;
         if (xp->x_childvec_len < XML_CHILDVEC_SIZE_THRESHOLD)
             xp->x_childvec_max = xp->x_childvec_max?2*xp->x_childvec_max:start;
         else
             xp->x_childvec_max += XML_CHILDVEC_SIZE_THRESHOLD;
-        xp->x_childvec = realloc(xp->x_childvec, xp->x_childvec_max*sizeof(cxobj*));
-        if (xp->x_childvec == NULL){
-            clicon_err(OE_XML, errno, "realloc");
+        if (xml_childvec_realloc(xp, oldmax) < 0)
             return -1;
-        }
     }
     xp->x_childvec[xp->x_childvec_len-1] = xc;
     return 0;
@@ -981,20 +1499,19 @@ xml_child_insert_pos(cxobj *xp,
                      int    i)
 {
     size_t size;
+    int    oldmax;
    
     if (!is_element(xp))
         return 0;
     xp->x_childvec_len++;
     if (xp->x_childvec_len > xp->x_childvec_max){
+        oldmax = xp->x_childvec_max;
         if (xp->x_childvec_len < XML_CHILDVEC_SIZE_THRESHOLD)
             xp->x_childvec_max = xp->x_childvec_max?2*xp->x_childvec_max:XML_CHILDVEC_SIZE_START;
         else
             xp->x_childvec_max += XML_CHILDVEC_SIZE_THRESHOLD;
-        xp->x_childvec = realloc(xp->x_childvec, xp->x_childvec_max*sizeof(cxobj*));
-        if (xp->x_childvec == NULL){
-            clicon_err(OE_XML, errno, "realloc");
+        if (xml_childvec_realloc(xp, oldmax) < 0)
             return -1;
-        }
     }
     size = (xml_child_nr(xp) - i - 1)*sizeof(cxobj *);
     memmove(&xp->x_childvec[i+1], &xp->x_childvec[i], size);
@@ -1015,14 +1532,13 @@ xml_childvec_set(cxobj *x,
 {
     if (!is_element(x))
         return 0;
+    if (x->x_childvec)
+        xml_mem_free(x, x->x_childvec, x->x_childvec_max*sizeof(cxobj*));
     x->x_childvec_len = len;
     x->x_childvec_max = len;
-    if (x->x_childvec)
-        free(x->x_childvec);
-    if ((x->x_childvec = calloc(len, sizeof(cxobj*))) == NULL){
-        clicon_err(OE_XML, errno, "calloc");
+    if ((x->x_childvec = xml_mem_alloc(x, len*sizeof(cxobj*))) == NULL)
         return -1;
-    }
+    memset(x->x_childvec, 0, len*sizeof(cxobj*));
     return 0;
 }
 
@@ -1062,6 +1578,57 @@ clixon_child_xvec_append(cxobj       *xn,
     return retval;
 }
 
+/*! Start allocating new XML trees in an arena
+ *
+ * Use for transient trees that are created and freed as a whole, such as parsed RPC
+ * messages and replies. Between push and pop, xml_new allocates nodes without parent in
+ * the current arena. Nodes created with a parent are allocated as the parent, also after
+ * pop. The nodes, their child vectors and their values are allocated in sequence in
+ * chunks of XML_ARENA_CHUNK_SIZE bytes instead of one malloc each.
+ * Freeing the last root of the arena frees its chunks without visiting the nodes, unless
+ * a node has been linked to a tree outside the arena, see struct xml_arena.
+ * Calls may be nested, end each call with xml_arena_pop
+ * @retval     0     OK
+ * @code
+ *   xml_arena_push();
+ *   ret = clixon_xml_parse_string(str, YB_NONE, NULL, &xt, NULL);
+ *   xml_arena_pop();
+ *   if (ret < 0)
+ *      err;
+ *   ...
+ *   xml_free(xt);
+ * @endcode
+ * @see xml_arena_pop
+ */
+int
+xml_arena_push(void)
+{
+    _xml_arena++;
+    return 0;
+}
+
+/*! Stop allocating new XML trees in an arena
+ *
+ * @retval     0     OK
+ * @see xml_arena_push
+ */
+int
+xml_arena_pop(void)
+{
+    struct xml_arena *xa;
+
+    if (_xml_arena > 0)
+        _xml_arena--;
+    if (_xml_arena == 0 && (xa = _xml_arena_cur) != NULL){
+        _xml_arena_cur = NULL;
+        if (xa->xa_nr == 0)
+            xml_arena_release(xa);
+        else if (xa->xa_escaped && xa->xa_chunk && xa->xa_chunk->xk_live == 0)
+            xml_arena_chunk_free(xa, xa->xa_chunk);
+    }
+    return 0;
+}
+
 /*! Create new xml node given a name and parent. Free with xml_free().
  *
  * @param[in]  name      Name of XML node
@@ -1084,8 +1651,9 @@ xml_new(char           *name,
         cxobj          *xp,
         enum cxobj_type type)
 {
-    struct xml *x = NULL;
-    size_t      sz;
+    struct xml       *x = NULL;
+    size_t            sz;
+    struct xml_arena *xa = NULL;
     
     switch (type){
     case CX_ELMNT:
@@ -1100,11 +1668,34 @@ xml_new(char           *name,
         return NULL;
         break;
     }
-    if ((x = malloc(sz)) == NULL){
-        clicon_err(OE_XML, errno, "malloc");
-        return NULL;
+    /* Allocate as parent, or in current arena if no parent */
+    if (xp)
+        xa = xml_arena_get(xp);
+    else if (_xml_arena){
+        if (_xml_arena_cur == NULL){
+            if ((_xml_arena_cur = calloc(1, sizeof(struct xml_arena))) == NULL){
+                clicon_err(OE_XML, errno, "calloc");
+                return NULL;
+            }
+        }
+        xa = _xml_arena_cur;
     }
-    memset(x, 0, sz);
+    if (xa){
+        if ((x = xml_arena_alloc(xa, sz)) == NULL)
+            return NULL;
+        memset(x, 0, sz);
+        x->x_arena = XML_ARENA_NODE;
+        xa->xa_nr++;
+        xa->xa_roots++;
+    }
+    else {
+        if ((x = malloc(sz)) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            return NULL;
+        }
+        memset(x, 0, sz);
+    }
+    _stats_xml_nr++;
     xml_type_set(x, type);
     if (name && (xml_name_set(x, name)) < 0)
         return NULL;
@@ -1114,7 +1705,6 @@ xml_new(char           *name,
             return NULL;
         x->_x_i = xml_child_nr(xp)-1;
     }
-    _stats_xml_nr++;
     return x;
 }
 
@@ -1208,6 +1798,8 @@ xml_cv_set(cxobj  *x,
         return 0;
     if (x->x_cv)
         cv_free(x->x_cv);
+    if (cv && xml_arena_side(x) < 0)
+        return -1;
     x->x_cv = cv;
     return 0;
 }
@@ -1225,7 +1817,7 @@ xml_cv_set(cxobj  *x,
  * There are several issues with this function:
  * @note (1) Ignores prefix which means namespaces are ignored
  * @note (2) Does not differentiate between element,attributes and body. You usually want elements.
- * @note (3) Linear scalability and relies on strcmp, does not use search/key indexes
+ * @note (3) Linear scalability, does not use search/key indexes
  * @note (4) Only returns first match, eg a list/leaf-list may have several children with same name
  * @see xml_find_type  A more generic function fixes (1) and (2) above
  */
@@ -1240,8 +1832,11 @@ xml_find(cxobj *xp,
     }
     if (!is_element(xp))
         return NULL;
+    /* Names are interned, if name is not interned there is no such child */
+    if ((name = clixon_intern_find(name)) == NULL)
+        return NULL;
     while ((x = xml_child_each(xp, x, -1)) != NULL) 
-        if (strcmp(name, xml_name(x)) == 0)
+        if (xml_name(x) == name)
             break; /* x is set */
     return x;
 }
@@ -1299,8 +1894,12 @@ xml_addsub(cxobj *xp,
         /* clear namespace context cache of child */
         nscache_clear(xc);
 #ifdef XML_EXPLICIT_INDEX
-    if (xml_search_index_p(xc))
-            xml_search_child_insert(xp, xc);
+        if (xml_search_index_p(xc)){
+            if (xml_search_child_insert(xp, xc) < 0)
+                goto done;
+        }
+        else if (xml_search_list_update(xc, 1) < 0)
+            goto done;
 #endif
     }
     retval = 0;
@@ -1325,13 +1924,12 @@ xml_wrap_all(cxobj *xp,
 
     if (!is_element(xp))
         return NULL;
-    if ((xw = xml_new(tag, NULL, CX_ELMNT)) == NULL)
+    /* Created under xp so that it is allocated as xp, then the other children are moved */
+    if ((xw = xml_new(tag, xp, CX_ELMNT)) == NULL)
         goto done;
-    while (xp->x_childvec_len)
+    while (xml_child_i(xp, 0) != xw)
         if (xml_addsub(xw, xml_child_i(xp, 0)) < 0)
             goto done;
-    if (xml_addsub(xp, xw) < 0)
-        goto done;
   done:
     return xw;
 }
@@ -1417,18 +2015,20 @@ xml_child_rm(cxobj *xp,
         clicon_err(OE_XML, 0, "Child not found");
         goto done;
     }
-    xml_parent_set(xc, NULL);
-    xp->x_childvec[i] = NULL;
-    xp->x_childvec_len--;
-    if (i<xp->x_childvec_len)
-        memmove(&xp->x_childvec[i], &xp->x_childvec[i+1], (xp->x_childvec_len-i)*sizeof(cxobj*));
 #ifdef XML_EXPLICIT_INDEX
+    /* Remove from search index vectors while parent is set */
     if (xml_type(xc) == CX_ELMNT){
         if (xml_search_index_p(xc))
             xml_search_child_rm(xp, xc);
-
+        else if (xml_search_list_update(xc, 0) < 0)
+            goto done;
     }
 #endif
+    xml_parent_set(xc, NULL);
+    xp->x_childvec[i] = NULL;
+    xp->x_childvec_len--;
+    if (i<xp->x_childvec_len)
+        memmove(&xp->x_childvec[i], &xp->x_childvec[i+1], (xp->x_childvec_len-i)*sizeof(cxobj*));
     retval = 0;
  done:
     return retval;
@@ -1733,19 +2333,17 @@ xml_find_type(cxobj           *xt,
               enum cxobj_type  type)
 {
     cxobj *x = NULL;
-    int    pmatch;  /* prefix match */
-    char  *xprefix; /* xprefix */
     
     if (!is_element(xt))
         return NULL;
+    /* Names and prefixes are interned, compare pointers */
+    if (prefix && (prefix = clixon_intern_find(prefix)) == NULL)
+        return NULL;
+    if (name && (name = clixon_intern_find(name)) == NULL)
+        return NULL;
     while ((x = xml_child_each(xt, x, type)) != NULL) {
-        if (prefix){
-            xprefix = xml_prefix(x);
-            pmatch = xprefix ? strcmp(prefix,xprefix)==0 : 0;
-        }
-        else
-            pmatch = 1;
-        if (pmatch && (name==NULL || strcmp(name, xml_name(x)) == 0))
+        if ((prefix == NULL || xml_prefix(x) == prefix) &&
+            (name == NULL || xml_name(x) == name))
             return x;
     }
     return NULL;
@@ -1774,8 +2372,10 @@ xml_find_value(cxobj      *xt,
     
     if (!is_element(xt))
         return NULL;
+    if ((name = clixon_intern_find(name)) == NULL)
+        return NULL;
     while ((x = xml_child_each(xt, x, -1)) != NULL) 
-        if (strcmp(name, xml_name(x)) == 0)
+        if (xml_name(x) == name)
             return xml_value(x);
     return NULL;
 }
@@ -1799,8 +2399,10 @@ xml_find_body(cxobj      *xt,
 
     if (!is_element(xt))
         return NULL;
+    if ((name = clixon_intern_find(name)) == NULL)
+        return NULL;
     while ((x = xml_child_each(xt, x, -1)) != NULL) 
-        if (strcmp(name, xml_name(x)) == 0)
+        if (xml_name(x) == name)
             return xml_body(x);
     return NULL;
 }
@@ -1829,8 +2431,10 @@ xml_find_body_obj(cxobj      *xt,
 
     if (!is_element(xt))
         return NULL;
+    if ((name = clixon_intern_find(name)) == NULL)
+        return NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
-        if (strcmp(name, xml_name(x)))
+        if (xml_name(x) != name)
             continue;
         if ((bstr = xml_body(x)) == NULL)
             continue;
@@ -1847,16 +2451,28 @@ xml_find_body_obj(cxobj      *xt,
 int
 xml_free(cxobj *x)
 {
-    int    i;
-    cxobj *xc;
+    int               i;
+    cxobj            *xc;
+    struct xml_arena *xa = NULL;
 
     if (x == NULL){
         return 0;
     }
-    if (x->x_name)
-        free(x->x_name);
-    if (x->x_prefix)
-        free(x->x_prefix);
+    if ((xa = xml_arena_get(x)) != NULL){
+        if (!xa->xa_escaped && x->x_up == NULL){
+            if (xa->xa_roots == 1){ /* Last root: whole arena without visiting nodes */
+                xml_arena_release(xa);
+                return 0;
+            }
+            xa->xa_roots--;
+        }
+    }
+    else { /* Names of arena nodes are held by the arena */
+        if (x->x_name)
+            clixon_intern_release(x->x_name);
+        if (x->x_prefix)
+            clixon_intern_release(x->x_prefix);
+    }
     switch (xml_type(x)){
     case CX_ELMNT:
         for (i=0; i<x->x_childvec_len; i++){
@@ -1866,25 +2482,35 @@ xml_free(cxobj *x)
             }
         }
         if (x->x_childvec)
-            free(x->x_childvec);
-        if (x->x_cv)
+            xml_mem_free(x, x->x_childvec, x->x_childvec_max*sizeof(cxobj*));
+        /* Side objects are cleared since the node may be registered in its arena */
+        if (x->x_cv){
             cv_free(x->x_cv);
-        if (x->x_ns_cache)
+            x->x_cv = NULL;
+        }
+        if (x->x_ns_cache){
             xml_nsctx_free(x->x_ns_cache);
+            x->x_ns_cache = NULL;
+        }
 #ifdef XML_EXPLICIT_INDEX
         xml_search_index_free(x);
 #endif
         break;
     case CX_BODY:
     case CX_ATTR:
-        if (x->x_value_cb)
-            cbuf_free(x->x_value_cb);  
+        if (x->x_hasvalue && x->x_value_len >= XML_VALUE_INLINE)
+            xml_mem_free(x, ((struct xmlbody *)x)->xb_value.xv_ptr, xml_value_cap(x->x_value_len));
         break;
     default:
         break;
     }
-    free(x);
     _stats_xml_nr--;
+    if (xa){
+        xa->xa_nr--;
+        xml_arena_mfree(xa, x, xml_type(x)==CX_ELMNT?sizeof(struct xml):sizeof(struct xmlbody));
+    }
+    else
+        free(x);
     return 0;
 }
 
@@ -1927,7 +2553,8 @@ xml_copy_one(cxobj *x0,
     default:
         break;
     }
-    xml_flag_set(x1, xml_flag(x0, XML_FLAG_DEFAULT | XML_FLAG_TOP)); /* Maybe more flags */
+    xml_flag_set(x1, xml_flag(x0, XML_FLAG_DEFAULT | XML_FLAG_TOP |
+                                 XML_FLAG_DIRTY | XML_FLAG_DIRTYRM)); /* Maybe more flags */
     retval = 0;
  done:
     return retval;
@@ -1964,6 +2591,11 @@ xml_copy(cxobj *x0,
             goto done;
         if (xml_copy(x, xcopy) < 0) /* recursion */
             goto done;
+#ifdef XML_EXPLICIT_INDEX
+        if (xml_type(xcopy) == CX_ELMNT && xml_search_index_p(xcopy) &&
+            xml_search_child_insert(x1, xcopy) < 0)
+            goto done;
+#endif
     }
     retval = 0;
   done:
@@ -2567,6 +3199,8 @@ xml_search_index_add(cxobj *x,
 {
     struct search_index *si = NULL;
 
+    if (xml_arena_side(x) < 0)
+        goto done;
     if ((si = malloc(sizeof(struct search_index))) == NULL){
         clicon_err(OE_XML, errno, "malloc");
         goto done;
@@ -2614,6 +3248,56 @@ xml_search_index_get(cxobj *x,
     return si;
 }
 
+/*! Find the position of a list element among elements with equal index value
+ *
+ * Index values need not be unique, so the binary search may find another element
+ * @param[in]  si    Search index
+ * @param[in]  xp    XML list element
+ * @param[in]  i     Position of an element with the same index value as xp
+ * @retval     j     Position of xp
+ * @retval    -1     Not found
+ */
+static int
+xml_search_index_exact(struct search_index *si,
+                       cxobj               *xp,
+                       int                  i)
+{
+    int    len = clixon_xvec_len(si->si_xvec);
+    int    j;
+    cxobj *x;
+
+    for (j=i; j>=0; j--){
+        if ((x = clixon_xvec_i(si->si_xvec, j)) == xp)
+            return j;
+        if (xml_cmp(xp, x, 0, 0, si->si_name) != 0)
+            break;
+    }
+    for (j=i+1; j<len; j++){
+        if ((x = clixon_xvec_i(si->si_xvec, j)) == xp)
+            return j;
+        if (xml_cmp(xp, x, 0, 0, si->si_name) != 0)
+            break;
+    }
+    return -1;
+}
+
+/*! Check if all keys of a list element exist and are bound to yang, so that it can be compared
+ * @param[in]  x   XML list element
+ * @retval     1   Yes
+ * @retval     0   No
+ */
+static int
+xml_search_keys_bound(cxobj *x)
+{
+    cg_var *cvi = NULL;
+    cxobj  *xk;
+
+    while ((cvi = cvec_each(yang_cvec_get(xml_spec(x)), cvi)) != NULL)
+        if ((xk = xml_find(x, cv_string_get(cvi))) == NULL || xml_spec(xk) == NULL)
+            return 0;
+    return 1;
+}
+
 /*--------------------------------------------------*/
 
 /*! Get sorted index vector for list for variable "name"
@@ -2654,8 +3338,11 @@ xml_search_child_insert(cxobj *xp,
     char                *indexvar;
     struct search_index *si;
     cxobj               *xpp;
+    cxobj               *x;
     int                  i;
     int                  len;
+    int                  eq = 0;
+    int                  bound;
     
     indexvar = xml_name(xi);
     if ((xpp = xml_parent(xp)) == NULL)
@@ -2668,9 +3355,25 @@ xml_search_child_insert(cxobj *xp,
     }
     /* Find element position using binary search and then remove */
     len = clixon_xvec_len(si->si_xvec);
-    if ((i = xml_search_indexvar_binary_pos(xp, indexvar, si->si_xvec, 0, len, len, NULL)) < 0)
+    if ((i = xml_search_indexvar_binary_pos(xp, indexvar, si->si_xvec, 0, len, len, &eq)) < 0)
         goto done;
-    assert(clixon_xvec_i(si->si_xvec, i) != xp);
+    if (eq){
+        /* Equal index values are ordered by list key, ie in document order for system 
+         * ordered lists, and xp may already be inserted, eg if a bound tree is bound again */
+        while (i > 0 &&
+               xml_cmp(xp, clixon_xvec_i(si->si_xvec, i-1), 0, 0, indexvar) == 0)
+            i--;
+        bound = xml_search_keys_bound(xp);
+        for (; i < len; i++){
+            x = clixon_xvec_i(si->si_xvec, i);
+            if (x == xp)
+                goto ok;
+            if (xml_cmp(xp, x, 0, 0, indexvar) != 0)
+                break;
+            if (bound && xml_search_keys_bound(x) && xml_cmp(xp, x, 0, 0, NULL) < 0)
+                break;
+        }
+    }
     if (clixon_xvec_insert_pos(si->si_xvec, xp, i) < 0)
         goto done;
  ok:
@@ -2691,6 +3394,7 @@ xml_search_child_rm(cxobj *xp,
     cxobj              *xpp;
     char               *indexvar;
     int                 i;
+    int                 j;
     int                 len;
     struct search_index *si;
     int                  eq = 0;
@@ -2704,18 +3408,54 @@ xml_search_child_rm(cxobj *xp,
     
     /* Find element using binary search and then remove */
     len = clixon_xvec_len(si->si_xvec);
+    if (len == 0)
+        goto ok;
     if ((i = xml_search_indexvar_binary_pos(xp, indexvar, si->si_xvec, 0, len, len, &eq)) < 0)
         goto done;
-        //    if (clixon_xvec_i(si->si_xvec, i) == xp)
-    if (eq)
-        if (clixon_xvec_rm_pos(si->si_xvec, i) < 0)
-            goto done;          
+    if (eq == 0)
+        goto ok;
+    if ((j = xml_search_index_exact(si, xp, i)) >= 0)
+        if (clixon_xvec_rm_pos(si->si_xvec, j) < 0)
+            goto done;
  ok:
     retval = 0;
  done:
     return retval;
 }
 
+/*! Insert or remove the search index leafs of a list element in the vectors of its parent
+ *
+ * Used when a whole list element is added or removed, the index leafs themselves are
+ * then not added or removed one by one.
+ * @param[in] xc      XML list element, with parent set
+ * @param[in] insert  1: insert in search vectors, 0: remove from search vectors
+ * @retval    0       OK
+ * @retval   -1       Error
+ */
+int
+xml_search_list_update(cxobj *xc,
+                       int    insert)
+{
+    yang_stmt *y;
+    cxobj     *xi = NULL;
+
+    if ((y = xml_spec(xc)) == NULL ||
+        yang_flag_get(y, YANG_FLAG_INDEX_LIST) == 0 ||
+        xml_parent(xc) == NULL)
+        return 0;
+    while ((xi = xml_child_each(xc, xi, CX_ELMNT)) != NULL) {
+        if ((y = xml_spec(xi)) == NULL || yang_flag_get(y, YANG_FLAG_INDEX) == 0)
+            continue;
+        if (insert){
+            if (xml_search_child_insert(xc, xi) < 0)
+                return -1;
+        }
+        else if (xml_search_child_rm(xc, xi) < 0)
+            return -1;
+    }
+    return 0;
+}
+
 /*! Iterator over xml children objects using (explicit) index variable
  *
  * @param[in] xparent xml tree node whose children should be iterated
@@ -140,6 +140,7 @@ strip_body_objects(cxobj *xt)
  * @param[in]   xt     XML tree node
  * @param[in]   xsibling
  * @param[in]   yspec  Top-level YANG spec / mount-point
+ * @param[in]   index  If set, insert search index leaf xt in index of its list element
  * @param[out]  xerr   Reason for failure, or NULL
  * @retval      2      OK Yang assignment not made because yang parent is anyxml or anydata
  * @retval      1      OK Yang assignment made
@@ -152,6 +153,7 @@ static int
 populate_self_parent(cxobj     *xt,
                      cxobj     *xsibling,
                      yang_stmt *yspec,
+                     int        index,
                      cxobj    **xerr)
 {
     int        retval = -1;
@@ -233,8 +235,8 @@ populate_self_parent(cxobj     *xt,
  set:
     xml_spec_set(xt, y);
 #ifdef XML_EXPLICIT_INDEX
-    if (xml_search_index_p(xt))
-        xml_search_child_insert(xp, xt);
+    if (index && xml_search_index_p(xt))
+        xml_search_child_insert(xml_parent(xt), xt);
 #endif
     retval = 1;
  done:
@@ -438,7 +440,7 @@ xml_bind_yang0_opt(clicon_handle h,
             goto done;
         break;
     case YB_PARENT:
-        if ((ret = populate_self_parent(xt, xsibling, yspec, xerr)) < 0)
+        if ((ret = populate_self_parent(xt, xsibling, yspec, 1, xerr)) < 0)
             goto done;
         break;
     default:
@@ -545,7 +547,7 @@ xml_bind_yang0(clicon_handle h,
             goto done;
         break;
     case YB_PARENT:
-        if ((ret = populate_self_parent(xt, NULL, yspec, xerr)) < 0)
+        if ((ret = populate_self_parent(xt, NULL, yspec, 1, xerr)) < 0)
             goto done;
         break;
     case YB_NONE:
@@ -577,6 +579,67 @@ xml_bind_yang0(clicon_handle h,
     goto done;
 }
 
+/*! Bind yang to a single XML node, not its children, for streaming parsing
+ *
+ * Children are bound as they are parsed by calling this function on each child 
+ * with YB_PARENT, and xml_bind_yang_node_end when the node is complete.
+ * @param[in]   xt       XML tree node
+ * @param[in]   yb       YB_MODULE or YB_PARENT
+ * @param[in]   yspec    Yang spec
+ * @param[in]   xsibling Previous sibling with same name (optimization), or NULL
+ * @param[out]  xerr     Reason for failure, or NULL
+ * @retval      2        OK Yang assignment not made because yang parent is anyxml or anydata
+ * @retval      1        OK yang assignment made
+ * @retval      0        Yang assigment not made and xerr set
+ * @retval     -1        Error
+ * @see clixon_xml_parse_fd
+ * @note Schema mount is not supported
+ */
+int
+xml_bind_yang_node(cxobj     *xt,
+                   yang_bind  yb,
+                   yang_stmt *yspec,
+                   cxobj     *xsibling,
+                   cxobj    **xerr)
+{
+    int retval = -1;
+
+    switch (yb){
+    case YB_MODULE:
+        retval = populate_self_top(xt, yspec, xerr);
+        break;
+    case YB_PARENT:
+        /* Index value and list keys are not parsed yet, see xml_bind_yang_node_end */
+        retval = populate_self_parent(xt, xsibling, yspec, 0, xerr);
+        break;
+    default:
+        clicon_err(OE_XML, EINVAL, "Invalid yang binding: %d", yb);
+        break;
+    }
+    return retval;
+}
+
+/*! Complete yang binding of a single XML node when all its children are parsed
+ *
+ * Search index leafs of a list element are inserted in the index vectors here, when
+ * their values and the list keys are known
+ * @param[in]   xt       XML tree node
+ * @retval      0        OK
+ * @retval     -1        Error
+ * @see xml_bind_yang_node
+ */
+int
+xml_bind_yang_node_end(cxobj *xt)
+{
+    if (strip_body_objects(xt) < 0)
+        return -1;
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_search_list_update(xt, 1) < 0)
+        return -1;
+#endif
+    return 0;
+}
+
 /*! RPC-specific
  *
  * @param[in]   h      Clixon handle
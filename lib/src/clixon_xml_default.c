@@ -328,6 +328,8 @@ xml_default(yang_stmt *yt,
                     /* Check when condition */
                     if (yang_check_when_xpath(NULL, xt, yc, &hit, &nr, &xpath) < 0)
                         goto done;
+                    if (hit) /* Default may depend on other nodes, see xml_diff_dirty */
+                        xml_dirty_mark(xt, 1);
                     if (hit && nr == 0)
                         break; /* Do not create default if xpath fails */
                     if (xml_find_type(xt, NULL, yang_argument_get(yc), CX_ELMNT) == NULL){
@@ -343,6 +345,8 @@ xml_default(yang_stmt *yt,
                     /* Check when condition */
                     if (yang_check_when_xpath(NULL, xt, yc, &hit, &nr, &xpath) < 0)
                         goto done;
+                    if (hit) /* Default may depend on other nodes, see xml_diff_dirty */
+                        xml_dirty_mark(xt, 1);
                     if (hit && nr == 0)
                         break; /* Do not create default if xpath fails */
                     /* If this is non-presence, (and it does not exist in xt) call 
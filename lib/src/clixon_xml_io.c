@@ -52,6 +52,7 @@
 #include <errno.h>
 #include <string.h>
 #include <limits.h>
+#include <sys/stat.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -315,13 +316,19 @@ xml_dump(FILE  *f,
  * @param[in]     level    Indentation level for prettyprint
  * @param[in]     pretty   Insert \n and spaces to make the xml more readable.
  * @param[in]     depth    Limit levels of child resources: -1 is all, 0 is none, 1 is node itself
+ * @param[in]     chunklen Call fn when cb has at least this many bytes after an element
+ * @param[in]     fn       Chunk callback, cb is reset after each call. If NULL, no chunks
+ * @param[in]     arg      Argument to fn
  */
 static int
-clixon_xml2cbuf1(cbuf   *cb, 
-                 cxobj  *x, 
-                 int     level,
-                 int     pretty,
-                 int32_t depth)
+clixon_xml2cbuf1(cbuf                *cb, 
+                 cxobj               *x, 
+                 int                  level,
+                 int                  pretty,
+                 int32_t              depth,
+                 size_t               chunklen,
+                 clixon_xml_chunk_cb *fn,
+                 void                *arg)
 {
     int    retval = -1;
     cxobj *xc;
@@ -367,7 +374,7 @@ clixon_xml2cbuf1(cbuf   *cb,
         while ((xc = xml_child_each(x, xc, -1)) != NULL) 
             switch (xml_type(xc)){
             case CX_ATTR:
-                if (clixon_xml2cbuf1(cb, xc, level+1, pretty, -1) < 0)
+                if (clixon_xml2cbuf1(cb, xc, level+1, pretty, -1, 0, NULL, NULL) < 0)
                     goto done;
                 break;
             case CX_BODY:
@@ -389,7 +396,7 @@ clixon_xml2cbuf1(cbuf   *cb,
             xc = NULL;
             while ((xc = xml_child_each(x, xc, -1)) != NULL) 
                 if (xml_type(xc) != CX_ATTR)
-                    if (clixon_xml2cbuf1(cb, xc, level+1, pretty, depth-1) < 0)
+                    if (clixon_xml2cbuf1(cb, xc, level+1, pretty, depth-1, chunklen, fn, arg) < 0)
                         goto done;
             if (pretty && hasbody == 0)
                 cprintf(cb, "%*s", level*PRETTYPRINT_INDENT, "");
@@ -403,6 +410,11 @@ clixon_xml2cbuf1(cbuf   *cb,
         }
         if (pretty)
             cbuf_append_str(cb, "\n");
+        if (fn && cbuf_len(cb) >= chunklen){
+            if (fn(cbuf_get(cb), cbuf_len(cb), arg) < 0)
+                goto done;
+            cbuf_reset(cb);
+        }
         break;
     default:
         break;
@@ -447,15 +459,82 @@ clixon_xml2cbuf(cbuf   *cb,
     if (skiptop){
         xc = NULL;
         while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL)
-            if (clixon_xml2cbuf1(cb, xc, level, pretty, depth) < 0)
+            if (clixon_xml2cbuf1(cb, xc, level, pretty, depth, 0, NULL, NULL) < 0)
+                goto done;
+    }
+    else {
+        if (clixon_xml2cbuf1(cb, xn, level, pretty, depth, 0, NULL, NULL) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Print an XML tree structure in chunks to a callback and encode chars "<>&"
+ *
+ * Same output as clixon_xml2cbuf but the output is not kept in one buffer. Instead fn is
+ * called each time at least chunklen bytes are printed, and once with the remainder.
+ * The buffer is then reused, which bounds memory to around chunklen for any size of tree.
+ * @param[in]     xn       Top-level xml object
+ * @param[in]     level    Indentation level for pretty
+ * @param[in]     pretty   Insert \n and spaces to make the xml more readable.
+ * @param[in]     depth    Limit levels of child resources: -1: all, 0: none, 1: node itself
+ * @param[in]     skiptop  0: Include top object 1: Skip top-object, only children, 
+ * @param[in]     chunklen Approximate size of each chunk
+ * @param[in]     fn       Chunk callback, called with buffer, length and arg
+ * @param[in]     arg      Argument to fn
+ * @retval        0        OK
+ * @retval        -1       Error, or fn returned error
+ * @code
+ *   static int
+ *   myfn(char *buf, size_t len, void *arg)
+ *   {
+ *     return write(*(int*)arg, buf, len) < 0 ? -1 : 0;
+ *   }
+ *   if (clixon_xml2chunks(xn, 0, 0, -1, 0, 65536, myfn, &fd) < 0)
+ *     goto err;
+ * @endcode
+ * @see  clixon_xml2cbuf
+ */
+int
+clixon_xml2chunks(cxobj               *xn,
+                  int                  level,
+                  int                  pretty,
+                  int32_t              depth,
+                  int                  skiptop,
+                  size_t               chunklen,
+                  clixon_xml_chunk_cb *fn,
+                  void                *arg)
+{
+    int    retval = -1;
+    cbuf  *cb = NULL;
+    cxobj *xc;
+
+    if (fn == NULL){
+        clicon_err(OE_XML, EINVAL, "fn is NULL");
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (skiptop){
+        xc = NULL;
+        while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL)
+            if (clixon_xml2cbuf1(cb, xc, level, pretty, depth, chunklen, fn, arg) < 0)
                 goto done;
     }
     else {
-        if (clixon_xml2cbuf1(cb, xn, level, pretty, depth) < 0)
+        if (clixon_xml2cbuf1(cb, xn, level, pretty, depth, chunklen, fn, arg) < 0)
             goto done;
     }
+    if (cbuf_len(cb) && fn(cbuf_get(cb), cbuf_len(cb), arg) < 0)
+        goto done;
     retval = 0;
  done:
+    if (cb)
+        cbuf_free(cb);
     return retval;
 }
 
@@ -727,6 +806,98 @@ clixon_xml_parse_file(FILE      *fp,
     return retval;
 }
 
+/*! Read an XML file in one chunk and parse it in place, calling a callback on each element
+ *
+ * The file is read with a single read(2) into a buffer that is scanned in place by the
+ * lexer (no extra string copies). For each element, fn is called when its start-tag has
+ * been parsed and again when the element is complete. This makes it possible for the 
+ * caller to bind yang, strip and sort while parsing, instead of in separate passes 
+ * afterwards.
+ * @param[in]     fd    File descriptor of a regular file containing XML
+ * @param[in]     fn    Callback on element start and end, or NULL
+ * @param[in]     arg   Argument to fn
+ * @param[in,out] xt    Pointer to XML parse tree. If empty, create.
+ * @retval        0     OK
+ * @retval       -1     Error with clicon_err called. Includes parse error and fn error
+ * @see clixon_xml_parse_file  Reads from stream and binds yang after parsing
+ * @note No yang binding or sorting is made, that is up to fn
+ */
+int
+clixon_xml_parse_fd(int            fd,
+                    xml_parsefn_t *fn,
+                    void          *arg,
+                    cxobj        **xt)
+{
+    int             retval = -1;
+    clixon_xml_yacc xy = {0,};
+    struct stat     st;
+    char           *buf = NULL;
+    size_t          len = 0;
+    ssize_t         n;
+    cxobj          *x;
+    int             i;
+
+    if (xt == NULL){
+        clicon_err(OE_XML, EINVAL, "xt is NULL");
+        return -1;
+    }
+    if (fstat(fd, &st) < 0){
+        clicon_err(OE_XML, errno, "fstat");
+        goto done;
+    }
+    /* Two trailing null characters required by in-place lexer scanning */
+    if ((buf = malloc(st.st_size + 2)) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        goto done;
+    }
+    while (len < st.st_size){
+        if ((n = read(fd, buf + len, st.st_size - len)) < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_XML, errno, "read");
+            goto done;
+        }
+        if (n == 0) /* File truncated after fstat */
+            break;
+        len += n;
+    }
+    buf[len] = '\0';
+    buf[len+1] = '\0';
+    if (*xt == NULL)
+        if ((*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+    if (len == 0){
+        retval = 0;
+        goto done;
+    }
+    xy.xy_parse_string = buf;
+    xy.xy_parse_len = len + 2;
+    xy.xy_xtop = *xt;
+    xy.xy_xparent = *xt;
+    xy.xy_fn = fn;
+    xy.xy_fnarg = arg;
+    if (clixon_xml_parsel_init(&xy) < 0)
+        goto exit;
+    if (clixon_xml_parseparse(&xy) != 0)  /* yacc returns 1 on error */
+        goto exit;
+    /* Purge all top-level body objects */
+    x = NULL;
+    while ((x = xml_find_type(*xt, NULL, "body", CX_BODY)) != NULL)
+        xml_purge(x);
+    for (i = 0; i < xy.xy_xlen; i++)
+        if (xml2ns_recurse(xy.xy_xvec[i]) < 0)
+            goto exit;
+    retval = 0;
+ exit:
+    clixon_xml_parsel_exit(&xy);
+ done:
+    if (xy.xy_xvec)
+        free(xy.xy_xvec);
+    if (buf)
+        free(buf);
+    return retval;
+}
+
 /*! Read an XML definition from string and parse it into a parse-tree, advanced API
  *
  * @param[in]     str   String containing XML definition. 
@@ -274,6 +274,84 @@ cvec2xml_1(cvec   *cvv,
     return retval;
 }
 
+static int xml_diff1(cxobj *x0, cxobj *x1, int dirty,
+                     cxobj ***x0vec, int *x0veclen, cxobj ***x1vec, int *x1veclen,
+                     cxobj ***changed_x0, cxobj ***changed_x1, int *changedlen);
+static int xml_diff1_dirty(cxobj *x0, cxobj *x1,
+                           cxobj ***x0vec, int *x0veclen, cxobj ***x1vec, int *x1veclen,
+                           cxobj ***changed_x0, cxobj ***changed_x1, int *changedlen);
+
+/*! Compute differences between two yang-equal xml nodes, see xml_diff1
+ *
+ * @param[in]  x0c   First XML node
+ * @param[in]  x1c   Second XML node, xml_cmp() of x0c and x1c is equal
+ * @param[in]  dirty If set, only descend into children marked with XML_FLAG_DIRTY
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xml_diff1 for the other parameters
+ */
+static int
+xml_diff_pair(cxobj     *x0c, 
+              cxobj     *x1c,
+              int        dirty,
+              cxobj   ***x0vec,
+              int       *x0veclen,
+              cxobj   ***x1vec,
+              int       *x1veclen,
+              cxobj   ***changed_x0,
+              cxobj   ***changed_x1,
+              int       *changedlen)
+{
+    int        retval = -1;
+    yang_stmt *yc0;
+    yang_stmt *yc1;
+    char      *b0;
+    char      *b1;
+
+    /* xml-spec NULL could happen with anydata children for example,
+     * if so, continute compare children but without yang
+     */
+    yc0 = xml_spec(x0c);
+    yc1 = xml_spec(x1c);
+    if (yc0 && yc1 && yc0 != yc1){ /* choice */
+        if (cxvec_append(x0c, x0vec, x0veclen) < 0) 
+            goto done;
+        if (cxvec_append(x1c, x1vec, x1veclen) < 0) 
+            goto done;
+    }
+    else if (yc0 && yang_keyword_get(yc0) == Y_LEAF){
+        /* if x0c and x1c are leafs w bodies, then they may be changed */
+        b0 = xml_body(x0c);
+        b1 = xml_body(x1c);
+        if (b0 == NULL && b1 == NULL)
+            ;
+        else if (b0 == NULL || b1 == NULL
+                 || strcmp(b0, b1) != 0 
+                 ){
+            if (cxvec_append(x0c, changed_x0, changedlen) < 0) 
+                goto done;
+            (*changedlen)--; /* append two vectors */
+            if (cxvec_append(x1c, changed_x1, changedlen) < 0) 
+                goto done;
+        }
+    }
+    else if (dirty){
+        if (xml_diff1_dirty(x0c, x1c,   
+                            x0vec, x0veclen, 
+                            x1vec, x1veclen, 
+                            changed_x0, changed_x1, changedlen)< 0)
+            goto done;
+    }
+    else if (xml_diff1(x0c, x1c, 0,
+                       x0vec, x0veclen, 
+                       x1vec, x1veclen, 
+                       changed_x0, changed_x1, changedlen)< 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Recursive help function to compute differences between two xml trees
  * @param[in]  x0         First XML tree
  * @param[in]  x1         Second XML tree
@@ -296,11 +374,13 @@ cvec2xml_1(cvec   *cvv,
  * (*) "comparing" a&b here is made by xml_cmp() which judges equality from a structural
  *     perspective, ie both have the same yang spec, if they are lists, they have the
  *     the same keys. NOT that the values are equal!
+ * If dirty is set, equal children of x1 not marked with XML_FLAG_DIRTY are skipped.
  * @see xml_diff  API function, this one is internal and recursive
  */
 static int
 xml_diff1(cxobj     *x0, 
           cxobj     *x1,
+          int        dirty,
           cxobj   ***x0vec,
           int       *x0veclen,
           cxobj   ***x1vec,
@@ -312,10 +392,6 @@ xml_diff1(cxobj     *x0,
     int        retval = -1;
     cxobj     *x0c = NULL; /* x0 child */
     cxobj     *x1c = NULL; /* x1 child */
-    yang_stmt *yc0;
-    yang_stmt *yc1;
-    char      *b0;
-    char      *b1;
     int        eq;
 
     /* Traverse x0 and x1 in lock-step */
@@ -351,40 +427,14 @@ xml_diff1(cxobj     *x0,
             x1c = xml_child_each(x1, x1c, CX_ELMNT);
             continue;
         }
+        else if (dirty && xml_flag(x1c, XML_FLAG_DIRTY) == 0)
+            ; /* equal and not edited */
         else{ /* equal */
-            /* xml-spec NULL could happen with anydata children for example,
-             * if so, continute compare children but without yang
-             */
-            yc0 = xml_spec(x0c);
-            yc1 = xml_spec(x1c);
-            if (yc0 && yc1 && yc0 != yc1){ /* choice */
-                if (cxvec_append(x0c, x0vec, x0veclen) < 0) 
-                    goto done;
-                if (cxvec_append(x1c, x1vec, x1veclen) < 0) 
-                    goto done;
-            }
-            else
-                if (yc0 && yang_keyword_get(yc0) == Y_LEAF){
-                    /* if x0c and x1c are leafs w bodies, then they may be changed */
-                    b0 = xml_body(x0c);
-                    b1 = xml_body(x1c);
-                    if (b0 == NULL && b1 == NULL)
-                        ;
-                    else if (b0 == NULL || b1 == NULL
-                             || strcmp(b0, b1) != 0 
-                             ){
-                        if (cxvec_append(x0c, changed_x0, changedlen) < 0) 
-                            goto done;
-                        (*changedlen)--; /* append two vectors */
-                        if (cxvec_append(x1c, changed_x1, changedlen) < 0) 
-                            goto done;
-                    }
-                }
-                else if (xml_diff1(x0c, x1c,   
-                                   x0vec, x0veclen, 
-                                   x1vec, x1veclen, 
-                                   changed_x0, changed_x1, changedlen)< 0)
-                    goto done;
+            if (xml_diff_pair(x0c, x1c, dirty,
+                              x0vec, x0veclen, 
+                              x1vec, x1veclen, 
+                              changed_x0, changed_x1, changedlen) < 0)
+                goto done;
         }
         x0c = xml_child_each(x0, x0c, CX_ELMNT);
         x1c = xml_child_each(x1, x1c, CX_ELMNT);
@@ -439,7 +489,7 @@ xml_diff(cxobj     *x0,
             goto done;
         goto ok;
     }
-    if (xml_diff1(x0, x1,
+    if (xml_diff1(x0, x1, 0,
                   first, firstlen, 
                   second, secondlen, 
                   changed_x0, changed_x1, changedlen) < 0)
@@ -450,6 +500,166 @@ xml_diff(cxobj     *x0,
     return retval;
 }
 
+/*! Compute differences between two xml trees descending only into edited nodes
+ *
+ * Children of x1 marked with XML_FLAG_DIRTY are looked up in x0 directly, other
+ * children are assumed to be equal. If a child may have been removed, ie x1 is marked
+ * with XML_FLAG_DIRTYRM or the number of children does not add up, fall back to
+ * a lock-step traversal of the children, see xml_diff1.
+ * @param[in]  x0         First XML node
+ * @param[in]  x1         Second XML node, marked with XML_FLAG_DIRTY
+ * @retval     0          OK
+ * @retval    -1          Error
+ * @see xml_diff1 for the other parameters
+ */
+static int
+xml_diff1_dirty(cxobj     *x0, 
+                cxobj     *x1,
+                cxobj   ***x0vec,
+                int       *x0veclen,
+                cxobj   ***x1vec,
+                int       *x1veclen,
+                cxobj   ***changed_x0,
+                cxobj   ***changed_x1,
+                int       *changedlen)
+{
+    int        retval = -1;
+    cxobj     *x0c;
+    cxobj     *x1c;
+    yang_stmt *yc;
+    int        added = 0; /* Edited children of x1 not in x0 */
+
+    if (xml_flag(x1, XML_FLAG_DIRTYRM))
+        goto full;
+    /* First pass: check that x0 has the same children as x1 except the added ones */
+    x1c = NULL;
+    while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL) {
+        if (xml_flag(x1c, XML_FLAG_DIRTY) == 0)
+            continue;
+        if ((yc = xml_spec(x1c)) == NULL)
+            goto full;
+        if (match_base_child(x0, x1c, yc, &x0c) < 0)
+            goto done;
+        if (x0c == NULL)
+            added++;
+    }
+    if (xml_child_nr_type(x0, CX_ELMNT) + added != xml_child_nr_type(x1, CX_ELMNT))
+        goto full;
+    /* Second pass: compare edited children in the same order as xml_diff1 */
+    x1c = NULL;
+    while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL) {
+        if (xml_flag(x1c, XML_FLAG_DIRTY) == 0)
+            continue;
+        if (match_base_child(x0, x1c, xml_spec(x1c), &x0c) < 0)
+            goto done;
+        if (x0c == NULL){
+            if (cxvec_append(x1c, x1vec, x1veclen) < 0) 
+                goto done;
+        }
+        else if (xml_diff_pair(x0c, x1c, 1,
+                               x0vec, x0veclen, 
+                               x1vec, x1veclen, 
+                               changed_x0, changed_x1, changedlen) < 0)
+            goto done;
+    }
+    goto ok;
+ full:
+    if (xml_diff1(x0, x1, 1,
+                  x0vec, x0veclen, 
+                  x1vec, x1veclen, 
+                  changed_x0, changed_x1, changedlen) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Compute differences between a datastore tree and a copy of it with marked edits
+ *
+ * Same result as xml_diff, but x1 is assumed to be a copy of x0 where every edited
+ * node and its ancestors are marked with XML_FLAG_DIRTY, see xml_dirty_mark.
+ * Unmarked subtrees are not compared, so that the cost is proportional to the edits
+ * rather than to the size of the trees.
+ * @param[in]  x0         First XML tree, eg running
+ * @param[in]  x1         Second XML tree with marked edits, eg candidate
+ * @param[out] first      Pointervector to XML nodes existing in only first tree
+ * @param[out] firstlen   Length of first vector
+ * @param[out] second     Pointervector to XML nodes existing in only second tree
+ * @param[out] secondlen  Length of second vector
+ * @param[out] changed_x0 Pointervector to XML nodes changed orig value
+ * @param[out] changed_x1 Pointervector to XML nodes changed wanted value
+ * @param[out] changedlen Length of changed vector
+ * @retval     0          OK
+ * @retval    -1          Error
+ * @see xml_diff
+ */
+int
+xml_diff_dirty(cxobj     *x0, 
+               cxobj     *x1,
+               cxobj   ***first,
+               int       *firstlen,
+               cxobj   ***second,
+               int       *secondlen,
+               cxobj   ***changed_x0,
+               cxobj   ***changed_x1,
+               int       *changedlen)
+{
+    if (x0 == NULL || x1 == NULL)
+        return xml_diff(x0, x1, first, firstlen, second, secondlen,
+                        changed_x0, changed_x1, changedlen);
+    *firstlen = 0;
+    *secondlen = 0;    
+    *changedlen = 0;
+    if (xml_flag(x1, XML_FLAG_DIRTY) == 0)
+        return 0;
+    return xml_diff1_dirty(x0, x1,
+                           first, firstlen, 
+                           second, secondlen, 
+                           changed_x0, changed_x1, changedlen);
+}
+
+/*! Mark an edited datastore node and its ancestors with XML_FLAG_DIRTY
+ *
+ * @param[in]  x    XML node that has been added or changed, or whose children have
+ * @param[in]  rm   If set, children of x may have been removed or re-ordered
+ * @retval     0    OK
+ * @note All ancestors are marked, also above an already marked node, since a node may
+ *       be marked in another tree, eg global defaults, before it is merged
+ * @see xml_diff_dirty
+ */
+int
+xml_dirty_mark(cxobj *x,
+               int    rm)
+{
+    if (rm)
+        xml_flag_set(x, XML_FLAG_DIRTYRM);
+    do {
+        xml_flag_set(x, XML_FLAG_DIRTY);
+    } while ((x = xml_parent(x)) != NULL);
+    return 0;
+}
+
+/*! Clear XML_FLAG_DIRTY marks of a datastore tree, only marked nodes are visited
+ *
+ * @param[in]  xt   XML tree
+ * @retval     0    OK
+ * @see xml_dirty_mark
+ */
+int
+xml_dirty_clear(cxobj *xt)
+{
+    cxobj *x;
+
+    if (xml_flag(xt, XML_FLAG_DIRTY) == 0)
+        return 0;
+    xml_flag_reset(xt, XML_FLAG_DIRTY | XML_FLAG_DIRTYRM);
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL)
+        xml_dirty_clear(x);
+    return 0;
+}
+
 /*! Compute if two XML trees are equal or not
  *
  * @param[in]  x0   First XML tree
@@ -1559,14 +1769,16 @@ yang_check_when_xpath(cxobj        *xn,
     int        retval = 1;
     yang_stmt *yc;
     char      *xpath = NULL;
+    xpath_tree *xpt = NULL;
     cxobj     *x = NULL;
     int        nr = 0;
     cvec      *nsc = NULL;
     int        xmalloc = 0;   /* ugly help variable to clean temporary object */
-    int        nscmalloc = 0; /* ugly help variable to remove */
 
     /* First variant */
     if ((xpath = yang_when_xpath_get(yn)) != NULL){
+        if ((xpt = yang_when_xpath_tree_get(yn)) == NULL)
+            goto done;
         x = xp;
         nsc = yang_when_nsc_get(yn);
         *hit = 1;
@@ -1574,6 +1786,8 @@ yang_check_when_xpath(cxobj        *xn,
     /* Second variant */
     else if ((yc = yang_find(yn, Y_WHEN, NULL)) != NULL){
         xpath = yang_argument_get(yc); /* "when" has xpath argument */
+        if ((xpt = yang_xpath_tree_get(yc)) == NULL)
+            goto done;
         /* Create dummy */
         if (xn == NULL){
             if ((x = xml_new(yang_argument_get(yn), xp, CX_ELMNT)) == NULL)
@@ -1583,15 +1797,14 @@ yang_check_when_xpath(cxobj        *xn,
         }
         else
             x = xn;
-        if (xml_nsctx_yang(yn, &nsc) < 0)
+        if ((nsc = yang_xpath_nsc_get(yn)) == NULL)
             goto done;
-        nscmalloc++;
         *hit = 1;
     }
     else
         *hit = 0;
-    if (x && xpath){
-        if ((nr = xpath_vec_bool(x, nsc, "%s", xpath)) < 0)
+    if (x && xpt){
+        if ((nr = xpath_tree_vec_bool(x, nsc, xpt)) < 0)
             goto done;
     }
     if (nrp)
@@ -1602,8 +1815,6 @@ yang_check_when_xpath(cxobj        *xn,
  done:
     if (xmalloc)
         xml_purge(x);
-    if (nsc && nscmalloc)
-        xml_nsctx_free(nsc);
     return retval;
 }
 
@@ -46,6 +46,8 @@
 /*! XML parser yacc handler struct */
 struct clixon_xml_parse_yacc {
     char       *xy_parse_string; /* original (copy of) parse string */
+    size_t      xy_parse_len;    /* If set, scan xy_parse_string in place, length including
+                                    two terminating null characters */
     int         xy_linenum;      /* Number of \n in parsed buffer */
     void       *xy_lexbuf;       /* internal parse buffer from lex */
     cxobj      *xy_xtop;         /* cxobj top element (fixed) */
@@ -55,6 +57,8 @@ struct clixon_xml_parse_yacc {
     int         xy_lex_state;    /* lex return state */
     cxobj     **xy_xvec;         /* Vector of created top-level nodes (to know which are created) */
     int         xy_xlen;         /* Length of xy_xvec */
+    xml_parsefn_t *xy_fn;        /* If set, called for each element start and end */
+    void       *xy_fnarg;        /* Argument to xy_fn */
 };
 typedef struct clixon_xml_parse_yacc clixon_xml_yacc;
 
@@ -248,9 +248,31 @@ xml_parse_prefixed_name(clixon_xml_yacc *xy,
     return retval;
 }
 
+/*! Empty element <name/> is complete, call start and end callbacks
+ */
+static int
+xml_parse_eslash(clixon_xml_yacc *xy)
+{
+    int retval = -1;
+
+    if (xy->xy_fn && xy->xy_xelement){
+        if (xy->xy_fn(xy->xy_xelement, 0, xy->xy_fnarg) < 0)
+            goto done;
+        if (xy->xy_fn(xy->xy_xelement, 1, xy->xy_fnarg) < 0)
+            goto done;
+    }
+    xy->xy_xelement = NULL;
+    retval = 0;
+ done:
+    return retval;
+}
+
 static int
 xml_parse_endslash_pre(clixon_xml_yacc *xy)
 {
+    if (xy->xy_fn && xy->xy_xelement)
+        if (xy->xy_fn(xy->xy_xelement, 0, xy->xy_fnarg) < 0)
+            return -1;
     xy->xy_xparent = xy->xy_xelement;
     xy->xy_xelement = NULL;
     return 0;
@@ -320,6 +342,8 @@ xml_parse_bslash(clixon_xml_yacc *xy,
         if (xml_rm_children(x, CX_BODY) < 0) /* remove all bodies */
             goto done;
     }
+    if (xy->xy_fn && xy->xy_fn(x, 1, xy->xy_fnarg) < 0)
+        goto done;
     retval = 0;
   done:
     if (prefix)
@@ -426,9 +450,9 @@ qname       : NAME           { if (xml_parse_prefixed_name(_XY, NULL, $1) < 0) Y
                                 _PARSE_DEBUG("qname -> NAME : NAME");}
             ;
 
-element1    :  ESLASH         {_XY->xy_xelement = NULL; 
+element1    :  ESLASH         { if (xml_parse_eslash(_XY) < 0) YYABORT;
                                _PARSE_DEBUG("element1 -> />");} 
-            | '>'             { xml_parse_endslash_pre(_XY); }
+            | '>'             { if (xml_parse_endslash_pre(_XY) < 0) YYABORT; }
               elist           { xml_parse_endslash_mid(_XY); }
               endtag          { xml_parse_endslash_post(_XY); 
                                _PARSE_DEBUG("element1 -> > elist endtag");} 
@@ -454,6 +454,47 @@ xml_sort_recurse(cxobj *xn)
     return retval;
 }
 
+/*! Sort the children of a single XML node, when a tree is built bottom-up
+ *
+ * Same as one level of xml_sort_recurse, but children are assumed already sorted,
+ * and cached values of grandchildren (list keys) are also cleared.
+ * @param[in]  xn   XML node whose children are sorted
+ * @retval    -1    Error
+ * @retval     0    OK
+ * @retval     1    OK, node is not sortable, eg state data
+ * @see xml_sort_recurse
+ */
+int
+xml_sort_node(cxobj *xn)
+{
+    int    retval = -1;
+    cxobj *x;
+    int    ret;
+
+    ret = xml_sort_verify(xn, NULL);
+    if (ret == 1) /* This node is not sortable */
+        goto skip;
+    if (ret == -1){ /* not sorted */
+        if ((ret = xml_sort(xn)) < 0)
+            goto done;
+        if (ret == 1) /* This node is not sortable */
+            goto skip;
+    }
+    if (xml_cv_cache_clear(xn) < 0)
+        goto done;
+    x = NULL;
+    while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL) {
+        if (xml_cv_cache_clear(x) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+ skip:
+    retval = 1;
+    goto done;
+}
+
 /*! Special case search for ordered-by user or state data where linear sort is used
  *
  * @param[in]  xp    Parent XML node (go through its childre)
@@ -574,6 +615,7 @@ search_multi_equals_xvec(clixon_xvec  *childvec,
                          int           yangi,
                          int           mid,
                          int           skip1,
+                         char         *indexvar,
                          clixon_xvec  *xvec)
 {
     int        retval = -1;
@@ -589,7 +631,7 @@ search_multi_equals_xvec(clixon_xvec  *childvec,
             goto done;
         if (yangi != yi) /* wrong yang */
             break;
-        if (xml_cmp(x1, xc, 0, skip1, NULL) != 0)
+        if (xml_cmp(x1, xc, 0, skip1, indexvar) != 0)
             break;
         if (clixon_xvec_prepend(xvec, xc) < 0)
             goto done;
@@ -601,7 +643,7 @@ search_multi_equals_xvec(clixon_xvec  *childvec,
             goto done;
         if (yangi != yi) /* wrong yang */
             break;
-        if (xml_cmp(x1, xc, 0, skip1, NULL) != 0)
+        if (xml_cmp(x1, xc, 0, skip1, indexvar) != 0)
             break;
         if (clixon_xvec_append(xvec, xc) < 0)
             goto done;
@@ -711,7 +753,7 @@ xml_search_indexvar(cxobj   *xp,
                 goto done;
             /* there may be more? */
             if (search_multi_equals_xvec(ivec, x1, yangi, pos,
-                                         0, xvec) < 0)
+                                         0, indexvar, xvec) < 0)
                 goto done;
         }
     }
@@ -1105,6 +1147,14 @@ xml_insert(cxobj           *xp,
     xml_parent_set(xi, xp);
     /* clear namespace context cache of child */
     nscache_clear(xi);
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_search_index_p(xi)){
+        if (xml_search_child_insert(xp, xi) < 0)
+            goto done;
+    }
+    else if (xml_search_list_update(xi, 1) < 0)
+        goto done;
+#endif
 
     retval = 0;
  done:
@@ -157,6 +157,28 @@ static const map_str2int axis_type_map[] = {
 };
 
 
+/*! XPath parse-tree cache entry, key is the xpath string
+ * Entries are in a hash table for lookup and in a LRU list for eviction.
+ * @see xpath_parse_cached
+ */
+struct xpath_cache_entry{
+    qelem_t                   xe_qelem;  /* LRU list, most recently used first */
+    struct xpath_cache_entry *xe_next;   /* Next in hash bucket */
+    uint32_t                  xe_hash;   /* Hash of xe_xpath */
+    char                     *xe_xpath;  /* XPath string (key) */
+    xpath_tree               *xe_tree;   /* Parsed xpath-tree */
+    int                       xe_ref;    /* Nr of users, not evicted if > 0 */
+};
+typedef struct xpath_cache_entry xpath_cache_entry;
+
+#if XPATH_CACHE_SIZE > 0
+static xpath_cache_entry  *_xpath_cache_lru = NULL;      /* LRU list head */
+static xpath_cache_entry  *_xpath_cache_bucket[XPATH_CACHE_SIZE] = {NULL,};
+static int                 _xpath_cache_nr = 0;
+#endif
+static uint64_t            _xpath_cache_hits = 0;
+static uint64_t            _xpath_cache_misses = 0;
+
 /*
  * XPATH parse tree type
  */
@@ -591,6 +613,194 @@ xpath_parse(const char  *xpath,
     return retval;
 }
 
+#if XPATH_CACHE_SIZE > 0
+/*! String hash for xpath cache, 32-bit FNV-1a
+ */
+static uint32_t
+xpath_cache_hash(const char *str)
+{
+    uint32_t h = 2166136261U;
+
+    while (*str){
+        h ^= (uint8_t)*str++;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+/*! Remove and free a (non-used) cache entry
+ */
+static int
+xpath_cache_entry_free(xpath_cache_entry *xe)
+{
+    xpath_cache_entry **xp;
+
+    xp = &_xpath_cache_bucket[xe->xe_hash % XPATH_CACHE_SIZE];
+    while (*xp != xe)
+        xp = &(*xp)->xe_next;
+    *xp = xe->xe_next;
+    DELQ(xe, _xpath_cache_lru, xpath_cache_entry *);
+    _xpath_cache_nr--;
+    if (xe->xe_xpath)
+        free(xe->xe_xpath);
+    if (xe->xe_tree)
+        xpath_tree_free(xe->xe_tree);
+    free(xe);
+    return 0;
+}
+#endif /* XPATH_CACHE_SIZE */
+
+/*! Given xpath, return parsed xpath-tree using a LRU cache of parsed xpaths
+ *
+ * The same xpaths, eg from YANG or from plugin code, are typically evaluated many times.
+ * The tree is shared and read-only and must be released with xpath_cache_release.
+ * A namespace context is not part of the key since parsing does not depend on it,
+ * prefixes are resolved at evaluation.
+ * @param[in]  xpath  String with XPATH 1.0 syntax
+ * @param[out] xptree XPath-tree, parsed, structured XPATH, read-only
+ * @param[out] xep    Cache entry handle, or NULL if not cached
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @code
+ *   xpath_tree        *xpt = NULL;
+ *   xpath_cache_entry *xe = NULL;
+ *   if (xpath_parse_cached(xpath, &xpt, &xe) < 0)
+ *     err;
+ *   ...
+ *   xpath_cache_release(xpt, xe);
+ * @endcode
+ * @see xpath_parse  Non-cached version
+ */
+static int
+xpath_parse_cached(const char         *xpath,
+                   xpath_tree        **xptree,
+                   xpath_cache_entry **xep)
+{
+    int                retval = -1;
+#if XPATH_CACHE_SIZE > 0
+    xpath_cache_entry *xe;
+    xpath_cache_entry *xe1;
+    uint32_t           h;
+    int                i;
+#endif
+
+    *xep = NULL;
+    if (xpath == NULL){
+        clicon_err(OE_XML, EINVAL, "XPath is NULL");
+        goto done;
+    }
+#if XPATH_CACHE_SIZE > 0
+    h = xpath_cache_hash(xpath);
+    for (xe = _xpath_cache_bucket[h % XPATH_CACHE_SIZE]; xe; xe = xe->xe_next)
+        if (xe->xe_hash == h && strcmp(xe->xe_xpath, xpath) == 0)
+            break;
+    if (xe != NULL){
+        _xpath_cache_hits++;
+        if (xe != _xpath_cache_lru){ /* Move first in LRU list */
+            DELQ(xe, _xpath_cache_lru, xpath_cache_entry *);
+            INSQ(xe, _xpath_cache_lru);
+        }
+        xe->xe_ref++;
+        *xptree = xe->xe_tree;
+        *xep = xe;
+        goto ok;
+    }
+#endif
+    _xpath_cache_misses++;
+    if (xpath_parse(xpath, xptree) < 0)
+        goto done;
+#if XPATH_CACHE_SIZE > 0
+    /* Evict least recently used entry not in use, if none just do not cache */
+    if (_xpath_cache_nr >= XPATH_CACHE_SIZE){
+        xe1 = _xpath_cache_lru;
+        for (i=0; i<_xpath_cache_nr; i++){
+            xe1 = PREVQ(xpath_cache_entry *, xe1);
+            if (xe1->xe_ref == 0){
+                xpath_cache_entry_free(xe1);
+                break;
+            }
+        }
+        if (_xpath_cache_nr >= XPATH_CACHE_SIZE)
+            goto ok;
+    }
+    if ((xe = malloc(sizeof(*xe))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(xe, 0, sizeof(*xe));
+    if ((xe->xe_xpath = strdup(xpath)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        free(xe);
+        goto done;
+    }
+    xe->xe_hash = h;
+    xe->xe_tree = *xptree;
+    xe->xe_ref = 1;
+    xe->xe_next = _xpath_cache_bucket[h % XPATH_CACHE_SIZE];
+    _xpath_cache_bucket[h % XPATH_CACHE_SIZE] = xe;
+    INSQ(xe, _xpath_cache_lru);
+    _xpath_cache_nr++;
+    *xep = xe;
+ ok:
+#endif
+    retval = 0;
+ done:
+    if (retval < 0 && *xptree && *xep == NULL){
+        xpath_tree_free(*xptree);
+        *xptree = NULL;
+    }
+    return retval;
+}
+
+/*! Release xpath-tree returned by xpath_parse_cached
+ * @param[in]  xptree  XPath-tree
+ * @param[in]  xe      Cache entry handle, or NULL if tree is not cached
+ */
+static int
+xpath_cache_release(xpath_tree        *xptree,
+                    xpath_cache_entry *xe)
+{
+    if (xe != NULL)
+        xe->xe_ref--;
+    else if (xptree)
+        xpath_tree_free(xptree);
+    return 0;
+}
+
+/*! Get xpath parse-tree cache statistics
+ * @param[out] nr      Number of cached xpath-trees
+ * @param[out] hits    Number of cache hits
+ * @param[out] misses  Number of cache misses, ie xpath parser invocations
+ * @retval     0       OK
+ */
+int
+xpath_cache_stats(uint64_t *nr,
+                  uint64_t *hits,
+                  uint64_t *misses)
+{
+#if XPATH_CACHE_SIZE > 0
+    *nr = _xpath_cache_nr;
+#else
+    *nr = 0;
+#endif
+    *hits = _xpath_cache_hits;
+    *misses = _xpath_cache_misses;
+    return 0;
+}
+
+/*! Free all cached xpath-trees, eg at exit
+ */
+void
+xpath_cache_exit(void)
+{
+#if XPATH_CACHE_SIZE > 0
+    xpath_cache_entry *xe;
+
+    while ((xe = _xpath_cache_lru) != NULL)
+        xpath_cache_entry_free(xe);
+#endif
+}
+
 /*! Given XML tree and xpath, parse xpath, eval it and return xpath context, 
  * This is a raw form of xpath where you can do type conversion of the return
  * value, etc, not just a nodeset.
@@ -616,13 +826,45 @@ xpath_vec_ctx(cxobj      *xcur,
               int         localonly,
               xp_ctx    **xrp)
 {
-    int         retval = -1;
-    xpath_tree *xptree = NULL;
-    xp_ctx      xc = {0,};
+    int                retval = -1;
+    xpath_tree        *xptree = NULL;
+    xpath_cache_entry *xe = NULL;
     
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
-    if (xpath_parse(xpath, &xptree) < 0)
+    if (xpath_parse_cached(xpath, &xptree, &xe) < 0)
+        goto done;
+    if (xpath_tree_vec_ctx(xcur, nsc, xptree, localonly, xrp) < 0)
         goto done;
+    retval = 0;
+ done:
+    if (xptree)
+        xpath_cache_release(xptree, xe);
+    return retval;
+}
+
+/*! Given XML tree and parsed xpath-tree, eval it and return xpath context
+ *
+ * Same as xpath_vec_ctx but with an already parsed xpath, eg pre-compiled from YANG
+ * @param[in]  xcur   XML-tree where to search
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xptree Parsed xpath-tree
+ * @param[in]  localonly Skip prefix and namespace tests (non-standard)
+ * @param[out] xrp    Return XPATH context
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xpath_vec_ctx
+ * @see yang_xpath_tree_get
+ */
+int
+xpath_tree_vec_ctx(cxobj      *xcur, 
+                   cvec       *nsc,
+                   xpath_tree *xptree,
+                   int         localonly,
+                   xp_ctx    **xrp)
+{
+    int    retval = -1;
+    xp_ctx xc = {0,};
+
     xc.xc_type = XT_NODESET;
     xc.xc_node = xcur;
     xc.xc_initial = xcur;
@@ -636,8 +878,6 @@ xpath_vec_ctx(cxobj      *xcur,
         free(xc.xc_nodeset);
         xc.xc_nodeset = NULL;
     }
-    if (xptree)
-        xpath_tree_free(xptree);
     return retval;
 }
 
@@ -959,6 +1199,33 @@ xpath_vec_bool(cxobj      *xcur,
     return retval;
 }
 
+/*! Given XML tree and parsed xpath-tree, returns boolean
+ * @param[in]  xcur     xml-tree where to search
+ * @param[in]  nsc      External XML namespace context, or NULL
+ * @param[in]  xptree   Parsed xpath-tree
+ * @retval     1        True
+ * @retval     0        False
+ * @retval    -1        Error
+ * @see xpath_vec_bool
+ */
+int
+xpath_tree_vec_bool(cxobj      *xcur, 
+                    cvec       *nsc,
+                    xpath_tree *xptree)
+{
+    int     retval = -1;
+    xp_ctx *xr = NULL;
+    
+    if (xpath_tree_vec_ctx(xcur, nsc, xptree, 0, &xr) < 0)
+        goto done;
+    if (xr)
+        retval = ctx2boolean(xr);
+ done:
+    if (xr)
+        ctx_free(xr);
+    return retval;
+}
+
 /*! Translate an xpath/nsc pair to a "canonical" form using yang prefixes
  *
  * @param[in]  xs      Parsed xpath - xpath_tree
@@ -1190,6 +1457,126 @@ xpath_count(cxobj      *xcur,
     return retval;
 }
 
+/*! Add namespaces of top-level nodes of an xpath-tree, internal function
+ *
+ * @param[in]  xs     XPath-tree
+ * @param[in]  nsc    Namespace context of xpath
+ * @param[in]  nsv    Vector of namespaces, namespace added as value if not already present
+ * @retval     1      OK
+ * @retval     0      Not determined, any top-level node may be selected
+ * @retval    -1      Error
+ */
+static int
+xpath_top_namespaces1(xpath_tree *xs,
+                      cvec       *nsc,
+                      cvec       *nsv)
+{
+    int         ret;
+    xpath_tree *xr;
+    xpath_tree *xn;
+    char       *ns;
+    cg_var     *cv;
+
+    if (xs == NULL)
+        return 0;
+    switch (xs->xs_type){
+    case XP_EXP:
+    case XP_AND:
+    case XP_RELEX:
+    case XP_ADD:
+    case XP_PATHEXPR:
+    case XP_LOCPATH:
+        if (xs->xs_c1 != NULL) /* Operator or filter expression */
+            return 0;
+        return xpath_top_namespaces1(xs->xs_c0, nsc, nsv);
+    case XP_UNION:
+        if ((ret = xpath_top_namespaces1(xs->xs_c0, nsc, nsv)) != 1)
+            return ret;
+        if (xs->xs_c1 == NULL)
+            return 1;
+        return xpath_top_namespaces1(xs->xs_c1, nsc, nsv);
+    case XP_ABSPATH:
+        if (xs->xs_int != A_ROOT)      /* eg //x */
+            return 0;
+        return xpath_top_namespaces1(xs->xs_c0, nsc, nsv);
+    case XP_RELLOCPATH:
+        /* First step is leftmost */
+        xr = xs;
+        while (xr->xs_c0 && xr->xs_c0->xs_type == XP_RELLOCPATH)
+            xr = xr->xs_c0;
+        if ((xn = xr->xs_c0) == NULL ||
+            xn->xs_type != XP_STEP ||
+            xn->xs_int != A_CHILD ||
+            (xn = xn->xs_c0) == NULL ||
+            xn->xs_type != XP_NODE ||
+            xn->xs_s1 == NULL ||
+            strcmp(xn->xs_s1, "*") == 0)
+            return 0;
+        if ((ns = xml_nsctx_get(nsc, xn->xs_s0)) == NULL)
+            return 0;
+        cv = NULL;
+        while ((cv = cvec_each(nsv, cv)) != NULL)
+            if (strcmp(cv_string_get(cv), ns) == 0)
+                return 1;
+        if (cvec_add_string(nsv, NULL, ns) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            return -1;
+        }
+        return 1;
+    default:
+        break;
+    }
+    return 0;
+}
+
+/*! Get namespaces of the top-level nodes an xpath may select
+ *
+ * Used to find which state data providers an xpath may select data from without
+ * evaluating the xpath, eg for "/ex:a/ex:b | /if:c" the namespaces of ex and if are returned.
+ * @param[in]  xpath  XPath
+ * @param[in]  nsc    Namespace context of xpath
+ * @param[out] nsvp   Vector of namespaces as values, free with cvec_free
+ * @retval     1      OK, namespaces in nsvp
+ * @retval     0      Not determined, any top-level node may be selected, eg "/", "//x" or wildcard
+ * @retval    -1      Error
+ */
+int
+xpath_top_namespaces(const char *xpath,
+                     cvec       *nsc,
+                     cvec      **nsvp)
+{
+    int                retval = -1;
+    xpath_tree        *xptree = NULL;
+    xpath_cache_entry *xe = NULL;
+    cvec              *nsv = NULL;
+    int                ret;
+
+    if (xpath == NULL || strlen(xpath) == 0 || strcmp(xpath, "/") == 0)
+        goto fail;
+    if (xpath_parse_cached(xpath, &xptree, &xe) < 0)
+        goto done;
+    if ((nsv = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if ((ret = xpath_top_namespaces1(xptree, nsc, nsv)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    *nsvp = nsv;
+    nsv = NULL;
+    retval = 1;
+ done:
+    if (nsv)
+        cvec_free(nsv);
+    if (xptree)
+        xpath_cache_release(xptree, xe);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Given an XML node, build an xpath recursively to root, internal function
  *
  * @param[in]  x      XML object
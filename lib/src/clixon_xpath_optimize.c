@@ -224,6 +224,7 @@ loop_preds(xpath_tree *xt,
  * @retval     1      Match
  *  XPath:
  *  y[k=3] # corresponds to: <name>[<keyname>=<keyval>]
+ *  where keyname is the list key(s), or a single explicit search index leaf
  */
 static int
 xpath_list_optimize_fn(xpath_tree  *xt,
@@ -245,6 +246,11 @@ xpath_list_optimize_fn(xpath_tree  *xt,
     cg_var      *cvi;
     int          i;
     yang_stmt   *ypp;
+    int          keys;
+#ifdef XML_EXPLICIT_INDEX
+    yang_stmt   *yi;
+    clixon_xvec *ivec = NULL;
+#endif
     
     /* revert to non-optimized if no yang */
     if ((yp = xml_spec(xv)) == NULL)
@@ -291,15 +297,31 @@ xpath_list_optimize_fn(xpath_tree  *xt,
     if (ret == 0)
         goto ok;
 
-    if (cvec_len(cvv) != cvec_len(cvk))
-        goto ok;
+    /* Predicates are the list keys in order */
+    keys = (cvec_len(cvv) == cvec_len(cvk));
     i = 0;
     cvi = NULL;
-    while ((cvi = cvec_each(cvk, cvi)) != NULL) {
+    while (keys && (cvi = cvec_each(cvk, cvi)) != NULL) {
         if (strcmp(cv_name_get(cvi), cv_string_get(cvec_i(cvv,i))))
-            goto ok;
+            keys = 0;
         i++;
     }
+    if (!keys){
+#ifdef XML_EXPLICIT_INDEX
+        /* Or a single predicate on an explicit search index, see clixon-config search_index
+         * Only if the index vector exists, otherwise the list is not indexed */
+        if (cvec_len(cvk) != 1 ||
+            (yi = yang_find_datanode(yc, cv_name_get(cvec_i(cvk, 0)))) == NULL ||
+            yang_flag_get(yi, YANG_FLAG_INDEX) == 0)
+            goto ok;
+        if (xml_search_vector_get(xv, cv_name_get(cvec_i(cvk, 0)), &ivec) < 0)
+            goto done;
+        if (ivec == NULL)
+            goto ok;
+#else
+        goto ok;
+#endif
+    }
     /* Use 2a form since yc allready given to compute cvk */
     if (clixon_xml_find_index(xv, yp, NULL, name, cvk, xvec) < 0)
         goto done;
@@ -71,10 +71,13 @@
 #include "clixon_hash.h"
 #include "clixon_handle.h"
 #include "clixon_file.h"
+#include "clixon_intern.h"
 #include "clixon_yang.h"
 #include "clixon_hash.h"
 #include "clixon_xml.h"
 #include "clixon_xml_nsctx.h"
+#include "clixon_xpath_ctx.h"
+#include "clixon_xpath.h"
 #include "clixon_yang_module.h"
 #include "clixon_plugin.h"
 #include "clixon_data.h"
@@ -245,6 +248,12 @@ yang_argument_set(yang_stmt *ys,
                   char      *arg)
 {
     ys->ys_argument = arg; /* not strdup/copied */
+    if (ys->ys_xpath){     /* Pre-compiled argument is invalid */
+        xpath_tree_free(ys->ys_xpath);
+        ys->ys_xpath = NULL;
+    }
+    if (ys->ys_parent)     /* Argument is key in parent index */
+        yang_index_clear(ys->ys_parent);
     return 0;
 }
 
@@ -409,6 +418,10 @@ yang_when_xpath_set(yang_stmt *ys,
         goto done;
         
     }
+    if (ys->ys_xpath){     /* Pre-compiled when xpath is invalid */
+        xpath_tree_free(ys->ys_xpath);
+        ys->ys_xpath = NULL;
+    }
     retval = 0;
  done:
     return retval;
@@ -452,6 +465,75 @@ yang_when_nsc_set(yang_stmt *ys,
     return retval;
 }
 
+/*! Get pre-compiled xpath-tree of a must, when or path statement argument
+ *
+ * The argument is parsed once, in ys_populate or on first call, and kept in the statement
+ * @param[in]  ys   Yang statement of type must, when or path
+ * @retval     xpt  Parsed xpath-tree, read-only, freed with ys
+ * @retval     NULL Error
+ * @see xpath_tree_vec_ctx  for evaluating the xpath-tree
+ */
+struct xpath_tree *
+yang_xpath_tree_get(yang_stmt *ys)
+{
+    if (ys->ys_xpath == NULL){
+        switch (ys->ys_keyword){
+        case Y_MUST:
+        case Y_WHEN:
+        case Y_PATH:
+            break;
+        default:
+            clicon_err(OE_YANG, EINVAL, "No xpath argument of %s", yang_key2str(ys->ys_keyword));
+            return NULL;
+        }
+        if (xpath_parse(ys->ys_argument, &ys->ys_xpath) < 0)
+            return NULL;
+    }
+    return ys->ys_xpath;
+}
+
+/*! Get pre-compiled xpath-tree of "when"-associated augment/uses of a data node
+ *
+ * The when xpath is parsed on first call and kept in the statement
+ * @param[in]  ys   Yang data node with "when"-associated augment/uses xpath
+ * @retval     xpt  Parsed xpath-tree, read-only, freed with ys
+ * @retval     NULL Error
+ * @see yang_when_xpath_get  for the xpath string
+ * @see yang_when_nsc_get    for its namespace context
+ */
+struct xpath_tree *
+yang_when_xpath_tree_get(yang_stmt *ys)
+{
+    if (ys->ys_xpath == NULL){
+        if (ys->ys_when_xpath == NULL){
+            clicon_err(OE_YANG, EINVAL, "No when xpath of %s", yang_key2str(ys->ys_keyword));
+            return NULL;
+        }
+        if (xpath_parse(ys->ys_when_xpath, &ys->ys_xpath) < 0)
+            return NULL;
+    }
+    return ys->ys_xpath;
+}
+
+/*! Get namespace context of xpath arguments in statement, ie the prefixes of its module
+ *
+ * The context is created by xml_nsctx_yang on first call and kept in the statement.
+ * Only call this after the yang spec is loaded and expanded
+ * @param[in]  ys   Yang statement, eg must, when or leaf with leafref
+ * @retval     nsc  Namespace context, read-only, freed with ys
+ * @retval     NULL Error
+ * @see xml_nsctx_yang  which creates a new context on each call
+ */
+cvec *
+yang_xpath_nsc_get(yang_stmt *ys)
+{
+    if (ys->ys_nsc == NULL){
+        if (xml_nsctx_yang(ys, &ys->ys_nsc) < 0)
+            return NULL;
+    }
+    return ys->ys_nsc;
+}
+
 /*! Get yang filename for error/debug purpose
  *
  * @param[in]  ys       Yang statement
@@ -683,6 +765,14 @@ ys_free1(yang_stmt *ys,
         free(ys->ys_when_xpath);
     if (ys->ys_when_nsc)
         cvec_free(ys->ys_when_nsc);
+    if (ys->ys_xpath)
+        xpath_tree_free(ys->ys_xpath);
+    if (ys->ys_nsc)
+        xml_nsctx_free(ys->ys_nsc);
+    if (ys->ys_index){
+        clicon_hash_free(ys->ys_index);
+        ys->ys_index = NULL;
+    }
     if (ys->ys_stmt)
         free(ys->ys_stmt);
     if (ys->ys_filename)
@@ -721,6 +811,7 @@ ys_prune(yang_stmt *yp,
     if (i >= yp->ys_len)
         goto done;
     yc = yp->ys_stmt[i];
+    yang_index_clear(yp);
     if (i < yp->ys_len - 1){
         size = (yp->ys_len - i - 1)*sizeof(struct yang_stmt *);
         memmove(&yp->ys_stmt[i],
@@ -777,6 +868,7 @@ ys_freechildren(yang_stmt *ys)
     int i;
     yang_stmt *yc;
     
+    yang_index_clear(ys);
     for (i=0; i<ys->ys_len; i++){
         if ((yc = ys->ys_stmt[i]) != NULL)
             ys_free(yc);
@@ -806,6 +898,7 @@ ys_free(yang_stmt *ys)
 static int 
 yn_realloc(yang_stmt *yn)
 {
+    yang_index_clear(yn);
     yn->ys_len++;
 
     if ((yn->ys_stmt = realloc(yn->ys_stmt, (yn->ys_len)*sizeof(yang_stmt *))) == 0){
@@ -841,6 +934,9 @@ ys_cp(yang_stmt *ynew,
 
     memcpy(ynew, yold, sizeof(*yold)); 
     ynew->ys_parent = NULL;
+    ynew->ys_xpath = NULL; /* Not copied, re-compiled on use */
+    ynew->ys_nsc = NULL;   /* Not copied, may be in other module */
+    ynew->ys_index = NULL; /* Not copied, built by yang_index_build */
     if (yold->ys_stmt)
         if ((ynew->ys_stmt = calloc(yold->ys_len, sizeof(yang_stmt *))) == NULL){
             clicon_err(OE_YANG, errno, "calloc");
@@ -955,6 +1051,8 @@ ys_replace(yang_stmt *yorig,
     if (ys_cp(yorig, yfrom) < 0)
         goto done;
     yorig->ys_parent = yp;
+    if (yp)
+        yang_index_clear(yp);
     retval = 0;
  done:
     return retval;
@@ -1032,6 +1130,196 @@ yn_each(yang_stmt *yparent,
     return yc;
 }
 
+/*! Entry in child argument index of a yang statement
+ * All statements with the same argument are kept in a vector in child order
+ * @see yang_index_build
+ */
+struct yang_index_entry{
+    yang_stmt *yi_ys;     /* Indexed statement */
+    int        yi_direct; /* 1: Child statement, 0: Data node under choice/case or input/output */
+};
+
+/*! Statements with arguments that are names and therefore indexed
+ * Skip documentation statements with long text arguments
+ */
+static int
+yang_index_keyword(enum rfc_6020 keyword)
+{
+    switch (keyword){
+    case Y_DESCRIPTION:
+    case Y_REFERENCE:
+    case Y_CONTACT:
+    case Y_ORGANIZATION:
+    case Y_ERROR_MESSAGE:
+        return 0;
+    default:
+        return 1;
+    }
+}
+
+/*! Add statement to child argument index
+ * @param[in]  index   Hash table
+ * @param[in]  ys      Yang statement to add
+ * @param[in]  direct  1: Child statement, 0: Data node under choice/case or input/output
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+yang_index_add(clicon_hash_t          *index,
+               yang_stmt              *ys,
+               int                     direct)
+{
+    int                      retval = -1;
+    struct yang_index_entry *vec;
+    struct yang_index_entry *vec1 = NULL;
+    size_t                   vlen = 0;
+    size_t                   n;
+
+    if (ys->ys_argument == NULL || !yang_index_keyword(ys->ys_keyword))
+        goto ok;
+    if ((vec = clicon_hash_value(index, ys->ys_argument, &vlen)) == NULL)
+        vlen = 0;
+    n = vlen/sizeof(*vec);
+    if ((vec1 = malloc(vlen + sizeof(*vec1))) == NULL){
+        clicon_err(OE_YANG, errno, "malloc");
+        goto done;
+    }
+    if (vlen)
+        memcpy(vec1, vec, vlen);
+    vec1[n].yi_ys = ys;
+    vec1[n].yi_direct = direct;
+    if (clicon_hash_add(index, ys->ys_argument, vec1, vlen + sizeof(*vec1)) == NULL)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (vec1)
+        free(vec1);
+    return retval;
+}
+
+/*! Add data nodes under a node that is transparent for yang_find_datanode
+ * @param[in]  index   Hash table
+ * @param[in]  yn      Yang node: choice, case, input or output
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see yang_find_datanode  for the same traversal
+ */
+static int
+yang_index_add_datanodes(clicon_hash_t *index,
+                         yang_stmt     *yn)
+{
+    int        i;
+    yang_stmt *ys;
+
+    for (i=0; i<yn->ys_len; i++){
+        ys = yn->ys_stmt[i];
+        if (yn->ys_keyword == Y_CHOICE){
+            if (ys->ys_keyword == Y_CASE){
+                if (yang_index_add_datanodes(index, ys) < 0)
+                    return -1;
+            }
+            else if (yang_datanode(ys)){
+                if (yang_index_add(index, ys, 0) < 0)
+                    return -1;
+            }
+        }
+        else if (ys->ys_keyword == Y_CHOICE ||
+                 ys->ys_keyword == Y_INPUT ||
+                 ys->ys_keyword == Y_OUTPUT){
+            if (yang_index_add_datanodes(index, ys) < 0)
+                return -1;
+        }
+        else if (yang_datanode(ys)){
+            if (yang_index_add(index, ys, 0) < 0)
+                return -1;
+        }
+    }
+    return 0;
+}
+
+/*! Build child argument index of yang statements recursively
+ *
+ * Statements with at least YANG_INDEX_MIN children get an index that maps arguments of
+ * children to statements. Data nodes under choice/case and input/output are also
+ * indexed, as seen by yang_find_datanode.
+ * Existing indexes are kept, any change of children, or of their arguments, clears the
+ * index of the parent and of enclosing choice/case/input/output nodes.
+ * @param[in]  ys    Top of yang tree, eg yang spec
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see yang_find
+ * @see yang_find_datanode
+ */
+int
+yang_index_build(yang_stmt *ys)
+{
+#if YANG_INDEX_MIN > 0
+    int        i;
+    yang_stmt *yc;
+
+    if (ys->ys_index == NULL && ys->ys_len >= YANG_INDEX_MIN){
+        if ((ys->ys_index = clicon_hash_init()) == NULL)
+            return -1;
+        for (i=0; i<ys->ys_len; i++){
+            yc = ys->ys_stmt[i];
+            if (yang_index_add(ys->ys_index, yc, 1) < 0)
+                goto err;
+            switch (yc->ys_keyword){
+            case Y_CHOICE: /* Its data nodes, not the choice itself */
+            case Y_INPUT:
+            case Y_OUTPUT:
+                if (yang_index_add_datanodes(ys->ys_index, yc) < 0)
+                    goto err;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    for (i=0; i<ys->ys_len; i++)
+        if (yang_index_build(ys->ys_stmt[i]) < 0)
+            return -1;
+    return 0;
+ err:
+    clicon_hash_free(ys->ys_index);
+    ys->ys_index = NULL;
+    return -1;
+#else
+    return 0;
+#endif
+}
+
+/*! Clear child argument index of yang statement since its children have changed
+ *
+ * Also clear the index of parents if the statement is transparent for data nodes
+ * @param[in]  ys    Yang statement
+ * @retval     0     OK
+ * @see yang_index_build
+ */
+int
+yang_index_clear(yang_stmt *ys)
+{
+    while (ys != NULL){
+        if (ys->ys_index){
+            clicon_hash_free(ys->ys_index);
+            ys->ys_index = NULL;
+        }
+        switch (ys->ys_keyword){
+        case Y_CHOICE:
+        case Y_CASE:
+        case Y_INPUT:
+        case Y_OUTPUT:
+            ys = ys->ys_parent;
+            break;
+        default:
+            ys = NULL;
+            break;
+        }
+    }
+    return 0;
+}
+
 /*! Find first child yang_stmt with matching keyword and argument
  *
  * @param[in]  yn         Yang node, current context node.
@@ -1054,14 +1342,26 @@ yang_find(yang_stmt  *yn,
     char      *name;
     yang_stmt *yspec;
     yang_stmt *ym;
-
-    for (i=0; i<yn->ys_len; i++){
-        ys = yn->ys_stmt[i];
-        if (keyword == 0 || ys->ys_keyword == keyword){
-            if (argument == NULL ||
-                (ys->ys_argument && strcmp(argument, ys->ys_argument) == 0)){
-                yret = ys;
-                break;
+    struct yang_index_entry *vec;
+    size_t     vlen;
+
+    if (yn->ys_index && argument && keyword && yang_index_keyword(keyword)){
+        if ((vec = clicon_hash_value(yn->ys_index, argument, &vlen)) != NULL)
+            for (i=0; i<vlen/sizeof(*vec); i++)
+                if (vec[i].yi_direct && vec[i].yi_ys->ys_keyword == keyword){
+                    yret = vec[i].yi_ys;
+                    break;
+                }
+    }
+    else{
+        for (i=0; i<yn->ys_len; i++){
+            ys = yn->ys_stmt[i];
+            if (keyword == 0 || ys->ys_keyword == keyword){
+                if (argument == NULL ||
+                    (ys->ys_argument && strcmp(argument, ys->ys_argument) == 0)){
+                    yret = ys;
+                    break;
+                }
             }
         }
     }
@@ -1137,7 +1437,19 @@ yang_find_datanode(yang_stmt *yn,
     yang_stmt *yspec;
     yang_stmt *ysmatch = NULL;
     char      *name;
+    struct yang_index_entry *vec;
+    size_t     vlen;
+    int        i;
 
+    if (yn->ys_index && argument){
+        if ((vec = clicon_hash_value(yn->ys_index, argument, &vlen)) != NULL)
+            for (i=0; i<vlen/sizeof(*vec); i++)
+                if (yang_datanode(vec[i].yi_ys)){
+                    ysmatch = vec[i].yi_ys;
+                    break;
+                }
+        goto submodules;
+    }
     ys = NULL;
     while ((ys = yn_each(yn, ys)) != NULL){
         if (yang_keyword_get(ys) == Y_CHOICE){ /* Look for its children */
@@ -1171,6 +1483,7 @@ yang_find_datanode(yang_stmt *yn,
     }
     /* Special case: if not match and yang node is module or submodule, extend
      * search to include submodules */
+ submodules:
     if (ysmatch == NULL &&
         (yang_keyword_get(yn) == Y_MODULE ||
          yang_keyword_get(yn) == Y_SUBMODULE)){
@@ -2902,6 +3215,20 @@ ys_populate2(yang_stmt    *ys,
     case Y_LEAF_LIST:
         if (ys_populate_leaf(h, ys) < 0)
             goto done;
+        /* fall through */
+    case Y_CONTAINER:
+    case Y_LIST:
+    case Y_ANYDATA:
+    case Y_ANYXML:
+    case Y_RPC:
+    case Y_ACTION:
+    case Y_NOTIFICATION:
+    case Y_INPUT:
+    case Y_OUTPUT:
+        /* Intern data node names for XML node names, see xml_name_set */
+        if (yang_argument_get(ys) &&
+            clixon_intern_permanent(yang_argument_get(ys)) == NULL)
+            goto done;
         break;
     case Y_MANDATORY: /* call yang_mandatory() to check if set */
     case Y_CONFIG:
@@ -2972,6 +3299,7 @@ yang_features(clicon_handle h,
                         yang_flag_set(ys, YANG_FLAG_DISABLED);
                         break;
                     }
+                    yang_index_clear(yt);
                     for (j=i+1; j<yt->ys_len; j++)
                         yt->ys_stmt[j-1] = yt->ys_stmt[j];
                     yt->ys_len--;
@@ -3859,6 +4187,7 @@ yang_list_index_add(yang_stmt *ys)
         goto ok;
     }
     yang_flag_set(ys, YANG_FLAG_INDEX);
+    yang_flag_set(yp, YANG_FLAG_INDEX_LIST);
  ok:
     retval = 0;
    // done:
@@ -102,6 +102,10 @@ struct yang_stmt{
     yang_type_cache   *ys_typecache; /* If ys_keyword==Y_TYPE, cache all typedef data except unions */
     char              *ys_when_xpath; /* Special conditional for a "when"-associated augment/uses xpath */
     cvec              *ys_when_nsc;   /* Special conditional for a "when"-associated augment/uses namespace ctx */
+    struct xpath_tree *ys_xpath;      /* Pre-compiled xpath of must/when/path argument,
+                                         or of ys_when_xpath for augment/uses data nodes */
+    cvec              *ys_nsc;        /* Cached namespace context of module, see yang_xpath_nsc_get */
+    struct clicon_hash **ys_index;    /* Child argument index, see yang_index_build */
     char              *ys_filename;   /* For debug/errors: filename (only (sub)modules) */
     int                ys_linenum;    /* For debug/errors: line number (in ys_filename) */
     rpc_callback_t    *ys_action_cb;  /* Action callback list, only for Y_ACTION */
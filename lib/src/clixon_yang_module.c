@@ -707,13 +707,12 @@ yang_stmt *
 yang_find_module_by_name(yang_stmt *yspec, 
                          char      *name)
 {
-    yang_stmt *ymod = NULL;
+    yang_stmt *ymod;
     
-    while ((ymod = yn_each(yspec, ymod)) != NULL) 
-        if ((yang_keyword_get(ymod) == Y_MODULE || yang_keyword_get(ymod) == Y_SUBMODULE) &&
-            strcmp(yang_argument_get(ymod), name)==0)
-            return ymod;
-    return NULL;
+    /* Module and submodule names are unique */
+    if ((ymod = yang_find(yspec, Y_MODULE, name)) == NULL)
+        ymod = yang_find(yspec, Y_SUBMODULE, name);
+    return ymod;
 }
 
 /*! Callback for handling RFC 7952 annotations
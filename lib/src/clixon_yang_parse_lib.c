@@ -584,6 +584,7 @@ yang_expand_uses_node(yang_stmt *yn,
      * yn is parent: the children of ygrouping replaces ys.
      * Is there a case when glen == 0?  YES AND THIS BREAKS
      */
+    yang_index_clear(yn);
     if (glen != 1){
         size = (yang_len_get(yn) - i - 1)*sizeof(struct yang_stmt *);
         yn->ys_len += glen - 1;
@@ -1568,6 +1569,9 @@ yang_parse_post(clicon_handle h,
     for (i=0; i<ylen; i++)
         if (yang_cardinality(h, ylist[i], yang_argument_get(ylist[i])) < 0)
             goto done;
+    /* 12. Build child indexes of new modules, and of earlier modules changed by augment */
+    if (yang_index_build(yspec) < 0)
+        goto done;
     retval = 0;
  done:
     if (ylist)
@@ -1933,7 +1937,8 @@ ys_parse_sub(yang_stmt  *ys,
         break;
     case Y_MUST:
     case Y_WHEN:
-        if (xpath_parse(yang_argument_get(ys), NULL) < 0)
+        /* Check syntax and pre-compile xpath */
+        if (yang_xpath_tree_get(ys) == NULL)
             goto done;
         break;
     case Y_REVISION:
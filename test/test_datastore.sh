@@ -161,6 +161,31 @@ diff $mydir/kalle_db $mydir/candidate_db
 new "datastore lock"
 expectpart "$($clixon_util_datastore $conf lock 756)" 0 ""
 
+# Datastore file written out-of-order and pretty-printed is bound, stripped and sorted on read
+cat <<EOF > $mydir/candidate_db
+<${DATASTORE_TOP}>
+   <x xmlns="urn:example:clixon">
+      <g>astring</g>
+      <f>
+         <e>a</e>
+         <e>b</e>
+         <e>c</e>
+      </f>
+      <d/>
+      <y><c>third-entry</c><b>3</b><a>2</a></y>
+      <y>
+         <a>1</a>
+         <b>3</b>
+         <c>second-entry</c>
+      </y>
+      <y><a>1</a><b>2</b><c>first-entry</c></y>
+   </x>
+</${DATASTORE_TOP}>
+EOF
+
+new "datastore get unsorted file"
+expectpart "$($clixon_util_datastore $conf get /)" 0 "^$xml2$"
+
 
 rm -rf $mydir
 
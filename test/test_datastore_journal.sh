@@ -0,0 +1,155 @@
+#!/usr/bin/env bash
+# Datastore journal tests, see CLICON_XMLDB_JOURNAL
+# Incremental edits are appended to <db>_db.journal instead of re-writing <db>_db
+# Check replay, torn and corrupt records, stale journals and compaction
+# Just run a binary direct to datastore. No clixon.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+fyang=$dir/journal.yang
+
+: ${clixon_util_datastore:=clixon_util_datastore}
+
+cat <<EOF > $fyang
+module journal{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix jo;
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type string;
+      }
+      leaf c {
+        type string;
+      }
+    }
+    leaf g {
+      type string;
+    }
+  }
+}
+EOF
+
+mydir=$dir/journal
+
+if [ ! -d $mydir ]; then
+    mkdir $mydir
+fi
+rm -rf $mydir/*
+
+# Large compaction threshold: journal is not compacted
+conf="-d candidate -b $mydir -y $fyang -j 1000000"
+
+new "datastore init"
+expectpart "$($clixon_util_datastore $conf init)" 0 ""
+
+new "datastore put replace writes snapshot"
+expectpart "$($clixon_util_datastore $conf put replace '<x xmlns="urn:example:clixon"><y><a>1</a><c>one</c></y></x>')" 0 ""
+
+if [ -s $mydir/candidate_db.journal ]; then
+    err "No journal" "Journal after replace"
+fi
+cp $mydir/candidate_db $dir/snapshot
+
+new "datastore put merge appends journal"
+expectpart "$($clixon_util_datastore $conf put merge '<x xmlns="urn:example:clixon"><y><a>2</a><c>two</c></y></x>')" 0 ""
+
+new "datastore put merge appends journal"
+expectpart "$($clixon_util_datastore $conf put merge '<x xmlns="urn:example:clixon"><g>gee</g></x>')" 0 ""
+
+new "datastore put remove appends journal"
+expectpart "$($clixon_util_datastore $conf put none '<x xmlns="urn:example:clixon"><y nc:operation="remove" xmlns:nc="urn:ietf:params:xml:ns:netconf:base:1.0"><a>1</a></y></x>')" 0 ""
+
+new "snapshot not re-written"
+if ! cmp -s $mydir/candidate_db $dir/snapshot; then
+    err "Snapshot unchanged" "Snapshot re-written"
+fi
+
+new "journal has three records"
+expectpart "$(grep -c '^[a-z]* [0-9]* [0-9a-f]*$' $mydir/candidate_db.journal)" 0 "^3$"
+
+result="^<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\"><y><a>2</a><c>two</c></y><g>gee</g></x></${DATASTORE_TOP}>$"
+
+new "datastore get replays journal"
+expectpart "$($clixon_util_datastore $conf get /)" 0 "$result"
+
+new "datastore exists"
+expectpart "$($clixon_util_datastore $conf exists)" 0 "exists: 1"
+
+# Record with bad checksum
+payload='<config><x xmlns="urn:example:clixon"><g>bad</g></x></config>'
+printf "merge %d 00000000\n%s\n" ${#payload} "$payload" >> $mydir/candidate_db.journal
+
+new "datastore get ignores record with bad checksum"
+expectpart "$($clixon_util_datastore $conf get /)" 0 "$result"
+
+# Torn record: crash in the middle of a write
+printf "merge 1000 0123abcd\n<config><x xmlns=" >> $mydir/candidate_db.journal
+
+new "datastore get ignores torn record"
+expectpart "$($clixon_util_datastore $conf get /)" 0 "$result"
+
+new "datastore put merge after torn record"
+expectpart "$($clixon_util_datastore $conf put merge '<x xmlns="urn:example:clixon"><y><a>3</a><c>three</c></y></x>')" 0 ""
+
+result="^<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\"><y><a>2</a><c>two</c></y><y><a>3</a><c>three</c></y><g>gee</g></x></${DATASTORE_TOP}>$"
+
+new "datastore get after torn record"
+expectpart "$($clixon_util_datastore $conf get /)" 0 "$result"
+
+new "datastore copy includes journal"
+expectpart "$($clixon_util_datastore $conf copy running)" 0 ""
+
+new "datastore get copy"
+expectpart "$($clixon_util_datastore -d running -b $mydir -y $fyang get /)" 0 "$result"
+
+# Stale journal: simulate crash after new snapshot renamed but before journal removed
+cp $mydir/candidate_db.journal $dir/journal
+
+new "datastore put replace"
+expectpart "$($clixon_util_datastore $conf put replace '<x xmlns="urn:example:clixon"><g>new</g></x>')" 0 ""
+
+cp $dir/journal $mydir/candidate_db.journal
+
+new "datastore get ignores stale journal"
+expectpart "$($clixon_util_datastore $conf get /)" 0 "^<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\"><g>new</g></x></${DATASTORE_TOP}>$"
+
+# Without journal the datastore file is re-written and the journal removed
+new "datastore put merge without journal"
+expectpart "$($clixon_util_datastore -d candidate -b $mydir -y $fyang put merge '<x xmlns="urn:example:clixon"><y><a>4</a></y></x>')" 0 ""
+
+if [ -f $mydir/candidate_db.journal ]; then
+    err "No journal" "Journal after non-journal write"
+fi
+
+# Small compaction threshold: journal is compacted when larger than snapshot
+conf="-d candidate -b $mydir -y $fyang -j 0"
+
+new "datastore delete"
+expectpart "$($clixon_util_datastore $conf delete)" 0 ""
+
+new "datastore init"
+expectpart "$($clixon_util_datastore $conf init)" 0 ""
+
+new "datastore put merge compacts"
+for i in $(seq 1 10); do
+    expectpart "$($clixon_util_datastore $conf put merge "<x xmlns=\"urn:example:clixon\"><y><a>$i</a></y></x>")" 0 ""
+    jsize=$(stat -c %s $mydir/candidate_db.journal 2> /dev/null || echo 0)
+    ssize=$(stat -c %s $mydir/candidate_db)
+    if [ $jsize -gt $ssize ]; then
+        err "journal <= snapshot" "journal: $jsize snapshot: $ssize"
+    fi
+done
+
+new "datastore get after compaction"
+expectpart "$($clixon_util_datastore $conf get /)" 0 "<y><a>1</a></y>" "<y><a>10</a></y>"
+
+rm -rf $mydir
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -97,6 +97,37 @@ EOF
 new "Netconf 1.1 multi-chunked framing"
 expecteof_netconf "$clixon_netconf -qef $cfg -o CLICON_NETCONF_BASE_CAPABILITY=1" 0 "$rpc" "" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter></table></data></rpc-reply>"
 
+# Reply larger than NETCONF_REPLY_CHUNK_SIZE is written as several chunks
+nr=3000
+new "generate $nr parameters"
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\">"
+for (( i=0; i<$nr; i++ )); do
+    rpc+="<parameter><name>p$i</name><value>abcdefghijklmnopqrstuvwxyz$i</value></parameter>"
+done
+rpc+="</table></config></edit-config></rpc>"
+
+new "Netconf 1.1 edit-config $nr parameters"
+expecteof_netconf "$clixon_netconf -qef $cfg -o CLICON_NETCONF_BASE_CAPABILITY=1" 0 "$DEFAULTHELLO" "$rpc" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "Netconf 1.1 get-config $nr parameters in several chunks"
+ret=$($clixon_netconf -qef $cfg -o CLICON_NETCONF_BASE_CAPABILITY=1 <<EOF
+$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>")
+EOF
+   )
+chunks=$(echo "$ret" | grep -c "^#[1-9][0-9]*$")
+if [ $chunks -lt 2 ]; then
+    err "several chunks" "$chunks"
+fi
+sum=$(echo "$ret" | grep "^#[1-9][0-9]*$" | tr -d '#' | awk '{s+=$1} END {print s}')
+data=$(echo "$ret" | grep -v "^#[1-9][0-9]*$" | grep -v "^##$" | tr -d '\n' | wc -c)
+if [ "$sum" != "$data" ]; then
+    err "chunk sizes $sum" "$data"
+fi
+match=$(echo "$ret" | grep -v "^#[1-9][0-9]*$" | tr -d '\n' | grep -c "^<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter>.*</value></parameter></table></data></rpc-reply>##$")
+if [ $match -ne 1 ]; then
+    err "whole reply and end-of-chunks" "$ret"
+fi
+
 if [ $BE -ne 0 ]; then
     new "Kill backend"
     # Check if premature kill
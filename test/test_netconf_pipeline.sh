@@ -0,0 +1,95 @@
+#!/usr/bin/env bash
+# Pipelined netconf rpcs in one session, see netconf_rpc_dispatch_async
+# Rpcs forwarded as-is to the backend (lock, validate, commit,..) are sent without waiting
+# for the reply and mixed with rpcs handled synchronously (edit-config, get-config).
+# Replies should come in request order and all rpcs should use the same backend session,
+# eg the lock taken by a pipelined rpc should be held by the session making the edit.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+frpc=$dir/rpc.xml
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container c {
+    leaf value {
+      type int32;
+    }
+  }
+}
+EOF
+
+# Netconf rpc with message-id
+# 1: message-id
+# 2: rpc body
+function rpcmsg()
+{
+    echo "$(chunked_framing "<rpc $DEFAULTONLY message-id=\"$1\">$2</rpc>")"
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+echo -n "$DEFAULTHELLO" > $frpc
+rpcmsg 1 "<lock><target><candidate/></target></lock>" >> $frpc
+rpcmsg 2 "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><value>1</value></c></config></edit-config>" >> $frpc
+rpcmsg 3 "<validate><source><candidate/></source></validate>" >> $frpc
+rpcmsg 4 "<get-config><source><candidate/></source></get-config>" >> $frpc
+rpcmsg 5 "<commit/>" >> $frpc
+rpcmsg 6 "<unlock><target><candidate/></target></unlock>" >> $frpc
+rpcmsg 7 "<unlock><target><candidate/></target></unlock>" >> $frpc
+rpcmsg 8 "<discard-changes/>" >> $frpc
+
+new "netconf pipelined rpcs replied in order"
+# Chunked replies are printed one per line, join them to check order
+expectpart "$($clixon_netconf -qef $cfg < $frpc | grep "^<rpc-reply" | tr -d '\n')" 0 "^<rpc-reply $DEFAULTONLY message-id=\"1\"><ok/></rpc-reply><rpc-reply $DEFAULTONLY message-id=\"2\"><ok/></rpc-reply><rpc-reply $DEFAULTONLY message-id=\"3\"><ok/></rpc-reply><rpc-reply $DEFAULTONLY message-id=\"4\"><data><c xmlns=\"urn:example:clixon\"><value>1</value></c></data></rpc-reply><rpc-reply $DEFAULTONLY message-id=\"5\"><ok/></rpc-reply><rpc-reply $DEFAULTONLY message-id=\"6\"><ok/></rpc-reply><rpc-reply $DEFAULTONLY message-id=\"7\"><rpc-error><error-type>protocol</error-type><error-tag>lock-denied</error-tag>.*</rpc-error></rpc-reply><rpc-reply $DEFAULTONLY message-id=\"8\"><ok/></rpc-reply>$"
+
+new "netconf get committed config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:clixon\"><value>1</value></c></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
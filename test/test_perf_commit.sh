@@ -0,0 +1,131 @@
+#!/usr/bin/env bash
+# Scaling/ performance tests
+# Commit latency as a function of config size where every commit is a one-leaf edit
+# Commit diffs only the edited subtrees of candidate, see xml_diff_dirty, so the diff
+# should not grow with the number of entries
+# Run with eg: perfnrs="1000 10000 100000" ./test_perf_commit.sh
+# and compare commit times with an earlier build
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Number of list entries in each measurement
+: ${perfnrs:="1000 10000 50000"}
+
+# Number of one-leaf commits in each measurement
+: ${perfreq:=20}
+
+# time function (this is a mess to get right on freebsd/linux)
+: ${TIMEFN:=time -p} # portability: 2>&1 | awk '/real/ {print $2}'
+if ! $TIMEFN true; then err "A working time function" "'$TIMEFN' does not work"; fi
+
+APPNAME=example
+
+cfg=$dir/config.xml
+fyang=$dir/$APPNAME.yang
+fconfig=$dir/large.xml
+fcommit=$dir/commit.xml
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module $APPNAME{
+  yang-version 1.1;
+  prefix ex;
+  namespace "urn:example:clixon";
+  container c {
+    list x {
+      key "name";
+      leaf name {
+        type int32;
+      }
+      leaf value {
+        type int32;
+      }
+    }
+  }
+}
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+for n in $perfnrs; do
+    rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>replace</default-operation><config>"
+    rpc+="<c xmlns=\"urn:example:clixon\">"
+    for (( i=0; i<$n; i++ )); do
+        rpc+="<x><name>$i</name><value>$i</value></x>"
+    done
+    rpc+="</c></config></edit-config></rpc>"
+    echo -n "$DEFAULTHELLO" > $fconfig
+    echo "$(chunked_framing "$rpc")" >> $fconfig
+
+    new "netconf write config with $n entries"
+    expecteof_file "$clixon_netconf -qef $cfg" 0 "$fconfig" "^<rpc-reply $DEFAULTNS><ok/></rpc-reply>$"
+
+    new "netconf commit config with $n entries"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    # Each commit changes the value of one entry in the middle of the list
+    echo -n "$DEFAULTHELLO" > $fcommit
+    for (( i=0; i<$perfreq; i++ )); do
+        echo "$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><x><name>$((n/2))</name><value>$((n+i))</value></x></c></config></edit-config></rpc>")" >> $fcommit
+        echo "$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")" >> $fcommit
+    done
+
+    new "netconf $perfreq one-leaf commits with $n entries"
+    { $TIMEFN $clixon_netconf -qef $cfg < $fcommit > /dev/null; } 2>&1 | awk -v n=$n '/real/ {print "entries: " n " commits time: " $2}'
+
+    new "netconf get one-leaf commit result"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:c/ex:x[ex:name='$((n/2))']\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:clixon\"><x><name>$((n/2))</name><value>$((n+perfreq-1))</value></x></c></data></rpc-reply>"
+
+    # Remove one entry and check the commit is reflected in running
+    new "netconf delete entry"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><x nc:operation=\"delete\" xmlns:nc=\"${BASENS}\"><name>0</name></x></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "netconf commit delete"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "netconf get deleted entry"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:c/ex:x[ex:name='0']\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+done
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+unset perfnrs
+unset perfreq
+
+rm -rf $dir
+
+new "endtest"
+endtest
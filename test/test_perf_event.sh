@@ -0,0 +1,39 @@
+#!/usr/bin/env bash
+# Event loop performance test:
+# Dispatch cost per ready fd as a function of number of registered fds, eg connected clients
+# With epoll the cost should be (close to) constant, with select it grows linearly and
+# fails above FD_SETSIZE (1024)
+# Baseline usec/dispatch 10/100/1000/4000 clients:
+#   select: 3.4/12.4/(fail)/(fail)
+#   epoll:  2.7/2.8/4.7/6.9
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_event:="clixon_util_event"}
+
+# Number of dispatch rounds per measurement
+: ${perfnr:=100000}
+
+# Number of registered fds (clients) in each measurement
+: ${perfclients:="10 100 1000 4000"}
+
+for n in $perfclients; do
+    new "event dispatch with $n clients"
+    ret=$($clixon_util_event -n $n -r $perfnr)
+    r=$?
+    if [ $r -ne 0 ]; then
+        err1 "0" "$r"
+    fi
+    echo "$ret" | awk '{print "clients: " $1 " usec/dispatch: " $2}'
+done
+
+new "event dispatch edge-triggered with 1000 clients"
+expectpart "$($clixon_util_event -e -n 1000 -r $perfnr)" 0 "^1000 "
+
+unset perfclients
+
+rm -rf $dir
+
+new "endtest"
+endtest
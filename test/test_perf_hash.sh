@@ -0,0 +1,35 @@
+#!/usr/bin/env bash
+# Hash table performance test of clicon_hash used for options, data and datastore elements
+# Insert, lookup and delete time per key as a function of number of keys
+# Baseline nsec/op insert/lookup 1K/100K/1M keys:
+#   1031 fixed buckets, byte-sum hash: 415/846  86135/109910  (>10 min)
+#   open addressing, resizing:         300/85   555/428       584/669
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_hash:="clixon_util_hash"}
+
+# Number of lookup rounds over all keys
+: ${perfnr:=10}
+
+# Number of keys in each measurement
+: ${perfkeys:="1000 100000 1000000"}
+
+for n in $perfkeys; do
+    new "hash insert/lookup/delete $n keys"
+    ret=$($clixon_util_hash -n $n -r $perfnr)
+    r=$?
+    if [ $r -ne 0 ]; then
+        err1 "0" "$r"
+    fi
+    echo "$ret" | awk '{print "keys: " $1 " nsec/insert: " $2 " nsec/lookup: " $3 " nsec/delete: " $4}'
+done
+
+unset perfkeys
+unset perfnr
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,167 @@
+#!/usr/bin/env bash
+# Scaling/ performance tests
+# Get latency of a large list with NACM read rules
+# Read rules are mapped to YANG nodes, see nacm_ydec_get, so filtering is one walk over
+# the reply and subtrees without rules are skipped
+# Run with eg: perfnr=100000 perfrules="0 10 100 1000" ./test_perf_nacm.sh
+# and compare get times with an earlier build
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Number of list entries
+: ${perfnr:=10000}
+
+# Number of NACM rules in each measurement
+: ${perfrules:="0 10 100"}
+
+# Number of get requests in each measurement
+: ${perfreq:=10}
+
+# time function (this is a mess to get right on freebsd/linux)
+: ${TIMEFN:=time -p} # portability: 2>&1 | awk '/real/ {print $2}'
+if ! $TIMEFN true; then err "A working time function" "'$TIMEFN' does not work"; fi
+
+APPNAME=example
+
+# Common NACM scripts
+. ./nacm.sh
+
+cfg=$dir/config.xml
+fyang=$dir/$APPNAME.yang
+fconfig=$dir/large.xml
+fget=$dir/get.xml
+fout=$dir/out.xml
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_NACM_MODE>internal</CLICON_NACM_MODE>
+  <CLICON_NACM_CREDENTIALS>none</CLICON_NACM_CREDENTIALS>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module $APPNAME{
+  yang-version 1.1;
+  prefix ex;
+  namespace "urn:example:clixon";
+  container c {
+    list x {
+      key "name";
+      leaf name {
+        type int32;
+      }
+      leaf value {
+        type int32;
+      }
+    }
+  }
+  container d {
+    leaf y {
+      type int32;
+    }
+  }
+}
+EOF
+
+# NACM config with read rules for the limited group
+# 1: number of rules, every other rule denies a value leaf of an entry, the others deny d
+function nacmconfig()
+{
+    echo -n "<nacm xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-acm\" nc:operation=\"replace\" xmlns:nc=\"${BASENS}\">"
+    echo -n "<enable-nacm>true</enable-nacm><read-default>permit</read-default><write-default>permit</write-default><exec-default>permit</exec-default>"
+    echo -n "$NGROUPS"
+    echo -n "<rule-list><name>limited-acl</name><group>limited</group>"
+    for (( r=0; r<$1; r++ )); do
+        if [ $((r%2)) -eq 0 ]; then
+            echo -n "<rule><name>r$r</name><module-name>$APPNAME</module-name><path xmlns:ex=\"urn:example:clixon\">/ex:c/ex:x[ex:name='$r']/ex:value</path><access-operations>read</access-operations><action>deny</action></rule>"
+        else
+            echo -n "<rule><name>r$r</name><module-name>$APPNAME</module-name><path xmlns:ex=\"urn:example:clixon\">/ex:d/ex:y</path><access-operations>read</access-operations><action>deny</action></rule>"
+        fi
+    done
+    echo -n "</rule-list>"
+    echo -n "$NADMIN"
+    echo -n "</nacm>"
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>"
+rpc+="$(nacmconfig 0)"
+rpc+="<c xmlns=\"urn:example:clixon\">"
+for (( i=0; i<$perfnr; i++ )); do
+    rpc+="<x><name>$i</name><value>$i</value></x>"
+done
+rpc+="</c><d xmlns=\"urn:example:clixon\"><y>0</y></d></config></edit-config></rpc>"
+echo -n "$DEFAULTHELLO" > $fconfig
+echo "$(chunked_framing "$rpc")" >> $fconfig
+
+new "netconf write large config with $perfnr entries"
+expecteof_file "$clixon_netconf -qef $cfg" 0 "$fconfig" "^<rpc-reply $DEFAULTNS><ok/></rpc-reply>$"
+
+new "netconf commit large config"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+for n in $perfrules; do
+    echo -n "$DEFAULTHELLO" > $fconfig
+    echo "$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$(nacmconfig $n)</config></edit-config></rpc>")" >> $fconfig
+    echo "$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")" >> $fconfig
+
+    new "netconf set $n nacm rules"
+    expectpart "$($clixon_netconf -qef $cfg -U andy < $fconfig | grep "^<rpc-reply" | tr -d '\n')" 0 "^<rpc-reply $DEFAULTNS><ok/></rpc-reply><rpc-reply $DEFAULTNS><ok/></rpc-reply>$"
+
+    echo -n "$DEFAULTHELLO" > $fget
+    for (( i=0; i<$perfreq; i++ )); do
+        echo "$(chunked_framing "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:c\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>")" >> $fget
+    done
+
+    new "netconf $perfreq gets with $n nacm rules"
+    { $TIMEFN $clixon_netconf -qef $cfg -U wilma < $fget > $fout; } 2>&1 | awk -v n=$n '/real/ {print "rules: " n " get time: " $2}'
+
+    # Denied value leafs of entries 0, 2, .. are removed
+    denied=$(((n+1)/2))
+    if [ $denied -gt $perfnr ]; then
+        denied=$perfnr
+    fi
+    new "Check number of values with $n nacm rules"
+    expectpart "$(grep -o "<value>" $fout | wc -l)" 0 "^$((perfreq*(perfnr-denied)))$"
+done
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+unset perfnr
+unset perfrules
+unset perfreq
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -2,6 +2,7 @@
 # Scaling/ performance tests for non-ssl RESTCONF
 # Lists (and leaf-lists)
 # Add, get and delete entries
+# Get throughput with 1 to N native restconf worker processes, see perfworkers
 # If both HTTP/1 and /2, force to /1 to test native http/1 implementation
 
 # Override default to use http/1.1, comment to use https/2
@@ -26,6 +27,12 @@ fi
 # Number of requests made get/put
 : ${perfreq:=10}
 
+# Number of restconf worker processes to measure throughput for (native only)
+: ${perfworkers:="1 2 4"}
+
+# Number of parallel clients in worker measurement
+: ${perfclients:=4}
+
 # time function (this is a mess to get right on freebsd/linux)
 # -f %e gives elapsed wall clock time but is not available on all systems
 # so we use time -p for POSIX compliance and awk to get wall clock time
@@ -167,6 +174,44 @@ new "restconf get $perfreq small config 1 key index"
     curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/scaling:x/y=$rnd > /dev/null
 done } 2>&1 | awk '/real/ {print $2}'
 
+# RESTCONF throughput as a function of number of worker processes
+# Each of perfclients parallel clients makes perfreq get requests
+if [ $RC -ne 0 -a "${WITH_RESTCONF}" = "native" ]; then
+    cfgw=$dir/workers-conf.xml
+    for w in $perfworkers; do
+        sed -e "s,<pretty>,<workers>$w</workers><pretty>," -e "s,$cfg,$cfgw," $cfg > $cfgw
+
+        new "kill restconf daemon"
+        stop_restconf
+
+        new "start restconf daemon with $w workers"
+        start_restconf -f $cfgw
+
+        new "wait restconf"
+        wait_restconf
+
+        new "restconf $w workers: $perfclients clients x $perfreq get"
+        { time -p for (( c=0; c<$perfclients; c++ )); do
+              for (( i=0; i<$perfreq; i++ )); do
+                  rnd=$(( ( RANDOM % $perfnr ) ))
+                  curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/scaling:x/y=$rnd
+              done > $dir/client$c.out &
+          done; wait; } 2>&1 | awk '/real/ {print $2}'
+
+        new "restconf $w workers: all requests ok"
+        expectpart "$(cat $dir/client*.out | grep -c "HTTP/$HVER 200")" 0 "^$(( perfclients * perfreq ))$"
+    done
+
+    new "kill restconf daemon"
+    stop_restconf
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+
+    new "wait restconf"
+    wait_restconf
+fi
+
 # RESTCONF put
 # Reference:
 # i686 format=xml perfnr=10000/100 time: 38/29s 20190425  WITH/OUT startup copying
@@ -241,6 +286,9 @@ if [ $BE -ne 0 ]; then
     stop_backend -f $cfg
 fi
 
+unset perfworkers
+unset perfclients
+
 rm -rf $dir
 
 new "endtest"
@@ -0,0 +1,135 @@
+#!/usr/bin/env bash
+# Scaling/ performance tests
+# Walk a large IF-MIB ifTable via clixon_snmp
+# Getnext is served by binary search in a polled table sorted by OID, see mibyang_table_poll,
+# so walk time per object should not grow with the number of rows
+# Run with eg: perfnr=100000 ./test_perf_snmp.sh
+# and compare walk times with an earlier build
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Re-use main example backend state callbacks
+APPNAME=example
+
+if [ ${ENABLE_NETSNMP} != "yes" ]; then
+    echo "Skipping test, Net-SNMP support not enabled."
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+# Number of ifTable rows
+: ${perfnr:=50000}
+
+# time function (this is a mess to get right on freebsd/linux)
+: ${TIMEFN:=time -p} # portability: 2>&1 | awk '/real/ {print $2}'
+if ! $TIMEFN true; then err "A working time function" "'$TIMEFN' does not work"; fi
+
+snmpbulkwalk="$(type -p snmpbulkwalk) -c public -v2c localhost -t 10 "
+
+cfg=$dir/conf_startup.xml
+fyang=$dir/clixon-example.yang
+fstate=$dir/state.xml
+fwalk=$dir/walk.txt
+
+# AgentX unix socket
+SOCK=/var/run/snmp.sock
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_STANDARD_DIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${MIB_GENERATED_YANG_DIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/var/tmp/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_SNMP_AGENT_SOCK>unix:$SOCK</CLICON_SNMP_AGENT_SOCK>
+  <CLICON_SNMP_MIB>IF-MIB</CLICON_SNMP_MIB>
+  <CLICON_VALIDATE_STATE_XML>false</CLICON_VALIDATE_STATE_XML>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  import IF-MIB {
+      prefix "if-mib";
+  }
+}
+EOF
+
+# State data that backend reads from file (on request), three columns per row
+echo "<IF-MIB xmlns=\"urn:ietf:params:xml:ns:yang:smiv2:IF-MIB\"><ifTable>" > $fstate
+for (( i=1; i<=$perfnr; i++ )); do
+    echo "<ifEntry><ifIndex>$i</ifIndex><ifDescr>if$i</ifDescr><ifMtu>1500</ifMtu></ifEntry>" >> $fstate
+done
+echo "</ifTable></IF-MIB>" >> $fstate
+
+new "test params: -s init -f $cfg -- -sS $fstate"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err "Failed to start backend"
+    fi
+    sudo pkill -f clixon_backend
+
+    new "Starting backend"
+    start_backend -s init -f $cfg -- -sS $fstate
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $SN -ne 0 ]; then
+    # Kill old clixon_snmp, if any
+    new "Terminating any old clixon_snmp processes"
+    sudo killall -q clixon_snmp
+
+    new "Starting clixon_snmp"
+    start_snmp $cfg &
+fi
+
+new "wait snmp"
+wait_snmp
+
+new "snmpwalk ifTable with $perfnr rows"
+{ $TIMEFN $snmpwalk IF-MIB::ifTable > $fwalk; } 2>&1 | awk -v n=$perfnr '/real/ {print "rows: " n " walk time: " $2}'
+
+# Row indexes above 255 check that the walk order is numeric
+new "Check walk length and order"
+expectpart "$(cat $fwalk | wc -l)" 0 "^$((3*perfnr))$"
+expectpart "$(head -1 $fwalk)" 0 "IF-MIB::ifIndex.1 = INTEGER: 1"
+expectpart "$(sed -n 256p $fwalk)" 0 "IF-MIB::ifIndex.256 = INTEGER: 256"
+expectpart "$(tail -1 $fwalk)" 0 "IF-MIB::ifMtu.$perfnr = INTEGER: 1500"
+
+new "snmpbulkwalk ifTable with $perfnr rows"
+{ $TIMEFN $snmpbulkwalk IF-MIB::ifTable > $fwalk; } 2>&1 | awk -v n=$perfnr '/real/ {print "rows: " n " bulkwalk time: " $2}'
+
+new "Check bulkwalk length"
+expectpart "$(cat $fwalk | wc -l)" 0 "^$((3*perfnr))$"
+
+new "Cleaning up"
+stop_snmp
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+unset perfnr
+
+rm -rf $dir
+
+new "endtest"
+endtest
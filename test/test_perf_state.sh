@@ -195,6 +195,12 @@ new "netconf get large config"
 rpc=$(chunked_framing "<rpc $DEFAULTNS><get> <filter type=\"xpath\" select=\"/ex:interfaces/ex:a[name='foo']/ex:b\" xmlns:ex=\"urn:example:clixon\"/></get></rpc>")
 { time -p echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg  > /dev/null; } 2>&1 | awk '/real/ {print $2}'
 
+# The backend writes large get replies in chunks, check the reply is complete
+new "netconf get large config reply complete"
+ret=$(echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg)
+expectpart "$(echo "$ret" | grep -o "<interface>" | wc -l)" 0 "^$perfnr$"
+expectpart "$ret" 0 "<name>e$((perfnr-1))</name><type>eth</type><status>up</status>" "</interfaces></data></rpc-reply>"
+
 new "restconf get large config"
 $TIMEFN curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:interfaces/a=foo/b 2>&1 | awk '/real/ {print $2}'
 
@@ -0,0 +1,60 @@
+#!/usr/bin/env bash
+# XML arena performance test, see xml_arena_push
+# 1. Parse a large list with and without arena, the output is the same
+# 2. Print xml_stats and time to free the tree with and without arena
+# 3. No nodes remain after freeing an arena tree by chunk
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xml:="clixon_util_xml"}
+
+# Number of list entries in file
+: ${perfnr:=100000}
+
+fxml=$dir/large.xml
+
+new "generate large file $fxml"
+echo -n "<table xmlns=\"urn:example:clixon\">" > $fxml
+for (( i=0; i<$perfnr; i++ )); do
+    echo -n "<parameter><name>a$i</name><value>This is a somewhat longer value of entry number $i</value></parameter>" >> $fxml
+done
+echo "</table>" >> $fxml
+
+new "xml parse and output without arena"
+$clixon_util_xml -of $fxml > $dir/heap.out
+if [ $? -ne 0 ]; then
+    err
+fi
+
+new "xml parse and output with arena"
+$clixon_util_xml -aof $fxml > $dir/arena.out
+if [ $? -ne 0 ]; then
+    err
+fi
+
+new "xml output with and without arena is equal"
+if ! cmp -s $dir/heap.out $dir/arena.out; then
+    err "$(head -c 200 $dir/heap.out)" "$(head -c 200 $dir/arena.out)"
+fi
+
+new "xml stats and free without arena"
+ret=$($clixon_util_xml -sf $fxml 2>&1)
+echo "$ret"
+match=$(echo "$ret" | grep --null -o "remaining:0")
+if [ -z "$match" ]; then
+    err "remaining:0" "$ret"
+fi
+
+new "xml stats and free with arena"
+ret=$($clixon_util_xml -asf $fxml 2>&1)
+echo "$ret"
+match=$(echo "$ret" | grep --null -o "remaining:0")
+if [ -z "$match" ]; then
+    err "remaining:0" "$ret"
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
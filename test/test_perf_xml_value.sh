@@ -0,0 +1,63 @@
+#!/usr/bin/env bash
+# XML value memory test on a datastore with many leaves, see xml_stats
+# Body values shorter than XML_VALUE_INLINE are stored in the node, longer in one allocation
+# 1. Print xml_stats of leaves with short values before freeing, and node count after
+# 2. Same with long values
+# 3. Leaves with short values use less memory than with long values
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xml:="clixon_util_xml"}
+
+# Number of leaves in file
+: ${perfnr:=1000000}
+
+fshort=$dir/short.xml
+flong=$dir/long.xml
+
+new "generate $perfnr leaves with short values $fshort"
+(echo -n "<x xmlns=\"urn:example:clixon\">"; seq 0 $((perfnr-1)) | awk '{printf "<c>%d</c>", $1}'; echo "</x>") > $fshort
+
+new "generate $perfnr leaves with long values $flong"
+(echo -n "<x xmlns=\"urn:example:clixon\">"; seq 0 $((perfnr-1)) | awk '{printf "<c>this is a long leaf value %d</c>", $1}'; echo "</x>") > $flong
+
+# Print stats and check no nodes remain after free
+# 1: file
+# Sets size
+function valuestats()
+{
+    ret=$($clixon_util_xml -sf $1 2>&1)
+    if [ $? -ne 0 ]; then
+        err "0" "$ret"
+    fi
+    echo "$ret"
+    nr=$(echo "$ret" | sed -n 's/^xml_stats nr:\([0-9]*\) size:.*$/\1/p')
+    size=$(echo "$ret" | sed -n 's/^xml_stats nr:[0-9]* size:\([0-9]*\)$/\1/p')
+    if [ -z "$nr" -o -z "$size" ]; then
+        err "xml_stats nr:<nr> size:<size>" "$ret"
+    fi
+    echo "bytes per leaf: $((size/perfnr))"
+    match=$(echo "$ret" | grep --null -o "remaining:0")
+    if [ -z "$match" ]; then
+        err "remaining:0" "$ret"
+    fi
+}
+
+new "xml stats short values"
+valuestats $fshort
+sizeshort=$size
+
+new "xml stats long values"
+valuestats $flong
+sizelong=$size
+
+new "short values use less memory than long values"
+if [ $sizeshort -ge $sizelong ]; then
+    err "< $sizelong" "$sizeshort"
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
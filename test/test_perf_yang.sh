@@ -0,0 +1,84 @@
+#!/usr/bin/env bash
+# Yang lookup performance test: load a yang spec and look up all data nodes by name
+# using yang_find and yang_find_datanode. See YANG_INDEX_MIN in clixon_custom.h
+# A generated module with wide containers, choices and rpcs is always used.
+# If OPENCONFIG is set, openconfig network-instance with its dependencies is loaded as well.
+# Prints: nodes load-ms lookups ns/lookup
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_yang:="clixon_util_yang"}
+
+# Number of children in each wide yang node
+: ${perfnr:=1000}
+
+# Number of lookup rounds over all data nodes
+: ${perfreq:=10}
+
+fyang=$dir/wide.yang
+
+echo "module wide{" > $fyang
+echo "  yang-version 1.1;" >> $fyang
+echo "  namespace \"urn:example:wide\";" >> $fyang
+echo "  prefix w;" >> $fyang
+echo "  container c {" >> $fyang
+for (( i=0; i<$perfnr; i++ )); do
+    echo "    leaf l$i { description \"leaf $i\"; type string; }" >> $fyang
+done
+echo "    choice ch {" >> $fyang
+for (( i=0; i<$perfnr; i++ )); do
+    echo "      case c$i { leaf k$i { type int32; } }" >> $fyang
+done
+echo "    }" >> $fyang
+echo "    list y {" >> $fyang
+echo "      key a;" >> $fyang
+echo "      leaf a { type string; }" >> $fyang
+for (( i=0; i<$perfnr; i++ )); do
+    echo "      container m$i { leaf n { type string; } }" >> $fyang
+done
+echo "    }" >> $fyang
+echo "  }" >> $fyang
+echo "  rpc r {" >> $fyang
+echo "    input {" >> $fyang
+for (( i=0; i<$perfnr; i++ )); do
+    echo "      leaf i$i { type string; }" >> $fyang
+done
+echo "    }" >> $fyang
+echo "  }" >> $fyang
+echo "}" >> $fyang
+
+# Data nodes: c, y, a and perfnr each of l, k, m, n and i
+nodes=$(( 5*perfnr + 3 ))
+
+new "yang lookup $perfnr wide nodes"
+ret=$($clixon_util_yang -y $fyang -n $perfreq)
+r=$?
+if [ $r -ne 0 ]; then
+    err1 "0" "$r"
+fi
+echo "$ret" | awk '{print "nodes: " $1 " load-ms: " $2 " lookups: " $3 " nsec/lookup: " $4}'
+
+new "yang lookup all nodes found"
+expectpart "$($clixon_util_yang -y $fyang -n 1)" 0 "^$nodes "
+
+new "yang datanode lookup via choice/case and input"
+expectpart "$($clixon_util_yang -y $fyang)" 0 "leaf k$(( perfnr - 1 ))" "leaf i$(( perfnr - 1 ))"
+
+if [ -d "$OPENCONFIG" ]; then
+    new "yang lookup openconfig network-instance"
+    ret=$($clixon_util_yang -Y $OPENCONFIG -Y $YANG_STANDARD_DIR -y $OPENCONFIG/release/models/network-instance/openconfig-network-instance.yang -n $perfreq)
+    r=$?
+    if [ $r -ne 0 ]; then
+        err1 "0" "$r"
+    fi
+    echo "$ret" | awk '{print "nodes: " $1 " load-ms: " $2 " lookups: " $3 " nsec/lookup: " $4}'
+fi
+
+unset perfnr
+unset perfreq
+
+rm -rf $dir
+
+new "endtest"
+endtest
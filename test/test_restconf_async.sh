@@ -0,0 +1,132 @@
+#!/usr/bin/env bash
+# Restconf GET served with asynchronous backend rpcs, see api_data_get_cb
+# Only native, fcgi uses synchronous rpcs
+# 1. Several clients GET concurrently, each gets its own reply
+# 2. GET, HEAD and not found replies are the same as synchronous
+# 3. Other methods on the same connection after a deferred GET
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Only works with native
+if [ "${WITH_RESTCONF}" != "native" ]; then
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi # skip
+fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/example.yang
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container table{
+      list parameter{
+         key name;
+         leaf name{
+            type string;
+         }
+         leaf value{
+            type string;
+         }
+      }
+   }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo pkill -f clixon_backend # to be sure
+
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+nr=10
+for (( i=0; i<$nr; i++ )); do
+    new "restconf POST parameter A$i"
+    expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+json" -d "{\"example:parameter\":[{\"name\":\"A$i\",\"value\":\"$i\"}]}" $RCPROTO://localhost/restconf/data/example:table)" 0 "HTTP/$HVER 201"
+done
+
+new "restconf concurrent GETs"
+for (( i=0; i<$nr; i++ )); do
+    curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=A$i > $dir/get$i.out 2>&1 &
+done
+wait
+for (( i=0; i<$nr; i++ )); do
+    new "restconf concurrent GET A$i"
+    expectpart "$(cat $dir/get$i.out)" 0 "HTTP/$HVER 200" "{\"example:parameter\":\[{\"name\":\"A$i\",\"value\":\"$i\"}\]}"
+done
+
+new "restconf HEAD"
+expectpart "$(curl $CURLOPTS -I $RCPROTO://localhost/restconf/data/example:table/parameter=A0)" 0 "HTTP/$HVER 200" "Content-Type: application/yang-data+json"
+
+new "restconf GET not found"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=B)" 0 "HTTP/$HVER 404" "Instance does not exist"
+
+new "restconf GET then DELETE on same connection"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=A1 --next $CURLOPTS -X DELETE $RCPROTO://localhost/restconf/data/example:table/parameter=A1)" 0 "HTTP/$HVER 200" "HTTP/$HVER 204"
+
+new "restconf GET deleted"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=A1)" 0 "HTTP/$HVER 404"
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -6,13 +6,16 @@
 #   - not a key int
 #   - key in an ordered-by user
 #   - key in state data
-# Use instance-id for tests, since api-path can only handle keys, and xpath is too complex.
+# Use instance-id for tests, since api-path can only handle keys.
+# XPath predicates on a single index variable also use the index, see xpath_optimize_check
 
 # Magic line must be first in script (see README.md)
 s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
 
 : ${clixon_util_path:=clixon_util_path -D $DBG -Y /usr/local/share/clixon}
 
+: ${clixon_util_xpath:=clixon_util_xpath -D $DBG -Y /usr/local/share/clixon}
+
 # Number of list/leaf-list entries
 : ${nr:=10000}
 
@@ -91,6 +94,32 @@ new "index search latency i=$rndi"
 new "non-index search latency j=$rndi"
 { time -p $clixon_util_path -f $xml1 -y $ydir -p /a:x1/a:y[a:j=\"$rndi\"] > /dev/null; }  2>&1 | awk '/real/ {print $2}'
 
+new "xpath index i=$rndi"
+expectpart "$($clixon_util_xpath -f $xml1 -y $ydir -n a:urn:example:a -p "/a:x1/a:y[a:i='$rndi']")" 0 "^nodeset:0:<y><k1>a$rnd</k1><z>foo$rnd</z><i>$rndi</i><j>$rndi</j></y>$"
+
+new "xpath index no match"
+expectpart "$($clixon_util_xpath -f $xml1 -y $ydir -n a:urn:example:a -p "/a:x1/a:y[a:i='$nr']")" 0 "^nodeset:$"
+
+# Index values need not be unique, equal values are returned in key order
+xml2=$dir/xml2.xml
+cat <<EOF > $xml2
+<x1 xmlns="urn:example:a">
+  <y><k1>a0</k1><i>-1</i></y>
+  <y><k1>a1</k1><i>7</i></y>
+  <y><k1>a2</k1><i>8</i></y>
+  <y><k1>a3</k1><i>7</i></y>
+  <y><k1>a4</k1><i>7</i></y>
+</x1>
+EOF
+
+new "xpath non-unique index i=7"
+expectpart "$($clixon_util_xpath -f $xml2 -y $ydir -n a:urn:example:a -p "/a:x1/a:y[a:i='7']")" 0 "^nodeset:0:<y><k1>a1</k1><i>7</i></y>
+1:<y><k1>a3</k1><i>7</i></y>
+2:<y><k1>a4</k1><i>7</i></y>$"
+
+new "xpath non-unique index i=-1"
+expectpart "$($clixon_util_xpath -f $xml2 -y $ydir -n a:urn:example:a -p "/a:x1/a:y[a:i='-1']")" 0 "^nodeset:0:<y><k1>a0</k1><i>-1</i></y>$"
+
 rm -rf $dir
 
 new "endtest"
@@ -0,0 +1,170 @@
+#!/usr/bin/env bash
+# Explicit search index in backend datastores
+# A list with a cc:search_index leaf is read from running_db at startup.
+# Then it is edited with create, merge, replace, delete and index value changes
+# XPath predicates on the index leaf use the index vector, see xpath_optimize_check,
+# which must be in index value order also when the datastore is read in one pass,
+# see xmldb_readfile_stream
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/moda.yang
+dbdir=$dir/db
+
+rm -rf $dbdir
+mkdir $dbdir
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dbdir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_FORMAT>xml</CLICON_XMLDB_FORMAT>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module moda{
+  namespace "urn:example:a";
+  prefix a;
+  import clixon-config {
+    prefix "cc";
+  }
+  container x1{
+    list y{
+      key k1;
+      leaf k1{
+        type string;
+      }
+      leaf i{
+        description "explicit index variable";
+        type int32;
+        cc:search_index;
+      }
+    }
+  }
+}
+EOF
+
+# Index values are not in key order and the index leaf comes before the key in some entries
+cat <<EOF > $dbdir/running_db
+<${DATASTORE_TOP}>
+  <x1 xmlns="urn:example:a">
+    <y><k1>a0</k1><i>50</i></y>
+    <y><i>30</i><k1>a1</k1></y>
+    <y><k1>a2</k1><i>10</i></y>
+    <y><i>40</i><k1>a3</k1></y>
+    <y><k1>a4</k1><i>20</i></y>
+    <y><k1>a5</k1><i>30</i></y>
+  </x1>
+</${DATASTORE_TOP}>
+EOF
+
+new "test params: -s running -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s running -f $cfg"
+    start_backend -s running -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+# Get with xpath filter on index leaf
+# 1: index value
+# 2: expected list entries
+function getindex()
+{
+    new "get i=$1"
+    if [ -z "$2" ]; then
+        ret="<data/>"
+    else
+        ret="<data>$2</data>"
+    fi
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/a:x1/a:y[a:i='$1']\" xmlns:a=\"urn:example:a\"/></get></rpc>" "" "<rpc-reply $DEFAULTNS>$ret</rpc-reply>"
+}
+
+getindex 10 "<x1 xmlns=\"urn:example:a\"><y><k1>a2</k1><i>10</i></y></x1>"
+getindex 20 "<x1 xmlns=\"urn:example:a\"><y><k1>a4</k1><i>20</i></y></x1>"
+getindex 30 "<x1 xmlns=\"urn:example:a\"><y><k1>a1</k1><i>30</i></y><y><k1>a5</k1><i>30</i></y></x1>"
+getindex 40 "<x1 xmlns=\"urn:example:a\"><y><k1>a3</k1><i>40</i></y></x1>"
+getindex 50 "<x1 xmlns=\"urn:example:a\"><y><k1>a0</k1><i>50</i></y></x1>"
+getindex 60 ""
+
+# Edit candidate and commit
+# 1: test name
+# 2: x1 content
+function editindex()
+{
+    new "edit-config $1"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x1 xmlns=\"urn:example:a\" xmlns:nc=\"$BASENS\">$2</x1></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit $1"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+editindex create "<y nc:operation=\"create\"><k1>a6</k1><i>25</i></y>"
+getindex 25 "<x1 xmlns=\"urn:example:a\"><y><k1>a6</k1><i>25</i></y></x1>"
+
+editindex "merge new" "<y><i>10</i><k1>a7</k1></y>"
+getindex 10 "<x1 xmlns=\"urn:example:a\"><y><k1>a2</k1><i>10</i></y><y><k1>a7</k1><i>10</i></y></x1>"
+
+editindex "merge change index value" "<y><k1>a2</k1><i>35</i></y>"
+getindex 10 "<x1 xmlns=\"urn:example:a\"><y><k1>a7</k1><i>10</i></y></x1>"
+getindex 35 "<x1 xmlns=\"urn:example:a\"><y><k1>a2</k1><i>35</i></y></x1>"
+
+editindex "merge change index leaf" "<y><k1>a1</k1><i nc:operation=\"replace\">5</i></y>"
+getindex 30 "<x1 xmlns=\"urn:example:a\"><y><k1>a5</k1><i>30</i></y></x1>"
+getindex 5 "<x1 xmlns=\"urn:example:a\"><y><k1>a1</k1><i>5</i></y></x1>"
+
+editindex replace "<y nc:operation=\"replace\"><k1>a4</k1><i>45</i></y>"
+getindex 20 ""
+getindex 45 "<x1 xmlns=\"urn:example:a\"><y><k1>a4</k1><i>45</i></y></x1>"
+
+editindex "delete entry" "<y nc:operation=\"delete\"><k1>a0</k1></y>"
+getindex 50 ""
+
+editindex "delete index leaf" "<y><k1>a3</k1><i nc:operation=\"delete\"/></y>"
+getindex 40 ""
+
+new "get all remaining"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/a:x1\" xmlns:a=\"urn:example:a\"/></get></rpc>" "" "<rpc-reply $DEFAULTNS><data><x1 xmlns=\"urn:example:a\"><y><k1>a1</k1><i>5</i></y><y><k1>a2</k1><i>35</i></y><y><k1>a3</k1></y><y><k1>a4</k1><i>45</i></y><y><k1>a5</k1><i>30</i></y><y><k1>a6</k1><i>25</i></y><y><k1>a7</k1><i>10</i></y></x1></data></rpc-reply>"
+
+new "edit-config replace container"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x1 xmlns=\"urn:example:a\" xmlns:nc=\"$BASENS\" nc:operation=\"replace\"><y><k1>b1</k1><i>30</i></y><y><k1>b0</k1><i>20</i></y></x1></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit replace container"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+getindex 30 "<x1 xmlns=\"urn:example:a\"><y><k1>b1</k1><i>30</i></y></x1>"
+getindex 20 "<x1 xmlns=\"urn:example:a\"><y><k1>b0</k1><i>20</i></y></x1>"
+getindex 10 ""
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -77,6 +77,13 @@ EOF
     new "hello session-id 2"
     expecteof "$clixon_util_socket -a $family -s $sock -D $DBG" 0 "<hello $DEFAULTONLY/>" "<hello $DEFAULTONLY><session-id>4</session-id></hello>"
 
+    # Several requests in one write must be split and replied to in order by backend
+    new "pipelined hello session-id 5"
+    expectpart "$(echo "<hello $DEFAULTONLY/>" | $clixon_util_socket -a $family -s $sock -D $DBG -n 10 | grep -c "<hello $DEFAULTONLY><session-id>5</session-id></hello>")" 0 "^10$"
+
+    new "hello session-id 6"
+    expecteof "$clixon_util_socket -a $family -s $sock -D $DBG" 0 "<hello $DEFAULTONLY/>" "<hello $DEFAULTONLY><session-id>6</session-id></hello>"
+
     if [ $BE -ne 0 ]; then
         new "Kill backend"
         # Check if premature kill
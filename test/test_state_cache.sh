@@ -0,0 +1,155 @@
+#!/usr/bin/env bash
+# State data cache of backend plugin state callbacks, see CLICON_STATE_CACHE_MAXAGE
+# Using the -sS <file> state capability of the main example: the state file is read on
+# every state callback, so changing the file shows if the callback was called or not.
+# 1. State is reused from cache within max-age, also with another session
+# 2. Another xpath, content or with-defaults is not cached
+# 3. State is read from the callback after max-age
+# 4. Commit clears the cache
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fstate=$dir/state.xml
+fyang=$dir/state.yang
+
+# Max age of cached state in ms
+MAXAGE=3000
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  <CLICON_STREAM_DISCOVERY_RFC8040>false</CLICON_STREAM_DISCOVERY_RFC8040>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+  <CLICON_STATE_CACHE_MAXAGE>$MAXAGE</CLICON_STATE_CACHE_MAXAGE>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module state{
+    yang-version 1.1;
+    namespace "urn:example:state";
+    prefix st;
+    container c{
+        leaf name{
+           type string;
+        }
+    }
+    container s{
+        config false;
+        leaf counter{
+           type uint32;
+        }
+    }
+}
+EOF
+
+# This is state data written to file that backend reads from (on request)
+# 1: counter value
+function setstate()
+{
+    echo "<s xmlns=\"urn:example:state\"><counter>$1</counter></s>" > $fstate
+}
+
+# Get state and check counter value
+# 1: counter value
+# 2: xpath
+# 3: content (default nonconfig)
+# 4: with-defaults (optional)
+function getstate()
+{
+    content=${3:-nonconfig}
+    wdef=""
+    if [ -n "$4" ]; then
+        wdef="<with-defaults xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-with-defaults\">$4</with-defaults>"
+    fi
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get content=\"$content\"><filter type=\"xpath\" select=\"$2\" xmlns:st=\"urn:example:state\"/>$wdef</get></rpc>" "" "<rpc-reply $DEFAULTNS><data><s xmlns=\"urn:example:state\"><counter>$1</counter></s></data></rpc-reply>"
+}
+
+setstate 1
+
+new "test params: -f $cfg -- -sS $fstate"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg -- -sS $fstate"
+    start_backend -s init -f $cfg -- -sS $fstate
+fi
+
+new "wait backend"
+wait_backend
+
+new "get state 1"
+getstate 1 "/st:s"
+
+setstate 2
+
+new "get cached state 1"
+getstate 1 "/st:s"
+
+new "get state 2 of other xpath"
+getstate 2 "/st:s/st:counter"
+
+setstate 3
+
+new "get cached state 1 again"
+getstate 1 "/st:s"
+
+new "get state 3 of other content"
+getstate 3 "/st:s" all
+
+new "get state 3 of other with-defaults"
+getstate 3 "/st:s" nonconfig report-all
+
+setstate 2
+
+new "sleep max-age"
+sleep $((MAXAGE/1000+1))
+
+new "get state 2 after max-age"
+getstate 2 "/st:s"
+
+setstate 3
+
+new "get cached state 2"
+getstate 2 "/st:s"
+
+new "edit config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:state\"><name>x</name></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get state 3 after commit"
+getstate 3 "/st:s"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,120 @@
+#!/usr/bin/env bash
+# State callbacks with registered namespaces, see clixon_statedata_ns_register
+# Two backend plugins register one namespace each for their state callback:
+# - the main example reads state from file in urn:example:state (-sS <file> -N <ns>)
+# - the nacm example returns nacm state in ietf-netconf-acm (-m)
+# Both log each call of their state callback, so the log shows which callbacks a get calls
+# 1. A get filtered on one namespace calls only the callback of that namespace
+# 2. A get without filter calls both
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fstate=$dir/state.xml
+fyang=$dir/state.yang
+flog=$dir/backend.log
+touch $flog
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  <CLICON_STREAM_DISCOVERY_RFC8040>false</CLICON_STREAM_DISCOVERY_RFC8040>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module state{
+    yang-version 1.1;
+    namespace "urn:example:state";
+    prefix st;
+    import ietf-netconf-acm {
+        prefix nacm;
+    }
+    container s{
+        config false;
+        leaf counter{
+           type uint32;
+        }
+    }
+}
+EOF
+
+cat <<EOF > $fstate
+<s xmlns="urn:example:state"><counter>42</counter></s>
+EOF
+
+# Check number of calls of a state callback in backend log
+# 1: callback function name
+# 2: expected number of calls
+function checkcalls()
+{
+    new "check $1 called $2 times"
+    n=$(grep -c "$1" $flog)
+    if [ "$n" != "$2" ]; then
+        err "$2 calls of $1" "$n"
+    fi
+}
+
+new "test params: -f $cfg -l f$flog -- -sS $fstate -N urn:example:state -m"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg -l f$flog -- -sS $fstate -N urn:example:state -m"
+    start_backend -s init -f $cfg -l f$flog -- -sS $fstate -N urn:example:state -m
+fi
+
+new "wait backend"
+wait_backend
+
+checkcalls example_statefile 0
+checkcalls nacm_statedata 0
+
+new "get state filtered on urn:example:state"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get content=\"nonconfig\"><filter type=\"xpath\" select=\"/st:s\" xmlns:st=\"urn:example:state\"/></get></rpc>" "" "<rpc-reply $DEFAULTNS><data><s xmlns=\"urn:example:state\"><counter>42</counter></s></data></rpc-reply>"
+
+checkcalls example_statefile 1
+checkcalls nacm_statedata 0
+
+new "get state filtered on ietf-netconf-acm"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get content=\"nonconfig\"><filter type=\"xpath\" select=\"/nacm:nacm\" xmlns:nacm=\"urn:ietf:params:xml:ns:yang:ietf-netconf-acm\"/></get></rpc>" "" "<denied-operations>0</denied-operations>"
+
+checkcalls example_statefile 1
+checkcalls nacm_statedata 1
+
+new "get state without filter"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get content=\"nonconfig\"/></rpc>" "" "<s xmlns=\"urn:example:state\"><counter>42</counter></s>"
+
+checkcalls example_statefile 2
+checkcalls nacm_statedata 2
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,121 @@
+#!/usr/bin/env bash
+# Stream replay log stored in segment files, see CLICON_STREAM_REPLAY_DIR
+# Uses the EXAMPLE stream of the main example, which emits an event every 5s
+# 1. Replay from a start time sends stored events
+# 2. Replay from now sends no stored events
+# 3. Replay log is kept over a backend restart
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/example.yang
+replaydir=$dir/replay
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_REGEXP>example_backend.so$</CLICON_BACKEND_REGEXP>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  <CLICON_STREAM_DISCOVERY_RFC5277>true</CLICON_STREAM_DISCOVERY_RFC5277>
+  <CLICON_STREAM_RETENTION>3600</CLICON_STREAM_RETENTION>
+  <CLICON_STREAM_REPLAY_DIR>$replaydir</CLICON_STREAM_REPLAY_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+   namespace "urn:example:clixon";
+   prefix ex;
+   notification event {
+      leaf event-class {
+         type string;
+      }
+      container reportingEntity {
+         leaf card {
+            type string;
+         }
+      }
+      leaf severity {
+         type string;
+      }
+   }
+}
+EOF
+
+# Subscribe to EXAMPLE stream with replay and count notifications received within 2s
+# 1: startTime
+function replaycount()
+{
+    rpc="<rpc $DEFAULTNS><create-subscription xmlns=\"urn:ietf:params:xml:ns:netmod:notification\"><stream>EXAMPLE</stream><startTime>$1</startTime></create-subscription></rpc>"
+    sleep 2 | cat <(echo "$DEFAULTHELLO$(chunked_framing "$rpc")") - | $clixon_netconf -qef $cfg | grep -o "<notification " | wc -l
+}
+
+mkdir -p $replaydir
+sudo chmod 777 $replaydir
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg -- -n"
+    start_backend -s init -f $cfg -- -n # create example notification stream
+fi
+
+new "wait backend"
+wait_backend
+
+START=$(date -u +"%Y-%m-%dT%H:%M:%S")
+
+new "wait for events"
+sleep 11
+
+new "replay from start expect 2-4 events"
+expectpart "$(replaycount $START)" 0 "^[234]$"
+
+new "replay segment file"
+expectpart "$(ls $replaydir)" 0 "^EXAMPLE-00000000.replay$"
+
+new "replay from now expect 0-1 events"
+expectpart "$(replaycount $(date -u +"%Y-%m-%dT%H:%M:%S"))" 0 "^[01]$"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    stop_backend -f $cfg
+
+    new "restart backend -s init -f $cfg -- -n"
+    start_backend -s init -f $cfg -- -n
+fi
+
+new "wait backend"
+wait_backend
+
+new "replay from start after restart expect 2-9 events"
+expectpart "$(replaycount $START)" 0 "^[2-9]$"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
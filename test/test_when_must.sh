@@ -139,6 +139,10 @@ expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>
 new "must: eth validate fail"
 expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag><error-severity>error</error-severity><error-message>An Ethernet MTU must be 1500</error-message></rpc-error></rpc-reply>"
 
+# Must/when xpaths are parsed once, either pre-compiled in yang or cached
+new "stats: xpath cache"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><stats $LIBNS/></rpc>" "" "<rpc-reply $DEFAULTNS><global $LIBNS><xmlnr>[0-9]*</xmlnr><yangnr>[0-9]*</yangnr><xpathnr>[0-9]*</xpathnr><xpathhits>[1-9][0-9]*</xpathhits><xpathmisses>[0-9]*</xpathmisses></global>"
+
 if [ $BE -ne 0 ]; then
     new "Kill backend"
     # Check if premature kill
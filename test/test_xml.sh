@@ -20,6 +20,13 @@ expecteof "$clixon_util_xml -o" 0 "<a><b/></a>" "^<a><b/></a>$"
 new "xml parse to json"
 expecteof "$clixon_util_xml -oj" 0 "<a><b/></a>" '{"a":{"b":{}}}'
 
+# Values shorter than 16 bytes are stored inline in the node, longer are allocated
+new "xml parse values around inline size"
+expecteof "$clixon_util_xml -o" 0 "<a><b>012345678901234</b><c>0123456789012345</c><d x=\"0123456789012345678\">01234567890123456</d></a>" "^<a><b>012345678901234</b><c>0123456789012345</c><d x=\"0123456789012345678\">01234567890123456</d></a>$"
+
+new "xml parse value appended across inline size"
+expecteof "$clixon_util_xml -o" 0 "<a>0123456789&amp;0123456789&lt;0123456789</a>" "^<a>0123456789&amp;0123456789&lt;0123456789</a>$"
+
 new "xml parse strange names"
 expecteof "$clixon_util_xml -o" 0 "<_-><b0.><c-.-._/></b0.></_->" "<_-><b0.><c-.-._/></b0.></_->"
 
@@ -66,7 +66,7 @@
 #include <clixon/clixon.h>
 
 /* Command line options to be passed to getopt(3) */
-#define DATASTORE_OPTS "hDd:b:f:x:y:Y:"
+#define DATASTORE_OPTS "hDd:b:f:x:y:Y:j:"
 
 /*! usage
  */
@@ -83,6 +83,7 @@ usage(char *argv0)
             "\t-x <xml>\tXML file. Alternative to put <xml> argument\n"
             "\t-y <file>\tYang file. Mandatory\n"
             "\t-Y <dir> \tYang dirs (can be several)\n"
+            "\t-j <max>\tJournal incremental edits, compact at <max> bytes\n"
             "and command is either:\n"
             "\tget [<xpath>]\n"
             "\tmget <nr> [<xpath>]\n"
@@ -176,6 +177,12 @@ main(int argc, char **argv)
             if (clicon_option_add(h, "CLICON_YANG_DIR", optarg) < 0)
                 goto done;
             break;
+        case 'j': /* journal */
+            if (!optarg)
+                usage(argv0);
+            clicon_option_str_set(h, "CLICON_XMLDB_JOURNAL", "true");
+            clicon_option_str_set(h, "CLICON_XMLDB_JOURNAL_MAX", optarg);
+            break;
         }
     /* 
      * Logs, error and debug to stderr, set debug level
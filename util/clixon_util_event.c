@@ -0,0 +1,205 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2020-2023 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  * Benchmark of event dispatch cost as a function of number of registered file descriptors,
+  * eg number of connected clients.
+  * Create <nr> socket pairs and register one end of each in the clixon event loop. A single
+  * token is passed around the sockets in pseudo-random order so that each loop round has
+  * exactly one ready fd. Prints number of fds and average dispatch time in microseconds.
+  * Example:
+  *   clixon_util_event -n 1000 -r 100000
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <syslog.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon/clixon.h"
+
+static int  *_sv = NULL;  /* Write ends of socket pairs */
+static int   _nr = 0;     /* Number of socket pairs */
+static int   _rounds = 0; /* Remaining dispatch rounds */
+static uint32_t _seed = 1; /* Pseudo-random state */
+
+/*! Read token and pass it on to next socket, exit when all rounds are done
+ */
+static int
+event_token_cb(int   s,
+               void *arg)
+{
+    char     ch;
+    int      i;
+
+    if (read(s, &ch, 1) < 0){
+        clicon_err(OE_UNIX, errno, "read");
+        return -1;
+    }
+    if (--_rounds <= 0){
+        clixon_exit_set(1);
+        return 0;
+    }
+    /* Pseudo-random walk over all sockets */
+    _seed = _seed*1103515245 + 12345;
+    i = (_seed >> 16) % _nr;
+    if (write(_sv[i], &ch, 1) < 0){
+        clicon_err(OE_UNIX, errno, "write");
+        return -1;
+    }
+    return 0;
+}
+
+static int
+usage(char *argv0)
+{
+    fprintf(stderr, "usage:%s [options]\n"
+            "where options are\n"
+            "\t-h \t\tHelp\n"
+            "\t-D <level>\tDebug\n"
+            "\t-n <nr>     \tNumber of registered fds/clients (default: 100)\n"
+            "\t-r <nr>     \tNumber of dispatch rounds (default: 100000)\n"
+            "\t-e          \tEdge-triggered mode\n",
+            argv0
+            );
+    exit(0);
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+    int            retval = -1;
+    char          *argv0 = argv[0];
+    int            c;
+    int            dbg = 0;
+    int            flags = 0;
+    int            rounds = 100000;
+    int            i;
+    int            sp[2];
+    struct rlimit  rl;
+    struct timeval t0;
+    struct timeval t1;
+    struct timeval t;
+    clicon_handle  h;
+
+    optind = 1;
+    opterr = 0;
+    _nr = 100;
+    while ((c = getopt(argc, argv, "hD:n:r:e")) != -1)
+        switch (c) {
+        case 'h':
+            usage(argv0);
+            break;
+        case 'D':
+            if (sscanf(optarg, "%d", &dbg) != 1)
+                usage(argv0);
+            break;
+        case 'n':
+            if ((_nr = atoi(optarg)) <= 0)
+                usage(argv0);
+            break;
+        case 'r':
+            if ((rounds = atoi(optarg)) <= 0)
+                usage(argv0);
+            break;
+        case 'e':
+            flags |= CLIXON_EVENT_EDGE;
+            break;
+        default:
+            usage(argv[0]);
+            break;
+        }
+    clicon_log_init(__FILE__, dbg?LOG_DEBUG:LOG_INFO, CLICON_LOG_STDERR); 
+    clicon_debug_init(dbg, NULL);
+    if ((h = clicon_handle_init()) == NULL)
+        goto done;
+    /* Two fds per client plus some margin */
+    if (getrlimit(RLIMIT_NOFILE, &rl) < 0){
+        clicon_err(OE_UNIX, errno, "getrlimit");
+        goto done;
+    }
+    if (rl.rlim_cur < 2*_nr + 16){
+        rl.rlim_cur = 2*_nr + 16;
+        if (rl.rlim_max < rl.rlim_cur)
+            rl.rlim_max = rl.rlim_cur;
+        if (setrlimit(RLIMIT_NOFILE, &rl) < 0){
+            clicon_err(OE_UNIX, errno, "setrlimit %d fds", 2*_nr + 16);
+            goto done;
+        }
+    }
+    if ((_sv = calloc(_nr, sizeof(int))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<_nr; i++){
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sp) < 0){
+            clicon_err(OE_UNIX, errno, "socketpair");
+            goto done;
+        }
+        _sv[i] = sp[1];
+        if (clixon_event_reg_fd_flags(sp[0], event_token_cb, (void*)(intptr_t)i, "token", flags) < 0)
+            goto done;
+    }
+    _rounds = rounds;
+    if (write(_sv[0], "x", 1) < 0){
+        clicon_err(OE_UNIX, errno, "write");
+        goto done;
+    }
+    gettimeofday(&t0, NULL);
+    if (clixon_event_loop(h) < 0)
+        goto done;
+    gettimeofday(&t1, NULL);
+    timersub(&t1, &t0, &t);
+    fprintf(stdout, "%d %.3f\n", _nr, (t.tv_sec*1000000.0 + t.tv_usec)/rounds);
+    retval = 0;
+ done:
+    clixon_event_exit();
+    if (_sv)
+        free(_sv);
+    return retval;
+}
@@ -0,0 +1,195 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2020-2023 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  *
+  * Hash table benchmark: insert, lookup and delete throughput of clicon_hash
+  * Insert <nr> keys, look up all keys <rounds> times in pseudo-random order, and delete
+  * all keys. Prints number of keys and average time per insert, lookup and delete in
+  * nanoseconds.
+  * Example:
+  *   clixon_util_hash -n 100000 -r 10
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/time.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon/clixon.h"
+
+static int
+usage(char *argv0)
+{
+    fprintf(stderr, "usage:%s [options]\n"
+            "where options are\n"
+            "\t-h \t\tHelp\n"
+            "\t-D <level>\tDebug\n"
+            "\t-n <nr>     \tNumber of keys (default: 1000)\n"
+            "\t-r <nr>     \tNumber of lookup rounds over all keys (default: 10)\n",
+            argv0
+            );
+    exit(0);
+}
+
+/*! Elapsed time since t0 in nanoseconds per operation
+ */
+static double
+elapsed_ns(struct timeval *t0,
+           int             nr)
+{
+    struct timeval t1;
+    struct timeval t;
+
+    gettimeofday(&t1, NULL);
+    timersub(&t1, t0, &t);
+    return (t.tv_sec*1000000000.0 + t.tv_usec*1000.0)/nr;
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+    int            retval = -1;
+    char          *argv0 = argv[0];
+    int            c;
+    int            dbg = 0;
+    int            nr = 1000;
+    int            rounds = 10;
+    int            i;
+    int            j;
+    char         **keys = NULL;
+    uint32_t      *order = NULL;
+    uint32_t       seed = 1;
+    uint32_t       tmp;
+    clicon_hash_t *hash = NULL;
+    struct timeval t0;
+    double         tins;
+    double         tlook;
+    double         tdel;
+
+    optind = 1;
+    opterr = 0;
+    while ((c = getopt(argc, argv, "hD:n:r:")) != -1)
+        switch (c) {
+        case 'h':
+            usage(argv0);
+            break;
+        case 'D':
+            if (sscanf(optarg, "%d", &dbg) != 1)
+                usage(argv0);
+            break;
+        case 'n':
+            if ((nr = atoi(optarg)) <= 0)
+                usage(argv0);
+            break;
+        case 'r':
+            if ((rounds = atoi(optarg)) <= 0)
+                usage(argv0);
+            break;
+        default:
+            usage(argv[0]);
+            break;
+        }
+    clicon_log_init(__FILE__, dbg?LOG_DEBUG:LOG_INFO, CLICON_LOG_STDERR); 
+    clicon_debug_init(dbg, NULL);
+    /* Keys look like typical option/data names with a numeric suffix */
+    if ((keys = calloc(nr, sizeof(char*))) == NULL ||
+        (order = calloc(nr, sizeof(uint32_t))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<nr; i++){
+        if ((keys[i] = malloc(32)) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        snprintf(keys[i], 32, "CLICON_KEY_%d", i);
+        order[i] = i;
+    }
+    /* Pseudo-random lookup order */
+    for (i=nr-1; i>0; i--){
+        seed = seed*1103515245 + 12345;
+        j = (seed >> 8) % (i+1);
+        tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    if ((hash = clicon_hash_init()) == NULL)
+        goto done;
+    gettimeofday(&t0, NULL);
+    for (i=0; i<nr; i++)
+        if (clicon_hash_add(hash, keys[i], &i, sizeof(i)) == NULL)
+            goto done;
+    tins = elapsed_ns(&t0, nr);
+    gettimeofday(&t0, NULL);
+    for (j=0; j<rounds; j++)
+        for (i=0; i<nr; i++)
+            if (clicon_hash_value(hash, keys[order[i]], NULL) == NULL){
+                clicon_err(OE_UNIX, ENOENT, "key %s not found", keys[order[i]]);
+                goto done;
+            }
+    tlook = elapsed_ns(&t0, nr*rounds);
+    gettimeofday(&t0, NULL);
+    for (i=0; i<nr; i++)
+        if (clicon_hash_del(hash, keys[order[i]]) < 0){
+            clicon_err(OE_UNIX, ENOENT, "key %s not found", keys[order[i]]);
+            goto done;
+        }
+    tdel = elapsed_ns(&t0, nr);
+    fprintf(stdout, "%d %.1f %.1f %.1f\n", nr, tins, tlook, tdel);
+    retval = 0;
+ done:
+    if (hash)
+        clicon_hash_free(hash);
+    if (keys){
+        for (i=0; i<nr; i++)
+            if (keys[i])
+                free(keys[i]);
+        free(keys);
+    }
+    if (order)
+        free(order);
+    return retval;
+}
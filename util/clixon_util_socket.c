@@ -55,6 +55,7 @@
 #include <signal.h>
 #include <sys/time.h>
 #include <sys/stat.h>
+#include <arpa/inet.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -73,6 +74,7 @@ usage(char *argv0)
             "\t-s <sockpath> \tPath to unix domain socket (or IP addr)\n"
             "\t-f <file>\tXML input file (overrides stdin)\n"
             "\t-J \t\tInput as JSON (instead of XML)\n"
+            "\t-n <nr>\tPipeline: send request <nr> times in one write, then read <nr> replies\n"
             ,
             argv0);
     exit(0);
@@ -101,6 +103,11 @@ main(int    argc,
     int                dbg = 0;
     int                s;
     int                eof = 0;
+    int                nr = 1;
+    int                i;
+    uint32_t           mlen;
+    char              *buf = NULL;
+    struct clicon_msg *reply = NULL;
 
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init(__FILE__, LOG_INFO, CLICON_LOG_STDERR); 
@@ -110,7 +117,7 @@ main(int    argc,
 
     optind = 1;
     opterr = 0;
-    while ((c = getopt(argc, argv, "hD:s:f:Ja:")) != -1)
+    while ((c = getopt(argc, argv, "hD:s:f:Ja:n:")) != -1)
         switch (c) {
         case 'h':
             usage(argv[0]);
@@ -131,6 +138,10 @@ main(int    argc,
         case 'a':
             family = optarg;
             break;
+        case 'n':
+            if (sscanf(optarg, "%d", &nr) != 1 || nr < 1)
+                usage(argv[0]);
+            break;
         default:
             usage(argv[0]);
             break;
@@ -178,10 +189,34 @@ main(int    argc,
     else
         if (clicon_rpc_connect_inet(h, sockpath, 4535, &s) < 0)
             goto done;
-    if (clicon_rpc(s, msg, &retdata, &eof) < 0)
-        goto done;
+    if (nr == 1){
+        if (clicon_rpc(s, msg, &retdata, &eof) < 0)
+            goto done;
+        fprintf(stdout, "%s\n", retdata);
+    }
+    else { /* Pipelined: all requests in one write, backend must split them */
+        mlen = ntohl(msg->op_len);
+        if ((buf = malloc(nr*mlen)) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        for (i=0; i<nr; i++)
+            memcpy(buf + i*mlen, msg, mlen);
+        if (write(s, buf, nr*mlen) != nr*mlen){
+            clicon_err(OE_UNIX, errno, "write");
+            goto done;
+        }
+        for (i=0; i<nr; i++){
+            if (clicon_msg_rcv(s, 0, &reply, &eof) < 0)
+                goto done;
+            if (eof)
+                break;
+            fprintf(stdout, "%s\n", reply->op_body);
+            free(reply);
+            reply = NULL;
+        }
+    }
     close(s);
-    fprintf(stdout, "%s\n", retdata);
     retval = 0;
  done:
     if (fp)
@@ -192,6 +227,12 @@ main(int    argc,
         xml_free(xt);
     if (msg)
         free(msg);
+    if (buf)
+        free(buf);
+    if (reply)
+        free(reply);
+    if (retdata)
+        free(retdata);
     if (cb)
         cbuf_free(cb);
     return retval;
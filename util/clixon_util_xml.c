@@ -54,6 +54,7 @@
 #include <string.h>
 #include <limits.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <syslog.h>
 #include <fcntl.h>
 #include <signal.h>
@@ -67,7 +68,7 @@
 #include "clixon/clixon.h"
 
 /* Command line options passed to getopt(3) */
-#define UTIL_XML_OPTS "hD:f:JjXl:pvoy:Y:t:T:u"
+#define UTIL_XML_OPTS "hD:f:JjXl:pvoy:Y:t:T:uas"
 
 static int
 validate_tree(clicon_handle h,
@@ -128,6 +129,8 @@ usage(char *argv0)
             "\t-t <file>\tXML top input file (where base tree is pasted to)\n"
             "\t-T <path>\tXPath to where in top input file base should be pasted\n"
             "\t-u \t\tTreat unknown XML as anydata\n"
+            "\t-a \t\tParse XML/JSON in an XML arena, see xml_arena_push\n"
+            "\t-s \t\tPrint XML statistics and time to free the tree on stderr\n"
             ,
             argv0);
     exit(0);
@@ -166,6 +169,13 @@ main(int    argc,
     cvec         *nsc = NULL; 
     yang_bind     yb;
     int           dbg = 0;
+    int           arena = 0;
+    int           stats = 0;
+    uint64_t      nr0 = 0;
+    uint64_t      nr;
+    size_t        sz;
+    struct timeval t0;
+    struct timeval t1;
 
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init(__FILE__, LOG_INFO, CLICON_LOG_STDERR); 
@@ -232,6 +242,12 @@ main(int    argc,
                 goto done;
             xml_bind_yang_unknown_anydata(1);
             break;
+        case 'a':
+            arena++;
+            break;
+        case 's':
+            stats++;
+            break;
         default:
             usage(argv[0]);
             break;
@@ -265,6 +281,8 @@ main(int    argc,
                 goto done;
         }
     }
+    if (stats)
+        xml_stats_global(&nr0);
     /* If top file is declared, the base XML/JSON is pasted as child to the top-file.
      * This is to emulate sub-tress, not just top-level parsing.
      * Always validated
@@ -301,8 +319,13 @@ main(int    argc,
         }
     }
     /* 2. Parse data (xml/json) */
+    if (arena)
+        xml_arena_push();
     if (jsonin){
-        if ((ret = clixon_json_parse_file(fp, 1, top_input_filename?YB_PARENT:YB_MODULE, yspec, &xt, &xerr)) < 0)
+        ret = clixon_json_parse_file(fp, 1, top_input_filename?YB_PARENT:YB_MODULE, yspec, &xt, &xerr);
+        if (arena)
+            xml_arena_pop();
+        if (ret < 0)
             goto done;
         if (ret == 0){
             clixon_netconf_error(xerr, "util_xml", NULL);
@@ -316,7 +339,10 @@ main(int    argc,
             yb = YB_MODULE;
         else
             yb = YB_PARENT;
-        if ((ret = clixon_xml_parse_file(fp, yb, yspec, &xt, &xerr)) < 0){
+        ret = clixon_xml_parse_file(fp, yb, yspec, &xt, &xerr);
+        if (arena)
+            xml_arena_pop();
+        if (ret < 0){
             fprintf(stderr, "xml parse error: %s\n", clicon_err_reason);
             goto done;
         }
@@ -346,6 +372,22 @@ main(int    argc,
         fprintf(stdout, "%s", cbuf_get(cb));
         fflush(stdout);
     }
+    /* 5. Statistics of tree and of freeing it */
+    if (stats){
+        nr = 0;
+        sz = 0;
+        if (xml_stats(xtop?xtop:xt, &nr, &sz) < 0)
+            goto done;
+        fprintf(stderr, "xml_stats nr:%" PRIu64 " size:%zu\n", nr, sz);
+        gettimeofday(&t0, NULL);
+        xml_free(xtop?xtop:xt);
+        gettimeofday(&t1, NULL);
+        xtop = xt = NULL;
+        timersub(&t1, &t0, &t1);
+        xml_stats_global(&nr);
+        fprintf(stderr, "xml_free time:%ld.%06lds remaining:%" PRIu64 "\n",
+                (long)t1.tv_sec, (long)t1.tv_usec, nr - nr0);
+    }
     retval = 0;
  done:
     if (tfp)
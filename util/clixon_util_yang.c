@@ -34,6 +34,9 @@
 
   * Parse a SINGLE yang file - no dependencies - utility function only useful
   * for basic syntactic checks.
+  * With -y, load a yang file or directory with dependencies, and optionally (-n) measure
+  * yang_find and yang_find_datanode of all data nodes, eg:
+  *   clixon_util_yang -Y /usr/local/share/openconfig -y /usr/local/share/openconfig/release/models -n 10
  */
 
 #ifdef HAVE_CONFIG_H
@@ -55,6 +58,7 @@
 #include <sys/stat.h>
 #include <libgen.h>
 #include <netinet/in.h>
+#include <sys/time.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -62,8 +66,6 @@
 /* clixon */
 #include "clixon/clixon.h"
 
-/*
-*/
 static int
 usage(char *argv0)
 {
@@ -71,22 +73,69 @@ usage(char *argv0)
             "where options are\n"
             "\t-h \t\tHelp\n"
             "\t-D <level> \tDebug\n"
-            "\t-l <s|e|o> \tLog on (s)yslog, std(e)rr, std(o)ut (stderr is default)\n",
+            "\t-l <s|e|o> \tLog on (s)yslog, std(e)rr, std(o)ut (stderr is default)\n"
+            "\t-y <file|dir>\tLoad yang file or all yangs in dir with dependencies (instead of stdin)\n"
+            "\t-Y <dir> \tYang dirs for dependencies (can be several)\n"
+            "\t-n <nr> \tLook up all data nodes <nr> times, print: nodes load-ms lookups ns/lookup\n",
             argv0);
     exit(0);
 }
 
+/*! Look up all data nodes from their parents by name
+ * @param[in]  yn    Yang node
+ * @param[out] nr    Number of lookups made
+ * @retval     0     OK
+ * @retval    -1     Error, node not found
+ */
+static int
+yang_find_all(yang_stmt *yn,
+              int       *nr)
+{
+    yang_stmt *yc = NULL;
+    char      *name;
+
+    while ((yc = yn_each(yn, yc)) != NULL){
+        if (yang_datanode(yc)){
+            name = yang_argument_get(yc);
+            /* Not necessarily yc: augments from other modules may use same name */
+            if (yang_find(yn, yang_keyword_get(yc), name) == NULL ||
+                yang_find_datanode(yn, name) == NULL){
+                clicon_err(OE_YANG, ENOENT, "%s %s not found", yang_key2str(yang_keyword_get(yc)), name);
+                return -1;
+            }
+            (*nr) += 2;
+        }
+        if (yang_find_all(yc, nr) < 0)
+            return -1;
+    }
+    return 0;
+}
+
 int
 main(int argc, char **argv)
 {
-    yang_stmt *yspec = NULL;
-    int        c;
-    int        logdst = CLICON_LOG_STDERR;
-    int        dbg = 0;
+    int            retval = -1;
+    yang_stmt     *yspec = NULL;
+    int            c;
+    int            logdst = CLICON_LOG_STDERR;
+    int            dbg = 0;
+    clicon_handle  h = NULL;
+    char          *yang_file_dir = NULL;
+    struct stat    st;
+    int            rounds = 0;
+    int            i;
+    int            nodes = 0;
+    int            nr = 0;
+    struct timeval t0;
+    struct timeval t1;
+    struct timeval t;
+    double         tload;
     
+    if ((h = clicon_handle_init()) == NULL)
+        goto done;
     optind = 1;
     opterr = 0;
-    while ((c = getopt(argc, argv, "hD:l:")) != -1)
+    while ((c = getopt(argc, argv, "hD:l:y:Y:n:")) != -1)
         switch (c) {
         case 'h':
             usage(argv[0]);
@@ -99,22 +148,69 @@ main(int argc, char **argv)
             if ((logdst = clicon_log_opt(optarg[0])) < 0)
                 usage(argv[0]);
             break;
+        case 'y':
+            yang_file_dir = optarg;
+            break;
+        case 'Y':
+            if (clicon_option_add(h, "CLICON_YANG_DIR", optarg) < 0)
+                goto done;
+            break;
+        case 'n':
+            if ((rounds = atoi(optarg)) <= 0)
+                usage(argv[0]);
+            break;
         default:
             usage(argv[0]);
             break;
         }
     clicon_log_init("clixon_util_yang", dbg?LOG_DEBUG:LOG_INFO, logdst);
     clicon_debug_init(dbg, NULL);
+    yang_init(h);
     if ((yspec = yspec_new()) == NULL)
         goto done;
-    if (yang_parse_file(stdin, "yang test", yspec) == NULL){
-        fprintf(stderr, "yang parse error %s\n", clicon_err_reason);
-        return -1;
+    if (yang_file_dir == NULL){
+        if (yang_parse_file(stdin, "yang test", yspec) == NULL){
+            fprintf(stderr, "yang parse error %s\n", clicon_err_reason);
+            goto done;
+        }
+        yang_print(stdout, yspec);
+        goto ok;
+    }
+    if (stat(yang_file_dir, &st) < 0){
+        clicon_err(OE_YANG, errno, "%s not found", yang_file_dir);
+        goto done;
     }
-    yang_print(stdout, yspec);
+    gettimeofday(&t0, NULL);
+    if (S_ISDIR(st.st_mode)){
+        if (yang_spec_load_dir(h, yang_file_dir, yspec) < 0)
+            goto done;
+    }
+    else if (yang_spec_parse_file(h, yang_file_dir, yspec) < 0)
+        goto done;
+    gettimeofday(&t1, NULL);
+    timersub(&t1, &t0, &t);
+    tload = t.tv_sec*1000.0 + t.tv_usec/1000.0;
+    if (rounds == 0){
+        yang_print(stdout, yspec);
+        goto ok;
+    }
+    gettimeofday(&t0, NULL);
+    for (i=0; i<rounds; i++){
+        nr = 0;
+        if (yang_find_all(yspec, &nr) < 0)
+            goto done;
+    }
+    gettimeofday(&t1, NULL);
+    timersub(&t1, &t0, &t);
+    nodes = nr/2;
+    fprintf(stdout, "%d %.1f %d %.1f\n", nodes, tload, nr*rounds,
+            nr?(t.tv_sec*1000000000.0 + t.tv_usec*1000.0)/(nr*rounds):0.0);
+ ok:
+    retval = 0;
  done:
     if (yspec)
         ys_free(yspec);
-     return 0;
+    if (h)
+        clicon_handle_exit(h);
+    return retval;
 }
-